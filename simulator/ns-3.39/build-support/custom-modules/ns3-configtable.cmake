@@ -173,6 +173,9 @@ macro(write_configtable)
   string(APPEND out "Python Bindings               : ")
   check_on_or_off("${NS3_PYTHON_BINDINGS}" "${ENABLE_PYTHON_BINDINGS}")
 
+  string(APPEND out "Slab allocator                : ")
+  check_on_or_off("${NS3_SLAB_ALLOCATOR}" "${NS3_SLAB_ALLOCATOR}")
+
   string(APPEND out "SQLite support                : ")
   check_on_or_off("${NS3_SQLITE}" "${ENABLE_SQLITE}")
 
@@ -627,6 +627,10 @@ macro(process_options)
     add_definitions(-DENABLE_DES_METRICS)
   endif()
 
+  if(${NS3_SLAB_ALLOCATOR})
+    add_definitions(-DENABLE_SLAB_ALLOCATOR)
+  endif()
+
   if(${NS3_SANITIZE} AND ${NS3_SANITIZE_MEMORY})
     message(
       FATAL_ERROR
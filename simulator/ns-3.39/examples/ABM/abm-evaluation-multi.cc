@@ -51,10 +51,7 @@
 
 #define PORT_END 65530
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
 
 
 using namespace ns3;
@@ -151,7 +148,7 @@ int get_target_leaf(int leafCount) {
 	return tar;
 }
 
-void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, struct cdf_table *cdfTable,
+void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, Ptr<FlowSizeDistribution> cdfTable,
                                   long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int priority)
 {
 	int fan = SERVER_COUNT * (LEAF_COUNT - 1);
@@ -225,7 +222,7 @@ void install_applications_incast (int incastLeaf, NodeContainer* servers, double
 	}
 }
 
-void install_applications (int txLeaf, NodeContainer* servers, double requestRate, struct cdf_table *cdfTable,
+void install_applications (int txLeaf, NodeContainer* servers, double requestRate, Ptr<FlowSizeDistribution> cdfTable,
                            long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int priority)
 {
 	uint64_t flowSize;
@@ -256,9 +253,9 @@ void install_applications (int txLeaf, NodeContainer* servers, double requestRat
 				PORT_START[rxLeaf * SERVER_COUNT + rxServer] = 4444;
 			}
 
-			uint64_t flowSize = gen_random_cdf (cdfTable);
+			uint64_t flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			while (flowSize == 0) {
-				flowSize = gen_random_cdf (cdfTable);
+				flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			}
 
 			Ptr<Node> rxNode = servers[rxLeaf].Get (rxServer);
@@ -795,14 +792,13 @@ main (int argc, char *argv[])
 
 	// double oversub_wrt_each = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT)/3;
 
-	struct cdf_table* cdfTable = new cdf_table ();
-	init_cdf (cdfTable);
-	load_cdf (cdfTable, cdfFileName.c_str ());
+	Ptr<FlowSizeDistribution> cdfTable = CreateObject<FlowSizeDistribution> ();
+	cdfTable->Load (cdfFileName);
 	NS_LOG_INFO ("Calculating request rate");
 
-	double requestRate_Cubic = loadCubic * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * avg_cdf (cdfTable)) / (serversCubic[0].GetN());
-	double requestRate_Dctcp = loadDctcp * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * avg_cdf (cdfTable)) / (serversDctcp[0].GetN());
-	double requestRate_Power = loadPower * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * avg_cdf (cdfTable)) / (serversPower[0].GetN());
+	double requestRate_Cubic = loadCubic * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * cdfTable->GetMean ()) / (serversCubic[0].GetN());
+	double requestRate_Dctcp = loadDctcp * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * cdfTable->GetMean ()) / (serversDctcp[0].GetN());
+	double requestRate_Power = loadPower * SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT / (8 * cdfTable->GetMean ()) / (serversPower[0].GetN());
 
 	if (randomSeed == 0)
 	{
@@ -847,6 +843,5 @@ main (int argc, char *argv[])
 	Simulator::Stop (Seconds (END_TIME));
 	Simulator::Run ();
 	Simulator::Destroy ();
-	free_cdf (cdfTable);
 	return 0;
 }
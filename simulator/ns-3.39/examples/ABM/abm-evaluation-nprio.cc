@@ -51,10 +51,7 @@
 
 #define PORT_END 65530
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
 
 
 using namespace ns3;
@@ -151,7 +148,7 @@ int get_target_leaf(int leafCount) {
 	return tar;
 }
 
-void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, struct cdf_table *cdfTable,
+void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, Ptr<FlowSizeDistribution> cdfTable,
                                   long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int priority)
 {
 	int fan = SERVER_COUNT;
@@ -221,7 +218,7 @@ void install_applications_incast (int incastLeaf, NodeContainer* servers, double
 	}
 }
 
-void install_applications (int txLeaf, NodeContainer* servers, double requestRate, struct cdf_table *cdfTable,
+void install_applications (int txLeaf, NodeContainer* servers, double requestRate, Ptr<FlowSizeDistribution> cdfTable,
                            long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int numPrior)
 {
 	uint64_t flowSize;
@@ -256,9 +253,9 @@ void install_applications (int txLeaf, NodeContainer* servers, double requestRat
 				PORT_START[rxLeaf * SERVER_COUNT + rxServer] = 4444;
 			}
 
-			uint64_t flowSize = gen_random_cdf (cdfTable);
+			uint64_t flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			while (flowSize == 0) {
-				flowSize = gen_random_cdf (cdfTable);
+				flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			}
 
 			Ptr<Node> rxNode = servers[rxLeaf].Get (rxServer);
@@ -862,11 +859,10 @@ main (int argc, char *argv[])
 	double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
 	NS_LOG_INFO ("Over-subscription ratio: " << oversubRatio);
 	NS_LOG_INFO ("Initialize CDF table");
-	struct cdf_table* cdfTable = new cdf_table ();
-	init_cdf (cdfTable);
-	load_cdf (cdfTable, cdfFileName.c_str ());
+	Ptr<FlowSizeDistribution> cdfTable = CreateObject<FlowSizeDistribution> ();
+	cdfTable->Load (cdfFileName);
 	NS_LOG_INFO ("Calculating request rate");
-	double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+	double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * cdfTable->GetMean ()) / SERVER_COUNT;
 	NS_LOG_INFO ("Average request rate: " << requestRate << " per second");
 	NS_LOG_INFO ("Initialize random seed: " << randomSeed);
 	if (randomSeed == 0)
@@ -903,6 +899,5 @@ main (int argc, char *argv[])
 	Simulator::Stop (Seconds (END_TIME));
 	Simulator::Run ();
 	Simulator::Destroy ();
-	free_cdf (cdfTable);
 	return 0;
 }
\ No newline at end of file
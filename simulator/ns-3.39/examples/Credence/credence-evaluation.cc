@@ -13,9 +13,6 @@
 #include <ctime>
 #include <set>
 #include <unordered_map>
-#include <pybind11/embed.h>
-#include <pybind11/numpy.h>
-#include <pybind11/stl.h>
 
 #include "ns3/core-module.h"
 #include "ns3/applications-module.h"
@@ -30,6 +27,7 @@
 #include "ns3/fq-pie-queue-disc.h"
 #include "ns3/fq-codel-queue-disc.h"
 #include "ns3/shared-memory.h"
+#include "ns3/tree-ensemble.h"
 #include "ns3/bufferlog-tag.h"
 
 # define PACKET_SIZE 1400
@@ -58,15 +56,10 @@
 
 #define PORT_END 65530
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
 
 
 using namespace ns3;
-namespace py = pybind11;
-using namespace pybind11::literals;
 
 NS_LOG_COMPONENT_DEFINE ("CREDENCE_EVALUATION");
 
@@ -202,7 +195,7 @@ int get_target_leaf(int leafCount) {
 	return tar;
 }
 
-void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, struct cdf_table *cdfTable,
+void install_applications_incast (int incastLeaf, NodeContainer* servers, double requestRate, uint32_t requestSize, Ptr<FlowSizeDistribution> cdfTable,
                                   long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int numPrior)
 {
 	int fan = SERVER_COUNT;
@@ -274,7 +267,7 @@ void install_applications_incast (int incastLeaf, NodeContainer* servers, double
 	}
 }
 
-void install_applications (int txLeaf, NodeContainer* servers, double requestRate, struct cdf_table *cdfTable,
+void install_applications (int txLeaf, NodeContainer* servers, double requestRate, Ptr<FlowSizeDistribution> cdfTable,
                            long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME, int numPrior)
 {
 	uint64_t flowSize;
@@ -304,9 +297,9 @@ void install_applications (int txLeaf, NodeContainer* servers, double requestRat
 				PORT_START[rxLeaf * SERVER_COUNT + rxServer] = 4444;
 			}
 
-			uint64_t flowSize = gen_random_cdf (cdfTable);
+			uint64_t flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			while (flowSize == 0) {
-				flowSize = gen_random_cdf (cdfTable);
+				flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 			}
 
 			Ptr<Node> rxNode = servers[rxLeaf].Get (rxServer);
@@ -348,33 +341,9 @@ void install_applications (int txLeaf, NodeContainer* servers, double requestRat
 	// std::cout << "Finished installation of applications from leaf-"<< fromLeafId << std::endl;
 }
 
-void getPrediction(py::object rf, py::object castInteger, uint32_t queueLength, uint32_t averageQueueLength, uint32_t sharedOccupancy,  uint32_t averageOccupancy, int &drop){
-	if (Simulator::Now().GetSeconds()>=START_TIME){
-		int pred = castInteger.attr("getPrediction")(rf, queueLength, averageQueueLength, sharedOccupancy, averageOccupancy).cast<int>();
-		if (pred ==0 || pred==1){
-			drop = pred;
-			// std::cout << "COUT out is: " << drop << std::endl;
-		}
-		else{
-			drop = 0;
-		}
-	}
-	else
-		drop = 0;
-}
-
 int
 main (int argc, char *argv[])
 {
-	py::scoped_interpreter guard{};
-	py::object joblib = py::module_::import("joblib");
-	py::object castInteger = py::module_::import("cast-to-integer");
-	// py::object rf = joblib.attr("load")(py::str("/home/vamsi/src/phd/codebase/ns3-datacenter/simulator/ns-3.39/examples/Credence/rf_models/model-2-0.8-0.875-2-WS-2.joblib"));
-	// int drop = 1;
-	// py::object *a = &rf;
-	// py::object *b = &castInteger;
-	// getPrediction(a,b,1,2,3,4,drop);
-	// return 0;
 	CommandLine cmd;
 
 	START_TIME = 10;
@@ -465,7 +434,7 @@ main (int argc, char *argv[])
 	cmd.AddValue("enableLqdTracing", "enable tracing Lqd events", enableLqdTracing);
 
 	std::string rfModelFile = "/home/vamsi/src/phd/codebase/ns3-datacenter/simulator/ns-3.39/examples/Credence/rf_models/model-2-0.8-0.75-2-WS-";
-	cmd.AddValue("rfModelFile", "path to rf model file. Note that the last part of the string is removed (index by switch id)", rfModelFile);
+	cmd.AddValue("rfModelFile", "path prefix of the rf models exported by trainLqd.py. The switch id and .json are appended", rfModelFile);
 
 	double errorProb = 0;
 	cmd.AddValue("errorProb", "insert some error 0-1", errorProb); 
@@ -798,7 +767,7 @@ main (int argc, char *argv[])
 	Ipv4AddressHelper ipv4;
 	Ipv4InterfaceContainer serverNics[LEAF_COUNT][SERVER_COUNT];
 
-	py::object rf[LEAF_COUNT+SPINE_COUNT];
+	Ptr<TreeEnsemble> rf[LEAF_COUNT+SPINE_COUNT];
 
 	for (uint32_t leaf = 0; leaf < LEAF_COUNT; leaf++) {
 		sharedMemoryLeaf[leaf] = CreateObject<SharedMemoryBuffer>();
@@ -809,7 +778,8 @@ main (int argc, char *argv[])
 		sharedMemoryLeaf[leaf]->setSwitchId(leaf);
 		sharedMemoryLeaf[leaf]->setAverageInteral(NanoSeconds(baseRTTNano*averageIntervalNano));
 		if (algorithm == CREDENCE){
-			rf[leaf] = joblib.attr("load")(py::str(rfModelFile+std::to_string(leaf)+".joblib"));
+			rf[leaf] = CreateObject<TreeEnsemble>();
+			rf[leaf]->Load(rfModelFile+std::to_string(leaf)+".json");
 		}
 	}
 
@@ -823,7 +793,8 @@ main (int argc, char *argv[])
 		sharedMemorySpine[spine]->setSwitchId(LEAF_COUNT+spine);
 		sharedMemorySpine[spine]->setAverageInteral(NanoSeconds(baseRTTNano*averageIntervalNano));
 		if (algorithm == CREDENCE){
-			rf[LEAF_COUNT+spine] = joblib.attr("load")(py::str(rfModelFile+std::to_string(LEAF_COUNT+spine)+".joblib"));
+			rf[LEAF_COUNT+spine] = CreateObject<TreeEnsemble>();
+			rf[LEAF_COUNT+spine]->Load(rfModelFile+std::to_string(LEAF_COUNT+spine)+".json");
 		}
 	}
 
@@ -925,7 +896,7 @@ main (int argc, char *argv[])
 				}
 				genDisc->setErr(errorProb);
 				genDisc->SetAttribute("predict",BooleanValue(true));
-				genDisc->TraceConnectWithoutContext("getPrediction", MakeBoundCallback(&getPrediction, rf[leaf], castInteger));
+				genDisc->SetAttribute("Predictor",PointerValue(rf[leaf]));
 				break;
 			default:
 				std::cout << "Error in buffer management configuration. Exiting!";
@@ -983,8 +954,8 @@ main (int argc, char *argv[])
 					genDisc[1]->SetAttribute("predict",BooleanValue(true));
 					genDisc[0]->setErr(errorProb);
 					genDisc[1]->setErr(errorProb);
-					genDisc[0]->TraceConnectWithoutContext("getPrediction", MakeBoundCallback(&getPrediction, rf[leaf], castInteger));
-					genDisc[1]->TraceConnectWithoutContext("getPrediction", MakeBoundCallback(&getPrediction, rf[LEAF_COUNT+spine], castInteger));
+					genDisc[0]->SetAttribute("Predictor",PointerValue(rf[leaf]));
+					genDisc[1]->SetAttribute("Predictor",PointerValue(rf[LEAF_COUNT+spine]));
 				}
 
 				for (uint32_t i = 0; i < 2; i++) {
@@ -1064,11 +1035,10 @@ main (int argc, char *argv[])
 	double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
 	NS_LOG_INFO ("Over-subscription ratio: " << oversubRatio);
 	NS_LOG_INFO ("Initialize CDF table");
-	struct cdf_table* cdfTable = new cdf_table ();
-	init_cdf (cdfTable);
-	load_cdf (cdfTable, cdfFileName.c_str ());
+	Ptr<FlowSizeDistribution> cdfTable = CreateObject<FlowSizeDistribution> ();
+	cdfTable->Load (cdfFileName);
 	NS_LOG_INFO ("Calculating request rate");
-	double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+	double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * cdfTable->GetMean ()) / SERVER_COUNT;
 	NS_LOG_INFO ("Average request rate: " << requestRate << " per second");
 	NS_LOG_INFO ("Initialize random seed: " << randomSeed);
 
@@ -1114,6 +1084,5 @@ main (int argc, char *argv[])
 	Simulator::Stop (Seconds (END_TIME));
 	Simulator::Run ();
 	Simulator::Destroy ();
-	free_cdf (cdfTable);
 	return 0;
 }
@@ -17,7 +17,23 @@ from IPython.display import Image
 # import graphviz
 # from sklearn.externals import joblib
 import joblib
+import json
 import sys
+
+def exportForest(rf, filename):
+    # flat node arrays of every tree, loaded by ns3::TreeEnsemble (credence-evaluation --rfModelFile)
+    trees = []
+    for estimator in rf.estimators_:
+        t = estimator.tree_
+        trees.append({"children_left": t.children_left.tolist(),
+                      "children_right": t.children_right.tolist(),
+                      "feature": t.feature.tolist(),
+                      "threshold": t.threshold.tolist(),
+                      "value": t.value[:, 0, :].tolist()})
+    with open(filename, 'w') as f:
+        json.dump({"n_features": int(rf.n_features_in_),
+                   "classes": [int(c) for c in rf.classes_],
+                   "trees": trees}, f)
 #%%
 csvfile=str(sys.argv[1])
 # csvfile="/home/vamsi/lakewood/src/phd/codebase/ns3-datacenter-Old/simulator/ns-3.35/examples/Credence/lqd-logs/lqdtrace-2-0.8-0.75-2-WS-0.csv"
@@ -84,6 +100,7 @@ for numTrees in trees:
     print(accuracy,precision,recall,f1score,numTrees,maxDepth,myScore)
 
     # joblib.dump(rf,dumpfile+'-'+str(numTrees)+'-'+switchId+'.joblib')
+    exportForest(rf,dumpfile+'-'+str(numTrees)+'-'+switchId+'.json')
 
 
 
@@ -19,12 +19,14 @@
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/error-model.h"
+#include "ns3/flow-trace-file.h"
 #include "ns3/global-route-manager.h"
 #include "ns3/internet-module.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/qbb-helper.h"
+#include "ns3/topology-file.h"
 #include <ns3/rdma-client-helper.h>
 #include <ns3/rdma-client.h>
 #include <ns3/rdma-driver.h>
@@ -111,7 +113,8 @@ unordered_map<uint64_t, double> rate2pmax;
 /************************************************
  * Runtime varibles
  ***********************************************/
-std::ifstream topof, flowf, tracef;
+std::ifstream tracef;
+FlowTraceFile flowf;
 
 NodeContainer n;
 NetDeviceContainer switchToSwitchInterfaces;
@@ -173,8 +176,14 @@ ReadFlowInput()
 {
     if (flow_input.idx < flow_num)
     {
-        flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >> flow_input.dport >>
-            flow_input.maxPacketCount >> flow_input.start_time;
+        FlowTraceRecord record;
+        flowf.Read(record);
+        flow_input.src = record.src;
+        flow_input.dst = record.dst;
+        flow_input.pg = record.pg;
+        flow_input.dport = record.dport;
+        flow_input.maxPacketCount = record.size;
+        flow_input.start_time = record.startTime;
         std::cout << "Flow " << flow_input.src << " " << flow_input.dst << " " << flow_input.pg
                   << " " << flow_input.dport << " " << flow_input.maxPacketCount << " "
                   << flow_input.start_time << " " << Simulator::Now().GetSeconds() << std::endl;
@@ -218,7 +227,7 @@ ScheduleFlowInputs()
     }
     else
     { // no more flows, close the file
-        flowf.close();
+        flowf.Close();
     }
 }
 
@@ -1096,19 +1105,22 @@ main(int argc, char* argv[])
         IntHeader::pint_bytes = Pint::get_n_bytes();
     }
 
-    topof.open(topology_file.c_str());
-    flowf.open(flow_file.c_str());
+    // text or binary, see convert-trace
+    TopologyFile topof;
+    NS_ABORT_MSG_UNLESS(topof.Open(topology_file), "Can't read the topology " << topology_file);
+    flowf.Open(flow_file);
     uint32_t node_num;
     uint32_t switch_num;
     uint32_t tors;
     uint32_t link_num;
     uint32_t trace_num;
-    topof >> node_num >> switch_num >> tors >>
-        link_num; // changed here. The previous order was node, switch, link // tors is not used.
-                  // switch_num=tors for now.
+    node_num = topof.GetNNodes();
+    switch_num = topof.GetNSwitches();
+    tors = topof.GetNTors(); // tors is not used. switch_num=tors for now.
+    link_num = topof.GetLinks().size();
     tors = switch_num;
     std::cout << node_num << " " << switch_num << " " << tors << " " << link_num << std::endl;
-    flowf >> flow_num;
+    flow_num = flowf.GetN();
 
     NodeContainer serverNodes;
     NodeContainer torNodes;
@@ -1121,8 +1133,7 @@ main(int argc, char* argv[])
     std::cout << "switch_num " << switch_num << std::endl;
     for (uint32_t i = 0; i < switch_num; i++)
     {
-        uint32_t sid;
-        topof >> sid;
+        uint32_t sid = topof.GetSwitches()[i];
         std::cout << "sid " << sid << std::endl;
         switchNumToId[i] = sid;
         switchIdToNum[sid] = i;
@@ -1201,19 +1212,17 @@ main(int argc, char* argv[])
     Ipv4AddressHelper ipv4;
     for (uint32_t i = 0; i < link_num; i++)
     {
-        uint32_t src;
-        uint32_t dst;
-        std::string data_rate;
-        std::string link_delay;
-        double error_rate;
-        topof >> src >> dst >> data_rate >> link_delay >> error_rate;
+        const TopologyLink& link = topof.GetLinks()[i];
+        uint32_t src = link.src;
+        uint32_t dst = link.dst;
+        double error_rate = link.errorRate;
 
         std::cout << src << " " << dst << " " << n.GetN() << std::endl;
         Ptr<Node> snode = n.Get(src);
         Ptr<Node> dnode = n.Get(dst);
 
-        qbb.SetDeviceAttribute("DataRate", StringValue(data_rate));
-        qbb.SetChannelAttribute("Delay", StringValue(link_delay));
+        qbb.SetDeviceAttribute("DataRate", DataRateValue(link.rate));
+        qbb.SetChannelAttribute("Delay", TimeValue(link.delay));
 
         if (error_rate > 0)
         {
@@ -1503,7 +1512,6 @@ main(int argc, char* argv[])
         Simulator::Schedule(Seconds(flow_input.start_time) - Simulator::Now(), ScheduleFlowInputs);
     }
 
-    topof.close();
     tracef.close();
     double delay = 0.5 * maxRtt * 1e-9; // 10 micro seconds
     Simulator::Schedule(Seconds(delay), PrintResultsFlow, sourceNodes, flow_num, delay);
@@ -21,18 +21,24 @@
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/error-model.h"
+#include "ns3/flow-trace-file.h"
 #include "ns3/global-route-manager.h"
 #include "ns3/internet-module.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/qbb-helper.h"
+#include "ns3/topology-file.h"
 #include <ns3/rdma-client-helper.h>
 #include <ns3/rdma-client.h>
 #include <ns3/rdma-driver.h>
 #include <ns3/rdma.h>
 #include <ns3/sim-setting.h>
 #include <ns3/switch-node.h>
+#include <ns3/topology-partitioner.h>
+#ifdef NS3_MPI
+#include <ns3/mpi-interface.h>
+#endif
 
 #include <cmath>
 #include <ctime>
@@ -51,10 +57,7 @@ using namespace std;
 
 NS_LOG_COMPONENT_DEFINE("GENERIC_SIMULATION");
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
 #define LINK_CAPACITY_BASE 1000000000 // 1Gbps
 
 uint32_t cc_mode = 1;
@@ -113,7 +116,8 @@ unordered_map<uint64_t, double> rate2pmax;
 /************************************************
  * Runtime varibles
  ***********************************************/
-std::ifstream topof, flowf, tracef;
+std::ifstream tracef;
+FlowTraceFile flowf;
 
 NodeContainer n;
 NetDeviceContainer switchToSwitchInterfaces;
@@ -178,8 +182,14 @@ ReadFlowInput()
 {
     if (flow_input.idx < flow_num)
     {
-        flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >> flow_input.dport >>
-            flow_input.maxPacketCount >> flow_input.start_time;
+        FlowTraceRecord record;
+        flowf.Read(record);
+        flow_input.src = record.src;
+        flow_input.dst = record.dst;
+        flow_input.pg = record.pg;
+        flow_input.dport = record.dport;
+        flow_input.maxPacketCount = record.size;
+        flow_input.start_time = record.startTime;
         std::cout << "Flow " << flow_input.src << " " << flow_input.dst << " " << flow_input.pg
                   << " " << flow_input.dport << " " << flow_input.maxPacketCount << " "
                   << flow_input.start_time << " " << Simulator::Now().GetSeconds() << std::endl;
@@ -223,7 +233,7 @@ ScheduleFlowInputs()
     }
     else
     { // no more flows, close the file
-        flowf.close();
+        flowf.Close();
     }
 }
 
@@ -543,13 +553,25 @@ get_target_leaf(int leafCount)
 
 uint64_t PORT_START = 4000;
 
+// whether this MPI rank simulates the node. Flows are still generated on every rank, so that
+// all ranks draw the same random numbers, but only installed on the rank of their sender.
+bool
+IsLocal(Ptr<Node> node)
+{
+#ifdef NS3_MPI
+    return !MpiInterface::IsEnabled() || node->GetSystemId() == MpiInterface::GetSystemId();
+#else
+    return true;
+#endif
+}
+
 uint32_t FAN = 5;
 
 void
 install_applications_queryNew(int fromLeafId,
                               double requestRate,
                               uint32_t requestSize,
-                              struct cdf_table* cdfTable,
+                              Ptr<FlowSizeDistribution> cdfTable,
                               long& flowCount,
                               long& totalFlowSize,
                               int SERVER_COUNT,
@@ -616,6 +638,10 @@ install_applications_queryNew(int fromLeafId,
                         : 0,
                     global_t == 1 ? maxRtt : pairRtt[fromServerIndex][destServerIndex],
                     Simulator::GetMaximumSimulationTime());
+                if (!IsLocal(n.Get(fromServerIndex)))
+                {
+                    continue;
+                }
                 ApplicationContainer appCon = clientHelper.Install(n.Get(fromServerIndex));
                 std::cout << " from " << fromServerIndex << " to " << destServerIndex
                           << " fromLeadId " << fromLeafId << " serverCount " << SERVER_COUNT
@@ -631,7 +657,7 @@ install_applications_queryNew(int fromLeafId,
 void
 install_applications(int fromLeafId,
                      double requestRate,
-                     struct cdf_table* cdfTable,
+                     Ptr<FlowSizeDistribution> cdfTable,
                      long& flowCount,
                      long& totalFlowSize,
                      int SERVER_COUNT,
@@ -670,10 +696,10 @@ install_applications(int fromLeafId,
                               [destServerIndex]++; // uint16_t (rand_range (PORT_START, PORT_END));
             uint16_t sport = portNumder[fromServerIndex][destServerIndex]++;
 
-            uint64_t flowSize = gen_random_cdf(cdfTable);
+            uint64_t flowSize = cdfTable->GetValue(rand_range(cdfTable->GetMinCdf(), cdfTable->GetMaxCdf()));
             while (flowSize == 0)
             {
-                flowSize = gen_random_cdf(cdfTable);
+                flowSize = cdfTable->GetValue(rand_range(cdfTable->GetMinCdf(), cdfTable->GetMaxCdf()));
             }
 
             totalFlowSize += flowSize;
@@ -691,12 +717,15 @@ install_applications(int fromLeafId,
                         : 0,
                 global_t == 1 ? maxRtt : pairRtt[fromServerIndex][destServerIndex],
                 Simulator::GetMaximumSimulationTime());
-            ApplicationContainer appCon = clientHelper.Install(n.Get(fromServerIndex));
-            std::cout << " from " << fromServerIndex << " to " << destServerIndex << " fromLeadId "
-                      << fromLeafId << " serverCount " << SERVER_COUNT << " leafCount "
-                      << LEAF_COUNT << std::endl;
-            //		appCon.Start(Seconds(flow_input.start_time));
-            appCon.Start(Seconds(startTime));
+            if (IsLocal(n.Get(fromServerIndex)))
+            {
+                ApplicationContainer appCon = clientHelper.Install(n.Get(fromServerIndex));
+                std::cout << " from " << fromServerIndex << " to " << destServerIndex
+                          << " fromLeadId " << fromLeafId << " serverCount " << SERVER_COUNT
+                          << " leafCount " << LEAF_COUNT << std::endl;
+                //		appCon.Start(Seconds(flow_input.start_time));
+                appCon.Start(Seconds(startTime));
+            }
 
             startTime += poission_gen_interval(requestRate);
         }
@@ -841,8 +870,27 @@ main(int argc, char* argv[])
 
     cmd.AddValue("incast", "incast", incast);
 
+    bool distributed = false;
+    bool nullmsg = false;
+    cmd.AddValue("distributed",
+                 "split the topology over the MPI ranks (run with mpirun -np <ranks>)",
+                 distributed);
+    cmd.AddValue("nullmsg", "with distributed, use the null message synchronization", nullmsg);
+
     cmd.Parse(argc, argv);
 
+    if (distributed)
+    {
+#ifdef NS3_MPI
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue(nullmsg ? "ns3::NullMessageSimulatorImpl"
+                                              : "ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+#else
+        NS_FATAL_ERROR("distributed needs ns-3 built with MPI (NS3_MPI)");
+#endif
+    }
+
     SPINE_LEAF_CAPACITY = SPINE_LEAF_CAPACITY * LINK_CAPACITY_BASE;
     LEAF_SERVER_CAPACITY = LEAF_SERVER_CAPACITY * LINK_CAPACITY_BASE;
 
@@ -1301,6 +1349,22 @@ main(int argc, char* argv[])
     }
     conf.close();
 
+    uint32_t systemCount = 1;
+    uint32_t systemId = 0;
+#ifdef NS3_MPI
+    if (MpiInterface::IsEnabled())
+    {
+        systemCount = MpiInterface::GetSize();
+        systemId = MpiInterface::GetSystemId();
+    }
+#endif
+    if (systemCount > 1)
+    {
+        // each rank writes the flows and pauses of its own nodes
+        fct_output_file += "." + std::to_string(systemId);
+        pfc_output_file += "." + std::to_string(systemId);
+    }
+
     // overriding config file. I prefer to use cmd arguments
     cc_mode = algorithm;   // overrides configuration file
     has_win = windowCheck; // overrides configuration file
@@ -1358,18 +1422,21 @@ main(int argc, char* argv[])
         printf("PINT bits: %d bytes: %d\n", Pint::get_n_bits(), Pint::get_n_bytes());
     }
 
-    topof.open(topology_file.c_str());
-    flowf.open(flow_file.c_str());
+    // text or binary, see convert-trace
+    TopologyFile topof;
+    NS_ABORT_MSG_UNLESS(topof.Open(topology_file), "Can't read the topology " << topology_file);
+    flowf.Open(flow_file);
     uint32_t node_num;
     uint32_t switch_num;
     uint32_t tors;
     uint32_t link_num;
     uint32_t trace_num;
-    topof >> node_num >> switch_num >> tors >>
-        link_num; // changed here. The previous order was node, switch, link // tors is not used.
-                  // switch_num=tors for now.
+    node_num = topof.GetNNodes();
+    switch_num = topof.GetNSwitches();
+    tors = topof.GetNTors(); // tors is not used. switch_num=tors for now.
+    link_num = topof.GetLinks().size();
     std::cout << node_num << " " << switch_num << " " << tors << " " << link_num << std::endl;
-    flowf >> flow_num;
+    flow_num = flowf.GetN();
 
     NodeContainer serverNodes;
     NodeContainer torNodes;
@@ -1379,11 +1446,20 @@ main(int argc, char* argv[])
 
     std::vector<uint32_t> node_type(node_num, 0);
 
+    std::vector<uint32_t> node_system(node_num, 0);
+    if (systemCount > 1)
+    {
+        TopologyPartitioner partitioner;
+        partitioner.Load(topology_file);
+        node_system = partitioner.Partition(systemCount);
+        std::cout << "rank " << systemId << " of " << systemCount << ", "
+                  << partitioner.GetCutLinks(node_system) << " links between ranks" << std::endl;
+    }
+
     std::cout << "switch_num " << switch_num << std::endl;
     for (uint32_t i = 0; i < switch_num; i++)
     {
-        uint32_t sid;
-        topof >> sid;
+        uint32_t sid = topof.GetSwitches()[i];
         std::cout << "sid " << sid << std::endl;
         switchNumToId[i] = sid;
         switchIdToNum[sid] = i;
@@ -1401,14 +1477,14 @@ main(int argc, char* argv[])
     {
         if (node_type[i] == 0)
         {
-            Ptr<Node> node = CreateObject<Node>();
+            Ptr<Node> node = CreateObject<Node>(node_system[i]);
             n.Add(node);
             allNodes.Add(node);
             serverNodes.Add(node);
         }
         else
         {
-            Ptr<SwitchNode> sw = CreateObject<SwitchNode>();
+            Ptr<SwitchNode> sw = CreateObject<SwitchNode>(node_system[i]);
             n.Add(sw);
             switchNodes.Add(sw);
             allNodes.Add(sw);
@@ -1457,19 +1533,17 @@ main(int argc, char* argv[])
     Ipv4AddressHelper ipv4;
     for (uint32_t i = 0; i < link_num; i++)
     {
-        uint32_t src;
-        uint32_t dst;
-        std::string data_rate;
-        std::string link_delay;
-        double error_rate;
-        topof >> src >> dst >> data_rate >> link_delay >> error_rate;
+        const TopologyLink& link = topof.GetLinks()[i];
+        uint32_t src = link.src;
+        uint32_t dst = link.dst;
+        double error_rate = link.errorRate;
 
         std::cout << src << " " << dst << " " << n.GetN() << std::endl;
         Ptr<Node> snode = n.Get(src);
         Ptr<Node> dnode = n.Get(dst);
 
-        qbb.SetDeviceAttribute("DataRate", StringValue(data_rate));
-        qbb.SetChannelAttribute("Delay", StringValue(link_delay));
+        qbb.SetDeviceAttribute("DataRate", DataRateValue(link.rate));
+        qbb.SetChannelAttribute("Delay", TimeValue(link.delay));
 
         if (error_rate > 0)
         {
@@ -1771,13 +1845,12 @@ main(int argc, char* argv[])
               << double(SERVER_COUNT * LEAF_SERVER_CAPACITY) << " denom "
               << (SPINE_LEAF_CAPACITY * SPINE_COUNT) << std::endl;
     NS_LOG_INFO("Initialize CDF table");
-    struct cdf_table* cdfTable = new cdf_table();
-    init_cdf(cdfTable);
-    load_cdf(cdfTable, cdfFileName.c_str());
+    Ptr<FlowSizeDistribution> cdfTable = CreateObject<FlowSizeDistribution>();
+    cdfTable->Load(cdfFileName);
     NS_LOG_INFO("Calculating request rate");
     //        double requestRate =0;
     double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio /
-                         (8 * avg_cdf(cdfTable)) / SERVER_COUNT;
+                         (8 * cdfTable->GetMean()) / SERVER_COUNT;
     //       double requestRate = load * LEAF_SERVER_CAPACITY * SERVER_COUNT  / (8 * avg_cdf
     //       (cdfTable)) / SERVER_COUNT;
     NS_LOG_INFO("Average request rate: " << requestRate << " per second");
@@ -1856,7 +1929,6 @@ main(int argc, char* argv[])
     std::cout << "Actual average QuerySize: "
               << static_cast<double>(totalFlowSizeQ) / (flowCountQ - flowCount) << std::endl;
 
-    topof.close();
     tracef.close();
     double delay = 1.5 * minRtt * 1e-9; // 10 micro seconds
     Simulator::Schedule(Seconds(delay), printBuffer, torNodes, delay);
@@ -1867,6 +1939,9 @@ main(int argc, char* argv[])
     Simulator::Stop(Seconds(END_TIME));
     Simulator::Run();
     Simulator::Destroy();
+#ifdef NS3_MPI
+    MpiInterface::Disable();
+#endif
     NS_LOG_INFO("Done.");
 
     endt = clock();
@@ -23,6 +23,8 @@
 #include <ns3/rdma-driver.h>
 #include <ns3/switch-node.h>
 #include <ns3/sim-setting.h>
+#include <ns3/flow-trace-file.h>
+#include <ns3/topology-file.h>
 
 #include <cmath>
 #include <fstream>
@@ -31,6 +33,7 @@
 #include <map>
 #include <ctime>
 #include <set>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <stdlib.h>
@@ -61,10 +64,8 @@ using namespace std;
 
 NS_LOG_COMPONENT_DEFINE("GENERIC_SIMULATION");
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
+#include "ns3/workload-generator.h"
 #define GIGA    1000000000          // 1Gbps
 
 std::string topology_file, flow_file;
@@ -115,7 +116,8 @@ uint32_t PORT_START[512] = {4444};
 /************************************************
  * Runtime varibles
  ***********************************************/
-std::ifstream topof, flowf, tracef;
+std::ifstream tracef;
+FlowTraceFile flowf;
 
 NodeContainer n;
 NetDeviceContainer switchToSwitchInterfaces;
@@ -169,7 +171,14 @@ uint32_t flow_num;
 
 void ReadFlowInput() {
     if (flow_input.idx < flow_num) {
-        flowf >> flow_input.src >> flow_input.dst >> flow_input.pg >> flow_input.dport >> flow_input.maxPacketCount >> flow_input.start_time;
+        FlowTraceRecord record;
+        flowf.Read(record);
+        flow_input.src = record.src;
+        flow_input.dst = record.dst;
+        flow_input.pg = record.pg;
+        flow_input.dport = record.dport;
+        flow_input.maxPacketCount = record.size;
+        flow_input.start_time = record.startTime;
         NS_ASSERT(n.Get(flow_input.src)->GetNodeType() == 0 && n.Get(flow_input.dst)->GetNodeType() == 0);
     }
 }
@@ -190,7 +199,7 @@ void ScheduleFlowInputs() {
     if (flow_input.idx < flow_num) {
         Simulator::Schedule(Seconds(flow_input.start_time) - Simulator::Now(), ScheduleFlowInputs);
     } else { // no more flows, close the file
-        flowf.close();
+        flowf.Close();
     }
 }
 
@@ -380,7 +389,7 @@ int get_target_leaf(int leafCount) {
 
 uint32_t FAN = 5;
 
-void incast_rdma (int fromLeafId, double requestRate, uint32_t requestSize, struct cdf_table *cdfTable,
+void incast_rdma (int fromLeafId, double requestRate, uint32_t requestSize, Ptr<FlowSizeDistribution> cdfTable,
                                     long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
     uint32_t fan = SERVER_COUNT;
@@ -430,7 +439,7 @@ void incast_rdma (int fromLeafId, double requestRate, uint32_t requestSize, stru
 }
 
 
-void workload_rdma (int fromLeafId, double requestRate, struct cdf_table *cdfTable,
+void workload_rdma (int fromLeafId, double requestRate, Ptr<FlowSizeDistribution> cdfTable,
                            long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
     for (int i = 0; i < SERVER_COUNT; i++)
@@ -463,9 +472,9 @@ void workload_rdma (int fromLeafId, double requestRate, struct cdf_table *cdfTab
             uint16_t dport = DestportNumder[fromServerIndex][destServerIndex]++; //uint16_t (rand_range (PORT_START, PORT_END));
             uint16_t sport = portNumder[fromServerIndex][destServerIndex]++;
 
-            uint64_t flowSize = gen_random_cdf (cdfTable);
+            uint64_t flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
             while (flowSize == 0)
-                flowSize = gen_random_cdf (cdfTable);
+                flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
 
             flowCount += 1;
 
@@ -482,7 +491,7 @@ void workload_rdma (int fromLeafId, double requestRate, struct cdf_table *cdfTab
 }
 
 
-void incast_tcp (int incastLeaf, double requestRate, uint32_t requestSize, struct cdf_table *cdfTable,
+void incast_tcp (int incastLeaf, double requestRate, uint32_t requestSize, Ptr<FlowSizeDistribution> cdfTable,
                                   long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
     int fan = SERVER_COUNT;
@@ -547,7 +556,7 @@ void incast_tcp (int incastLeaf, double requestRate, uint32_t requestSize, struc
     }
 }
 
-void workload_tcp (int txLeaf, double requestRate, struct cdf_table *cdfTable,
+void workload_tcp (int txLeaf, double requestRate, Ptr<FlowSizeDistribution> cdfTable,
                            long &flowCount, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
     uint64_t flowSize;
@@ -572,9 +581,9 @@ void workload_tcp (int txLeaf, double requestRate, struct cdf_table *cdfTable,
                 PORT_START[rxLeaf * SERVER_COUNT + rxServer] = 4444;
             }
 
-            uint64_t flowSize = gen_random_cdf (cdfTable);
+            uint64_t flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
             while (flowSize == 0) {
-                flowSize = gen_random_cdf (cdfTable);
+                flowSize = cdfTable->GetValue (rand_range (cdfTable->GetMinCdf (), cdfTable->GetMaxCdf ()));
             }
 
             Ptr<Node> rxNode = n.Get (rxLeaf*SERVER_COUNT + rxServer);
@@ -614,6 +623,85 @@ void workload_tcp (int txLeaf, double requestRate, struct cdf_table *cdfTable,
 }
 
 
+/* The flows of workload_rdma and workload_tcp, installed by a WorkloadGenerator when they start (--lazyWorkload) */
+uint32_t lazyServerCount;
+uint32_t lazyLeafCount;
+double lazyEndTime;
+long lazyFlowCount;
+
+uint32_t lazy_destination (uint32_t fromServerIndex)
+{
+    // Permutation demand matrix
+    uint32_t targetLeaf = fromServerIndex / lazyServerCount + 1;
+    if (targetLeaf == lazyLeafCount)
+        targetLeaf = 0;
+    return targetLeaf * lazyServerCount + rand () % lazyServerCount;
+}
+
+void lazy_rdma_flow (const WorkloadFlow &flow)
+{
+    uint32_t fromServerIndex = flow.src;
+    uint32_t destServerIndex = flow.dst;
+
+    if (DestportNumder[fromServerIndex][destServerIndex] == UINT16_MAX - 1)
+        DestportNumder[fromServerIndex][destServerIndex] = rand_range(10000, 11000);
+
+    if (portNumder[fromServerIndex][destServerIndex] == UINT16_MAX - 1)
+        portNumder[fromServerIndex][destServerIndex] = rand_range(10000, 11000);
+
+    uint16_t dport = DestportNumder[fromServerIndex][destServerIndex]++;
+    uint16_t sport = portNumder[fromServerIndex][destServerIndex]++;
+
+    lazyFlowCount += 1;
+
+    // the application starts as soon as it is installed
+    RdmaClientHelper clientHelper(3, serverAddress[fromServerIndex], serverAddress[destServerIndex], sport, dport, flow.size, has_win ? (global_t == 1 ? maxBdp : pairBdp[n.Get(fromServerIndex)][n.Get(destServerIndex)]) : 0, global_t == 1 ? maxRtt : pairRtt[fromServerIndex][destServerIndex], Simulator::GetMaximumSimulationTime());
+    clientHelper.Install(n.Get(fromServerIndex));
+}
+
+void lazy_tcp_flow (const WorkloadFlow &flow)
+{
+    uint32_t prior = 1; // hardcoded for tcp
+    uint64_t flowSize = flow.size;
+
+    uint16_t port = PORT_START[flow.dst]++;
+    if (port >= UINT16_MAX - 1) {
+        port = 4444;
+        PORT_START[flow.dst] = 4444;
+    }
+
+    // start and stop times of applications installed during the run are relative to now
+    Time stop = Seconds (lazyEndTime) - Simulator::Now ();
+
+    Ptr<Node> rxNode = n.Get (flow.dst);
+    Ptr<Ipv4> ipv4 = rxNode->GetObject<Ipv4> ();
+    Ipv4Address rxAddress = ipv4->GetAddress (1, 0).GetLocal ();
+
+    Ptr<BulkSendApplication> bulksend = CreateObject<BulkSendApplication>();
+    bulksend->SetAttribute("Protocol", TypeIdValue(TcpSocketFactory::GetTypeId()));
+    bulksend->SetAttribute ("SendSize", UintegerValue (flowSize));
+    bulksend->SetAttribute ("MaxBytes", UintegerValue(flowSize));
+    bulksend->SetAttribute("FlowId", UintegerValue(lazyFlowCount++));
+    bulksend->SetAttribute("priorityCustom", UintegerValue(prior));
+    bulksend->SetAttribute("Remote", AddressValue(InetSocketAddress (rxAddress, port)));
+    bulksend->SetAttribute("InitialCwnd", UintegerValue (maxBdp/packet_payload_size + 1));
+    bulksend->SetAttribute("priority", UintegerValue(prior));
+    bulksend->SetStopTime (stop);
+    n.Get (flow.src)->AddApplication(bulksend);
+
+    PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+    ApplicationContainer sinkApp = sink.Install (rxNode);
+    sinkApp.Get(0)->SetAttribute("TotalQueryBytes", UintegerValue(flowSize));
+    sinkApp.Get(0)->SetAttribute("priority", UintegerValue(0)); // ack packets are prioritized
+    sinkApp.Get(0)->SetAttribute("priorityCustom", UintegerValue(0)); // ack packets are prioritized
+    sinkApp.Get(0)->SetAttribute("flowId", UintegerValue(lazyFlowCount));
+    sinkApp.Get(0)->SetAttribute("senderPriority", UintegerValue(prior));
+    lazyFlowCount += 1;
+    sinkApp.Stop (stop);
+    sinkApp.Get(0)->TraceConnectWithoutContext("FlowFinish", MakeBoundCallback(&TraceMsgFinish, fctOutput));
+}
+
+
 uint32_t flowEnd = 0;
 
 void printBuffer(Ptr<OutputStreamWrapper> fout, NodeContainer switches, double delay) {
@@ -725,6 +813,21 @@ int main(int argc, char *argv[])
     
     std::string bufferModel = "sonic";
     cmd.AddValue("bufferModel", "the buffer model to be used in the switch MMU", bufferModel);
+
+    bool lazyDequeueRates = false;
+    cmd.AddValue("lazyDequeueRates", "update ABM dequeue rates per queue on use instead of periodic sweeps", lazyDequeueRates);
+
+    bool lazyWorkload = false;
+    cmd.AddValue("lazyWorkload", "generate the background flows as the simulation runs instead of installing them all up front", lazyWorkload);
+
+    bool selectiveRepeat = false;
+    cmd.AddValue("selectiveRepeat", "RDMA loss recovery with selective repeat instead of go-back-N", selectiveRepeat);
+    double mlxTimerSlot = 0;
+    cmd.AddValue("mlxTimerSlot", "DCQCN timing wheel slot in microseconds, 0 for one event per timer", mlxTimerSlot);
+    uint32_t strictClasses = 0xff;
+    cmd.AddValue("strictClasses", "bitmap of the switch egress classes served in strict priority, the others share by DWRR", strictClasses);
+    std::string quanta = "";
+    cmd.AddValue("quanta", "comma separated DWRR quantum in bytes of the switch egress classes 0, 1, ...", quanta);
     
     double gamma = 0.99;
     cmd.AddValue("gamma","gamma parameter value for Reverie", gamma);
@@ -986,6 +1089,12 @@ int main(int argc, char *argv[])
 
     Config::SetDefault("ns3::QbbNetDevice::PauseTime", UintegerValue(pause_time));
     Config::SetDefault("ns3::QbbNetDevice::QcnEnabled", BooleanValue(enable_qcn));
+    Config::SetDefault("ns3::BEgressQueue::StrictPriorityClasses", UintegerValue(strictClasses));
+    std::vector<uint32_t> quantum;
+    std::istringstream quantaStream(quanta);
+    for (std::string q; std::getline(quantaStream, q, ',') && quantum.size() < 8;) {
+        quantum.push_back(std::stoul(q));
+    }
 
     // set int_multi
     IntHop::multi = int_multi;
@@ -1006,17 +1115,24 @@ int main(int argc, char *argv[])
         printf("PINT bits: %d bytes: %d\n", Pint::get_n_bits(), Pint::get_n_bytes());
     }
 
-    topof.open(topology_file.c_str());
-    flowf.open(flow_file.c_str());
+    // text or binary, see convert-trace
+    TopologyFile topof;
+    NS_ABORT_MSG_UNLESS(topof.Open(topology_file), "Can't read the topology " << topology_file);
+    flowf.Open(flow_file);
     uint32_t node_num, switch_num, tors, link_num, trace_num;
-    topof >> node_num >> switch_num >> tors >> link_num >> LEAF_SERVER_CAPACITY >> SPINE_LEAF_CAPACITY ;
+    node_num = topof.GetNNodes();
+    switch_num = topof.GetNSwitches();
+    tors = topof.GetNTors();
+    link_num = topof.GetLinks().size();
+    LEAF_SERVER_CAPACITY = topof.GetHeader(4);
+    SPINE_LEAF_CAPACITY = topof.GetHeader(5);
     LEAF_COUNT = tors;
     SPINE_COUNT = switch_num - tors;
     SERVER_COUNT = (node_num - switch_num) / tors;
 
     LINK_COUNT = (link_num - (SERVER_COUNT * tors))/(LEAF_COUNT*SPINE_COUNT); // number of links between each tor-spine pair
 
-    flowf >> flow_num;
+    flow_num = flowf.GetN();
 
     NodeContainer serverNodes;
     NodeContainer torNodes;
@@ -1027,8 +1143,7 @@ int main(int argc, char *argv[])
     std::vector<uint32_t> node_type(node_num, 0);
 
     for (uint32_t i = 0; i < switch_num; i++) {
-        uint32_t sid;
-        topof >> sid;
+        uint32_t sid = topof.GetSwitches()[i];
         switchNumToId[i] = sid;
         switchIdToNum[sid] = i;
         if (i < tors) {
@@ -1098,17 +1213,16 @@ int main(int argc, char *argv[])
     Ipv4AddressHelper ipv4;
     for (uint32_t i = 0; i < link_num; i++)
     {
-        uint32_t src, dst;
-        std::string data_rate, link_delay;
-        double error_rate;
-        topof >> src >> dst >> data_rate >> link_delay >> error_rate;
+        const TopologyLink &link = topof.GetLinks()[i];
+        uint32_t src = link.src, dst = link.dst;
+        double error_rate = link.errorRate;
 
         // std::cout << src << " " << dst << " " << n.GetN() << std::endl;
         Ptr<Node> snode = n.Get(src), dnode = n.Get(dst);
 
 
-        qbb.SetDeviceAttribute("DataRate", StringValue(data_rate));
-        qbb.SetChannelAttribute("Delay", StringValue(link_delay));
+        qbb.SetDeviceAttribute("DataRate", DataRateValue(link.rate));
+        qbb.SetChannelAttribute("Delay", TimeValue(link.delay));
 
         if (error_rate > 0)
         {
@@ -1205,6 +1319,8 @@ int main(int argc, char *argv[])
             rdmaHw->SetAttribute("RateAI", DataRateValue(DataRate(rate_ai)));
             rdmaHw->SetAttribute("RateHAI", DataRateValue(DataRate(rate_hai)));
             rdmaHw->SetAttribute("L2BackToZero", BooleanValue(l2_back_to_zero));
+            rdmaHw->SetAttribute("SelectiveRepeat", BooleanValue(selectiveRepeat));
+            rdmaHw->SetAttribute("MlxTimerSlot", DoubleValue(mlxTimerSlot));
             rdmaHw->SetAttribute("L2ChunkSize", UintegerValue(l2_chunk_size));
             rdmaHw->SetAttribute("L2AckInterval", UintegerValue(l2_ack_interval));
             rdmaHw->SetAttribute("CcMode", UintegerValue(rdmacc));
@@ -1289,6 +1405,7 @@ int main(int argc, char *argv[])
             sw->m_mmu->SetEgressLosslessAlg(bufferalgEgress);
             sw->m_mmu->SetABMalphaHigh(1024);
             sw->m_mmu->SetABMdequeueUpdateNS(maxRtt);
+            sw->m_mmu->SetLazyDequeueRates(lazyDequeueRates);
             sw->m_mmu->SetPortCount(sw->GetNDevices() - 1); // set the actual port count here so that we don't always iterate over the default 256 ports.
             sw->m_mmu->SetBufferModel(bufferModel);
             sw->m_mmu->SetGamma(gamma);
@@ -1298,6 +1415,9 @@ int main(int argc, char *argv[])
                 uint64_t rate = dev->GetDataRate().GetBitRate();
                 // set port bandwidth in the mmu, used by ABM.
                 sw->m_mmu->bandwidth[j] = rate;
+                for (uint32_t qu = 0; qu < quantum.size(); qu++) {
+                    dev->GetQueue()->SetQuantum(qu, quantum[qu]);
+                }
                 for (uint32_t qu = 0; qu < 8; qu++) {
                     if (qu == 3 || qu == 0) { // lossless
                         sw->m_mmu->SetAlphaIngress(alpha_values[qu], j, qu);
@@ -1367,9 +1487,8 @@ int main(int argc, char *argv[])
     /* Applications Background*/
     double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
     std::cout << "SERVER_COUNT " << SERVER_COUNT << " LEAF_COUNT " << LEAF_COUNT << " SPINE_COUNT " << SPINE_COUNT << " LINK_COUNT " << LINK_COUNT << " RDMALOAD " << rdmaload << " TCPLOAD " << tcpload << " oversubRatio " << oversubRatio << std::endl;
-    struct cdf_table* cdfTable = new cdf_table ();
-    init_cdf (cdfTable);
-    load_cdf (cdfTable, cdfFileName.c_str ());
+    Ptr<FlowSizeDistribution> cdfTable = CreateObject<FlowSizeDistribution> ();
+    cdfTable->Load (cdfFileName);
 
     if (randomSeed == 0)
     {
@@ -1385,11 +1504,26 @@ int main(int argc, char *argv[])
 
     long flowCount = 1;
     long totalFlowSize = 0;
-    double requestRate = rdmaload * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+    double requestRate = rdmaload * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * cdfTable->GetMean ()) / SERVER_COUNT;
+
+    lazyServerCount = SERVER_COUNT;
+    lazyLeafCount = LEAF_COUNT;
+    lazyEndTime = END_TIME;
+    Ptr<WorkloadGenerator> rdmaWorkload;
+    if (lazyWorkload && requestRate > 0) {
+        rdmaWorkload = CreateObject<WorkloadGenerator> ();
+        rdmaWorkload->SetAttribute ("FlowRate", DoubleValue (requestRate));
+        rdmaWorkload->SetHosts (SERVER_COUNT * LEAF_COUNT);
+        rdmaWorkload->SetFlowSizeDistribution (cdfTable);
+        rdmaWorkload->SetDestinationCallback (MakeCallback (&lazy_destination));
+        rdmaWorkload->SetFlowCallback (MakeCallback (&lazy_rdma_flow));
+        rdmaWorkload->Start (Seconds (START_TIME), Seconds (FLOW_LAUNCH_END_TIME));
+    }
 
     for (int fromLeafId = 0; fromLeafId < LEAF_COUNT; fromLeafId ++)
     {
-        workload_rdma(fromLeafId, requestRate, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
+        if (!lazyWorkload)
+            workload_rdma(fromLeafId, requestRate, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
         if (rdmaqueryRequestRate > 0 && rdmarequestSize > 0){
             incast_rdma(fromLeafId, rdmaqueryRequestRate, rdmarequestSize, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
         }
@@ -1420,16 +1554,27 @@ int main(int argc, char *argv[])
         Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue ("On"));
     }
 
-    requestRate = tcpload * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * avg_cdf (cdfTable)) / SERVER_COUNT;
+    requestRate = tcpload * LEAF_SERVER_CAPACITY * SERVER_COUNT / oversubRatio / (8 * cdfTable->GetMean ()) / SERVER_COUNT;
+    Ptr<WorkloadGenerator> tcpWorkload;
+    if (lazyWorkload && requestRate > 0) {
+        tcpWorkload = CreateObject<WorkloadGenerator> ();
+        tcpWorkload->SetAttribute ("FlowRate", DoubleValue (requestRate));
+        tcpWorkload->SetHosts (SERVER_COUNT * LEAF_COUNT);
+        tcpWorkload->SetFlowSizeDistribution (cdfTable);
+        tcpWorkload->SetDestinationCallback (MakeCallback (&lazy_destination));
+        tcpWorkload->SetFlowCallback (MakeCallback (&lazy_tcp_flow));
+        tcpWorkload->Start (Seconds (START_TIME), Seconds (FLOW_LAUNCH_END_TIME));
+    }
     for (int fromLeafId = 0; fromLeafId < LEAF_COUNT; fromLeafId ++)
     {
-        workload_tcp(fromLeafId, requestRate, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
+        if (!lazyWorkload)
+            workload_tcp(fromLeafId, requestRate, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
         if (tcpqueryRequestRate > 0 && tcprequestSize > 0) {
             incast_tcp(fromLeafId, tcpqueryRequestRate, tcprequestSize, cdfTable, flowCount, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
         }
     }
 std::cout << "apps finished" << std::endl;
-    topof.close();
+    lazyFlowCount = flowCount; // after the ids of the incast flows
     tracef.close();
     double delay = 1.5 * maxRtt * 1e-9; // 10 micro seconds
     Simulator::Schedule(Seconds(START_TIME), printBuffer, torStats, torNodes, delay);
@@ -68,10 +68,7 @@ using namespace std;
 
 NS_LOG_COMPONENT_DEFINE("GENERIC_SIMULATION");
 
-extern "C"
-{
-#include "cdf.h"
-}
+#include "ns3/flow-size-distribution.h"
 #define LINK_CAPACITY_BASE    1000000000          // 1Gbps
 
 std::string data_rate, link_delay, topology_file, flow_file;
@@ -504,6 +501,9 @@ int main(int argc, char *argv[])
     std::string bufferModel = "sonic";
     cmd.AddValue("bufferModel", "the buffer model to be used in the switch MMU", bufferModel);
 
+    bool lazyDequeueRates = false;
+    cmd.AddValue("lazyDequeueRates", "update ABM dequeue rates per queue on use instead of periodic sweeps", lazyDequeueRates);
+
     cmd.Parse (argc, argv);
 
     fctOutput = asciiTraceHelper.CreateFileStream (fctOutFile);
@@ -1038,6 +1038,7 @@ int main(int argc, char *argv[])
             sw->m_mmu->SetEgressLosslessAlg(bufferalgEgress);
             sw->m_mmu->SetABMalphaHigh(1024);
             sw->m_mmu->SetABMdequeueUpdateNS(minRtt);
+            sw->m_mmu->SetLazyDequeueRates(lazyDequeueRates);
             sw->m_mmu->SetPortCount(sw->GetNDevices()-1); // set the actual port count here so that we don't always iterate over the default 256 ports.
             sw->m_mmu->SetBufferModel(bufferModel);
             // std::cout << "ports " << sw->GetNDevices() << " node " << i << std::endl;
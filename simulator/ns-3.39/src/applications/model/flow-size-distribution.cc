@@ -0,0 +1,233 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-size-distribution.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowSizeDistribution");
+
+NS_OBJECT_ENSURE_REGISTERED(FlowSizeDistribution);
+
+TypeId
+FlowSizeDistribution::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::FlowSizeDistribution")
+                            .SetParent<Object>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<FlowSizeDistribution>();
+    return tid;
+}
+
+FlowSizeDistribution::FlowSizeDistribution()
+    : m_minCdf(0),
+      m_maxCdf(1),
+      m_aliasValid(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FlowSizeDistribution::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_uniform = nullptr;
+    Object::DoDispose();
+}
+
+Ptr<UniformRandomVariable>
+FlowSizeDistribution::GetUniform()
+{
+    // created on first use, so that a table only used through GetValue does not take a stream
+    if (!m_uniform)
+    {
+        m_uniform = CreateObject<UniformRandomVariable>();
+    }
+    return m_uniform;
+}
+
+void
+FlowSizeDistribution::Load(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ifstream in(fileName);
+    NS_ABORT_MSG_UNLESS(in.is_open(), "Can't open the CDF file " << fileName);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        double value;
+        double cdf;
+        if (fields >> value >> cdf)
+        {
+            Add(value, cdf);
+        }
+    }
+}
+
+void
+FlowSizeDistribution::Add(double value, double cdf)
+{
+    NS_LOG_FUNCTION(this << value << cdf);
+    NS_ABORT_MSG_IF(!m_cdf.empty() && cdf < m_cdf.back(), "CDF entries out of order");
+    m_value.push_back(value);
+    m_cdf.push_back(cdf);
+    m_minCdf = std::min(m_minCdf, cdf);
+    m_maxCdf = std::max(m_maxCdf, cdf);
+    m_aliasValid = false;
+}
+
+uint32_t
+FlowSizeDistribution::GetN() const
+{
+    return m_value.size();
+}
+
+double
+FlowSizeDistribution::GetMean() const
+{
+    // each segment is uniform in size, so it contributes its midpoint
+    double mean = 0;
+    for (uint32_t i = 0; i < m_value.size(); i++)
+    {
+        if (i == 0)
+        {
+            mean += m_value[0] / 2 * m_cdf[0];
+        }
+        else
+        {
+            mean += (m_value[i] + m_value[i - 1]) / 2 * (m_cdf[i] - m_cdf[i - 1]);
+        }
+    }
+    return mean;
+}
+
+double
+FlowSizeDistribution::GetMinCdf() const
+{
+    return m_minCdf;
+}
+
+double
+FlowSizeDistribution::GetMaxCdf() const
+{
+    return m_maxCdf;
+}
+
+double
+FlowSizeDistribution::Interpolate(uint32_t segment, double cdf) const
+{
+    if (segment == m_value.size())
+    {
+        return m_value.back();
+    }
+    double x1 = segment == 0 ? 0 : m_cdf[segment - 1];
+    double y1 = segment == 0 ? 0 : m_value[segment - 1];
+    double x2 = m_cdf[segment];
+    double y2 = m_value[segment];
+    if (x1 == x2)
+    {
+        return (y1 + y2) / 2;
+    }
+    return y1 + (cdf - x1) * (y2 - y1) / (x2 - x1);
+}
+
+double
+FlowSizeDistribution::GetValue(double cdf) const
+{
+    NS_ASSERT_MSG(!m_value.empty(), "empty CDF");
+    // the first entry at or above cdf
+    uint32_t segment = std::lower_bound(m_cdf.begin(), m_cdf.end(), cdf) - m_cdf.begin();
+    return Interpolate(segment, cdf);
+}
+
+void
+FlowSizeDistribution::BuildAliasTable()
+{
+    NS_LOG_FUNCTION(this);
+    // Vose's alias method, segment i ends at entry i, segment n is past the last entry
+    uint32_t n = m_value.size() + 1;
+    double total = m_maxCdf - m_minCdf;
+    std::vector<double> scaled(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double lo = i == 0 ? m_minCdf : m_cdf[i - 1];
+        double hi = i == n - 1 ? m_maxCdf : m_cdf[i];
+        scaled[i] = total > 0 ? (hi - lo) / total * n : (i == 0 ? n : 0);
+    }
+    m_prob.assign(n, 1);
+    m_alias.resize(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        m_alias[i] = i;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        m_prob[s] = scaled[s];
+        m_alias[s] = l;
+        scaled[l] -= 1 - scaled[s];
+        if (scaled[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // the rest is 1 up to rounding
+    m_aliasValid = true;
+}
+
+double
+FlowSizeDistribution::Sample()
+{
+    NS_ASSERT_MSG(!m_value.empty(), "empty CDF");
+    if (!m_aliasValid)
+    {
+        BuildAliasTable();
+    }
+    Ptr<UniformRandomVariable> uniform = GetUniform();
+    double u = uniform->GetValue(0, m_prob.size());
+    uint32_t segment = std::min<uint32_t>(u, m_prob.size() - 1);
+    if (u - segment >= m_prob[segment])
+    {
+        segment = m_alias[segment];
+    }
+    double lo = segment == 0 ? m_minCdf : m_cdf[segment - 1];
+    double hi = segment == m_value.size() ? m_maxCdf : m_cdf[segment];
+    return Interpolate(segment, uniform->GetValue(lo, hi));
+}
+
+int64_t
+FlowSizeDistribution::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    GetUniform()->SetStream(stream);
+    return 1;
+}
+
+} // namespace ns3
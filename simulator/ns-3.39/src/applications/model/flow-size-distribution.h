@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_SIZE_DISTRIBUTION_H
+#define FLOW_SIZE_DISTRIBUTION_H
+
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup applications
+ *
+ * \brief Empirical flow size distribution of a workload (websearch, datamining, ...)
+ *
+ * The distribution is a CDF table, one "value cdf" pair per line of a file, in increasing cdf
+ * order. Between two entries the size is interpolated linearly, from size 0 at cdf 0 up to the
+ * first entry; cdf values past the last entry map to the last size. This is the format and the
+ * distribution of the cdf.c table the datacenter examples used to carry.
+ *
+ * GetValue is the inverse CDF, a binary search. Sample draws from the same distribution in
+ * constant time with an alias table over the segments between entries: one draw picks the
+ * segment, a second one the point within it.
+ */
+class FlowSizeDistribution : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    FlowSizeDistribution();
+
+    /**
+     * \brief Append the entries of a CDF file, one "value cdf" pair per line
+     * \param fileName the file
+     */
+    void Load(const std::string& fileName);
+
+    /**
+     * \brief Append an entry
+     * \param value the flow size
+     * \param cdf the probability of a size up to value, not below the cdf of the last entry
+     */
+    void Add(double value, double cdf);
+
+    /// \return the number of entries
+    uint32_t GetN() const;
+
+    /// \return the mean flow size
+    double GetMean() const;
+
+    /// \return the smallest cdf value, 0 unless an entry is below
+    double GetMinCdf() const;
+
+    /// \return the largest cdf value, 1 unless an entry is above
+    double GetMaxCdf() const;
+
+    /**
+     * \brief The inverse CDF
+     * \param cdf a value between GetMinCdf and GetMaxCdf
+     * \return the flow size at cdf
+     */
+    double GetValue(double cdf) const;
+
+    /// \return a random flow size
+    double Sample();
+
+    /**
+     * \brief Use fixed random variable streams
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// \return the source of the samples, created on first use
+    Ptr<UniformRandomVariable> GetUniform();
+
+    /**
+     * \param segment index of the entry the segment ends at, GetN for the segment past the last
+     * \param cdf a cdf value within the segment
+     * \return the flow size at cdf
+     */
+    double Interpolate(uint32_t segment, double cdf) const;
+
+    /// Rebuild m_prob and m_alias from the entries
+    void BuildAliasTable();
+
+    std::vector<double> m_value; //!< flow size of each entry
+    std::vector<double> m_cdf;   //!< cdf of each entry
+    double m_minCdf;             //!< smallest cdf value
+    double m_maxCdf;             //!< largest cdf value
+    std::vector<double> m_prob;    //!< per segment: probability of keeping it when drawn
+    std::vector<uint32_t> m_alias; //!< per segment: the segment drawn otherwise
+    bool m_aliasValid;             //!< whether the alias table matches the entries
+    Ptr<UniformRandomVariable> m_uniform; //!< source of the samples
+};
+
+} // namespace ns3
+
+#endif /* FLOW_SIZE_DISTRIBUTION_H */
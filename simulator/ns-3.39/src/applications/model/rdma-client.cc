@@ -89,7 +89,9 @@ RdmaClient::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&RdmaClient::m_baseRtt),
                    MakeUintegerChecker<uint64_t> ())
-	.AddAttribute ("stopTime", "stopTime", TimeValue (Simulator::GetMaximumSimulationTime()),
+	// Time::Max () is what Simulator::GetMaximumSimulationTime () returns; calling the
+	// simulator here would create it before MPI can select its implementation.
+	.AddAttribute ("stopTime", "stopTime", TimeValue (Time::Max ()),
 				                      MakeTimeAccessor (&RdmaClient::stopTime),
 				                      MakeTimeChecker ())
 
@@ -0,0 +1,307 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "workload-generator.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("WorkloadGenerator");
+
+NS_OBJECT_ENSURE_REGISTERED(WorkloadGenerator);
+
+TypeId
+WorkloadGenerator::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::WorkloadGenerator")
+            .SetParent<Object>()
+            .SetGroupName("Applications")
+            .AddConstructor<WorkloadGenerator>()
+            .AddAttribute("Arrival",
+                          "The arrival process of the flows of a source",
+                          EnumValue(WorkloadGenerator::POISSON),
+                          MakeEnumAccessor(&WorkloadGenerator::m_arrival),
+                          MakeEnumChecker(WorkloadGenerator::POISSON,
+                                          "Poisson",
+                                          WorkloadGenerator::ON_OFF,
+                                          "OnOff"))
+            .AddAttribute("Pattern",
+                          "The destinations of the flows of a source",
+                          EnumValue(WorkloadGenerator::ALL_TO_ALL),
+                          MakeEnumAccessor(&WorkloadGenerator::m_pattern),
+                          MakeEnumChecker(WorkloadGenerator::ALL_TO_ALL,
+                                          "AllToAll",
+                                          WorkloadGenerator::PERMUTATION,
+                                          "Permutation",
+                                          WorkloadGenerator::INCAST,
+                                          "Incast"))
+            .AddAttribute("FlowRate",
+                          "Arrivals per second of each source, during the on periods",
+                          DoubleValue(1000),
+                          MakeDoubleAccessor(&WorkloadGenerator::m_flowRate),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("MeanOnTime",
+                          "Mean length of the on periods of OnOff arrivals",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&WorkloadGenerator::m_meanOn),
+                          MakeTimeChecker())
+            .AddAttribute("MeanOffTime",
+                          "Mean length of the off periods of OnOff arrivals",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&WorkloadGenerator::m_meanOff),
+                          MakeTimeChecker())
+            .AddAttribute("IncastFanIn",
+                          "Hosts answering each Incast query",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&WorkloadGenerator::m_incastFanIn),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("IncastSize",
+                          "Bytes of each Incast query, split evenly between the senders",
+                          UintegerValue(1000000),
+                          MakeUintegerAccessor(&WorkloadGenerator::m_incastSize),
+                          MakeUintegerChecker<uint64_t>(1));
+    return tid;
+}
+
+WorkloadGenerator::WorkloadGenerator()
+    : m_nHosts(0),
+      m_flowCount(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_gap = CreateObject<ExponentialRandomVariable>();
+    m_uniform = CreateObject<UniformRandomVariable>();
+}
+
+WorkloadGenerator::~WorkloadGenerator()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+WorkloadGenerator::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Stop();
+    m_sources.clear();
+    m_sizes = nullptr;
+    m_flowCallback = MakeNullCallback<void, const WorkloadFlow&>();
+    m_destination = MakeNullCallback<uint32_t, uint32_t>();
+    Object::DoDispose();
+}
+
+void
+WorkloadGenerator::SetHosts(uint32_t n)
+{
+    NS_LOG_FUNCTION(this << n);
+    m_nHosts = n;
+    m_sources.clear();
+}
+
+void
+WorkloadGenerator::SetSources(const std::vector<uint32_t>& sources)
+{
+    NS_LOG_FUNCTION(this);
+    m_sources.clear();
+    for (uint32_t host : sources)
+    {
+        NS_ABORT_MSG_IF(host >= m_nHosts, "source " << host << " is not a host");
+        m_sources.push_back({host, host, Time(), EventId()});
+    }
+}
+
+void
+WorkloadGenerator::SetFlowSizeDistribution(Ptr<FlowSizeDistribution> distribution)
+{
+    m_sizes = distribution;
+}
+
+void
+WorkloadGenerator::SetFlowCallback(FlowCallback cb)
+{
+    m_flowCallback = cb;
+}
+
+void
+WorkloadGenerator::SetDestinationCallback(DestinationCallback cb)
+{
+    m_destination = cb;
+}
+
+void
+WorkloadGenerator::Start(Time start, Time stop)
+{
+    NS_LOG_FUNCTION(this << start << stop);
+    NS_ABORT_MSG_IF(m_nHosts < 2, "a workload needs at least 2 hosts");
+    NS_ABORT_MSG_IF(m_flowRate <= 0, "FlowRate must be positive");
+    NS_ABORT_MSG_IF(m_pattern != INCAST && !m_sizes, "no flow size distribution");
+    NS_ABORT_MSG_IF(m_flowCallback.IsNull(), "no flow callback");
+    if (m_sources.empty())
+    {
+        for (uint32_t host = 0; host < m_nHosts; host++)
+        {
+            m_sources.push_back({host, host, Time(), EventId()});
+        }
+    }
+    if (m_pattern == PERMUTATION)
+    {
+        // Sattolo's shuffle: a single cycle, so no host sends to itself
+        std::vector<uint32_t> peer(m_nHosts);
+        for (uint32_t i = 0; i < m_nHosts; i++)
+        {
+            peer[i] = i;
+        }
+        for (uint32_t i = m_nHosts - 1; i > 0; i--)
+        {
+            std::swap(peer[i], peer[m_uniform->GetInteger(0, i - 1)]);
+        }
+        for (auto& s : m_sources)
+        {
+            s.peer = peer[s.host];
+        }
+    }
+    if (m_pattern == INCAST)
+    {
+        m_senders.resize(m_nHosts);
+        for (uint32_t i = 0; i < m_nHosts; i++)
+        {
+            m_senders[i] = i;
+        }
+    }
+    m_stop = stop;
+    for (uint32_t i = 0; i < m_sources.size(); i++)
+    {
+        m_sources[i].onEnd = start + Seconds(m_gap->GetValue(m_meanOn.GetSeconds(), 0));
+        ScheduleNext(i, start);
+    }
+}
+
+void
+WorkloadGenerator::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& s : m_sources)
+    {
+        s.event.Cancel();
+    }
+}
+
+uint64_t
+WorkloadGenerator::GetFlowCount() const
+{
+    return m_flowCount;
+}
+
+int64_t
+WorkloadGenerator::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_gap->SetStream(stream);
+    m_uniform->SetStream(stream + 1);
+    return 2;
+}
+
+void
+WorkloadGenerator::ScheduleNext(uint32_t index, Time t)
+{
+    Source& s = m_sources[index];
+    Time next = t + Seconds(m_gap->GetValue(1 / m_flowRate, 0));
+    if (m_arrival == ON_OFF)
+    {
+        // gaps are memoryless, so an arrival past the on period restarts after the off period
+        while (next > s.onEnd && next < m_stop)
+        {
+            Time offEnd = s.onEnd + Seconds(m_gap->GetValue(m_meanOff.GetSeconds(), 0));
+            s.onEnd = offEnd + Seconds(m_gap->GetValue(m_meanOn.GetSeconds(), 0));
+            next = offEnd + Seconds(m_gap->GetValue(1 / m_flowRate, 0));
+        }
+    }
+    if (next >= m_stop)
+    {
+        return;
+    }
+    s.event = Simulator::Schedule(next - Simulator::Now(), &WorkloadGenerator::Arrive, this, index);
+}
+
+uint32_t
+WorkloadGenerator::OtherHost(uint32_t src)
+{
+    uint32_t dst = m_uniform->GetInteger(0, m_nHosts - 2);
+    return dst >= src ? dst + 1 : dst;
+}
+
+void
+WorkloadGenerator::StartFlow(uint32_t src, uint32_t dst, uint64_t size)
+{
+    NS_LOG_FUNCTION(this << src << dst << size);
+    WorkloadFlow flow = {m_flowCount++, src, dst, size};
+    m_flowCallback(flow);
+}
+
+void
+WorkloadGenerator::Arrive(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    const Source& s = m_sources[index];
+    if (m_pattern == INCAST)
+    {
+        // a partial shuffle draws the senders, skipping the source itself
+        uint32_t fanIn = std::min(m_incastFanIn, m_nHosts - 1);
+        uint64_t size = m_incastSize / fanIn;
+        for (uint32_t k = 0, n = 0; n < fanIn; k++)
+        {
+            std::swap(m_senders[k], m_senders[m_uniform->GetInteger(k, m_nHosts - 1)]);
+            if (m_senders[k] != s.host)
+            {
+                StartFlow(m_senders[k], s.host, size);
+                n++;
+            }
+        }
+    }
+    else
+    {
+        uint32_t dst;
+        if (!m_destination.IsNull())
+        {
+            dst = m_destination(s.host);
+        }
+        else if (m_pattern == PERMUTATION)
+        {
+            dst = s.peer;
+        }
+        else
+        {
+            dst = OtherHost(s.host);
+        }
+        uint64_t size = 0;
+        while (size == 0)
+        {
+            size = m_sizes->Sample();
+        }
+        StartFlow(s.host, dst, size);
+    }
+    ScheduleNext(index, Simulator::Now());
+}
+
+} // namespace ns3
@@ -0,0 +1,206 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include "flow-size-distribution.h"
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup applications
+ *
+ * \brief A flow of a workload, between two hosts identified by their index
+ */
+struct WorkloadFlow
+{
+    uint64_t id;   //!< sequence number of the flow, from 0
+    uint32_t src;  //!< sending host
+    uint32_t dst;  //!< receiving host
+    uint64_t size; //!< bytes
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Generates the flows of a datacenter workload as the simulation runs
+ *
+ * Every source host starts flows at the times of an arrival process, Poisson or on-off. The
+ * destinations follow a traffic pattern:
+ * - ALL_TO_ALL: any other host, uniformly,
+ * - PERMUTATION: a fixed other host per source, a random permutation of the hosts,
+ * - INCAST: each arrival is a query of the source, answered by IncastFanIn other hosts with
+ *   IncastSize / IncastFanIn bytes each.
+ * A destination callback overrides ALL_TO_ALL and PERMUTATION with the pattern of the caller,
+ * e.g. a host under the next leaf switch. Sizes come from a FlowSizeDistribution, or are
+ * IncastSize / IncastFanIn for INCAST.
+ *
+ * The generator does not create applications: the flow callback gets each flow when it starts
+ * and installs whatever carries it, an RdmaClient or a BulkSendApplication and its PacketSink.
+ * Only the next arrival of each source is scheduled, so the memory of the generator and of the
+ * event queue does not grow with the number of flows of the run.
+ */
+class WorkloadGenerator : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    WorkloadGenerator();
+    ~WorkloadGenerator() override;
+
+    /// Arrival process of the flows of a source
+    enum Arrival
+    {
+        POISSON, //!< exponential gaps of mean 1 / FlowRate
+        ON_OFF,  //!< POISSON during exponential on periods, nothing during exponential off periods
+    };
+
+    /// Destinations of the flows of a source
+    enum Pattern
+    {
+        ALL_TO_ALL,  //!< any other host
+        PERMUTATION, //!< one other host per source
+        INCAST,      //!< IncastFanIn other hosts send to the source
+    };
+
+    /// Callback invoked when a flow starts
+    typedef Callback<void, const WorkloadFlow&> FlowCallback;
+
+    /// Callback returning the destination host of a flow of a source host
+    typedef Callback<uint32_t, uint32_t> DestinationCallback;
+
+    /**
+     * \brief Use hosts 0 to n - 1, all of them sources unless SetSources says otherwise
+     * \param n number of hosts
+     */
+    void SetHosts(uint32_t n);
+
+    /**
+     * \brief Start flows from these hosts only
+     * \param sources the source hosts
+     */
+    void SetSources(const std::vector<uint32_t>& sources);
+
+    /**
+     * \param distribution the flow sizes of ALL_TO_ALL and PERMUTATION flows
+     */
+    void SetFlowSizeDistribution(Ptr<FlowSizeDistribution> distribution);
+
+    /**
+     * \param cb called with each flow at its start time
+     */
+    void SetFlowCallback(FlowCallback cb);
+
+    /**
+     * \param cb picks the destination of the flows of a source instead of the pattern
+     */
+    void SetDestinationCallback(DestinationCallback cb);
+
+    /**
+     * \brief Generate flows starting strictly between start and stop
+     * \param start the time arrivals count from
+     * \param stop no flow starts at or after this time
+     */
+    void Start(Time start, Time stop);
+
+    /// Cancel the pending arrivals
+    void Stop();
+
+    /// \return the number of flows started so far
+    uint64_t GetFlowCount() const;
+
+    /**
+     * \brief Use fixed random variable streams
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Arrival state of a source
+    struct Source
+    {
+        uint32_t host;  //!< the host
+        uint32_t peer;  //!< destination under PERMUTATION
+        Time onEnd;     //!< end of the current on period under ON_OFF
+        EventId event;  //!< the next arrival
+    };
+
+    /**
+     * \brief Schedule the next arrival of a source after time t
+     * \param index the source
+     * \param t the last arrival, or the start time
+     */
+    void ScheduleNext(uint32_t index, Time t);
+
+    /**
+     * \brief Start the flows of an arrival and schedule the next one
+     * \param index the source
+     */
+    void Arrive(uint32_t index);
+
+    /**
+     * \param src the source host
+     * \return another host, uniformly
+     */
+    uint32_t OtherHost(uint32_t src);
+
+    /**
+     * \brief Start one flow
+     * \param src sending host
+     * \param dst receiving host
+     * \param size bytes
+     */
+    void StartFlow(uint32_t src, uint32_t dst, uint64_t size);
+
+    Arrival m_arrival;        //!< arrival process
+    Pattern m_pattern;        //!< traffic pattern
+    double m_flowRate;        //!< arrivals per second per source, during on periods
+    Time m_meanOn;            //!< mean on period
+    Time m_meanOff;           //!< mean off period
+    uint32_t m_incastFanIn;   //!< senders per incast query
+    uint64_t m_incastSize;    //!< bytes per incast query
+    uint32_t m_nHosts;        //!< number of hosts
+    std::vector<Source> m_sources; //!< the sources
+    Time m_stop;              //!< no flow starts at or after this time
+    uint64_t m_flowCount;     //!< flows started
+    std::vector<uint32_t> m_senders; //!< scratch for drawing incast senders
+    Ptr<FlowSizeDistribution> m_sizes; //!< flow sizes
+    FlowCallback m_flowCallback;       //!< gets the flows
+    DestinationCallback m_destination; //!< destinations instead of the pattern
+    Ptr<ExponentialRandomVariable> m_gap;   //!< exponential variates of mean 1
+    Ptr<UniformRandomVariable> m_uniform;   //!< destinations and permutations
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_GENERATOR_H */
@@ -0,0 +1,374 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/bulk-send-application.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/flow-size-distribution.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/workload-generator.h"
+
+#include <set>
+
+using namespace ns3;
+
+/**
+ * \brief A websearch-like CDF
+ * \return the distribution
+ */
+static Ptr<FlowSizeDistribution>
+WebSearch()
+{
+    Ptr<FlowSizeDistribution> d = CreateObject<FlowSizeDistribution>();
+    d->Add(0, 0);
+    d->Add(2000, 0);
+    d->Add(2100, 0.02);
+    d->Add(10000, 0.15);
+    d->Add(20000, 0.2);
+    d->Add(30000, 0.3);
+    d->Add(50000, 0.4);
+    d->Add(80000, 0.53);
+    d->Add(200000, 0.6);
+    d->Add(1000000, 0.7);
+    d->Add(2000000, 0.8);
+    d->Add(5000000, 0.9);
+    d->Add(10000000, 0.97);
+    d->Add(30000000, 1);
+    return d;
+}
+
+/**
+ * \ingroup applications-test
+ *
+ * \brief FlowSizeDistribution against the linear search of the cdf.c table it replaces
+ */
+class FlowSizeDistributionTestCase : public TestCase
+{
+  public:
+    FlowSizeDistributionTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+FlowSizeDistributionTestCase::FlowSizeDistributionTestCase()
+    : TestCase("FlowSizeDistribution maps and samples like the cdf.c table")
+{
+}
+
+void
+FlowSizeDistributionTestCase::DoRun()
+{
+    Ptr<FlowSizeDistribution> d = WebSearch();
+    std::vector<std::pair<double, double>> table = {{0, 0},
+                                                    {2000, 0},
+                                                    {2100, 0.02},
+                                                    {10000, 0.15},
+                                                    {20000, 0.2},
+                                                    {30000, 0.3},
+                                                    {50000, 0.4},
+                                                    {80000, 0.53},
+                                                    {200000, 0.6},
+                                                    {1000000, 0.7},
+                                                    {2000000, 0.8},
+                                                    {5000000, 0.9},
+                                                    {10000000, 0.97},
+                                                    {30000000, 1}};
+    for (uint32_t k = 0; k <= 10000; k++)
+    {
+        double x = k / 10000.0;
+        double expected = table.back().first;
+        for (uint32_t i = 0; i < table.size(); i++)
+        {
+            if (x <= table[i].second)
+            {
+                double x1 = i == 0 ? 0 : table[i - 1].second;
+                double y1 = i == 0 ? 0 : table[i - 1].first;
+                double x2 = table[i].second;
+                double y2 = table[i].first;
+                expected = x1 == x2 ? (y1 + y2) / 2 : y1 + (x - x1) * (y2 - y1) / (x2 - x1);
+                break;
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(d->GetValue(x), expected, "inverse CDF at " << x);
+    }
+
+    d->AssignStreams(1);
+    double sum = 0;
+    uint32_t below = 0;
+    const uint32_t n = 400000;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double v = d->Sample();
+        NS_TEST_ASSERT_MSG_GT_OR_EQ(v, 2000, "sample below the smallest size");
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(v, 30000000, "sample above the largest size");
+        sum += v;
+        below += v <= 80000;
+    }
+    NS_TEST_ASSERT_MSG_EQ_TOL(sum / n / d->GetMean(), 1, 0.03, "sample mean");
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(below) / n, 0.53, 0.005, "sample CDF at 80000");
+}
+
+/**
+ * \ingroup applications-test
+ *
+ * \brief The arrival processes and traffic patterns of WorkloadGenerator
+ */
+class WorkloadGeneratorPatternTestCase : public TestCase
+{
+  public:
+    WorkloadGeneratorPatternTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * \brief Run a workload of 16 hosts for 100ms and keep its flows in m_flows
+     * \param g the generator
+     */
+    void Generate(Ptr<WorkloadGenerator> g);
+    /**
+     * \brief Record a flow
+     * \param flow the flow
+     */
+    void Flow(const WorkloadFlow& flow);
+
+    std::vector<WorkloadFlow> m_flows; //!< the flows of the last run
+    std::vector<Time> m_starts;        //!< start time of each flow
+};
+
+WorkloadGeneratorPatternTestCase::WorkloadGeneratorPatternTestCase()
+    : TestCase("WorkloadGenerator arrivals and destinations")
+{
+}
+
+void
+WorkloadGeneratorPatternTestCase::Flow(const WorkloadFlow& flow)
+{
+    NS_TEST_ASSERT_MSG_EQ(flow.id, m_flows.size(), "flow ids not sequential");
+    NS_TEST_ASSERT_MSG_NE(flow.src, flow.dst, "flow to itself");
+    NS_TEST_ASSERT_MSG_GT(flow.size, 0, "empty flow");
+    m_flows.push_back(flow);
+    m_starts.push_back(Simulator::Now());
+}
+
+void
+WorkloadGeneratorPatternTestCase::Generate(Ptr<WorkloadGenerator> g)
+{
+    m_flows.clear();
+    m_starts.clear();
+    g->SetHosts(16);
+    g->SetFlowSizeDistribution(WebSearch());
+    g->SetFlowCallback(MakeCallback(&WorkloadGeneratorPatternTestCase::Flow, this));
+    g->AssignStreams(10);
+    g->Start(MilliSeconds(10), MilliSeconds(110));
+    Simulator::Run();
+    Simulator::Destroy();
+    for (Time t : m_starts)
+    {
+        NS_TEST_ASSERT_MSG_GT(t, MilliSeconds(10), "flow before the start");
+        NS_TEST_ASSERT_MSG_LT(t, MilliSeconds(110), "flow after the stop");
+    }
+}
+
+void
+WorkloadGeneratorPatternTestCase::DoRun()
+{
+    // Poisson, all to all: 16 sources x 10000 flows/s x 100ms
+    Ptr<WorkloadGenerator> g = CreateObject<WorkloadGenerator>();
+    g->SetAttribute("FlowRate", DoubleValue(10000));
+    Generate(g);
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_flows.size()), 16000, 400, "Poisson flow count");
+    std::set<uint32_t> dsts;
+    for (const auto& f : m_flows)
+    {
+        if (f.src == 0)
+        {
+            dsts.insert(f.dst);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(dsts.size(), 15, "all to all reaches every other host");
+
+    // permutation: one destination per source, every host receives from one source
+    g = CreateObject<WorkloadGenerator>();
+    g->SetAttribute("Pattern", EnumValue(WorkloadGenerator::PERMUTATION));
+    Generate(g);
+    std::vector<int> peer(16, -1);
+    std::set<uint32_t> receivers;
+    for (const auto& f : m_flows)
+    {
+        NS_TEST_ASSERT_MSG_EQ((peer[f.src] == -1 || peer[f.src] == int(f.dst)), true, "peer changed");
+        peer[f.src] = f.dst;
+        receivers.insert(f.dst);
+    }
+    NS_TEST_ASSERT_MSG_EQ(receivers.size(), 16, "not a permutation");
+
+    // incast: queries of 4 senders to the source, 100000 bytes each
+    g = CreateObject<WorkloadGenerator>();
+    g->SetAttribute("Pattern", EnumValue(WorkloadGenerator::INCAST));
+    g->SetAttribute("IncastFanIn", UintegerValue(4));
+    g->SetAttribute("IncastSize", UintegerValue(400000));
+    g->SetAttribute("FlowRate", DoubleValue(100));
+    Generate(g);
+    NS_TEST_ASSERT_MSG_EQ(m_flows.size() % 4, 0, "partial query");
+    for (uint32_t q = 0; q + 4 <= m_flows.size(); q += 4)
+    {
+        std::set<uint32_t> senders;
+        for (uint32_t i = q; i < q + 4; i++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(m_flows[i].dst, m_flows[q].dst, "query to several hosts");
+            NS_TEST_ASSERT_MSG_EQ(m_flows[i].size, 100000, "query split");
+            NS_TEST_ASSERT_MSG_EQ(m_starts[i], m_starts[q], "query spread over time");
+            senders.insert(m_flows[i].src);
+        }
+        NS_TEST_ASSERT_MSG_EQ(senders.size(), 4, "sender twice in a query");
+    }
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_flows.size()), 16 * 100 * 0.1 * 4, 100, "incast queries");
+
+    // on-off: on a third of the time
+    g = CreateObject<WorkloadGenerator>();
+    g->SetAttribute("Arrival", EnumValue(WorkloadGenerator::ON_OFF));
+    g->SetAttribute("MeanOnTime", TimeValue(MicroSeconds(500)));
+    g->SetAttribute("MeanOffTime", TimeValue(MicroSeconds(1000)));
+    g->SetAttribute("FlowRate", DoubleValue(30000));
+    Generate(g);
+    NS_TEST_ASSERT_MSG_EQ_TOL(double(m_flows.size()), 16000, 1200, "on-off flow count");
+
+    // destination callback
+    g = CreateObject<WorkloadGenerator>();
+    g->SetDestinationCallback(MakeCallback(+[](uint32_t src) { return (src + 8) % 16; }));
+    Generate(g);
+    for (const auto& f : m_flows)
+    {
+        NS_TEST_ASSERT_MSG_EQ(f.dst, (f.src + 8) % 16, "destination callback ignored");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ *
+ * \brief WorkloadGenerator flows carried by BulkSendApplications installed when they start
+ */
+class WorkloadGeneratorBulkSendTestCase : public TestCase
+{
+  public:
+    WorkloadGeneratorBulkSendTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * \brief Install a BulkSendApplication and its PacketSink for a flow
+     * \param flow the flow
+     */
+    void Install(const WorkloadFlow& flow);
+    /**
+     * \brief Record a packet received by a sink
+     * \param p the packet
+     * \param addr the sender's address
+     */
+    void ReceiveRx(Ptr<const Packet> p, const Address& addr);
+
+    NodeContainer m_nodes;           //!< the hosts
+    Ipv4InterfaceContainer m_ifaces; //!< their addresses
+    uint64_t m_bytes{0};             //!< bytes of the flows started
+    uint64_t m_received{0};          //!< bytes received
+};
+
+WorkloadGeneratorBulkSendTestCase::WorkloadGeneratorBulkSendTestCase()
+    : TestCase("WorkloadGenerator flows over BulkSendApplication")
+{
+}
+
+void
+WorkloadGeneratorBulkSendTestCase::ReceiveRx(Ptr<const Packet> p, const Address& addr)
+{
+    m_received += p->GetSize();
+}
+
+void
+WorkloadGeneratorBulkSendTestCase::Install(const WorkloadFlow& flow)
+{
+    uint16_t port = 1000 + flow.id;
+    Ptr<BulkSendApplication> source = CreateObject<BulkSendApplication>();
+    source->SetAttribute("Protocol", TypeIdValue(TcpSocketFactory::GetTypeId()));
+    source->SetAttribute("MaxBytes", UintegerValue(flow.size));
+    source->SetAttribute("Remote",
+                         AddressValue(InetSocketAddress(m_ifaces.GetAddress(flow.dst), port)));
+    m_nodes.Get(flow.src)->AddApplication(source);
+    PacketSinkHelper sink("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinkApp = sink.Install(m_nodes.Get(flow.dst));
+    sinkApp.Get(0)->TraceConnectWithoutContext(
+        "Rx",
+        MakeCallback(&WorkloadGeneratorBulkSendTestCase::ReceiveRx, this));
+    m_bytes += flow.size;
+}
+
+void
+WorkloadGeneratorBulkSendTestCase::DoRun()
+{
+    m_nodes.Create(2);
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    simpleHelper.SetChannelAttribute("Delay", StringValue("10us"));
+    NetDeviceContainer devices = simpleHelper.Install(m_nodes);
+    InternetStackHelper internet;
+    internet.Install(m_nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    m_ifaces = ipv4.Assign(devices);
+
+    Ptr<FlowSizeDistribution> sizes = CreateObject<FlowSizeDistribution>();
+    sizes->Add(1000, 0);
+    sizes->Add(20000, 1);
+    Ptr<WorkloadGenerator> g = CreateObject<WorkloadGenerator>();
+    g->SetHosts(2);
+    g->SetAttribute("FlowRate", DoubleValue(100));
+    g->SetFlowSizeDistribution(sizes);
+    g->SetFlowCallback(MakeCallback(&WorkloadGeneratorBulkSendTestCase::Install, this));
+    g->AssignStreams(1);
+    g->Start(Seconds(0), Seconds(0.2));
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(g->GetFlowCount(), 10, "too few flows");
+    NS_TEST_ASSERT_MSG_EQ(m_received, m_bytes, "flows not delivered");
+}
+
+/**
+ * \ingroup applications-test
+ *
+ * \brief WorkloadGenerator TestSuite
+ */
+static class WorkloadGeneratorTestSuite : public TestSuite
+{
+  public:
+    WorkloadGeneratorTestSuite()
+        : TestSuite("workload-generator", UNIT)
+    {
+        AddTestCase(new FlowSizeDistributionTestCase(), TestCase::QUICK);
+        AddTestCase(new WorkloadGeneratorPatternTestCase(), TestCase::QUICK);
+        AddTestCase(new WorkloadGeneratorBulkSendTestCase(), TestCase::QUICK);
+    }
+} g_workloadGeneratorTestSuite; ///< the test suite
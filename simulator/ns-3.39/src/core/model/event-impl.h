@@ -20,6 +20,7 @@
 #define EVENT_IMPL_H
 
 #include "simple-ref-count.h"
+#include "slab-allocator.h"
 
 #include <stdint.h>
 
@@ -67,6 +68,30 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+#ifdef ENABLE_SLAB_ALLOCATOR
+    /**
+     * Allocate an event from the SlabAllocator.
+     *
+     * \param [in] size The size of the event.
+     * \returns The memory for the event.
+     */
+    static void* operator new(std::size_t size)
+    {
+        return SlabAllocator::Allocate(size);
+    }
+
+    /**
+     * Release an event to the SlabAllocator.
+     *
+     * \param [in] p The event.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size)
+    {
+        SlabAllocator::Deallocate(p, size);
+    }
+#endif /* ENABLE_SLAB_ALLOCATOR */
+
   protected:
     /**
      * Implementation for Invoke().
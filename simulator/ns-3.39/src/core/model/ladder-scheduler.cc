@@ -0,0 +1,307 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "type-id.h"
+#include "uinteger.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "Number of events above which a bucket is split over a new rung "
+                          "instead of being sorted",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topStart(0),
+      m_topMin(UINT64_MAX),
+      m_topMax(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_qSize(0),
+      m_threshold(50)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart(const Rung& rung) const
+{
+    return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.key.m_ts << ev.key.m_uid);
+    const uint64_t ts = ev.key.m_ts;
+    m_qSize++;
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        FillBottom();
+        return;
+    }
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        if (ts >= CurrentStart(rung))
+        {
+            rung.buckets[(ts - rung.start) / rung.width].push_back(ev);
+            rung.count++;
+            return;
+        }
+    }
+    InsertBottom(ev);
+    // Split a large Bottom over a new rung, unless all of it is due at once
+    if (m_bottom.size() - m_bottomHead > m_threshold && m_nRungs < MAX_RUNGS &&
+        m_bottom[m_bottomHead].key.m_ts != m_bottom.back().key.m_ts)
+    {
+        uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+        uint64_t end = m_nRungs > 0 ? CurrentStart(m_rungs[m_nRungs - 1]) : m_topStart;
+        NS_LOG_LOGIC("split bottom of " << m_bottom.size() - m_bottomHead << " events");
+        m_bottom.erase(m_bottom.begin(), m_bottom.begin() + m_bottomHead);
+        m_bottomHead = 0;
+        SpawnRung(m_bottom, start, end - start);
+        FillBottom();
+    }
+}
+
+void
+LadderScheduler::InsertBottom(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.key.m_ts << ev.key.m_uid);
+    m_bottom.insert(std::lower_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev), ev);
+}
+
+void
+LadderScheduler::SortBottom()
+{
+    NS_LOG_FUNCTION(this << m_bottom.size());
+    // Events due at the same time usually come in order of uid already
+    if (!std::is_sorted(m_bottom.begin(), m_bottom.end()))
+    {
+        std::sort(m_bottom.begin(), m_bottom.end());
+    }
+}
+
+void
+LadderScheduler::SpawnRung(Bucket& events, uint64_t start, uint64_t span)
+{
+    NS_LOG_FUNCTION(this << events.size() << start << span);
+    NS_ASSERT(m_nRungs < MAX_RUNGS && span > 0 && !events.empty());
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t nBuckets = std::min<uint64_t>({events.size(), MAX_BUCKETS, span});
+    rung.nBuckets = nBuckets;
+    rung.current = 0;
+    rung.start = start;
+    rung.width = (span + nBuckets - 1) / nBuckets;
+    rung.count = events.size();
+    if (rung.buckets.size() < nBuckets)
+    {
+        rung.buckets.resize(nBuckets);
+    }
+    for (const auto& ev : events)
+    {
+        rung.buckets[(ev.key.m_ts - start) / rung.width].push_back(ev);
+    }
+    events.clear();
+}
+
+void
+LadderScheduler::TransferTop()
+{
+    NS_LOG_FUNCTION(this << m_top.size());
+    NS_ASSERT(m_nRungs == 0 && m_bottom.empty());
+    if (m_top.size() <= m_threshold)
+    {
+        m_bottom.swap(m_top);
+        SortBottom();
+        m_topStart = m_topMax + 1;
+    }
+    else
+    {
+        SpawnRung(m_top, m_topMin, m_topMax - m_topMin + 1);
+        const Rung& rung = m_rungs[0];
+        m_topStart = rung.start + rung.nBuckets * rung.width;
+    }
+    m_topMin = UINT64_MAX;
+    m_topMax = 0;
+}
+
+void
+LadderScheduler::FillBottom()
+{
+    NS_LOG_FUNCTION(this);
+    while (m_bottom.empty())
+    {
+        if (m_nRungs == 0)
+        {
+            if (m_top.empty())
+            {
+                return;
+            }
+            TransferTop();
+            continue;
+        }
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+        Bucket& bucket = rung.buckets[rung.current];
+        uint64_t start = CurrentStart(rung);
+        rung.current++;
+        rung.count -= bucket.size();
+        if (bucket.size() > m_threshold && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            SpawnRung(bucket, start, rung.width);
+        }
+        else
+        {
+            // Bottom is empty: swap to keep the capacity of both
+            m_bottom.swap(bucket);
+            SortBottom();
+        }
+    }
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom[m_bottomHead++];
+    if (m_bottomHead == m_bottom.size())
+    {
+        m_bottom.clear();
+        m_bottomHead = 0;
+    }
+    m_qSize--;
+    FillBottom();
+    NS_LOG_LOGIC("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << &ev);
+    NS_ASSERT(!IsEmpty());
+    const uint64_t ts = ev.key.m_ts;
+    Bucket* bucket = nullptr;
+    Rung* rung = nullptr;
+    if (ts >= m_topStart)
+    {
+        bucket = &m_top;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < m_nRungs; i++)
+        {
+            if (ts >= CurrentStart(m_rungs[i]))
+            {
+                rung = &m_rungs[i];
+                bucket = &rung->buckets[(ts - rung->start) / rung->width];
+                break;
+            }
+        }
+    }
+    if (bucket == nullptr)
+    {
+        auto i = std::lower_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev);
+        NS_ASSERT(i != m_bottom.end() && i->key.m_uid == ev.key.m_uid);
+        m_bottom.erase(i);
+        if (m_bottomHead == m_bottom.size())
+        {
+            m_bottom.clear();
+            m_bottomHead = 0;
+        }
+    }
+    else
+    {
+        auto i = std::find_if(bucket->begin(), bucket->end(), [&ev](const Event& e) {
+            return e.key.m_uid == ev.key.m_uid;
+        });
+        NS_ASSERT(i != bucket->end());
+        *i = bucket->back();
+        bucket->pop_back();
+        if (rung != nullptr)
+        {
+            rung->count--;
+        }
+    }
+    m_qSize--;
+    FillBottom();
+}
+
+} // namespace ns3
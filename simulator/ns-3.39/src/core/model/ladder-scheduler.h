@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang], for the
+ * integer time stamps of ns-3.
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are kept in three tiers:
+ *  - Top, an unsorted `std::vector` of the events far in the future,
+ *    at or after `m_topStart`.
+ *  - The ladder, up to `MAX_RUNGS` rungs of buckets. Each rung covers the
+ *    span of one bucket of the rung above it, split in buckets of a
+ *    uniform width. Buckets are unsorted.
+ *  - Bottom, a sorted `std::vector` of the earliest events, which
+ *    RemoveNext() reads in order.
+ *
+ * When Bottom runs empty it is refilled from the first non-empty bucket
+ * of the lowest rung. A bucket with more than `Threshold` events is not
+ * sorted but split over a new rung, which keeps the sorts short.
+ * When the ladder runs empty, Top is spread over a new first rung.
+ * Unlike a calendar queue the bucket widths follow the events without
+ * any resizing, so dense bursts of events a few nanoseconds apart, as in
+ * datacenter simulations, don't degrade it.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to Top or a bucket; sorted insert in Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom kept sorted
+ * Remove()     | ~Constant       | Search within a bucket
+ * RemoveNext() | ~Constant       | Pop from Bottom; refill from the ladder
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | `MAX_RUNGS` x `std::vector` of buckets | Buckets are reused
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Bucket type: an unsorted vector of Events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder. */
+    struct Rung
+    {
+        std::vector<Bucket> buckets; //!< The buckets, only the first nBuckets are used.
+        uint32_t nBuckets;           //!< Number of buckets in use.
+        uint32_t current;            //!< First bucket not yet moved down.
+        uint64_t start;              //!< Time stamp at the start of the first bucket.
+        uint64_t width;              //!< Duration of a bucket, in dimensionless time units.
+        uint64_t count;              //!< Number of events in the rung.
+    };
+
+    /** Maximum number of rungs. */
+    static constexpr uint32_t MAX_RUNGS = 8;
+    /** Maximum number of buckets of a rung. */
+    static constexpr uint32_t MAX_BUCKETS = 4096;
+
+    /**
+     * Get the time stamp at the start of the first bucket of a rung
+     * not yet moved down.
+     *
+     * \param [in] rung The rung.
+     * \returns The time stamp.
+     */
+    inline uint64_t CurrentStart(const Rung& rung) const;
+    /**
+     * Add a rung below the others and spread events over it.
+     *
+     * \param [in,out] events The events, cleared.
+     * \param [in] start The start of the span covered by the rung.
+     * \param [in] span The duration of the span, in dimensionless time units.
+     */
+    void SpawnRung(Bucket& events, uint64_t start, uint64_t span);
+    /**
+     * Insert an event in Bottom, keeping it sorted.
+     *
+     * \param [in] ev The new Event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /** Sort Bottom after it was refilled. */
+    void SortBottom();
+    /** Refill Bottom from the ladder or Top if it is empty. */
+    void FillBottom();
+    /** Move Top down to a new rung, or to Bottom if it is small. */
+    void TransferTop();
+
+    /** Events at or after \c m_topStart. */
+    Bucket m_top;
+    /** Start of the span of Top. */
+    uint64_t m_topStart;
+    /** Lower bound of the time stamps in Top. */
+    uint64_t m_topMin;
+    /** Upper bound of the time stamps in Top. */
+    uint64_t m_topMax;
+    /** The rungs, only the first \c m_nRungs are used. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+    /** The earliest events, sorted; the first \c m_bottomHead were removed already. */
+    Bucket m_bottom;
+    /** Index of the next event of Bottom. */
+    std::size_t m_bottomHead;
+    /** Number of events in queue. */
+    uint64_t m_qSize;
+    /** Bucket size above which a bucket is split over a new rung. */
+    uint32_t m_threshold;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,230 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "slab-allocator.h"
+
+#include "log.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SlabAllocator implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SlabAllocator");
+
+namespace
+{
+
+/** Number of size classes of 16 bytes. */
+constexpr std::size_t N_SMALL_CLASSES = 16;
+/** Number of size classes. */
+constexpr std::size_t N_CLASSES = N_SMALL_CLASSES + SlabAllocator::MAX_SIZE / 256 - 1;
+/** Size of the header of a slab, which keeps the alignment of the blocks. */
+constexpr std::size_t SLAB_HEADER = 16;
+
+/** A free block, linked in the freelist of its size class. */
+struct FreeBlock
+{
+    FreeBlock* next; //!< The next free block.
+};
+
+/** A slab, linked in the list of all the slabs so that they stay reachable. */
+struct Slab
+{
+    Slab* next; //!< The previous slab allocated.
+};
+
+/**
+ * The freelists of a thread.
+ *
+ * This is zero-initialized and trivially destructible, so it stays usable
+ * by the destructors of static objects which run at exit.
+ */
+struct ThreadCache
+{
+    FreeBlock* heads[N_CLASSES]; //!< The freelists, by size class.
+    uint64_t allocations;        //!< Calls to Allocate().
+    uint64_t deallocations;      //!< Calls to Deallocate().
+    uint64_t large;              //!< Allocations above MAX_SIZE.
+};
+
+/** Hands the freelists of a thread which exits over to the other threads. */
+struct ThreadCacheRelease
+{
+    ~ThreadCacheRelease();
+    bool armed{false}; //!< Set when a freelist of t_cache gets blocks, to construct this object.
+};
+
+thread_local ThreadCache t_cache;          //!< The freelists of this thread.
+thread_local ThreadCacheRelease t_release; //!< Releases t_cache when this thread exits.
+
+std::mutex g_mutex;                //!< Protects g_heads and g_slabList.
+FreeBlock* g_heads[N_CLASSES];     //!< The freelists of the threads which exited.
+Slab* g_slabList = nullptr;        //!< All the slabs.
+std::atomic<uint64_t> g_slabs{0}; //!< Number of slabs.
+
+/**
+ * Get the size class of a request.
+ * \param [in] size The size of the request, at most MAX_SIZE.
+ * \returns The size class.
+ */
+inline std::size_t
+ClassOf(std::size_t size)
+{
+    if (size <= 256)
+    {
+        return size == 0 ? 0 : (size - 1) / 16;
+    }
+    return N_SMALL_CLASSES + (size - 257) / 256;
+}
+
+/**
+ * Get the size of the blocks of a size class.
+ * \param [in] c The size class.
+ * \returns The size of the blocks, in bytes.
+ */
+inline std::size_t
+BlockSize(std::size_t c)
+{
+    return c < N_SMALL_CLASSES ? (c + 1) * 16 : (c - N_SMALL_CLASSES + 2) * 256;
+}
+
+/**
+ * Refill an empty freelist of this thread, from the threads which exited
+ * or from a new slab.
+ * \param [in] c The size class.
+ * \returns The first block of the freelist.
+ */
+FreeBlock*
+Refill(std::size_t c)
+{
+    NS_LOG_FUNCTION(c);
+    t_release.armed = true;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_heads[c] == nullptr)
+    {
+        std::size_t blockSize = BlockSize(c);
+        auto slab = static_cast<uint8_t*>(::operator new(SlabAllocator::SLAB_SIZE));
+        reinterpret_cast<Slab*>(slab)->next = g_slabList;
+        g_slabList = reinterpret_cast<Slab*>(slab);
+        g_slabs++;
+        // Link the blocks in address order
+        FreeBlock* head = nullptr;
+        for (std::size_t i = (SlabAllocator::SLAB_SIZE - SLAB_HEADER) / blockSize; i > 0; i--)
+        {
+            auto block = reinterpret_cast<FreeBlock*>(slab + SLAB_HEADER + (i - 1) * blockSize);
+            block->next = head;
+            head = block;
+        }
+        g_heads[c] = head;
+    }
+    t_cache.heads[c] = g_heads[c];
+    g_heads[c] = nullptr;
+    return t_cache.heads[c];
+}
+
+ThreadCacheRelease::~ThreadCacheRelease()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (std::size_t c = 0; c < N_CLASSES; c++)
+    {
+        FreeBlock* head = t_cache.heads[c];
+        if (head == nullptr)
+        {
+            continue;
+        }
+        FreeBlock* tail = head;
+        while (tail->next != nullptr)
+        {
+            tail = tail->next;
+        }
+        tail->next = g_heads[c];
+        g_heads[c] = head;
+        t_cache.heads[c] = nullptr;
+    }
+}
+
+} // unnamed namespace
+
+void*
+SlabAllocator::Allocate(std::size_t size)
+{
+    ThreadCache& cache = t_cache;
+    cache.allocations++;
+    if (size > MAX_SIZE)
+    {
+        cache.large++;
+        return ::operator new(size);
+    }
+    std::size_t c = ClassOf(size);
+    FreeBlock* block = cache.heads[c];
+    if (block == nullptr)
+    {
+        block = Refill(c);
+    }
+    cache.heads[c] = block->next;
+    return block;
+}
+
+void
+SlabAllocator::Deallocate(void* p, std::size_t size)
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    ThreadCache& cache = t_cache;
+    cache.deallocations++;
+    if (size > MAX_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+    std::size_t c = ClassOf(size);
+    if (cache.heads[c] == nullptr)
+    {
+        t_release.armed = true;
+    }
+    auto block = static_cast<FreeBlock*>(p);
+    block->next = cache.heads[c];
+    cache.heads[c] = block;
+}
+
+SlabAllocator::Stats
+SlabAllocator::GetStats()
+{
+    const ThreadCache& cache = t_cache;
+    return Stats{cache.allocations, cache.deallocations, cache.large, g_slabs.load()};
+}
+
+bool
+SlabAllocator::IsEnabled()
+{
+#ifdef ENABLE_SLAB_ALLOCATOR
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SlabAllocator declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup core
+ * \brief Freelists of small memory blocks, sorted by size class.
+ *
+ * Requests of up to MAX_SIZE bytes are rounded up to a size class:
+ * multiples of 16 bytes up to 256 bytes, then multiples of 256 bytes.
+ * Each class keeps a freelist of blocks; an empty freelist is refilled
+ * by carving a new slab of SLAB_SIZE bytes. Slabs are never returned to
+ * the system, so the memory held follows the peak number of live blocks.
+ * Larger requests go to the global operator new.
+ *
+ * The freelists are per thread, so Allocate() and Deallocate() take no
+ * lock; a block can be released by another thread than the one which
+ * allocated it. The freelists of a thread which exits are handed over to
+ * the threads which run out of blocks next.
+ *
+ * When ns-3 is configured with `--enable-slab-allocator`
+ * (`NS3_SLAB_ALLOCATOR`), the events, packets, buffer data and packet
+ * and byte tag lists are allocated here.
+ */
+class SlabAllocator
+{
+  public:
+    /** Largest request served from the freelists, in bytes. */
+    static constexpr std::size_t MAX_SIZE = 4096;
+    /** Size of the slabs carved into blocks, in bytes. */
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+    /** Allocation counters. */
+    struct Stats
+    {
+        uint64_t allocations;   //!< Calls to Allocate() from the calling thread.
+        uint64_t deallocations; //!< Calls to Deallocate() from the calling thread.
+        uint64_t large;         //!< Allocations above MAX_SIZE from the calling thread.
+        uint64_t slabs;         //!< Slabs allocated by all the threads.
+    };
+
+    /**
+     * Allocate a block.
+     *
+     * \param [in] size The size of the block, in bytes.
+     * \returns The block, aligned for any fundamental type.
+     */
+    static void* Allocate(std::size_t size);
+    /**
+     * Release a block.
+     *
+     * \param [in] p The block, from Allocate(); may be null.
+     * \param [in] size The size passed to Allocate().
+     */
+    static void Deallocate(void* p, std::size_t size);
+    /**
+     * Get the allocation counters.
+     *
+     * \returns The counters.
+     */
+    static Stats GetStats();
+    /**
+     * Check whether the simulator core allocates through this class,
+     * that is whether ns-3 was built with `NS3_SLAB_ALLOCATOR`.
+     *
+     * \returns \c true if the slab allocator is enabled.
+     */
+    static bool IsEnabled();
+};
+
+} // namespace ns3
+
+#endif /* SLAB_ALLOCATOR_H */
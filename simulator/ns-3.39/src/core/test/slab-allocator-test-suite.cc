@@ -0,0 +1,203 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/slab-allocator.h"
+#include "ns3/test.h"
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * SlabAllocator test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup slab-allocator-tests SlabAllocator test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup slab-allocator-tests
+ * Blocks are aligned, don't overlap, and are reused within their size class.
+ */
+class SlabAllocatorBlocksTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    SlabAllocatorBlocksTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SlabAllocatorBlocksTestCase::SlabAllocatorBlocksTestCase()
+    : TestCase("Size classes and block reuse")
+{
+}
+
+void
+SlabAllocatorBlocksTestCase::DoRun()
+{
+    SlabAllocator::Stats before = SlabAllocator::GetStats();
+
+    // a freed block is the next one given out in its size class
+    void* p = SlabAllocator::Allocate(40);
+    SlabAllocator::Deallocate(p, 40);
+    NS_TEST_ASSERT_MSG_EQ(SlabAllocator::Allocate(33), p, "block not reused in its class");
+    void* q = SlabAllocator::Allocate(49);
+    NS_TEST_ASSERT_MSG_NE(q, p, "block reused by another class");
+    SlabAllocator::Deallocate(p, 33);
+    SlabAllocator::Deallocate(q, 49);
+
+    // blocks of all the classes, and a large one, are aligned and distinct
+    std::vector<std::pair<uint8_t*, std::size_t>> blocks;
+    for (std::size_t size = 1; size <= SlabAllocator::MAX_SIZE + 1000; size += 97)
+    {
+        for (uint32_t i = 0; i < 20; i++)
+        {
+            auto block = static_cast<uint8_t*>(SlabAllocator::Allocate(size));
+            NS_TEST_ASSERT_MSG_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0, "misaligned block");
+            std::memset(block, static_cast<int>(blocks.size()), size);
+            blocks.emplace_back(block, size);
+        }
+    }
+    for (std::size_t i = 0; i < blocks.size(); i++)
+    {
+        const auto& [block, size] = blocks[i];
+        for (std::size_t j = 0; j < size; j++)
+        {
+            if (block[j] != static_cast<uint8_t>(i))
+            {
+                NS_TEST_ASSERT_MSG_EQ(block[j], static_cast<uint8_t>(i), "overlapping blocks");
+            }
+        }
+        SlabAllocator::Deallocate(block, size);
+    }
+
+    SlabAllocator::Stats after = SlabAllocator::GetStats();
+    uint64_t nLarge = 0;
+    for (std::size_t size = 1; size <= SlabAllocator::MAX_SIZE + 1000; size += 97)
+    {
+        nLarge += size > SlabAllocator::MAX_SIZE ? 20 : 0;
+    }
+    NS_TEST_ASSERT_MSG_EQ(after.allocations - before.allocations,
+                          blocks.size() + 3,
+                          "allocations counted");
+    NS_TEST_ASSERT_MSG_EQ(after.deallocations - before.deallocations,
+                          blocks.size() + 3,
+                          "deallocations counted");
+    NS_TEST_ASSERT_MSG_EQ(after.large - before.large, nLarge, "large allocations counted");
+    SlabAllocator::Deallocate(nullptr, 8);
+}
+
+/**
+ * \ingroup slab-allocator-tests
+ * Blocks cross threads, and the freelists of a thread which exits are reused.
+ */
+class SlabAllocatorThreadsTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    SlabAllocatorThreadsTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SlabAllocatorThreadsTestCase::SlabAllocatorThreadsTestCase()
+    : TestCase("Blocks shared between threads")
+{
+}
+
+void
+SlabAllocatorThreadsTestCase::DoRun()
+{
+    // the largest size class, which nothing else uses
+    const uint32_t n = SlabAllocator::SLAB_SIZE / SlabAllocator::MAX_SIZE / 2;
+
+    // allocated by one thread, released by another
+    std::vector<void*> blocks;
+    std::thread producer([&blocks, n]() {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            blocks.push_back(SlabAllocator::Allocate(SlabAllocator::MAX_SIZE));
+        }
+    });
+    producer.join();
+    std::thread consumer([&blocks]() {
+        for (void* block : blocks)
+        {
+            SlabAllocator::Deallocate(block, SlabAllocator::MAX_SIZE);
+        }
+    });
+    consumer.join();
+
+    // the blocks left by the consumer are handed over to the next thread
+    uint64_t slabs = SlabAllocator::GetStats().slabs;
+    std::set<void*> reused;
+    std::thread next([&reused, n]() {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            reused.insert(SlabAllocator::Allocate(SlabAllocator::MAX_SIZE));
+        }
+        for (void* block : reused)
+        {
+            SlabAllocator::Deallocate(block, SlabAllocator::MAX_SIZE);
+        }
+    });
+    next.join();
+    NS_TEST_ASSERT_MSG_EQ(SlabAllocator::GetStats().slabs, slabs, "new slab instead of reuse");
+    NS_TEST_ASSERT_MSG_EQ((reused == std::set<void*>(blocks.begin(), blocks.end())),
+                          true,
+                          "blocks of the exited thread not reused");
+}
+
+/**
+ * \ingroup slab-allocator-tests
+ * SlabAllocator test suite.
+ */
+class SlabAllocatorTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    SlabAllocatorTestSuite();
+};
+
+SlabAllocatorTestSuite::SlabAllocatorTestSuite()
+    : TestSuite("slab-allocator")
+{
+    AddTestCase(new SlabAllocatorBlocksTestCase());
+    AddTestCase(new SlabAllocatorThreadsTestCase());
+}
+
+/**
+ * \ingroup slab-allocator-tests
+ * SlabAllocatorTestSuite instance variable.
+ */
+static SlabAllocatorTestSuite g_slabAllocatorTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
@@ -71,13 +72,24 @@ Ipv4GlobalRouting::GetTypeId()
                           "Interface notification events (up/down, or add/remove address)",
                           BooleanValue(false),
                           MakeBooleanAccessor(&Ipv4GlobalRouting::m_respondToInterfaceEvents),
+                          MakeBooleanChecker())
+            .AddAttribute("IndexedLookup",
+                          "Set to true to find routes in a per destination hash of ECMP sets and a "
+                          "prefix trie of the network routes, built on the first lookup after the "
+                          "routes change; set to false to scan the route lists per packet. Both "
+                          "make the same forwarding decisions.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&Ipv4GlobalRouting::m_indexedLookup),
                           MakeBooleanChecker());
     return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_indexedLookup(true),
+      m_trieValid(false),
+      m_indexDirty(true)
 {
     NS_LOG_FUNCTION(this);
 
@@ -96,6 +108,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_indexDirty = true;
 }
 
 void
@@ -105,6 +118,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_indexDirty = true;
 }
 
 void
@@ -117,6 +131,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_indexDirty = true;
 }
 
 void
@@ -126,6 +141,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_indexDirty = true;
 }
 
 void
@@ -138,6 +154,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_indexDirty = true;
 }
 
 /* Modification */
@@ -203,9 +220,134 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     NS_LOG_FUNCTION(this << dest << oif);
     NS_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = nullptr;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-    RouteVec_t allRoutes;
+    // all available routes that bring packets to their destination
+    const RouteVec& allRoutes = LookupRoutes(dest, oif);
+    if (!allRoutes.empty()) // if route(s) is found
+    {
+        // pick up one of the routes uniformly at random if random
+        // ECMP routing is enabled, or always select the first route
+        // consistently if random ECMP routing is disabled
+        uint32_t selectIndex;
+        if (m_randomEcmpRouting)
+        {
+            selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
+        }
+        else
+        {
+            selectIndex = 0;
+        }
+        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex);
+        // create a Ipv4Route object from the selected routing table entry
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        /// \todo handle multi-address case
+        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
+        rtentry->SetGateway(route->GetGateway());
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        return rtentry;
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+/* Modification */
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipPayload, Ptr<NetDevice> oif)
+ {
+   NS_LOG_FUNCTION_NOARGS ();
+  NS_ABORT_MSG_IF (m_randomEcmpRouting && m_flowEcmpRouting, "Ecmp mode selection");
+  NS_LOG_LOGIC ("Looking for route for destination " << header.GetDestination());
+   Ptr<Ipv4Route> rtentry = 0;
+   // all available routes that bring packets to their destination
+  const RouteVec& allRoutes = LookupRoutes (header.GetDestination (), oif);
+  if (allRoutes.size () > 0 ) // if route(s) is found
+    {
+      // select one of the routes uniformly at random if random
+      // ECMP routing is enabled, or map a flow consistently to a route
+      // if flow ECMP routing is enabled, or otherwise always select the 
+      // first route
+      uint32_t selectIndex;
+      // std::cout << "numroutes=" << allRoutes.size () << std::endl;
+      if (m_randomEcmpRouting)
+        {
+          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+        }
+      else  if (m_flowEcmpRouting && (allRoutes.size () > 1))
+        {
+          selectIndex = GetTupleValue (header, ipPayload) % allRoutes.size ();
+          // std:: cout << "Hash=" << GetTupleValue (header, ipPayload) << std::endl;
+        }
+      else
+        {
+          selectIndex = 0;
+        }
+      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
+      // create a Ipv4Route object from the selected routing table entry
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      /// \todo handle multi-address case
+      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
+      rtentry->SetGateway (route->GetGateway ());
+      uint32_t interfaceIdx = route->GetInterface ();
+      // std::cout << "interfaceIndex=" <<interfaceIdx << std::endl;
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+      return rtentry;
+    }
+  else 
+    {
+      return 0;
+    }
+}
+/* Modification */
+
+const Ipv4GlobalRouting::RouteVec&
+Ipv4GlobalRouting::LookupRoutes(Ipv4Address dest, Ptr<NetDevice> oif)
+{
+    if (!m_indexedLookup || oif)
+    {
+        LookupRoutesLinear(dest, oif, m_allRoutes);
+        return m_allRoutes;
+    }
+    if (m_indexDirty)
+    {
+        BuildIndex();
+    }
+    auto it = m_ecmpSets.find(dest.Get());
+    if (it != m_ecmpSets.end())
+    {
+        return it->second;
+    }
+    // No host route; the answer is kept for the next packet to dest
+    RouteVec& allRoutes = m_ecmpSets[dest.Get()];
+    if (!m_trieValid)
+    {
+        LookupRoutesLinear(dest, nullptr, allRoutes);
+        return allRoutes;
+    }
+    LookupNetworkTrie(dest, allRoutes);
+    if (allRoutes.empty()) // consider external if no host/network found
+    {
+        for (ASExternalRoutesCI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        {
+            if ((*k)->GetDestNetworkMask().IsMatch(dest, (*k)->GetDestNetwork()))
+            {
+                allRoutes.push_back(*k);
+                break;
+            }
+        }
+    }
+    return allRoutes;
+}
+
+void
+Ipv4GlobalRouting::LookupRoutesLinear(Ipv4Address dest,
+                                      Ptr<NetDevice> oif,
+                                      RouteVec& allRoutes) const
+{
+    allRoutes.clear();
 
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
     for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
@@ -228,7 +370,7 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     if (allRoutes.empty()) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        for (NetworkRoutesCI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
         {
             Ipv4Mask mask = (*j)->GetDestNetworkMask();
             Ipv4Address entry = (*j)->GetDestNetwork();
@@ -249,7 +391,7 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        for (ASExternalRoutesCI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
         {
             Ipv4Mask mask = (*k)->GetDestNetworkMask();
             Ipv4Address entry = (*k)->GetDestNetwork();
@@ -269,157 +411,75 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
             }
         }
     }
-    if (!allRoutes.empty()) // if route(s) is found
-    {
-        // pick up one of the routes uniformly at random if random
-        // ECMP routing is enabled, or always select the first route
-        // consistently if random ECMP routing is disabled
-        uint32_t selectIndex;
-        if (m_randomEcmpRouting)
-        {
-            selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
-        }
-        else
+}
+
+void
+Ipv4GlobalRouting::LookupNetworkTrie(Ipv4Address dest, RouteVec& allRoutes) const
+{
+    // every prefix on the path of dest matches; report them in m_networkRoutes order
+    std::vector<std::pair<uint32_t, Ipv4RoutingTableEntry*>> found;
+    uint32_t addr = dest.Get();
+    uint32_t depths = 0;
+    int32_t node = 0;
+    for (uint32_t bit = 0; node >= 0; bit++)
+    {
+        const TrieNode& n = m_trie[node];
+        if (!n.routes.empty())
         {
-            selectIndex = 0;
+            found.insert(found.end(), n.routes.begin(), n.routes.end());
+            depths++;
         }
-        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex);
-        // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-        return rtentry;
+        node = bit < 32 ? n.child[(addr >> (31 - bit)) & 1] : -1;
     }
-    else
+    if (depths > 1)
     {
-        return nullptr;
+        std::sort(found.begin(), found.end());
+    }
+    for (const auto& route : found)
+    {
+        allRoutes.push_back(route.second);
     }
 }
 
-/* Modification */
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> ipPayload, Ptr<NetDevice> oif)
- {
-   NS_LOG_FUNCTION_NOARGS ();
-  NS_ABORT_MSG_IF (m_randomEcmpRouting && m_flowEcmpRouting, "Ecmp mode selection");
-  NS_LOG_LOGIC ("Looking for route for destination " << header.GetDestination());
-   Ptr<Ipv4Route> rtentry = 0;
-   // store all available routes that bring packets to their destination
-   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-
-  RouteVec_t allRoutes;
-
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+void
+Ipv4GlobalRouting::BuildIndex()
+{
+    NS_LOG_FUNCTION(this);
+    m_ecmpSets.clear();
+    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == (header.GetDestination ())) 
-        {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
-        }
+        m_ecmpSets[(*i)->GetDest().Get()].push_back(*i);
     }
-  if (allRoutes.size () == 0) // if no host route is found
+
+    m_trie.assign(1, TrieNode{{-1, -1}, {}});
+    m_trieValid = true;
+    uint32_t pos = 0;
+    for (NetworkRoutesCI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++, pos++)
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+        uint32_t inverse = ~(*j)->GetDestNetworkMask().Get();
+        if (inverse & (inverse + 1))
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (header.GetDestination (), entry)) 
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
+            NS_LOG_LOGIC("Network mask is not a prefix, scanning the route lists");
+            m_trieValid = false;
+            break;
         }
-    }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
-    {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+        uint32_t network = (*j)->GetDestNetwork().Get();
+        uint16_t length = (*j)->GetDestNetworkMask().GetPrefixLength();
+        int32_t node = 0;
+        for (uint16_t bit = 0; bit < length; bit++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (header.GetDestination (), entry))
+            uint32_t b = (network >> (31 - bit)) & 1;
+            if (m_trie[node].child[b] < 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
+                m_trie[node].child[b] = m_trie.size();
+                m_trie.push_back(TrieNode{{-1, -1}, {}});
             }
+            node = m_trie[node].child[b];
         }
+        m_trie[node].routes.emplace_back(pos, *j);
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
-    {
-      // select one of the routes uniformly at random if random
-      // ECMP routing is enabled, or map a flow consistently to a route
-      // if flow ECMP routing is enabled, or otherwise always select the 
-      // first route
-      uint32_t selectIndex;
-      // std::cout << "numroutes=" << allRoutes.size () << std::endl;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else  if (m_flowEcmpRouting && (allRoutes.size () > 1))
-        {
-          selectIndex = GetTupleValue (header, ipPayload) % allRoutes.size ();
-          // std:: cout << "Hash=" << GetTupleValue (header, ipPayload) << std::endl;
-        }
-      else
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
-      // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
-      /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      // std::cout << "interfaceIndex=" <<interfaceIdx << std::endl;
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
-    }
-  else 
-    {
-      return 0;
-    }
+    m_indexDirty = false;
 }
-/* Modification */
 
 uint32_t
 Ipv4GlobalRouting::GetNRoutes() const
@@ -480,6 +540,7 @@ void
 Ipv4GlobalRouting::RemoveRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
+    m_indexDirty = true;
     if (index < m_hostRoutes.size())
     {
         uint32_t tmp = 0;
@@ -556,6 +617,9 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_ecmpSets.clear();
+    m_trie.clear();
+    m_indexDirty = true;
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -28,6 +28,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -241,6 +243,9 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     /// Set to true if this interface should respond to interface events by globallly recomputing
     /// routes
     bool m_respondToInterfaceEvents;
+    /// Set to true to look routes up in a hash of ECMP sets and a prefix trie instead of scanning
+    /// the route lists
+    bool m_indexedLookup;
     /// A uniform random number generator for randomly routing packets among ECMP
     Ptr<UniformRandomVariable> m_rand;
 
@@ -265,6 +270,42 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
     typedef std::list<Ipv4RoutingTableEntry*>::iterator ASExternalRoutesI;
 
+    /// the routes a destination may take, in routing table order
+    typedef std::vector<Ipv4RoutingTableEntry*> RouteVec;
+
+    /// node of the binary prefix trie over the network routes
+    struct TrieNode
+    {
+        int32_t child[2]; //!< index of the child for the next address bit, -1 if none
+        /// network routes ending at this prefix, with their position in m_networkRoutes
+        std::vector<std::pair<uint32_t, Ipv4RoutingTableEntry*>> routes;
+    };
+
+    /**
+     * rief Find all the routes to dest, in the order of the route lists
+     *
+     * Host routes win over network routes, which win over the first matching external route.
+     * \param dest destination address
+     * \param oif output interface if any (put 0 otherwise)
+     * eturn the routes, valid until the next call
+     */
+    const RouteVec& LookupRoutes(Ipv4Address dest, Ptr<NetDevice> oif);
+    /**
+     * rief LookupRoutes by scanning the route lists
+     * \param dest destination address
+     * \param oif output interface if any (put 0 otherwise)
+     * \param allRoutes filled with the routes
+     */
+    void LookupRoutesLinear(Ipv4Address dest, Ptr<NetDevice> oif, RouteVec& allRoutes) const;
+    /**
+     * rief LookupRoutes for the network routes with the prefix trie
+     * \param dest destination address
+     * \param allRoutes filled with the matching network routes
+     */
+    void LookupNetworkTrie(Ipv4Address dest, RouteVec& allRoutes) const;
+    /// Build m_ecmpSets and m_trie from the route lists
+    void BuildIndex();
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -282,6 +323,13 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    /// ECMP set per destination: the host routes, filled in for other destinations on first use
+    std::unordered_map<uint32_t, RouteVec> m_ecmpSets;
+    std::vector<TrieNode> m_trie; //!< prefix trie of m_networkRoutes, root at 0
+    bool m_trieValid;             //!< false if a network mask is not a prefix
+    bool m_indexDirty;            //!< routes changed since BuildIndex
+    RouteVec m_allRoutes;         //!< result of the last linear LookupRoutes
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -186,7 +186,7 @@ void TcpAdvanced::ProcessDcAck(Ptr<Packet> packet, const TcpHeader& tcpHeader, P
 
 
 
-void TcpAdvanced::UpdateRatePowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb, bool fast_react) {
+void TcpAdvanced::UpdateRatePowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb, bool fast_react) {
 	uint32_t next_seq = tcb->m_nextTxSequence.Get().GetValue();
 	uint32_t ackNum = tcpHeader.GetAckNumber().GetValue();
 
@@ -290,13 +290,13 @@ void TcpAdvanced::UpdateRatePowertcp(Ptr<Packet> packet, const TcpHeader& tcpHea
 
 
 
-void TcpAdvanced::FastReactPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb) {
+void TcpAdvanced::FastReactPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb) {
 	if (tcb->m_fast_react)
 		UpdateRatePowertcp(packet, tcpHeader, tcb, fb, true);
 }
 
 
-void TcpAdvanced::UpdateRateThetaPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb, bool fast_react) {
+void TcpAdvanced::UpdateRateThetaPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb, bool fast_react) {
 	uint32_t next_seq = tcb->m_nextTxSequence.Get().GetValue();
 	uint32_t ackNum = tcpHeader.GetAckNumber().GetValue();
 
@@ -371,14 +371,14 @@ void TcpAdvanced::UpdateRateThetaPowertcp(Ptr<Packet> packet, const TcpHeader& t
 
 
 
-void TcpAdvanced::FastReactThetaPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb) {
+void TcpAdvanced::FastReactThetaPowertcp(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb) {
 	if (tcb->m_fast_react) {
 		// UpdateRateThetaPowertcp(packet,tcpHeader, tcb,fb, true);
 	}
 }
 
 
-void TcpAdvanced::UpdateRateHpcc(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb, bool fast_react) {
+void TcpAdvanced::UpdateRateHpcc(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb, bool fast_react) {
 
 	uint32_t next_seq = tcb->m_nextTxSequence.Get().GetValue();
 
@@ -501,14 +501,14 @@ void TcpAdvanced::UpdateRateHpcc(Ptr<Packet> packet, const TcpHeader& tcpHeader,
 	}
 }
 
-void TcpAdvanced::FastReactHpcc(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb) {
+void TcpAdvanced::FastReactHpcc(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb) {
 	if (tcb->m_fast_react)
 		UpdateRateHpcc(packet, tcpHeader, tcb, fb, true);
 }
 
 
 /*Timely*/
-void TcpAdvanced::UpdateRateTimely(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb, bool fast_react) {
+void TcpAdvanced::UpdateRateTimely(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb, bool fast_react) {
 	uint32_t next_seq = tcb->m_nextTxSequence.Get().GetValue();
 
 	uint64_t rtt = Simulator::Now().GetNanoSeconds() - fb.getPktTimestamp();
@@ -566,7 +566,7 @@ void TcpAdvanced::UpdateRateTimely(Ptr<Packet> packet, const TcpHeader& tcpHeade
 	}
 }
 
-void TcpAdvanced::FastReactTimely(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, FeedbackTag fb) {
+void TcpAdvanced::FastReactTimely(Ptr<Packet> packet, const TcpHeader& tcpHeader, Ptr<TcpSocketState> tcb, const FeedbackTag& fb) {
 }
 
 
@@ -38,6 +38,7 @@
 #include "ns3/socket-factory.h"
 #include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/udp-header.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
@@ -1313,6 +1314,148 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting indexed lookup test.
+ *
+ * The hashed ECMP sets and the prefix trie must pick the same routes as the route list scan,
+ * with flow ECMP over host routes, overlapping network routes, external routes and after a route
+ * is removed.
+ */
+class Ipv4GlobalRoutingIndexedLookupTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingIndexedLookupTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * \brief Route random flows with both routing objects and compare
+     * \param nFlows number of flows
+     */
+    void Compare(uint32_t nFlows);
+
+    Ptr<Ipv4GlobalRouting> m_routing[2]; //!< indexed, linear
+    Ptr<UniformRandomVariable> m_rand;   //!< destinations and ports
+};
+
+Ipv4GlobalRoutingIndexedLookupTestCase::Ipv4GlobalRoutingIndexedLookupTestCase()
+    : TestCase("Indexed global routing lookup matches the route list scan")
+{
+}
+
+void
+Ipv4GlobalRoutingIndexedLookupTestCase::Compare(uint32_t nFlows)
+{
+    const char* prefixes[] = {"10.1.0.0", "10.2.3.0", "10.2.9.0", "10.7.0.0", "192.168.5.0",
+                              "172.16.0.0"};
+    for (uint32_t i = 0; i < nFlows; i++)
+    {
+        Ipv4Header header;
+        header.SetSource(Ipv4Address("10.0.1.1"));
+        header.SetDestination(
+            Ipv4Address(Ipv4Address(prefixes[m_rand->GetInteger(0, 5)]).Get() +
+                        m_rand->GetInteger(1, 60)));
+        header.SetProtocol(17);
+        UdpHeader udp;
+        udp.SetSourcePort(m_rand->GetInteger(1, 65535));
+        udp.SetDestinationPort(m_rand->GetInteger(1, 65535));
+        Ptr<Packet> p = Create<Packet>(100);
+        p->AddHeader(udp);
+
+        Ptr<Ipv4Route> route[2];
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            Socket::SocketErrno err;
+            route[k] = m_routing[k]->RouteOutput(p, header, nullptr, err);
+        }
+        NS_TEST_ASSERT_MSG_EQ(bool(route[0]), bool(route[1]), "route found by one lookup only");
+        if (route[0])
+        {
+            NS_TEST_ASSERT_MSG_EQ(route[0]->GetOutputDevice(),
+                                  route[1]->GetOutputDevice(),
+                                  "different device for " << header.GetDestination());
+            NS_TEST_ASSERT_MSG_EQ(route[0]->GetGateway(),
+                                  route[1]->GetGateway(),
+                                  "different gateway for " << header.GetDestination());
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingIndexedLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    for (uint32_t i = 1; i <= 4; i++)
+    {
+        Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice>();
+        dev->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(dev);
+        int32_t ifIndex = ipv4->AddInterface(dev);
+        ipv4->AddAddress(ifIndex,
+                         Ipv4InterfaceAddress(Ipv4Address(Ipv4Address("10.0.0.1").Get() + (i << 8)),
+                                              Ipv4Mask("/24")));
+        ipv4->SetUp(ifIndex);
+    }
+
+    m_rand = CreateObject<UniformRandomVariable>();
+    m_rand->SetStream(1);
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        m_routing[k] = CreateObject<Ipv4GlobalRouting>();
+        m_routing[k]->SetAttribute("FlowEcmpRouting", BooleanValue(true));
+        m_routing[k]->SetAttribute("IndexedLookup", BooleanValue(k == 0));
+        m_routing[k]->SetIpv4(ipv4);
+        // three way ECMP host routes, interleaved like GlobalRouteManager adds them
+        for (uint32_t nh = 1; nh <= 3; nh++)
+        {
+            for (uint32_t h = 1; h <= 40; h++)
+            {
+                m_routing[k]->AddHostRouteTo(Ipv4Address(Ipv4Address("10.1.0.0").Get() + h),
+                                             Ipv4Address(Ipv4Address("10.0.0.2").Get() + (nh << 8)),
+                                             nh);
+            }
+        }
+        // overlapping prefixes, the longest first: all that match are ECMP in list order
+        m_routing[k]->AddNetworkRouteTo(Ipv4Address("10.2.3.0"), Ipv4Mask("/24"), 2);
+        m_routing[k]->AddNetworkRouteTo(Ipv4Address("10.0.0.0"),
+                                        Ipv4Mask("/8"),
+                                        Ipv4Address("10.0.4.2"),
+                                        4);
+        m_routing[k]->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                                        Ipv4Mask("/16"),
+                                        Ipv4Address("10.0.1.2"),
+                                        1);
+        m_routing[k]->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                                        Ipv4Mask("/16"),
+                                        Ipv4Address("10.0.3.2"),
+                                        3);
+        m_routing[k]->AddASExternalRouteTo(Ipv4Address("192.168.0.0"),
+                                           Ipv4Mask("/16"),
+                                           Ipv4Address("10.0.4.2"),
+                                           4);
+        m_routing[k]->AddASExternalRouteTo(Ipv4Address("192.0.0.0"),
+                                           Ipv4Mask("/8"),
+                                           Ipv4Address("10.0.3.2"),
+                                           3);
+    }
+    Compare(2000);
+
+    // drop one of the ECMP host routes and a network route, the index must follow
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        m_routing[k]->RemoveRoute(5);
+        m_routing[k]->RemoveRoute(121);
+    }
+    Compare(2000);
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1335,6 +1478,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingIndexedLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
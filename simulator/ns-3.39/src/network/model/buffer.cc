@@ -20,6 +20,7 @@
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/slab-allocator.h"
 
 #define LOG_INTERNAL_STATE(y)                                                                      \
     NS_LOG_LOGIC(y << "start=" << m_start << ", end=" << m_end                                     \
@@ -173,7 +174,11 @@ Buffer::Allocate(uint32_t reqSize)
     NS_ASSERT(reqSize >= 1);
     reqSize += ALLOC_OVER_PROVISION;
     uint32_t size = reqSize - 1 + sizeof(Buffer::Data);
+#ifdef ENABLE_SLAB_ALLOCATOR
+    uint8_t* b = static_cast<uint8_t*>(SlabAllocator::Allocate(size));
+#else
     uint8_t* b = new uint8_t[size];
+#endif
     Buffer::Data* data = reinterpret_cast<Buffer::Data*>(b);
     data->m_size = reqSize;
     data->m_count = 1;
@@ -185,8 +190,12 @@ Buffer::Deallocate(Buffer::Data* data)
 {
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
+#ifdef ENABLE_SLAB_ALLOCATOR
+    SlabAllocator::Deallocate(data, data->m_size - 1 + sizeof(Buffer::Data));
+#else
     uint8_t* buf = reinterpret_cast<uint8_t*>(data);
     delete[] buf;
+#endif
 }
 
 Buffer::Buffer()
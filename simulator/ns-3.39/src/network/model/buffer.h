@@ -25,7 +25,10 @@
 #include <stdint.h>
 #include <vector>
 
+// The slab allocator keeps its own freelists of buffer data
+#ifndef ENABLE_SLAB_ALLOCATOR
 #define BUFFER_FREE_LIST 1
+#endif
 
 namespace ns3
 {
@@ -19,12 +19,16 @@
 #include "byte-tag-list.h"
 
 #include "ns3/log.h"
+#include "ns3/slab-allocator.h"
 
 #include <cstring>
 #include <limits>
 #include <vector>
 
+// The slab allocator keeps its own freelists of tag data
+#ifndef ENABLE_SLAB_ALLOCATOR
 #define USE_FREE_LIST 1
+#endif
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max())
 
@@ -407,7 +411,11 @@ ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
+#ifdef ENABLE_SLAB_ALLOCATOR
+    uint8_t* buffer = static_cast<uint8_t*>(SlabAllocator::Allocate(size + sizeof(ByteTagListData) - 4));
+#else
     uint8_t* buffer = new uint8_t[size + sizeof(ByteTagListData) - 4];
+#endif
     ByteTagListData* data = (ByteTagListData*)buffer;
     data->count = 1;
     data->size = size;
@@ -426,8 +434,12 @@ ByteTagList::Deallocate(ByteTagListData* data)
     data->count--;
     if (data->count == 0)
     {
+#ifdef ENABLE_SLAB_ALLOCATOR
+        SlabAllocator::Deallocate(data, data->size + sizeof(ByteTagListData) - 4);
+#else
         uint8_t* buffer = (uint8_t*)data;
         delete[] buffer;
+#endif
     }
 }
 
@@ -29,6 +29,7 @@
 
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/slab-allocator.h"
 
 #include <cstring>
 
@@ -44,14 +45,30 @@ PacketTagList::CreateTagData(size_t dataSize)
                   "Requested TagData size " << dataSize << " exceeds maximum "
                                             << std::numeric_limits<decltype(TagData::size)>::max());
 
-    void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+#ifdef ENABLE_SLAB_ALLOCATOR
+    void* p = SlabAllocator::Allocate(sizeof(TagData) + dataSize - 1);
+#else
+    void* p = ::operator new(sizeof(TagData) + dataSize - 1);
+#endif
+    // The matching frees are in RemoveAll, RemoveWriter and ReplaceWriter
 
     TagData* tag = new (p) TagData;
     tag->size = dataSize;
     return tag;
 }
 
+void
+PacketTagList::FreeTagData(TagData* tag)
+{
+    std::size_t size = sizeof(TagData) + tag->size - 1;
+    tag->~TagData();
+#ifdef ENABLE_SLAB_ALLOCATOR
+    SlabAllocator::Deallocate(tag, size);
+#else
+    ::operator delete(tag, size);
+#endif
+}
+
 bool
 PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 {
@@ -195,8 +212,7 @@ PacketTagList::RemoveWriter(Tag& tag,
     if (preMerge)
     {
         // found tid before first merge, so delete cur
-        cur->~TagData();
-        std::free(cur);
+        FreeTagData(cur);
     }
     else
     {
@@ -234,11 +250,23 @@ PacketTagList::ReplaceWriter(Tag& tag,
 
     // found tid
     bool found = true;
-    if (preMerge)
+    if (preMerge && tag.GetSerializedSize() == cur->size)
     {
         // found tid before first merge, so just rewrite
         tag.Serialize(TagBuffer(cur->data, cur->data + cur->size));
     }
+    else if (preMerge)
+    {
+        // found tid before first merge, but the tag changed size (e.g. FeedbackTag
+        // grows by one hop per switch): swap cur for a resized node
+        TagData* copy = CreateTagData(tag.GetSerializedSize());
+        copy->tid = cur->tid;
+        copy->count = 1;
+        tag.Serialize(TagBuffer(copy->data, copy->data + copy->size));
+        copy->next = cur->next;
+        *prevNext = copy;
+        FreeTagData(cur);
+    }
     else
     {
         // cur is always a merge at this point
@@ -115,7 +115,8 @@ class Tag;
  *     target tag is found relative to the first branch point:
  *     - \e Target before <em> the first branch point: </em> \n
  *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
+ *       in the case of #Remove; rewritten in the case of #Replace, or
+ *       reallocated if the tag now serializes to a different size).
  *     - \e Target at or after <em> the first branch point: </em> \n
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
@@ -252,6 +253,12 @@ class PacketTagList
      * \returns The newly constructed TagData object.
      */
     static TagData* CreateTagData(size_t dataSize);
+    /**
+     * Destruct and release a TagData struct from CreateTagData().
+     *
+     * \param [in] tag The TagData object.
+     */
+    static void FreeTagData(TagData* tag);
 
     /**
      * Typedef of method function pointer for copy-on-write operations
@@ -365,15 +372,13 @@ PacketTagList::RemoveAll()
         }
         if (prev != nullptr)
         {
-            prev->~TagData();
-            std::free(prev);
+            FreeTagData(prev);
         }
         prev = cur;
     }
     if (prev != nullptr)
     {
-        prev->~TagData();
-        std::free(prev);
+        FreeTagData(prev);
     }
     m_next = nullptr;
 }
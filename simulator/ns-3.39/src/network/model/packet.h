@@ -32,6 +32,7 @@
 #include "ns3/callback.h"
 #include "ns3/mac48-address.h"
 #include "ns3/ptr.h"
+#include "ns3/slab-allocator.h"
 
 #include <stdint.h>
 
@@ -716,6 +717,30 @@ class Packet : public SimpleRefCount<Packet>
      */
     Ptr<NixVector> GetNixVector() const;
 
+#ifdef ENABLE_SLAB_ALLOCATOR
+    /**
+     * Allocate a packet from the SlabAllocator.
+     *
+     * \param [in] size The size of the packet.
+     * \returns The memory for the packet.
+     */
+    static void* operator new(std::size_t size)
+    {
+        return SlabAllocator::Allocate(size);
+    }
+
+    /**
+     * Release a packet to the SlabAllocator.
+     *
+     * \param [in] p The packet.
+     * \param [in] size The size of the packet.
+     */
+    static void operator delete(void* p, std::size_t size)
+    {
+        SlabAllocator::Deallocate(p, size);
+    }
+#endif /* ENABLE_SLAB_ALLOCATOR */
+
     /**
      * TracedCallback signature for Ptr<Packet>
      *
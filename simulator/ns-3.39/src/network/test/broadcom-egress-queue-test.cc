@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \brief Strict priority and DWRR between the classes of a BEgressQueue
+ */
+class BEgressQueueSchedulerTest : public TestCase
+{
+  public:
+    BEgressQueueSchedulerTest();
+    void DoRun() override;
+
+  private:
+    /**
+     * \brief Dequeue n packets and count them per class
+     * \param q the queue
+     * \param n number of packets
+     * \param paused the paused classes
+     * \param count incremented per dequeued packet of each class
+     */
+    void Drain(Ptr<BEgressQueue> q, uint32_t n, bool paused[], uint32_t count[]);
+};
+
+BEgressQueueSchedulerTest::BEgressQueueSchedulerTest()
+    : TestCase("BEgressQueue serves strict classes first and shares the rest by quantum")
+{
+}
+
+void
+BEgressQueueSchedulerTest::Drain(Ptr<BEgressQueue> q, uint32_t n, bool paused[], uint32_t count[])
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = q->DequeueRR(paused);
+        NS_TEST_ASSERT_MSG_NE(p, nullptr, "nothing dequeued");
+        count[q->GetLastQueue()]++;
+    }
+}
+
+void
+BEgressQueueSchedulerTest::DoRun()
+{
+    bool paused[BEgressQueue::qCnt] = {false};
+
+    // default: every class strict, lowest first
+    Ptr<BEgressQueue> q = CreateObject<BEgressQueue>();
+    q->Enqueue(Create<Packet>(100), 5);
+    q->Enqueue(Create<Packet>(100), 3);
+    q->Enqueue(Create<Packet>(100), 1);
+    for (uint32_t expected : {1, 3, 5})
+    {
+        q->DequeueRR(paused);
+        NS_TEST_ASSERT_MSG_EQ(q->GetLastQueue(), expected, "strict priority order");
+    }
+    NS_TEST_ASSERT_MSG_EQ(q->DequeueRR(paused), nullptr, "empty queue");
+
+    // DWRR 1:3 between classes 1 and 3, class 0 strict
+    q = CreateObject<BEgressQueue>();
+    q->SetAttribute("StrictPriorityClasses", UintegerValue(0x1));
+    q->SetQuantum(1, 1000);
+    q->SetQuantum(3, 3000);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        q->Enqueue(Create<Packet>(1000), 1);
+        q->Enqueue(Create<Packet>(1000), 3);
+    }
+    uint32_t count[BEgressQueue::qCnt] = {0};
+    Drain(q, 40, paused, count);
+    NS_TEST_ASSERT_MSG_EQ(count[1], 10, "class 1 share");
+    NS_TEST_ASSERT_MSG_EQ(count[3], 30, "class 3 share");
+    q->Enqueue(Create<Packet>(64), 0);
+    q->DequeueRR(paused);
+    NS_TEST_ASSERT_MSG_EQ(q->GetLastQueue(), 0, "class 0 not strict");
+
+    // a paused class gives its share away
+    paused[3] = true;
+    count[1] = count[3] = 0;
+    Drain(q, 20, paused, count);
+    NS_TEST_ASSERT_MSG_EQ(count[1], 20, "paused class served");
+    paused[3] = false;
+
+    // quanta below the packet size take several rounds
+    q = CreateObject<BEgressQueue>();
+    q->SetAttribute("StrictPriorityClasses", UintegerValue(0x1));
+    q->SetQuantum(1, 250);
+    q->SetQuantum(2, 500);
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        q->Enqueue(Create<Packet>(1000), 1);
+        q->Enqueue(Create<Packet>(1000), 2);
+    }
+    count[1] = count[2] = 0;
+    Drain(q, 30, paused, count);
+    NS_TEST_ASSERT_MSG_EQ(count[1], 10, "class 1 share with small quanta");
+    NS_TEST_ASSERT_MSG_EQ(count[2], 20, "class 2 share with small quanta");
+
+    // strict class 3 before the DWRR classes 1 and 2
+    q = CreateObject<BEgressQueue>();
+    q->SetAttribute("StrictPriorityClasses", UintegerValue(0x9));
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        q->Enqueue(Create<Packet>(1000), 1);
+        q->Enqueue(Create<Packet>(1000), 2);
+        q->Enqueue(Create<Packet>(1000), 3);
+    }
+    count[1] = count[2] = count[3] = 0;
+    Drain(q, 10, paused, count);
+    NS_TEST_ASSERT_MSG_EQ(count[3], 10, "strict class not first");
+    Drain(q, 20, paused, count);
+    NS_TEST_ASSERT_MSG_EQ(count[1], 10, "class 1 with the default quantum");
+    NS_TEST_ASSERT_MSG_EQ(count[2], 10, "class 2 with the default quantum");
+    NS_TEST_ASSERT_MSG_EQ(q->GetNBytesTotal(), 0, "bytes left");
+}
+
+/**
+ * \brief TestSuite for the BEgressQueue scheduler
+ */
+class BEgressQueueTestSuite : public TestSuite
+{
+  public:
+    BEgressQueueTestSuite();
+};
+
+BEgressQueueTestSuite::BEgressQueueTestSuite()
+    : TestSuite("broadcom-egress-queue", UNIT)
+{
+    AddTestCase(new BEgressQueueSchedulerTest, TestCase::QUICK);
+}
+
+static BEgressQueueTestSuite g_bEgressQueueTestSuite; //!< The testsuite
@@ -16,6 +16,7 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/feedback-tag.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/packet.h"
 #include "ns3/test.h"
@@ -1202,6 +1203,34 @@ PacketTagListTest::DoRun()
     ReplaceCheck(7);
 }
 
+{ // Replace with a tag that grows
+    std::cout << GetName() << "check replacing a tag that changes size" << std::endl;
+    PacketTagList ptl = ref;
+    FeedbackTag fb;
+    ptl.Add(fb); // before the first merge
+    for (uint32_t hop = 0; hop < 4; hop++)
+    {
+        fb.setTelemetryTxBytes(hop, 100 + hop);
+        fb.incrementHopCount();
+        ptl.Replace(fb);
+    }
+    PacketTagList mrg = ptl; // now at the merge
+    fb.setTelemetryTxBytes(4, 104);
+    fb.incrementHopCount();
+    mrg.Replace(fb);
+
+    FeedbackTag out;
+    NS_TEST_EXPECT_MSG_EQ(ptl.Peek(out), true, "grown tag missing");
+    NS_TEST_EXPECT_MSG_EQ(out.getHopCount(), 4, "grown tag hops");
+    NS_TEST_EXPECT_MSG_EQ(out.getFeedback(3).txBytes, 103, "grown tag last hop");
+    NS_TEST_EXPECT_MSG_EQ(mrg.Peek(out), true, "grown tag missing after merge");
+    NS_TEST_EXPECT_MSG_EQ(out.getHopCount(), 5, "grown tag hops after merge");
+    NS_TEST_EXPECT_MSG_EQ(out.getFeedback(4).txBytes, 104, "grown tag last hop after merge");
+    CheckRefList(ref, "grow orig");
+    CheckRefList(ptl, "grow copy");
+    CheckRefList(mrg, "grow merge");
+}
+
 { // Timing
     std::cout << GetName() << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max();
@@ -0,0 +1,215 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/flow-trace-file.h"
+#include "ns3/test.h"
+#include "ns3/topology-file.h"
+
+#include <fstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief A text flow trace converted to the binary format reads back sorted by start time
+ */
+class FlowTraceFileTestCase : public TestCase
+{
+  public:
+    FlowTraceFileTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+FlowTraceFileTestCase::FlowTraceFileTestCase()
+    : TestCase("Convert and read flow traces")
+{
+}
+
+void
+FlowTraceFileTestCase::DoRun()
+{
+    std::string text = CreateTempDirFilename("flow.txt");
+    std::string binary = CreateTempDirFilename("flow.bin");
+    {
+        std::ofstream out(text);
+        out << "5\n"
+            << "0 32 3 100 10000 2.0\n"
+            << "1 33 3 101 1000000000000 1.5\n"
+            << "2 34 2 65535 1 2.0\n"
+            << "70000 35 3 103 4000 1.000000001\n"
+            << "4 36 3 104 5000 3\n";
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(FlowTraceFile::IsBinary(text), false, "text trace taken as binary");
+    NS_TEST_ASSERT_MSG_EQ(FlowTraceFile::Convert(text, binary), true, "conversion failed");
+    NS_TEST_ASSERT_MSG_EQ(FlowTraceFile::IsBinary(binary), true, "binary trace not recognized");
+
+    // the text trace in file order
+    FlowTraceFile trace;
+    NS_TEST_ASSERT_MSG_EQ(trace.Open(text), true, "can't open the text trace");
+    NS_TEST_ASSERT_MSG_EQ(trace.GetN(), 5, "wrong number of flows");
+    std::vector<FlowTraceRecord> flows;
+    FlowTraceRecord r;
+    while (trace.Read(r))
+    {
+        flows.push_back(r);
+    }
+    NS_TEST_ASSERT_MSG_EQ(flows.size(), 5, "wrong number of flows read");
+    NS_TEST_ASSERT_MSG_EQ(flows[1].size, 1000000000000ULL, "64 bit size");
+    NS_TEST_ASSERT_MSG_EQ(flows[2].dport, 65535, "port");
+    NS_TEST_ASSERT_MSG_EQ(flows[3].src, 70000, "32 bit node");
+
+    // the binary trace by start time, ties in file order
+    NS_TEST_ASSERT_MSG_EQ(trace.Open(binary), true, "can't open the binary trace");
+    NS_TEST_ASSERT_MSG_EQ(trace.GetN(), 5, "wrong number of flows");
+    std::vector<uint32_t> order = {3, 1, 0, 2, 4};
+    for (uint32_t i : order)
+    {
+        NS_TEST_ASSERT_MSG_EQ(trace.Read(r), true, "flow missing");
+        const FlowTraceRecord& f = flows[i];
+        NS_TEST_ASSERT_MSG_EQ(r.src, f.src, "src of flow " << i);
+        NS_TEST_ASSERT_MSG_EQ(r.dst, f.dst, "dst of flow " << i);
+        NS_TEST_ASSERT_MSG_EQ(r.pg, f.pg, "pg of flow " << i);
+        NS_TEST_ASSERT_MSG_EQ(r.dport, f.dport, "dport of flow " << i);
+        NS_TEST_ASSERT_MSG_EQ(r.size, f.size, "size of flow " << i);
+        NS_TEST_ASSERT_MSG_EQ(r.startTime, f.startTime, "start of flow " << i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(trace.Read(r), false, "flow past the end");
+
+    // a truncated binary trace is rejected
+    std::string truncated = CreateTempDirFilename("truncated.bin");
+    {
+        std::ifstream in(binary, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(truncated, std::ios::binary);
+        out.write(content.data(), content.size() - 2);
+    }
+    NS_TEST_ASSERT_MSG_EQ(trace.Open(truncated), false, "truncated trace accepted");
+    NS_TEST_ASSERT_MSG_EQ(trace.Open(CreateTempDirFilename("missing")), false, "missing file");
+
+    // an empty trace
+    NS_TEST_ASSERT_MSG_EQ(FlowTraceFile::Write(binary, {}), true, "can't write an empty trace");
+    NS_TEST_ASSERT_MSG_EQ(trace.Open(binary), true, "can't open an empty trace");
+    NS_TEST_ASSERT_MSG_EQ(trace.Read(r), false, "flow in an empty trace");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief A text topology converted to the binary format reads back the same
+ */
+class TopologyFileTestCase : public TestCase
+{
+  public:
+    TopologyFileTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TopologyFileTestCase::TopologyFileTestCase()
+    : TestCase("Convert and read topologies")
+{
+}
+
+void
+TopologyFileTestCase::DoRun()
+{
+    std::string text = CreateTempDirFilename("topology.txt");
+    std::string binary = CreateTempDirFilename("topology.bin");
+    {
+        // Reverie's header: nodes switches tors links, then the link capacities
+        std::ofstream out(text);
+        out << "7 3 2 6 10 40\n"
+            << "4 5 6 \n"
+            << "0 4 10Gbps 1us 0\n"
+            << "1 4 10Gbps 1us 0\n"
+            << "2 5 10Gbps 1us 0\n"
+            << "3 5 10Gbps 1us 0.001\n"
+            << "4 6 40Gbps 0.5us 0\n"
+            << "5 6 40Gbps 1500ns 0\n";
+    }
+
+    TopologyFile topology;
+    NS_TEST_ASSERT_MSG_EQ(topology.Open(text), true, "can't read the text topology");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetNHeader(), 6, "header");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetNNodes(), 7, "nodes");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetNSwitches(), 3, "switches");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetNTors(), 2, "tors");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetHeader(5), 40, "extra header value");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetHeader(6), 0, "past the header");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetSwitches().size(), 3, "switch ids");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetLinks().size(), 6, "links");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetLinks()[4].rate, DataRate("40Gbps"), "rate");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetLinks()[4].delay, NanoSeconds(500), "delay");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetLinks()[3].errorRate, 0.001, "error rate");
+
+    NS_TEST_ASSERT_MSG_EQ(TopologyFile::Convert(text, binary), true, "conversion failed");
+    NS_TEST_ASSERT_MSG_EQ(TopologyFile::IsBinary(binary), true, "binary topology not recognized");
+    NS_TEST_ASSERT_MSG_EQ(TopologyFile::IsBinary(text), false, "text topology taken as binary");
+    TopologyFile copy;
+    NS_TEST_ASSERT_MSG_EQ(copy.Open(binary), true, "can't read the binary topology");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetNHeader(), topology.GetNHeader(), "header");
+    for (uint32_t i = 0; i < topology.GetNHeader(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(copy.GetHeader(i), topology.GetHeader(i), "header value " << i);
+    }
+    NS_TEST_ASSERT_MSG_EQ((copy.GetSwitches() == topology.GetSwitches()), true, "switch ids");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetLinks().size(), topology.GetLinks().size(), "links");
+    for (uint32_t i = 0; i < topology.GetLinks().size(); i++)
+    {
+        const TopologyLink& a = topology.GetLinks()[i];
+        const TopologyLink& b = copy.GetLinks()[i];
+        NS_TEST_ASSERT_MSG_EQ(b.src, a.src, "src of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(b.dst, a.dst, "dst of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(b.rate, a.rate, "rate of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(b.delay, a.delay, "delay of link " << i);
+        NS_TEST_ASSERT_MSG_EQ(b.errorRate, a.errorRate, "error rate of link " << i);
+    }
+
+    // a text topology with fewer links than announced is rejected
+    {
+        std::ofstream out(text);
+        out << "7 3 2 6\n4 5 6\n0 4 10Gbps 1us 0\n";
+    }
+    NS_TEST_ASSERT_MSG_EQ(topology.Open(text), false, "short topology accepted");
+    NS_TEST_ASSERT_MSG_EQ(topology.GetLinks().size(), 0, "links of a rejected topology");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief FlowTraceFile and TopologyFile TestSuite
+ */
+class TraceFileTestSuite : public TestSuite
+{
+  public:
+    TraceFileTestSuite();
+};
+
+TraceFileTestSuite::TraceFileTestSuite()
+    : TestSuite("trace-file", UNIT)
+{
+    AddTestCase(new FlowTraceFileTestCase, TestCase::QUICK);
+    AddTestCase(new TopologyFileTestCase, TestCase::QUICK);
+}
+
+static TraceFileTestSuite traceFileTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,16 @@ namespace ns3 {
 				DoubleValue(1000.0 * 1024 * 1024),
 				MakeDoubleAccessor(&BEgressQueue::m_maxBytes),
 				MakeDoubleChecker<double>())
+			.AddAttribute("StrictPriorityClasses",
+				"Bitmap of the classes served in strict priority, lowest class first. The other classes share the rest by DWRR. Class 0 is always strict.",
+				UintegerValue(0xff),
+				MakeUintegerAccessor(&BEgressQueue::m_strictClasses),
+				MakeUintegerChecker<uint32_t>())
+			.AddAttribute("Quantum",
+				"DWRR quantum in bytes of the classes without one set by SetQuantum. Dequeue is O(1) while it is at least the largest packet.",
+				UintegerValue(1500),
+				MakeUintegerAccessor(&BEgressQueue::m_defaultQuantum),
+				MakeUintegerChecker<uint32_t>(1))
 			;
 
 		return tid;
@@ -54,6 +64,14 @@ namespace ns3 {
 		m_bytesInQueueTotal = 0;
 		m_rxBytes= 0;
 		m_rrlast = 0;
+		m_qlast = 0;
+		m_ready = 0;
+		numTxBytes = 0;
+		for (uint32_t i = 0; i < qCnt; i++)
+		{
+			m_quantum[i] = 0;
+			m_deficit[i] = 0;
+		}
 		for (uint32_t i = 0; i < fCnt; i++)
 		{
 			m_bytesInQueue[i] = 0;
@@ -85,6 +103,8 @@ namespace ns3 {
 				m_bytesInQueueTotal += p->GetSize();
 				m_bytesInQueue[qIndex] += p->GetSize();
 				m_rxBytes+= p->GetSize();
+				if (qIndex < qCnt)
+					m_ready |= 1u << qIndex;
 			}
 			else
 			{
@@ -106,50 +126,76 @@ namespace ns3 {
 			NS_LOG_LOGIC("Queue empty");
 			return 0;
 		}
-		bool found = false;
-		uint32_t qIndex;
+		// classes with packets that may send; class 0 ignores PFC
+		uint32_t open = m_ready & 1;
+		for (uint32_t i = 1; i < qCnt; i++)
+		{
+			if (!paused[i])
+				open |= m_ready & (1u << i);
+		}
+		if (open == 0)
+		{
+			NS_LOG_LOGIC("Nothing can be sent");
+			return 0;
+		}
+		uint32_t strict = open & (m_strictClasses | 1);
+		uint32_t qIndex = strict ? __builtin_ctz(strict) : NextDwrr(open & ~strict);
 
-		if (m_queues[0]->GetNPackets() > 0) //0 is the highest priority
+		Ptr<Packet> p = m_queues[qIndex]->Dequeue();
+		m_traceBeqDequeue(p, qIndex);
+		m_bytesInQueueTotal -= p->GetSize();
+		m_bytesInQueue[qIndex] -= p->GetSize();
+		if (m_queues[qIndex]->GetNPackets() == 0)
 		{
-			found = true;
-			qIndex = 0;
+			m_ready &= ~(1u << qIndex);
+			m_deficit[qIndex] = 0; // an idle class does not keep its deficit
 		}
-		else
+		else if (!strict)
 		{
-			if (!found)
-			{
-				for (qIndex = 1; qIndex <= qCnt; qIndex++)
-				{
-					m_rrlast = 0;
-					if (!paused[(qIndex + m_rrlast) % qCnt] && m_queues[(qIndex + m_rrlast) % qCnt]->GetNPackets() > 0)  //round robin
-					{
-						found = true;
-						break;
-					}
-				}
-				qIndex = (qIndex + m_rrlast) % qCnt;
-			}
+			m_deficit[qIndex] -= p->GetSize();
 		}
-		if (found)
+		m_qlast = qIndex;
+		NS_LOG_LOGIC("Popped " << p);
+		NS_LOG_LOGIC("Number bytes " << m_bytesInQueueTotal);
+		// vamsi
+		numTxBytes+=p->GetSize();
+//		std::cout << "numBytes" << numTxBytes << std::endl;
+		return p;
+	}
+
+	uint32_t
+		BEgressQueue::NextDwrr(uint32_t open)
+	{
+		uint32_t c = m_rrlast;
+		if (((open >> c) & 1) && m_deficit[c] >= m_queues[c]->Peek()->GetSize())
+		{
+			return c; // the class in service keeps the link while its deficit lasts
+		}
+		while (true)
 		{
-			Ptr<Packet> p = m_queues[qIndex]->Dequeue();
-			m_traceBeqDequeue(p, qIndex);
-			m_bytesInQueueTotal -= p->GetSize();
-			m_bytesInQueue[qIndex] -= p->GetSize();
-			if (qIndex != 0)
+			// next open class after c, wrapping around
+			uint32_t after = open & ~((2u << c) - 1);
+			c = __builtin_ctz(after ? after : open);
+			m_deficit[c] += GetQuantum(c);
+			if (m_deficit[c] >= m_queues[c]->Peek()->GetSize())
 			{
-				m_rrlast = qIndex;
+				m_rrlast = c;
+				return c;
 			}
-			m_qlast = qIndex;
-			NS_LOG_LOGIC("Popped " << p);
-			NS_LOG_LOGIC("Number bytes " << m_bytesInQueueTotal);
-			// vamsi
-			numTxBytes+=p->GetSize();
-//			std::cout << "numBytes" << numTxBytes << std::endl;
-			return p;
 		}
-		NS_LOG_LOGIC("Nothing can be sent");
-		return 0;
+	}
+
+	void
+		BEgressQueue::SetQuantum(uint32_t qIndex, uint32_t quantum)
+	{
+		NS_ASSERT(qIndex < qCnt);
+		m_quantum[qIndex] = quantum;
+	}
+
+	uint32_t
+		BEgressQueue::GetQuantum(uint32_t qIndex) const
+	{
+		return m_quantum[qIndex] ? m_quantum[qIndex] : m_defaultQuantum;
 	}
 
 	bool
@@ -205,6 +251,7 @@ namespace ns3 {
 			m_bytesInQueueTotal += p->GetSize();
 			m_bytesInQueue[qIndex] += p->GetSize();
 			m_rxBytes+= p->GetSize();
+			m_ready |= 1u << qIndex;
 		}
 		else
 		{
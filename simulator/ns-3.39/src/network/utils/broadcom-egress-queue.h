@@ -45,6 +45,10 @@ namespace ns3 {
 
 		uint32_t GetLastQueue();
 
+		// DWRR share of class qIndex in bytes per round, 0 for the Quantum attribute
+		void SetQuantum(uint32_t qIndex, uint32_t quantum);
+		uint32_t GetQuantum(uint32_t qIndex) const;
+
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqEnqueue;
 		TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqDequeue;
 
@@ -61,6 +65,8 @@ namespace ns3 {
 	private:
 		bool DoEnqueue(Ptr<Packet> p, uint32_t qIndex);
 		Ptr<Packet> DoDequeueRR(bool paused[]);
+		// the class after m_rrlast whose deficit covers its head packet, out of the classes in open
+		uint32_t NextDwrr(uint32_t open);
 		//for compatibility
 		virtual bool DoEnqueue(Ptr<Packet> p);
 		virtual Ptr<Packet> DoDequeue(void);
@@ -69,8 +75,13 @@ namespace ns3 {
 		uint32_t m_bytesInQueue[fCnt];
 		uint32_t m_bytesInQueueTotal;
 		uint64_t m_rxBytes;
-		uint32_t m_rrlast;
+		uint32_t m_rrlast; // DWRR class in service
 		uint32_t m_qlast;
+		uint32_t m_strictClasses; // bit i set: class i is served before the DWRR classes, lowest first
+		uint32_t m_defaultQuantum;
+		uint32_t m_quantum[qCnt];
+		uint32_t m_deficit[qCnt];
+		uint32_t m_ready; // bit i set: class i has packets
 		std::vector<Ptr<Queue<Packet>> > m_queues; // uc queues
 		// vamsi
 		uint64_t numTxBytes; // for throughput calculations
@@ -95,7 +95,7 @@ uint32_t CustomHeader::GetSerializedSize (void) const{
 		else if (l3Prot == 0x11) // UDP
 			len += GetUdpHeaderSize();
 		else if (l3Prot == 0xFC || l3Prot == 0xFD)
-			len += GetAckSerializedSize();
+			len += GetAckSerializedSize() + (((ack.flags >> 1) & 1) ? sizeof(ack.sack) : 0);
 		else if (l3Prot == 0xFF)
 			len += 8;
 		else if (l3Prot == 0xFE)
@@ -175,6 +175,10 @@ void CustomHeader::Serialize (Buffer::Iterator start) const{
 		  i.WriteU16(ack.pg);
 		  i.WriteU32(ack.seq);
 		  udp.ih.Serialize(i);
+		  if ((ack.flags >> 1) & 1){ // qbbHeader::FLAG_SACK
+			  i.Next(IntHeader::GetStaticSize());
+			  i.WriteU32(ack.sack);
+		  }
 	  }else if (l3Prot == 0xFE){ // PFC
 		  i.WriteU32 (pfc.time);
 		  i.WriteU32 (pfc.qlen);
@@ -313,6 +317,11 @@ CustomHeader::Deserialize (Buffer::Iterator start)
 		  if (getInt)
 			  ack.ih.Deserialize(i);
 		  l4Size = GetAckSerializedSize();
+		  if ((ack.flags >> 1) & 1){ // qbbHeader::FLAG_SACK
+			  i.Next(IntHeader::GetStaticSize());
+			  ack.sack = i.ReadU32();
+			  l4Size += sizeof(ack.sack);
+		  }
 	  }else if (l3Prot == 0xFE){ // PFC
 		  pfc.time = i.ReadU32 ();
 		  pfc.qlen = i.ReadU32 ();
@@ -328,6 +337,18 @@ uint8_t CustomHeader::GetIpv4EcnBits (void) const{
 	return m_tos & 0x3;
 }
 
+uint32_t CustomHeader::GetL4Ports (void) const{
+	if (!(headerType & L4_Header))
+		return 0;
+	if (l3Prot == 0x6) // TCP
+		return tcp.sport | ((uint32_t)tcp.dport << 16);
+	else if (l3Prot == 0x11) // UDP
+		return udp.sport | ((uint32_t)udp.dport << 16);
+	else if (l3Prot == 0xFC || l3Prot == 0xFD) // ACK or NACK
+		return ack.sport | ((uint32_t)ack.dport << 16);
+	return 0;
+}
+
 uint32_t CustomHeader::GetAckSerializedSize(void){
 	return sizeof(ack.sport) + sizeof(ack.dport) + sizeof(ack.flags) + sizeof(ack.pg) + sizeof(ack.seq) + IntHeader::GetStaticSize();
 }
@@ -124,6 +124,7 @@ public:
 		  uint16_t pg;
 		  uint32_t seq; // the qbb sequence number.
 		  IntHeader ih;
+		  uint32_t sack; // selective repeat NACK only, see qbbHeader::FLAG_SACK
 	  } ack;
 	  // PauseHeader
 	  struct {
@@ -134,6 +135,11 @@ public:
   };
 
   uint8_t GetIpv4EcnBits (void) const;
+  /**
+   * \brief L4 ports of TCP, UDP and ACK/NACK packets, as used for flow hashing
+   * \return sport | dport << 16, or 0 if the packet has no ports or L4 was not parsed
+   */
+  uint32_t GetL4Ports (void) const;
   static uint32_t GetAckSerializedSize(void);
   static uint32_t GetUdpHeaderSize(void); // include udp, seqTs, INT
   static uint32_t GetStaticWholeHeaderSize(void); // ppp + ip + udp + int
@@ -35,7 +35,7 @@ uint32_t
 FeedbackTag::GetSerializedSize (void) const
 {
 //  return 1;
-  return max_hops*sizeof(telemetry)+1+1+8; // max_hops number of telemetry structures + 1 (for max_hops) and +1 (for n_hops) + 8 (timstamp)
+  return n_hops*HOP_SIZE+1+1+8; // n_hops number of telemetry structures + 1 (for max_hops) and +1 (for n_hops) + 8 (timstamp)
 }
 void
 FeedbackTag::Serialize (TagBuffer i) const
@@ -53,7 +53,7 @@ FeedbackTag::Serialize (TagBuffer i) const
 //	  uint32_t qlenDeq;
 //  };
 
-  for (uint32_t x=0; x < max_hops; x++){
+  for (uint32_t x=0; x < n_hops; x++){
 	  i.WriteU64(Feedback[x].bandwidth);
 	  i.WriteU64(Feedback[x].tsEnq);
 	  i.WriteU64(Feedback[x].tsDeq);
@@ -69,7 +69,8 @@ FeedbackTag::Deserialize (TagBuffer i)
 	n_hops = i.ReadU8();
 	sent_timestamp = i.ReadU64();
 
-	for (uint32_t x =0 ; x < max_hops;x++){
+	NS_ASSERT_MSG (n_hops <= 16, "FeedbackTag: more hops than telemetry slots");
+	for (uint32_t x =0 ; x < n_hops;x++){
 		Feedback[x].bandwidth = i.ReadU64();
 		Feedback[x].tsEnq =   i.ReadU64();
 		Feedback[x].tsDeq =   i.ReadU64();
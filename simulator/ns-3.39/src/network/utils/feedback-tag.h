@@ -39,8 +39,8 @@ public:
   };
 
   void incrementHopCount(){n_hops++;}
-  uint32_t getHopCount(){return n_hops;}
-  uint32_t getMaxHops(){return max_hops;}
+  uint32_t getHopCount() const {return n_hops;}
+  uint32_t getMaxHops() const {return max_hops;}
   void setMaxHops(uint32_t n){max_hops=n;}
   void pushTelemetry(FeedbackTag::telemetry t){Feedback[n_hops] = t ;} /* Here the assumption is that, before a node pushes feedback info, it first increments n_hops value. Be careful with this. */
   void setTelemetryBw(uint32_t hop, uint64_t bw){Feedback[hop].bandwidth = bw;}
@@ -50,16 +50,20 @@ public:
   void setTelemetryQlenDeq(uint32_t hop, uint32_t val){Feedback[hop].qlenDeq = val;}
   void setTelemetryTxBytes(uint32_t hop, uint64_t val){Feedback[hop].txBytes = val;}
 
-  FeedbackTag::telemetry getFeedback(uint32_t i){return Feedback[i];}
+  const FeedbackTag::telemetry& getFeedback(uint32_t i) const {return Feedback[i];}
 
   void setPktTimestamp(uint64_t ts){sent_timestamp = ts;}
-  uint64_t getPktTimestamp(){return sent_timestamp;}
+  uint64_t getPktTimestamp() const {return sent_timestamp;}
+
+  /* Bytes of one hop on the wire. Only the n_hops hops filled so far are serialized, so the tag
+   * grows by this much at every dequeue instead of always carrying the 16 slots. */
+  static const uint32_t HOP_SIZE = 8+8+8+4+4+8;
 
 private:
   uint8_t max_hops=16; // This is hardcoded for now. Sorry!
   uint8_t n_hops=0;
   uint64_t sent_timestamp=0;
-  FeedbackTag::telemetry Feedback[16]; // size of 16 is hardcoded for now. Sorry!
+  FeedbackTag::telemetry Feedback[16] = {}; // size of 16 is hardcoded for now. Sorry!
 //  std::vector<FeedbackTag::telemetry> Feedback;
 };
 
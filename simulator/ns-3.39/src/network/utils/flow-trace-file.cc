@@ -0,0 +1,246 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-trace-file.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowTraceFile");
+
+namespace
+{
+
+const char FLOW_TRACE_MAGIC[8] = {'N', 'S', '3', 'F', 'L', 'O', 'W', 'S'}; //!< first bytes
+const uint32_t FLOW_TRACE_VERSION = 1;                                   //!< format version
+const uint64_t FLOW_TRACE_HEADER = 24;                                   //!< bytes before the columns
+const uint64_t FLOW_TRACE_RECORD = 28;                                   //!< bytes per flow
+
+/**
+ * \brief Write a column of a binary trace
+ * \param out the trace
+ * \param column the values
+ */
+template <typename T>
+void
+WriteColumn(std::ofstream& out, const std::vector<T>& column)
+{
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+} // namespace
+
+FlowTraceFile::FlowTraceFile()
+    : m_binary(false),
+      m_n(0),
+      m_next(0),
+      m_start(nullptr),
+      m_size(nullptr),
+      m_src(nullptr),
+      m_dst(nullptr),
+      m_pg(nullptr),
+      m_dport(nullptr)
+{
+}
+
+bool
+FlowTraceFile::Open(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    Close();
+    if (IsBinary(fileName))
+    {
+        if (!m_file.Open(fileName))
+        {
+            return false;
+        }
+        const uint8_t* data = m_file.GetData();
+        uint32_t version;
+        std::memcpy(&version, data + 8, sizeof(version));
+        std::memcpy(&m_n, data + 16, sizeof(m_n));
+        if (version != FLOW_TRACE_VERSION ||
+            m_file.GetSize() != FLOW_TRACE_HEADER + m_n * FLOW_TRACE_RECORD)
+        {
+            NS_LOG_WARN("Bad binary flow trace " << fileName);
+            Close();
+            return false;
+        }
+        const uint8_t* column = data + FLOW_TRACE_HEADER;
+        m_start = reinterpret_cast<const double*>(column);
+        column += m_n * sizeof(double);
+        m_size = reinterpret_cast<const uint64_t*>(column);
+        column += m_n * sizeof(uint64_t);
+        m_src = reinterpret_cast<const uint32_t*>(column);
+        column += m_n * sizeof(uint32_t);
+        m_dst = reinterpret_cast<const uint32_t*>(column);
+        column += m_n * sizeof(uint32_t);
+        m_pg = reinterpret_cast<const uint16_t*>(column);
+        column += m_n * sizeof(uint16_t);
+        m_dport = reinterpret_cast<const uint16_t*>(column);
+        m_binary = true;
+        return true;
+    }
+    m_text.open(fileName);
+    if (!m_text.is_open() || !(m_text >> m_n))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void
+FlowTraceFile::Close()
+{
+    NS_LOG_FUNCTION(this);
+    m_file.Close();
+    if (m_text.is_open())
+    {
+        m_text.close();
+    }
+    m_text.clear();
+    m_binary = false;
+    m_n = 0;
+    m_next = 0;
+    m_start = nullptr;
+    m_size = nullptr;
+    m_src = nullptr;
+    m_dst = nullptr;
+    m_pg = nullptr;
+    m_dport = nullptr;
+}
+
+uint64_t
+FlowTraceFile::GetN() const
+{
+    return m_n;
+}
+
+bool
+FlowTraceFile::Read(FlowTraceRecord& record)
+{
+    if (m_next >= m_n)
+    {
+        return false;
+    }
+    if (m_binary)
+    {
+        record.src = m_src[m_next];
+        record.dst = m_dst[m_next];
+        record.pg = m_pg[m_next];
+        record.dport = m_dport[m_next];
+        record.size = m_size[m_next];
+        record.startTime = m_start[m_next];
+    }
+    else
+    {
+        uint64_t src;
+        uint64_t dst;
+        uint64_t pg;
+        uint64_t dport;
+        if (!(m_text >> src >> dst >> pg >> dport >> record.size >> record.startTime))
+        {
+            NS_LOG_WARN("Flow trace ends after " << m_next << " of " << m_n << " flows");
+            m_n = m_next;
+            return false;
+        }
+        record.src = src;
+        record.dst = dst;
+        record.pg = pg;
+        record.dport = dport;
+    }
+    m_next++;
+    return true;
+}
+
+bool
+FlowTraceFile::IsBinary(const std::string& fileName)
+{
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[sizeof(FLOW_TRACE_MAGIC)];
+    return in.read(magic, sizeof(magic)) &&
+           std::memcmp(magic, FLOW_TRACE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool
+FlowTraceFile::Write(const std::string& fileName, std::vector<FlowTraceRecord> records)
+{
+    NS_LOG_FUNCTION(fileName << records.size());
+    // stable, so that flows starting together keep the order of the text trace
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](const FlowTraceRecord& a, const FlowTraceRecord& b) {
+                         return a.startTime < b.startTime;
+                     });
+    uint64_t n = records.size();
+    std::vector<double> start(n);
+    std::vector<uint64_t> size(n);
+    std::vector<uint32_t> src(n);
+    std::vector<uint32_t> dst(n);
+    std::vector<uint16_t> pg(n);
+    std::vector<uint16_t> dport(n);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        start[i] = records[i].startTime;
+        size[i] = records[i].size;
+        src[i] = records[i].src;
+        dst[i] = records[i].dst;
+        pg[i] = records[i].pg;
+        dport[i] = records[i].dport;
+    }
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+    uint32_t reserved = 0;
+    out.write(FLOW_TRACE_MAGIC, sizeof(FLOW_TRACE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&FLOW_TRACE_VERSION), sizeof(FLOW_TRACE_VERSION));
+    out.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    WriteColumn(out, start);
+    WriteColumn(out, size);
+    WriteColumn(out, src);
+    WriteColumn(out, dst);
+    WriteColumn(out, pg);
+    WriteColumn(out, dport);
+    return bool(out);
+}
+
+bool
+FlowTraceFile::Convert(const std::string& textFileName, const std::string& binaryFileName)
+{
+    NS_LOG_FUNCTION(textFileName << binaryFileName);
+    FlowTraceFile text;
+    if (!text.Open(textFileName))
+    {
+        return false;
+    }
+    std::vector<FlowTraceRecord> records;
+    records.reserve(text.GetN());
+    FlowTraceRecord record;
+    while (text.Read(record))
+    {
+        records.push_back(record);
+    }
+    return Write(binaryFileName, std::move(records));
+}
+
+} // namespace ns3
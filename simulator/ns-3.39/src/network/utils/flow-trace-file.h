@@ -0,0 +1,132 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_TRACE_FILE_H
+#define FLOW_TRACE_FILE_H
+
+#include "mapped-file.h"
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief A flow of a flow trace, a "src dst pg dport size start_time" line of flow.txt
+ */
+struct FlowTraceRecord
+{
+    uint32_t src;     //!< sending node
+    uint32_t dst;     //!< receiving node
+    uint16_t pg;      //!< priority group
+    uint16_t dport;   //!< destination port
+    uint64_t size;    //!< bytes
+    double startTime; //!< seconds
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief A flow trace, read one flow at a time
+ *
+ * The text format is the flow.txt of the datacenter examples: the number of flows, then one
+ * "src dst pg dport size start_time" line per flow. The binary format holds the same flows
+ * sorted by start time, column after column in host byte order:
+ *
+ * \verbatim
+   char     magic[8]            "NS3FLOWS"
+   uint32_t version             1
+   uint32_t reserved            0
+   uint64_t n                   number of flows
+   double   startTime[n]
+   uint64_t size[n]
+   uint32_t src[n]
+   uint32_t dst[n]
+   uint16_t pg[n]
+   uint16_t dport[n]
+   \endverbatim
+ *
+ * A binary trace is mapped in memory: opening it reads nothing, and a flow costs a few loads
+ * instead of the parsing of a line. Open picks the format from the first bytes of the file.
+ */
+class FlowTraceFile
+{
+  public:
+    FlowTraceFile();
+
+    /**
+     * \brief Open a text or binary trace, closing the previous one
+     * \param fileName the trace
+     * \return false if the file can't be opened or is not a valid trace
+     */
+    bool Open(const std::string& fileName);
+
+    /// Close the trace
+    void Close();
+
+    /// \return the number of flows of the trace
+    uint64_t GetN() const;
+
+    /**
+     * \brief Read the next flow, in the order of the file
+     * \param record the flow read
+     * \return false after the last flow
+     */
+    bool Read(FlowTraceRecord& record);
+
+    /**
+     * \param fileName a file
+     * \return whether the file is a binary flow trace
+     */
+    static bool IsBinary(const std::string& fileName);
+
+    /**
+     * \brief Write a binary trace
+     * \param fileName the trace
+     * \param records the flows, in any order
+     * \return false if the file can't be written
+     */
+    static bool Write(const std::string& fileName, std::vector<FlowTraceRecord> records);
+
+    /**
+     * \brief Convert a trace to the binary format
+     * \param textFileName the text trace
+     * \param binaryFileName the binary trace
+     * \return false if a file can't be read or written
+     */
+    static bool Convert(const std::string& textFileName, const std::string& binaryFileName);
+
+  private:
+    MappedFile m_file;       //!< the binary trace
+    std::ifstream m_text;    //!< the text trace
+    bool m_binary;           //!< whether the trace is binary
+    uint64_t m_n;            //!< number of flows
+    uint64_t m_next;         //!< index of the next flow
+    const double* m_start;   //!< start time column
+    const uint64_t* m_size;  //!< size column
+    const uint32_t* m_src;   //!< source column
+    const uint32_t* m_dst;   //!< destination column
+    const uint16_t* m_pg;    //!< priority group column
+    const uint16_t* m_dport; //!< destination port column
+};
+
+} // namespace ns3
+
+#endif /* FLOW_TRACE_FILE_H */
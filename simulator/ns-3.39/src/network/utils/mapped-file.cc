@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mapped-file.h"
+
+#include "ns3/log.h"
+
+#ifdef __WIN32__
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MappedFile");
+
+MappedFile::MappedFile()
+    : m_data(nullptr),
+      m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool
+MappedFile::Open(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    Close();
+#ifdef __WIN32__
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    m_copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+    return true;
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_size = st.st_size;
+    if (m_size == 0)
+    {
+        // mmap rejects empty mappings
+        close(fd);
+        m_data = m_copy.data();
+        return true;
+    }
+    void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        m_size = 0;
+        return false;
+    }
+    // traces are read front to back
+    madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(p);
+    return true;
+#endif
+}
+
+void
+MappedFile::Close()
+{
+    NS_LOG_FUNCTION(this);
+#ifndef __WIN32__
+    if (m_data && m_size > 0)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_copy.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const uint8_t*
+MappedFile::GetData() const
+{
+    return m_data;
+}
+
+uint64_t
+MappedFile::GetSize() const
+{
+    return m_size;
+}
+
+} // namespace ns3
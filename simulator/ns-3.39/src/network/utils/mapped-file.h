@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief A read-only file mapped in memory
+ *
+ * The pages of the file are loaded by the kernel as they are touched, and dropped under memory
+ * pressure, so reading a large trace costs neither a copy nor its size in resident memory.
+ * Where mmap is not available the file is read into a buffer instead.
+ */
+class MappedFile
+{
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * \brief Map a file, unmapping the previous one
+     * \param fileName the file
+     * \return false if the file can't be opened or mapped
+     */
+    bool Open(const std::string& fileName);
+
+    /// Unmap the file
+    void Close();
+
+    /// \return the first byte of the file, nullptr when no file is mapped
+    const uint8_t* GetData() const;
+
+    /// \return the size of the file in bytes
+    uint64_t GetSize() const;
+
+  private:
+    const uint8_t* m_data;       //!< the mapping
+    uint64_t m_size;             //!< size of the file
+    std::vector<uint8_t> m_copy; //!< the content of the file where mmap is not available
+};
+
+} // namespace ns3
+
+#endif /* MAPPED_FILE_H */
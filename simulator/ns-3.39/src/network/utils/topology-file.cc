@@ -0,0 +1,252 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-file.h"
+
+#include "mapped-file.h"
+
+#include "ns3/log.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TopologyFile");
+
+namespace
+{
+
+const char TOPOLOGY_MAGIC[8] = {'N', 'S', '3', 'T', 'O', 'P', 'O', 'L'}; //!< first bytes
+const uint32_t TOPOLOGY_VERSION = 1;                                  //!< format version
+
+} // namespace
+
+TopologyFile::TopologyFile()
+{
+}
+
+bool
+TopologyFile::Open(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    m_header.clear();
+    m_switches.clear();
+    m_links.clear();
+    bool ok = IsBinary(fileName) ? ReadBinary(fileName) : ReadText(fileName);
+    if (!ok)
+    {
+        NS_LOG_WARN("Bad topology " << fileName);
+        m_header.clear();
+        m_switches.clear();
+        m_links.clear();
+    }
+    return ok;
+}
+
+bool
+TopologyFile::ReadText(const std::string& fileName)
+{
+    std::ifstream in(fileName);
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line))
+    {
+        return false;
+    }
+    std::istringstream first(line);
+    uint64_t value;
+    while (first >> value)
+    {
+        m_header.push_back(value);
+    }
+    if (m_header.size() < 4)
+    {
+        return false;
+    }
+    m_switches.resize(GetHeader(1));
+    for (auto& id : m_switches)
+    {
+        if (!(in >> id))
+        {
+            return false;
+        }
+    }
+    m_links.resize(GetHeader(3));
+    for (auto& link : m_links)
+    {
+        std::string rate;
+        std::string delay;
+        if (!(in >> link.src >> link.dst >> rate >> delay >> link.errorRate))
+        {
+            return false;
+        }
+        link.rate = DataRate(rate);
+        link.delay = Time(delay);
+    }
+    return true;
+}
+
+bool
+TopologyFile::ReadBinary(const std::string& fileName)
+{
+    MappedFile file;
+    if (!file.Open(fileName) || file.GetSize() < 16)
+    {
+        return false;
+    }
+    const uint8_t* data = file.GetData();
+    uint32_t version;
+    uint32_t nHeader;
+    std::memcpy(&version, data + 8, sizeof(version));
+    std::memcpy(&nHeader, data + 12, sizeof(nHeader));
+    if (version != TOPOLOGY_VERSION || nHeader < 4 ||
+        file.GetSize() < 16 + uint64_t(nHeader) * sizeof(uint64_t))
+    {
+        return false;
+    }
+    m_header.resize(nHeader);
+    std::memcpy(m_header.data(), data + 16, nHeader * sizeof(uint64_t));
+    uint64_t nSwitches = GetHeader(1);
+    uint64_t nLinks = GetHeader(3);
+    uint64_t offset = 16 + nHeader * sizeof(uint64_t);
+    if (file.GetSize() != offset + nSwitches * 4 + nLinks * 32)
+    {
+        return false;
+    }
+    std::vector<uint64_t> rate(nLinks);
+    std::vector<int64_t> delay(nLinks);
+    std::vector<double> errorRate(nLinks);
+    std::vector<uint32_t> src(nLinks);
+    std::vector<uint32_t> dst(nLinks);
+    m_switches.resize(nSwitches);
+    auto column = [data, &offset](void* to, uint64_t bytes) {
+        if (bytes > 0)
+        {
+            std::memcpy(to, data + offset, bytes);
+        }
+        offset += bytes;
+    };
+    column(rate.data(), nLinks * sizeof(uint64_t));
+    column(delay.data(), nLinks * sizeof(int64_t));
+    column(errorRate.data(), nLinks * sizeof(double));
+    column(m_switches.data(), nSwitches * sizeof(uint32_t));
+    column(src.data(), nLinks * sizeof(uint32_t));
+    column(dst.data(), nLinks * sizeof(uint32_t));
+    m_links.resize(nLinks);
+    for (uint64_t i = 0; i < nLinks; i++)
+    {
+        m_links[i] = {src[i], dst[i], DataRate(rate[i]), PicoSeconds(delay[i]), errorRate[i]};
+    }
+    return true;
+}
+
+bool
+TopologyFile::Write(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+    uint32_t nHeader = m_header.size();
+    std::vector<uint64_t> rate;
+    std::vector<int64_t> delay;
+    std::vector<double> errorRate;
+    std::vector<uint32_t> src;
+    std::vector<uint32_t> dst;
+    for (const auto& link : m_links)
+    {
+        rate.push_back(link.rate.GetBitRate());
+        delay.push_back(link.delay.GetPicoSeconds());
+        errorRate.push_back(link.errorRate);
+        src.push_back(link.src);
+        dst.push_back(link.dst);
+    }
+    out.write(TOPOLOGY_MAGIC, sizeof(TOPOLOGY_MAGIC));
+    out.write(reinterpret_cast<const char*>(&TOPOLOGY_VERSION), sizeof(TOPOLOGY_VERSION));
+    out.write(reinterpret_cast<const char*>(&nHeader), sizeof(nHeader));
+    out.write(reinterpret_cast<const char*>(m_header.data()), nHeader * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(rate.data()), rate.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(delay.data()), delay.size() * sizeof(int64_t));
+    out.write(reinterpret_cast<const char*>(errorRate.data()), errorRate.size() * sizeof(double));
+    out.write(reinterpret_cast<const char*>(m_switches.data()),
+              m_switches.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(src.data()), src.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(dst.data()), dst.size() * sizeof(uint32_t));
+    return bool(out);
+}
+
+uint32_t
+TopologyFile::GetNHeader() const
+{
+    return m_header.size();
+}
+
+uint64_t
+TopologyFile::GetHeader(uint32_t i) const
+{
+    return i < m_header.size() ? m_header[i] : 0;
+}
+
+uint32_t
+TopologyFile::GetNNodes() const
+{
+    return GetHeader(0);
+}
+
+uint32_t
+TopologyFile::GetNSwitches() const
+{
+    return GetHeader(1);
+}
+
+uint32_t
+TopologyFile::GetNTors() const
+{
+    return GetHeader(2);
+}
+
+const std::vector<uint32_t>&
+TopologyFile::GetSwitches() const
+{
+    return m_switches;
+}
+
+const std::vector<TopologyLink>&
+TopologyFile::GetLinks() const
+{
+    return m_links;
+}
+
+bool
+TopologyFile::IsBinary(const std::string& fileName)
+{
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[sizeof(TOPOLOGY_MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, TOPOLOGY_MAGIC, sizeof(magic)) == 0;
+}
+
+bool
+TopologyFile::Convert(const std::string& textFileName, const std::string& binaryFileName)
+{
+    NS_LOG_FUNCTION(textFileName << binaryFileName);
+    TopologyFile topology;
+    return topology.Open(textFileName) && topology.Write(binaryFileName);
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TOPOLOGY_FILE_H
+#define TOPOLOGY_FILE_H
+
+#include "data-rate.h"
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief A link of a topology, a "src dst rate delay error_rate" line of topology.txt
+ */
+struct TopologyLink
+{
+    uint32_t src;     //!< one end
+    uint32_t dst;     //!< the other end
+    DataRate rate;    //!< data rate
+    Time delay;       //!< propagation delay
+    double errorRate; //!< packet error rate
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief The topology of a datacenter example: a header, the switches and the links
+ *
+ * The text format is the topology.txt of the datacenter examples. Its first line is the header,
+ * "nodes switches tors links" followed by whatever else the example needs, e.g. the link
+ * capacities of Reverie. Then come the ids of the switches, then one
+ * "src dst rate delay error_rate" line per link, e.g. "0 128 100Gbps 1us 0". The binary format
+ * holds the same, with rates and delays already parsed, in host byte order:
+ *
+ * \verbatim
+   char     magic[8]            "NS3TOPOL"
+   uint32_t version             1
+   uint32_t h                   number of header values
+   uint64_t header[h]
+   uint64_t rate[links]         bit/s
+   int64_t  delay[links]        ps
+   double   errorRate[links]
+   uint32_t switch[switches]
+   uint32_t src[links]
+   uint32_t dst[links]
+   \endverbatim
+ *
+ * Open picks the format from the first bytes of the file.
+ */
+class TopologyFile
+{
+  public:
+    TopologyFile();
+
+    /**
+     * \brief Read a text or binary topology
+     * \param fileName the topology
+     * \return false if the file can't be opened or is not a valid topology
+     */
+    bool Open(const std::string& fileName);
+
+    /**
+     * \brief Write the topology in the binary format
+     * \param fileName the file
+     * \return false if the file can't be written
+     */
+    bool Write(const std::string& fileName) const;
+
+    /// \return the number of values of the first line
+    uint32_t GetNHeader() const;
+
+    /**
+     * \param i index of a value of the first line
+     * \return the value, 0 past the end of the line
+     */
+    uint64_t GetHeader(uint32_t i) const;
+
+    /// \return the number of nodes, hosts and switches
+    uint32_t GetNNodes() const;
+
+    /// \return the number of switches
+    uint32_t GetNSwitches() const;
+
+    /// \return the number of top of rack switches
+    uint32_t GetNTors() const;
+
+    /// \return the ids of the switches, the top of rack switches first
+    const std::vector<uint32_t>& GetSwitches() const;
+
+    /// \return the links
+    const std::vector<TopologyLink>& GetLinks() const;
+
+    /**
+     * \param fileName a file
+     * \return whether the file is a binary topology
+     */
+    static bool IsBinary(const std::string& fileName);
+
+    /**
+     * \brief Convert a topology to the binary format
+     * \param textFileName the text topology
+     * \param binaryFileName the binary topology
+     * \return false if a file can't be read or written
+     */
+    static bool Convert(const std::string& textFileName, const std::string& binaryFileName);
+
+  private:
+    /**
+     * \param fileName a text topology
+     * \return false if the file can't be read
+     */
+    bool ReadText(const std::string& fileName);
+
+    /**
+     * \param fileName a binary topology
+     * \return false if the file can't be read
+     */
+    bool ReadBinary(const std::string& fileName);
+
+    std::vector<uint64_t> m_header;    //!< values of the first line
+    std::vector<uint32_t> m_switches;  //!< switch ids
+    std::vector<TopologyLink> m_links; //!< the links
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_FILE_H */
@@ -25,15 +25,16 @@
 #include "ns3/simulator.h"
 
 #include <iostream>
-// #include "ns3/point-to-point-remote-channel.h"
 #include "ns3/qbb-channel.h"
-// #include "ns3/qbb-remote-channel.h"
+#include "ns3/qbb-remote-channel.h"
 #include "ns3/config.h"
 #include "ns3/names.h"
 #include "ns3/packet.h"
 #include "ns3/queue.h"
-// #include "ns3/mpi-interface.h"
-// #include "ns3/mpi-receiver.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#endif
 
 #include "point-to-point-helper.h"
 #include "qbb-helper.h"
@@ -83,7 +84,7 @@ void
 QbbHelper::SetChannelAttribute(std::string n1, const AttributeValue& v1)
 {
     m_channelFactory.Set(n1, v1);
-    // m_remoteChannelFactory.Set (n1, v1);
+    m_remoteChannelFactory.Set(n1, v1);
 }
 
 void
@@ -276,44 +277,37 @@ QbbHelper::Install(Ptr<Node> a, Ptr<Node> b)
 
     // If MPI is enabled, we need to see if both nodes have the same system id
     // (rank), and the rank is the same as this instance.  If both are true,
-    // use a normal p2p channel, otherwise use a remote channel
-    bool useNormalChannel = true;
+    // use a normal qbb channel, otherwise use a remote channel
     Ptr<QbbChannel> channel = 0;
-    // if (MpiInterface::IsEnabled ())
-    // //   {
-    // //     uint32_t n1SystemId = a->GetSystemId ();
-    // //     uint32_t n2SystemId = b->GetSystemId ();
-    // //     uint32_t currSystemId = MpiInterface::GetSystemId ();
-    // //     if (n1SystemId != currSystemId || n2SystemId != currSystemId)
-    // //       {
-    // //         useNormalChannel = false;
-    // //       }
-    //   std:cout << "Can't use MPI. It was originally supported. Feel free to uncomment and start
-    //   debugging Funtion QbbHelper::Install (Ptr<Node> a, Ptr<Node> b)
-    //   /src/point-to-point/model/qbb-helper.cc" NS_ASSERT(0);
-    //   }
+#ifdef NS3_MPI
+    bool useNormalChannel = true;
+    if (MpiInterface::IsEnabled())
+    {
+        uint32_t n1SystemId = a->GetSystemId();
+        uint32_t n2SystemId = b->GetSystemId();
+        uint32_t currSystemId = MpiInterface::GetSystemId();
+        if (n1SystemId != currSystemId || n2SystemId != currSystemId)
+        {
+            useNormalChannel = false;
+        }
+    }
     if (useNormalChannel)
     {
         channel = m_channelFactory.Create<QbbChannel>();
     }
     else
     {
-        std::cout << "Can't use MPI. It was originally supported. Feel free to uncomment and start "
-                     "debugging Funtion QbbHelper::Install (Ptr<Node> a, Ptr<Node> b) "
-                     "/src/point-to-point/model/qbb-helper.cc"
-                  << std::endl;
-        NS_ASSERT(0);
+        channel = m_remoteChannelFactory.Create<QbbRemoteChannel>();
+        Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver>();
+        Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver>();
+        mpiRecA->SetReceiveCallback(MakeCallback(&QbbNetDevice::Receive, devA));
+        mpiRecB->SetReceiveCallback(MakeCallback(&QbbNetDevice::Receive, devB));
+        devA->AggregateObject(mpiRecA);
+        devB->AggregateObject(mpiRecB);
     }
-    // else
-    //   {
-    //     channel = m_remoteChannelFactory.Create<QbbRemoteChannel> ();
-    //     Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
-    //     Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
-    //     mpiRecA->SetReceiveCallback (MakeCallback (&QbbNetDevice::Receive, devA));
-    //     mpiRecB->SetReceiveCallback (MakeCallback (&QbbNetDevice::Receive, devB));
-    //     devA->AggregateObject (mpiRecA);
-    //     devB->AggregateObject (mpiRecB);
-    //   }
+#else
+    channel = m_channelFactory.Create<QbbChannel>();
+#endif
 
     devA->Attach(channel);
     devB->Attach(channel);
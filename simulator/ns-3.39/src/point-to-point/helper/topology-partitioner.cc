@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-partitioner.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/topology-file.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TopologyPartitioner");
+
+TopologyPartitioner::TopologyPartitioner()
+{
+}
+
+void
+TopologyPartitioner::Load(std::string topologyFile)
+{
+    TopologyFile topology;
+    NS_ABORT_MSG_IF(!topology.Open(topologyFile),
+                    "TopologyPartitioner: cannot read " << topologyFile);
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (const auto& link : topology.GetLinks())
+    {
+        links.emplace_back(link.src, link.dst);
+    }
+    SetTopology(topology.GetNNodes(), topology.GetSwitches(), links);
+}
+
+void
+TopologyPartitioner::Read(std::istream& in)
+{
+    uint32_t nNodes;
+    uint32_t nSwitches;
+    uint32_t nTors;
+    uint32_t nLinks;
+    in >> nNodes >> nSwitches >> nTors >> nLinks;
+    std::vector<uint32_t> switches(nSwitches);
+    for (auto& sid : switches)
+    {
+        in >> sid;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> links(nLinks);
+    for (auto& link : links)
+    {
+        std::string rate;
+        std::string delay;
+        double errorRate;
+        in >> link.first >> link.second >> rate >> delay >> errorRate;
+    }
+    NS_ABORT_MSG_IF(in.fail(), "TopologyPartitioner: malformed topology");
+    SetTopology(nNodes, switches, links);
+}
+
+void
+TopologyPartitioner::SetTopology(uint32_t nNodes,
+                                 const std::vector<uint32_t>& switches,
+                                 const std::vector<std::pair<uint32_t, uint32_t>>& links)
+{
+    m_isSwitch.assign(nNodes, false);
+    for (uint32_t sid : switches)
+    {
+        NS_ABORT_MSG_IF(sid >= nNodes, "TopologyPartitioner: bad switch id " << sid);
+        m_isSwitch[sid] = true;
+    }
+    m_neighbors.assign(nNodes, {});
+    for (const auto& link : links)
+    {
+        NS_ABORT_MSG_IF(link.first >= nNodes || link.second >= nNodes,
+                        "TopologyPartitioner: bad link " << link.first << " " << link.second);
+        m_neighbors[link.first].push_back(link.second);
+        m_neighbors[link.second].push_back(link.first);
+    }
+    m_links = links;
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Partition(uint32_t nParts) const
+{
+    NS_ABORT_MSG_IF(nParts == 0, "TopologyPartitioner: need at least one part");
+    uint32_t nNodes = m_isSwitch.size();
+    const uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> part(nNodes, unassigned);
+    std::vector<uint64_t> load(nParts, 0); // nodes per rank
+
+    // ToRs and their hosts, in node id order
+    std::vector<uint32_t> tors;
+    std::vector<uint32_t> weight(nNodes, 0);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        if (!m_isSwitch[i])
+        {
+            continue;
+        }
+        for (uint32_t j : m_neighbors[i])
+        {
+            if (!m_isSwitch[j])
+            {
+                weight[i]++;
+            }
+        }
+        if (weight[i] > 0)
+        {
+            weight[i]++; // the ToR itself
+            tors.push_back(i);
+            total += weight[i];
+        }
+    }
+
+    uint64_t before = 0;
+    for (uint32_t tor : tors)
+    {
+        // the rank whose share holds the middle of this ToR's weight
+        uint32_t p = std::min<uint64_t>(nParts - 1, (2 * before + weight[tor]) * nParts / (2 * total));
+        before += weight[tor];
+        part[tor] = p;
+        load[p]++;
+        for (uint32_t j : m_neighbors[tor])
+        {
+            if (!m_isSwitch[j] && part[j] == unassigned)
+            {
+                part[j] = p;
+                load[p]++;
+            }
+        }
+    }
+
+    // Remaining switches, nearest to the ToRs first, so that aggregation switches are placed
+    // before the cores above them
+    std::vector<uint32_t> order;
+    std::vector<bool> seen(nNodes, false);
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        if (part[i] != unassigned)
+        {
+            order.push_back(i);
+            seen[i] = true;
+        }
+    }
+    for (uint32_t k = 0; k < order.size(); k++)
+    {
+        for (uint32_t j : m_neighbors[order[k]])
+        {
+            if (!seen[j])
+            {
+                seen[j] = true;
+                order.push_back(j);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        if (!seen[i])
+        {
+            order.push_back(i); // not connected to any host
+        }
+    }
+
+    std::vector<uint32_t> count(nParts);
+    for (uint32_t i : order)
+    {
+        if (part[i] != unassigned)
+        {
+            continue;
+        }
+        std::fill(count.begin(), count.end(), 0);
+        for (uint32_t j : m_neighbors[i])
+        {
+            if (part[j] != unassigned)
+            {
+                count[part[j]]++;
+            }
+        }
+        uint32_t best = 0;
+        for (uint32_t p = 1; p < nParts; p++)
+        {
+            if (count[p] > count[best] || (count[p] == count[best] && load[p] < load[best]))
+            {
+                best = p;
+            }
+        }
+        part[i] = best;
+        load[best]++;
+    }
+
+    NS_LOG_INFO(nParts << " parts, " << GetCutLinks(part) << " of " << m_links.size()
+                       << " links cut");
+    return part;
+}
+
+uint32_t
+TopologyPartitioner::GetCutLinks(const std::vector<uint32_t>& systemId) const
+{
+    uint32_t cut = 0;
+    for (const auto& link : m_links)
+    {
+        if (systemId[link.first] != systemId[link.second])
+        {
+            cut++;
+        }
+    }
+    return cut;
+}
+
+} // namespace ns3
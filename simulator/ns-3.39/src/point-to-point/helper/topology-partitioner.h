@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TOPOLOGY_PARTITIONER_H
+#define TOPOLOGY_PARTITIONER_H
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup qbb
+ *
+ * \brief Split a datacenter topology over MPI ranks
+ *
+ * Reads the topology files of the examples (leaf-spine or fat-tree):
+ *
+ * \code
+ * <nodes> <switches> <tors> <links>
+ * <switch id> ... <switch id>
+ * <src> <dst> <rate> <delay> <error rate>      (one line per link)
+ * \endcode
+ *
+ * and gives every node the system id of the rank that simulates it. Hosts always stay with
+ * their ToR, so only switch to switch links cross ranks and the lookahead is a fabric link
+ * delay. ToRs are cut into contiguous, host balanced ranges of node ids, which keeps the
+ * ToRs of a fat-tree pod together. Every other switch goes to the rank holding most of its
+ * neighbours (aggregation switches follow their pod), ties to the least loaded rank (spines
+ * and cores are spread out).
+ *
+ * Nodes must then be created with the system id, e.g. CreateObject<Node>(systemId[i]) and
+ * CreateObject<SwitchNode>(systemId[i]), before QbbHelper::Install.
+ */
+class TopologyPartitioner
+{
+  public:
+    TopologyPartitioner();
+
+    /**
+     * \brief Read the topology from a text or binary file (see TopologyFile). Aborts if it
+     * cannot be read.
+     * \param topologyFile the topology file
+     */
+    void Load(std::string topologyFile);
+
+    /**
+     * \brief Read the topology from a stream
+     * \param in the topology
+     */
+    void Read(std::istream& in);
+
+    /**
+     * \param nNodes number of nodes
+     * \param switches ids of the switches, all other nodes are hosts
+     * \param links the links, as pairs of node ids
+     */
+    void SetTopology(uint32_t nNodes,
+                     const std::vector<uint32_t>& switches,
+                     const std::vector<std::pair<uint32_t, uint32_t>>& links);
+
+    /**
+     * \param nParts number of ranks
+     * \return the system id of every node
+     */
+    std::vector<uint32_t> Partition(uint32_t nParts) const;
+
+    /**
+     * \param systemId the system id of every node
+     * \return the number of links between nodes of different ranks
+     */
+    uint32_t GetCutLinks(const std::vector<uint32_t>& systemId) const;
+
+  private:
+    std::vector<bool> m_isSwitch;
+    std::vector<std::vector<uint32_t>> m_neighbors;
+    std::vector<std::pair<uint32_t, uint32_t>> m_links;
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_PARTITIONER_H */
@@ -20,7 +20,8 @@ qbbHeader::qbbHeader(uint16_t pg)
       dport(0),
       flags(0),
       m_pg(pg),
-      m_seq(0)
+      m_seq(0),
+      m_sack(0)
 {
 }
 
@@ -29,7 +30,8 @@ qbbHeader::qbbHeader()
       dport(0),
       flags(0),
       m_pg(0),
-      m_seq(0)
+      m_seq(0),
+      m_sack(0)
 {
 }
 
@@ -74,6 +76,13 @@ qbbHeader::SetCnp()
     flags |= 1 << FLAG_CNP;
 }
 
+void
+qbbHeader::SetSack(uint32_t seq)
+{
+    flags |= 1 << FLAG_SACK;
+    m_sack = seq;
+}
+
 void
 qbbHeader::SetIntHeader(const IntHeader& _ih)
 {
@@ -132,6 +141,18 @@ qbbHeader::GetCnp() const
     return (flags >> FLAG_CNP) & 1;
 }
 
+uint8_t
+qbbHeader::GetSackFlag() const
+{
+    return (flags >> FLAG_SACK) & 1;
+}
+
+uint32_t
+qbbHeader::GetSack() const
+{
+    return m_sack;
+}
+
 TypeId
 qbbHeader::GetTypeId(void)
 {
@@ -155,7 +176,7 @@ qbbHeader::Print(std::ostream& os) const
 uint32_t
 qbbHeader::GetSerializedSize(void) const
 {
-    return GetBaseSize() + IntHeader::GetStaticSize();
+    return GetBaseSize() + IntHeader::GetStaticSize() + (GetSackFlag() ? sizeof(m_sack) : 0);
 }
 
 uint32_t
@@ -178,6 +199,11 @@ qbbHeader::Serialize(Buffer::Iterator start) const
 
     // write IntHeader
     ih.Serialize(i);
+    if (GetSackFlag())
+    {
+        i.Next(IntHeader::GetStaticSize());
+        i.WriteU32(m_sack);
+    }
 }
 
 uint32_t
@@ -192,6 +218,11 @@ qbbHeader::Deserialize(Buffer::Iterator start)
 
     // read IntHeader
     ih.Deserialize(i);
+    if (GetSackFlag())
+    {
+        i.Next(IntHeader::GetStaticSize());
+        m_sack = i.ReadU32();
+    }
     return GetSerializedSize();
 }
 }; // namespace ns3
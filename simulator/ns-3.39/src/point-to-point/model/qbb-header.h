@@ -27,7 +27,8 @@ class qbbHeader : public Header
   public:
     enum
     {
-        FLAG_CNP = 0
+        FLAG_CNP = 0,
+        FLAG_SACK = 1 // selective repeat NACK, carries the seq of the out of order packet
     };
 
     qbbHeader(uint16_t pg);
@@ -44,6 +45,8 @@ class qbbHeader : public Header
     void SetDport(uint32_t _dport);
     void SetTs(uint64_t ts);
     void SetCnp();
+    // Selective repeat: the receiver holds the packet starting at seq (serialized after INT)
+    void SetSack(uint32_t seq);
     void SetIntHeader(const IntHeader& _ih);
     // Set swift endpoint delay duration, pass sending timestamp
     void SetSwiftEndDelay(uint64_t t4);
@@ -61,6 +64,8 @@ class qbbHeader : public Header
     uint16_t GetDport() const;
     uint64_t GetTs() const;
     uint8_t GetCnp() const;
+    uint8_t GetSackFlag() const;
+    uint32_t GetSack() const;
 
     static TypeId GetTypeId(void);
     TypeId GetInstanceTypeId(void) const override;
@@ -76,6 +81,7 @@ class qbbHeader : public Header
     uint16_t m_pg;
     uint32_t m_seq; // the qbb sequence number.
     IntHeader ih;
+    uint32_t m_sack; // only on the wire with FLAG_SACK
 };
 
 }; // namespace ns3
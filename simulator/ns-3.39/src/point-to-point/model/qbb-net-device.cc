@@ -33,6 +33,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/double.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/enum.h"
 #include "ns3/error-model.h"
 #include "ns3/interface-tag.h"
 #include "ns3/ipv4-header.h"
@@ -66,12 +67,24 @@ uint32_t RdmaEgressQueue::ack_q_idx = 3;
 uint32_t RdmaEgressQueue::tcpip_q_idx = 1;
 
 // RdmaEgressQueue
+NS_OBJECT_ENSURE_REGISTERED(RdmaEgressQueue);
+
 TypeId
 RdmaEgressQueue::GetTypeId(void)
 {
     static TypeId tid =
         TypeId("ns3::RdmaEgressQueue")
             .SetParent<Object>()
+            .AddAttribute("QpScheduler",
+                          "How the next qp to send from is picked. ReadyRing keeps eligible qps in "
+                          "a ring and paced qps in a timer heap, and serves them in the same order "
+                          "as LinearScan. Must be set before the first qp is added.",
+                          EnumValue(RdmaEgressQueue::LINEAR_SCAN),
+                          MakeEnumAccessor(&RdmaEgressQueue::m_schedType),
+                          MakeEnumChecker(RdmaEgressQueue::LINEAR_SCAN,
+                                          "LinearScan",
+                                          RdmaEgressQueue::READY_RING,
+                                          "ReadyRing"))
             .AddTraceSource("RdmaEnqueue",
                             "Enqueue a packet in the RdmaEgressQueue.",
                             MakeTraceSourceAccessor(&RdmaEgressQueue::m_traceRdmaEnqueue),
@@ -87,6 +100,7 @@ RdmaEgressQueue::RdmaEgressQueue()
 {
     m_rrlast = 0;
     m_qlast = 0;
+    m_schedType = LINEAR_SCAN;
     m_ackQ = CreateObject<DropTailQueue<Packet>>();
     m_ackQ->SetAttribute(
         "MaxSize",
@@ -124,41 +138,48 @@ RdmaEgressQueue::DequeueQindex(int qIndex)
     return 0;
 }
 
+// The IntHeader of a packet with l3 protocol prot, in place in the packet buffer like in
+// SwitchNode::SwitchNotifyDequeue; nullptr if the packet does not carry one
+static IntHeader*
+PeekIntHeader(Ptr<Packet> p, uint8_t prot)
+{
+    uint8_t* buf = p->GetBuffer();
+    if (buf[PppHeader::GetStaticSize() + 9] != prot)
+    {
+        return nullptr;
+    }
+    switch (prot)
+    {
+    case 0x11: // ppp, ip, udp, SeqTs, INT
+        return (IntHeader*)&buf[PppHeader::GetStaticSize() + 20 + 8 + 6];
+    case 0xFC: // ppp, ip, qbbHeader up to the seq, INT
+        return (IntHeader*)&buf[PppHeader::GetStaticSize() + 20 + 12];
+    default:
+        return nullptr;
+    }
+}
+
 // Calculate endpoint delay for Swift CC; actually seems useless, endpoint delay always 0
-//
-// In theory it can also use CustomHeader, but since it works, we don't change it
 void
 SwiftCalcEndpointDelay(Ptr<Packet> p)
 {
-    PppHeader ph;
-    p->RemoveHeader(ph);
-    Ipv4Header iph;
-    p->RemoveHeader(iph);
-    if (iph.GetProtocol() == 0xFC)
-    { // sending an ACK
-        qbbHeader qh;
-        p->RemoveHeader(qh);
+    IntHeader* ih = PeekIntHeader(p, 0xFC);
+    if (ih)
+    { // sending an ACK, same as qbbHeader::SetSwiftEndDelay
         auto t4 = Simulator::Now().GetNanoSeconds();
-        qh.SetSwiftEndDelay(t4);
-        p->AddHeader(qh);
+        ih->swift.remote_delay = t4 - ih->swift.remote_delay;
     }
-    p->AddHeader(iph);
-    p->AddHeader(ph);
 }
 
 // Attach t_sent (t1) to header for Swift CC
 void
 SwiftAttachTSent(Ptr<Packet> p)
 {
-    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
-    ch.getInt = 1;
-    p->RemoveHeader(ch);
-    if (ch.l3Prot == 0x11)
+    IntHeader* ih = PeekIntHeader(p, 0x11);
+    if (ih)
     { // UDP
-        auto t1 = Simulator::Now().GetNanoSeconds();
-        ch.udp.ih.swift.ts = t1;
+        ih->swift.ts = Simulator::Now().GetNanoSeconds();
     }
-    p->AddHeader(ch);
 }
 
 // Determines the next queue index from which to dequeue a packet for transmission, based on
@@ -170,8 +191,6 @@ SwiftAttachTSent(Ptr<Packet> p)
 int
 RdmaEgressQueue::GetNextQindex(bool paused[])
 {
-    bool found = false;
-    uint32_t qIndex;
     if (!paused[ack_q_idx] && m_ackQ->GetNPackets() > 0)
     { // top priority queue, try to send first
         return -1;
@@ -179,57 +198,19 @@ RdmaEgressQueue::GetNextQindex(bool paused[])
 
     // no pkt in highest priority queue, do rr for each qp
     int res = -1024;
-
     for (uint32_t dorr = 0; dorr < 2; dorr++)
     {
         hostDequeueIndex++;
         if (hostDequeueIndex % 2)
         {
-            uint32_t fcount = m_qpGrp->GetN();
-            uint32_t min_finish_id = 0xffffffff;
-            for (qIndex = 1; qIndex <= fcount; qIndex++) // go through all queues
+            if (m_schedType == READY_RING)
             {
-                //m_rrlast = 0;
-                uint32_t idx = (qIndex + m_rrlast) % fcount; // start from where we left last time
-                Ptr<RdmaQueuePair> qp = m_qpGrp->Get(idx);
-
-                if (!paused[qp->m_pg] && qp->GetBytesLeft() > 0 && !qp->IsWinBound())
-                { // not paused, not empty, not win bound
-                    if (m_qpGrp->Get(idx)->m_nextAvail.GetTimeStep() >
-                        Simulator::Now().GetTimeStep())
-                    { // still sending or pacing, not available
-                        continue;
-                    }
-                    res = idx;          // send from this queue
-                    qp->UpdatePacing(); // add another pacing delay to nextAvail
-                    break;
-                }
-                else if (qp->IsFinished())
-                { // finished
-                    min_finish_id = idx < min_finish_id ? idx : min_finish_id;
-                }
+                res = m_qpSched.GetNextQindex(m_qpGrp, m_rrlast, paused);
             }
-
-            // clear the finished qp
-            if (min_finish_id < 0xffffffff)
+            else
             {
-                int nxt = min_finish_id;
-                auto& qps = m_qpGrp->m_qps;
-                for (int i = min_finish_id + 1; i < fcount; i++)
-                {
-                    if (!qps[i]->IsFinished())
-                    {
-                        if (i == res)
-                        { // update res to the idx after removing finished qp
-                            res = nxt;
-                        }
-                        qps[nxt] = qps[i];
-                        nxt++;
-                    }
-                }
-                qps.resize(nxt);
+                res = GetNextQpLinear(paused);
             }
-
             if (res != -1024)
             {
                 return res;
@@ -248,6 +229,79 @@ RdmaEgressQueue::GetNextQindex(bool paused[])
     return res;
 }
 
+// Round robin over the qps by scanning all of them, starting after the one served last.
+// Finished qps passed over by the scan are removed from m_qpGrp.
+int
+RdmaEgressQueue::GetNextQpLinear(bool paused[])
+{
+    int res = -1024;
+    uint32_t qIndex;
+    uint32_t fcount = m_qpGrp->GetN();
+    uint32_t min_finish_id = 0xffffffff;
+    for (qIndex = 1; qIndex <= fcount; qIndex++) // go through all queues
+    {
+        //m_rrlast = 0;
+        uint32_t idx = (qIndex + m_rrlast) % fcount; // start from where we left last time
+        Ptr<RdmaQueuePair> qp = m_qpGrp->Get(idx);
+
+        if (!paused[qp->m_pg] && qp->GetBytesLeft() > 0 && !qp->IsWinBound())
+        { // not paused, not empty, not win bound
+            if (m_qpGrp->Get(idx)->m_nextAvail.GetTimeStep() > Simulator::Now().GetTimeStep())
+            { // still sending or pacing, not available
+                continue;
+            }
+            res = idx;          // send from this queue
+            qp->UpdatePacing(); // add another pacing delay to nextAvail
+            break;
+        }
+        else if (qp->IsFinished())
+        { // finished
+            min_finish_id = idx < min_finish_id ? idx : min_finish_id;
+        }
+    }
+
+    // clear the finished qp
+    if (min_finish_id < 0xffffffff)
+    {
+        int nxt = min_finish_id;
+        auto& qps = m_qpGrp->m_qps;
+        for (int i = min_finish_id + 1; i < fcount; i++)
+        {
+            if (!qps[i]->IsFinished())
+            {
+                if (i == res)
+                { // update res to the idx after removing finished qp
+                    res = nxt;
+                }
+                qps[nxt] = qps[i];
+                nxt++;
+            }
+        }
+        qps.resize(nxt);
+    }
+    return res;
+}
+
+Time
+RdmaEgressQueue::GetNextAvail()
+{
+    if (m_schedType == READY_RING)
+    {
+        return m_qpSched.GetNextAvail(m_qpGrp);
+    }
+    Time t = Simulator::GetMaximumSimulationTime();
+    for (uint32_t i = 0; i < GetFlowCount(); i++)
+    {
+        Ptr<RdmaQueuePair> qp = GetQp(i);
+        if (qp->GetBytesLeft() == 0)
+        {
+            continue;
+        }
+        t = Min(qp->m_nextAvail, t);
+    }
+    return t;
+}
+
 // Retrieves the last queue index that was used for dequeuing, potentially for logging or further
 // decision-making processes.
 int
@@ -285,6 +339,31 @@ RdmaEgressQueue::RecoverQueue(uint32_t i)
 {
     NS_ASSERT_MSG(i < m_qpGrp->GetN(), "RdmaEgressQueue::RecoverQueue: qIndex >= m_qpGrp->GetN()");
     m_qpGrp->Get(i)->snd_nxt = m_qpGrp->Get(i)->snd_una;
+    WakeQp(m_qpGrp->Get(i));
+}
+
+void
+RdmaEgressQueue::AddQp(Ptr<RdmaQueuePair> qp)
+{
+    if (m_schedType == READY_RING)
+    {
+        m_qpSched.AddQp(m_qpGrp, qp);
+    }
+}
+
+void
+RdmaEgressQueue::WakeQp(Ptr<RdmaQueuePair> qp)
+{
+    if (m_schedType == READY_RING)
+    {
+        m_qpSched.WakeQp(qp);
+    }
+}
+
+void
+RdmaEgressQueue::ReassignedQps()
+{
+    m_qpSched.SetDirty();
 }
 
 // Enqueues a packet into a high-priority queue, typically used for control packets or urgent data.
@@ -500,7 +579,10 @@ QbbNetDevice::DequeueAndTransmit(void)
             p = m_rdmaEQ->DequeueQindex(qIndex);
             // if (p==NULL)
             // std::cout << "p is null" << std::endl;
-            SwiftAttachTSent(p);
+            if (IntHeader::mode == IntHeader::SWIFT)
+            {
+                SwiftAttachTSent(p);
+            }
             // transmit
             m_traceQpDequeue(p, lastQp);
             TransmitStart(p);
@@ -512,16 +594,7 @@ QbbNetDevice::DequeueAndTransmit(void)
         else
         { // no packet to send
             NS_LOG_INFO("PAUSE prohibits send at node " << m_node->GetId());
-            Time t = Simulator::GetMaximumSimulationTime();
-            for (uint32_t i = 0; i < m_rdmaEQ->GetFlowCount(); i++)
-            {
-                Ptr<RdmaQueuePair> qp = m_rdmaEQ->GetQp(i);
-                if (qp->GetBytesLeft() == 0)
-                {
-                    continue;
-                }
-                t = Min(qp->m_nextAvail, t);
-            }
+            Time t = m_rdmaEQ->GetNextAvail();
             if (m_nextSend.IsExpired() && t < Simulator::GetMaximumSimulationTime() &&
                 t > Simulator::Now())
             {
@@ -539,11 +612,6 @@ QbbNetDevice::DequeueAndTransmit(void)
         {
             m_snifferTrace(p);
             m_promiscSnifferTrace(p);
-            Ipv4Header h;
-            Ptr<Packet> packet = p->Copy();
-            uint16_t protocol = 0;
-            ProcessHeader(packet, protocol);
-            packet->RemoveHeader(h);
             InterfaceTag t;
             uint32_t qIndex = m_queue->GetLastQueue();
             if (qIndex == 0)
@@ -708,12 +776,7 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
         else
         { // NIC
             int ret;
-            Ptr<Packet> cp = packet->Copy();
-            PppHeader ph;
-            cp->RemoveHeader(ph);
-            Ipv4Header ih;
-            cp->RemoveHeader(ih);
-            switch (ih.GetProtocol())
+            switch (ch.l3Prot)
             {
             case 0x06: { // tcp
                 m_snifferTrace(packet);
@@ -855,12 +918,14 @@ void
 QbbNetDevice::NewQp(Ptr<RdmaQueuePair> qp)
 {
     qp->m_nextAvail = Simulator::Now();
+    m_rdmaEQ->AddQp(qp);
     DequeueAndTransmit();
 }
 
 void
 QbbNetDevice::ReassignedQp(Ptr<RdmaQueuePair> qp)
 {
+    m_rdmaEQ->ReassignedQps();
     DequeueAndTransmit();
 }
 
@@ -27,6 +27,7 @@
 #include "ns3/event-id.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4.h"
+#include "ns3/rdma-qp-scheduler.h"
 #include "ns3/rdma-queue-pair.h"
 #include "ns3/udp-header.h"
 
@@ -43,6 +44,14 @@ class RdmaEgressQueue : public Object
 {
   public:
     static const uint32_t qCnt = 8;
+
+    // how GetNextQindex picks the next qp
+    enum SchedulerType
+    {
+        LINEAR_SCAN, // scan all qps on every dequeue
+        READY_RING,  // RdmaQpScheduler, same order as LINEAR_SCAN
+    };
+
     static uint32_t ack_q_idx;
     static uint32_t tcpip_q_idx;
     int m_qlast;
@@ -58,11 +67,15 @@ class RdmaEgressQueue : public Object
     RdmaEgressQueue();
     Ptr<Packet> DequeueQindex(int qIndex);
     int GetNextQindex(bool paused[]);
+    Time GetNextAvail(); // earliest m_nextAvail among the qps with bytes left
     int GetLastQueue();
     uint32_t GetNBytes(uint32_t qIndex);
     uint32_t GetFlowCount(void);
     Ptr<RdmaQueuePair> GetQp(uint32_t i);
     void RecoverQueue(uint32_t i);
+    void AddQp(Ptr<RdmaQueuePair> qp);    // qp was appended to m_qpGrp
+    void WakeQp(Ptr<RdmaQueuePair> qp);   // ACK/NACK/rate change may have unblocked qp
+    void ReassignedQps();                 // m_qpGrp was rebuilt
     void EnqueueHighPrioQ(Ptr<Packet> p);
     void CleanHighPrio(TracedCallback<Ptr<const Packet>, uint32_t> dropCb);
 
@@ -72,6 +85,12 @@ class RdmaEgressQueue : public Object
     Ptr<QbbNetDevice> qb_dev;
     bool dummy_paused[8];
     uint64_t hostDequeueIndex;
+
+  private:
+    int GetNextQpLinear(bool paused[]);
+
+    SchedulerType m_schedType;
+    RdmaQpScheduler m_qpSched;
 };
 
 /**
@@ -267,6 +286,11 @@ class QbbNetDevice : public PointToPointNetDevice
     uint64_t hostDequeueIndex;
 };
 
+// Swift timestamps, written in place into the headers of a packet the NIC sends: t_sent (t1) of a
+// data packet, and the endpoint delay of an ACK
+void SwiftAttachTSent(Ptr<Packet> p);
+void SwiftCalcEndpointDelay(Ptr<Packet> p);
+
 } // namespace ns3
 
 #endif // QBB_NET_DEVICE_H
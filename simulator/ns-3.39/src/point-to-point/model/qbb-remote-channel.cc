@@ -27,7 +27,9 @@
 #include "ns3/simulator.h"
 
 #include <iostream>
-// #include "ns3/mpi-interface.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 
 using namespace std;
 
@@ -66,10 +68,11 @@ QbbRemoteChannel::TransmitStart(Ptr<Packet> p, Ptr<QbbNetDevice> src, Time txTim
     Ptr<QbbNetDevice> dst = GetDestination(wire);
 
 #ifdef NS3_MPI
-    // Calculate the rxTime (absolute)
-    // Time rxTime = Simulator::Now () + txTime + GetDelay ();
-    // MpiInterface::SendPacket (p, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-    NS_FATAL_ERROR("MPI Issue");
+    // The packet is serialized right away, with its CustomHeader/INT bytes and packet tags
+    // (InterfaceTag, UnSchedTag, MyPriorityTag, FeedbackTag), and handed to the MpiReceiver
+    // aggregated to dst on the other rank. PFC frames are ordinary packets and go the same way.
+    Time rxTime = Simulator::Now() + txTime + GetDelay();
+    MpiInterface::SendPacket(p, rxTime, dst->GetNode()->GetId(), dst->GetIfIndex());
 #else
     NS_FATAL_ERROR("Can't use distributed simulator without MPI compiled in");
 #endif
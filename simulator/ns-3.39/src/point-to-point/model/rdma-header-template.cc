@@ -0,0 +1,223 @@
+#include "rdma-header-template.h"
+
+#include "ppp-header.h"
+#include "qbb-header.h"
+
+#include "ns3/int-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-header.h"
+
+#include <cstring>
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(RdmaHeaderTemplate);
+
+// offsets in the template, after the 14 byte PppHeader
+static const uint32_t IP_LENGTH = 14 + 2;
+static const uint32_t IP_ID = 14 + 4;
+static const uint32_t IP_PROTOCOL = 14 + 9;
+static const uint32_t UDP_LENGTH = 14 + 20 + 4;
+static const uint32_t SEQ = 14 + 20 + 8;
+static const uint32_t INT_HEADER = 14 + 20 + 8 + 6;
+static const uint32_t L4_START = 14 + 20; // UdpHeader, or the qbbHeader after an ACK template
+
+RdmaHeaderTemplate::RdmaHeaderTemplate()
+    : m_size(0),
+      m_kind(NONE),
+      m_protocol(0),
+      m_ipid(0),
+      m_seq(0),
+      m_payloadSize(0),
+      m_ackSize(0),
+      m_ack(nullptr)
+{
+}
+
+TypeId
+RdmaHeaderTemplate::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::RdmaHeaderTemplate")
+                            .SetParent<Header>()
+                            .SetGroupName("PointToPoint")
+                            .AddConstructor<RdmaHeaderTemplate>();
+    return tid;
+}
+
+TypeId
+RdmaHeaderTemplate::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+RdmaHeaderTemplate::Print(std::ostream& os) const
+{
+    os << (m_kind == DATA ? "data" : "ack") << " seq=" << m_seq << " id=" << m_ipid;
+}
+
+void
+RdmaHeaderTemplate::InitData(Ipv4Address sip,
+                             Ipv4Address dip,
+                             uint16_t sport,
+                             uint16_t dport,
+                             uint16_t pg)
+{
+    // the headers as RdmaHw added them one by one
+    Ptr<Packet> p = Create<Packet>();
+    SeqTsHeader seqTs;
+    seqTs.SetSeq(0);
+    seqTs.SetPG(pg);
+    p->AddHeader(seqTs);
+    UdpHeader udpHeader;
+    udpHeader.SetDestinationPort(dport);
+    udpHeader.SetSourcePort(sport);
+    p->AddHeader(udpHeader);
+    Ipv4Header ipHeader;
+    ipHeader.SetSource(sip);
+    ipHeader.SetDestination(dip);
+    ipHeader.SetProtocol(0x11);
+    ipHeader.SetPayloadSize(p->GetSize());
+    ipHeader.SetTtl(64);
+    ipHeader.SetTos(0);
+    ipHeader.SetIdentification(0);
+    p->AddHeader(ipHeader);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021); // EtherToPpp(0x800), see point-to-point-net-device.cc
+    p->AddHeader(ppp);
+
+    NS_ASSERT(p->GetSize() <= maxSize && ppp.GetSerializedSize() == 14);
+    m_size = p->CopyData(m_bytes, maxSize);
+    std::memset(m_bytes + 2, 0, 12); // PppHeader only writes the protocol
+    m_kind = DATA;
+}
+
+void
+RdmaHeaderTemplate::InitAck(Ipv4Address sip, Ipv4Address dip)
+{
+    Ptr<Packet> p = Create<Packet>();
+    Ipv4Header head;
+    head.SetDestination(dip);
+    head.SetSource(sip);
+    head.SetProtocol(0xFC);
+    head.SetTtl(64);
+    head.SetPayloadSize(0);
+    head.SetIdentification(0);
+    p->AddHeader(head);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+
+    m_size = p->CopyData(m_bytes, maxSize);
+    NS_ASSERT(m_size == L4_START);
+    std::memset(m_bytes + 2, 0, 12);
+    m_kind = ACK;
+}
+
+bool
+RdmaHeaderTemplate::IsInitialized() const
+{
+    return m_kind != NONE;
+}
+
+void
+RdmaHeaderTemplate::SetData(uint32_t seq, uint16_t ipid, uint32_t payloadSize)
+{
+    NS_ASSERT(m_kind == DATA);
+    m_seq = seq;
+    m_ipid = ipid;
+    m_payloadSize = payloadSize;
+}
+
+void
+RdmaHeaderTemplate::SetAck(const qbbHeader& ack,
+                           uint8_t protocol,
+                           uint16_t ipid,
+                           uint32_t paddingSize)
+{
+    NS_ASSERT(m_kind == ACK);
+    m_ack = &ack;
+    m_ackSize = ack.GetSerializedSize();
+    m_protocol = protocol;
+    m_ipid = ipid;
+    m_payloadSize = m_ackSize + paddingSize;
+}
+
+uint32_t
+RdmaHeaderTemplate::GetSerializedSize() const
+{
+    // the qbbHeader of an ACK is part of this header, the padding is not
+    return m_kind == ACK ? m_size + m_ackSize : m_size;
+}
+
+void
+RdmaHeaderTemplate::Serialize(Buffer::Iterator start) const
+{
+    Buffer::Iterator i = start;
+    i.Write(m_bytes, m_size);
+    if (m_kind == DATA)
+    {
+        uint32_t udpSize = m_size - L4_START + m_payloadSize;
+        i = start;
+        i.Next(IP_LENGTH);
+        i.WriteHtonU16(20 + udpSize);
+        i.WriteHtonU16(m_ipid);
+        i = start;
+        i.Next(UDP_LENGTH);
+        i.WriteHtonU16(udpSize);
+        i.Next(2); // checksum
+        i.WriteHtonU32(m_seq);
+        if (IntHeader::mode == IntHeader::TS)
+        {
+            i = start;
+            i.Next(INT_HEADER);
+            i.WriteU64(Simulator::Now().GetTimeStep());
+        }
+    }
+    else
+    {
+        m_ack->Serialize(i);
+        i = start;
+        i.Next(IP_LENGTH);
+        i.WriteHtonU16(20 + m_payloadSize);
+        i.WriteHtonU16(m_ipid);
+        i = start;
+        i.Next(IP_PROTOCOL);
+        i.WriteU8(m_protocol);
+    }
+}
+
+uint32_t
+RdmaHeaderTemplate::Deserialize(Buffer::Iterator start)
+{
+    // only used to print packets
+    Buffer::Iterator i = start;
+    i.Read(m_bytes, L4_START);
+    m_protocol = m_bytes[IP_PROTOCOL];
+    m_ipid = (m_bytes[IP_ID] << 8) | m_bytes[IP_ID + 1];
+    m_ack = nullptr;
+    if (m_protocol == 0x11)
+    {
+        m_kind = DATA;
+        m_size = INT_HEADER + IntHeader::GetStaticSize();
+        i.Read(m_bytes + L4_START, m_size - L4_START);
+        m_seq = 0;
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            m_seq = (m_seq << 8) | m_bytes[SEQ + k];
+        }
+        return m_size;
+    }
+    m_kind = ACK;
+    m_size = L4_START;
+    qbbHeader ack;
+    m_ackSize = ack.Deserialize(i);
+    m_seq = ack.GetSeq();
+    return m_size + m_ackSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,72 @@
+#ifndef RDMA_HEADER_TEMPLATE_H
+#define RDMA_HEADER_TEMPLATE_H
+
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+
+#include <cstdint>
+
+namespace ns3
+{
+
+class qbbHeader;
+
+/**
+ * \brief The header stack of the packets of one qp, serialized once and then written into every
+ * packet with a single AddHeader
+ *
+ * A data template holds the PppHeader, Ipv4Header, UdpHeader and SeqTsHeader that RdmaHw puts on
+ * a data packet; per packet only the IP length and id, the UDP length, the seq and, with the
+ * TS IntHeader, the timestamp are patched. An ACK template holds the PppHeader and Ipv4Header
+ * of the ACKs and NACKs; per packet the IP length, id and protocol are patched and the qbbHeader
+ * is written after them. The bytes are the same as with the headers added one by one.
+ */
+class RdmaHeaderTemplate : public Header
+{
+  public:
+    RdmaHeaderTemplate();
+
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    void Print(std::ostream& os) const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+
+    // Builds the template of the data packets from sip:sport to dip:dport on priority pg
+    void InitData(Ipv4Address sip, Ipv4Address dip, uint16_t sport, uint16_t dport, uint16_t pg);
+    // Builds the template of the ACKs and NACKs from sip to dip
+    void InitAck(Ipv4Address sip, Ipv4Address dip);
+    bool IsInitialized() const;
+
+    // The next Serialize writes a data packet with seq and ipid, carrying payloadSize bytes
+    void SetData(uint32_t seq, uint16_t ipid, uint32_t payloadSize);
+    // The next Serialize writes an ACK (protocol 0xFC) or NACK (0xFD) with ipid and the qbbHeader
+    // ack, followed by paddingSize bytes. ack must outlive the AddHeader call.
+    void SetAck(const qbbHeader& ack, uint8_t protocol, uint16_t ipid, uint32_t paddingSize);
+
+  private:
+    enum Kind : uint8_t
+    {
+        NONE,
+        DATA,
+        ACK,
+    };
+
+    // PppHeader + Ipv4Header + UdpHeader + SeqTsHeader with the largest IntHeader
+    static const uint32_t maxSize = 14 + 20 + 8 + 6 + 42;
+
+    uint8_t m_bytes[maxSize];
+    uint8_t m_size;
+    Kind m_kind;
+    uint8_t m_protocol;
+    uint16_t m_ipid;
+    uint32_t m_seq;
+    uint32_t m_payloadSize; // bytes after the IP header
+    uint32_t m_ackSize;     // size of the qbbHeader of an ACK
+    const qbbHeader* m_ack;
+};
+
+} // namespace ns3
+
+#endif /* RDMA_HEADER_TEMPLATE_H */
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <ostream>
 #include <random>
+#include <tuple>
 
 namespace ns3
 {
@@ -69,6 +70,17 @@ RdmaHw::GetTypeId(void)
                           BooleanValue(false),
                           MakeBooleanAccessor(&RdmaHw::m_backto0),
                           MakeBooleanChecker())
+            .AddAttribute("SelectiveRepeat",
+                          "Selective repeat loss recovery (receiver bitmap, SACK in the NACK, "
+                          "per-QP retransmission and RTO) instead of go-back-N.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RdmaHw::m_selectiveRepeat),
+                          MakeBooleanChecker())
+            .AddAttribute("SelectiveRepeatRto",
+                          "The selective repeat retransmission timeout in microseconds",
+                          DoubleValue(320.0),
+                          MakeDoubleAccessor(&RdmaHw::m_srRto),
+                          MakeDoubleChecker<double>())
             .AddAttribute("EwmaGain",
                           "Control gain parameter which determines the level of rate decrease",
                           DoubleValue(1.0 / 16),
@@ -94,6 +106,12 @@ RdmaHw::GetTypeId(void)
                           DoubleValue(4.0),
                           MakeDoubleAccessor(&RdmaHw::m_rateDecreaseInterval),
                           MakeDoubleChecker<double>())
+            .AddAttribute("MlxTimerSlot",
+                          "Slot in microseconds of the per-NIC timing wheel of the Mellanox "
+                          "timers; 0 gives every timer its own simulator event",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&RdmaHw::m_mlxTimerSlot),
+                          MakeDoubleChecker<double>(0.0))
             .AddAttribute("FastRecoveryTimes",
                           "The rate increase timer at RP",
                           UintegerValue(5),
@@ -302,6 +320,10 @@ RdmaHw::GetTypeId(void)
 }
 
 RdmaHw::RdmaHw()
+    : m_handleAck(nullptr),
+      m_handleCnp(nullptr),
+      m_mlxTimerSeq(0),
+      m_mlxTimersRunning(false)
 {
 }
 
@@ -332,6 +354,147 @@ RdmaHw::Setup(QpCompleteCallback cb)
     }
     // setup qp complete callback
     m_qpCompleteCallback = cb;
+    SetupCc();
+}
+
+void
+RdmaHw::SetupCc()
+{
+    m_handleAck = nullptr;
+    m_handleCnp = nullptr;
+    switch (m_cc_mode)
+    {
+    case CC_MODE::MLX_CNP:
+        m_handleCnp = &RdmaHw::cnp_received_mlx;
+        break;
+    case CC_MODE::HPCC:
+        // Not only HPCC, but also PowerTCP!
+        m_handleAck = PowerTCPEnabled ? &RdmaHw::HandleAckPower : &RdmaHw::HandleAckHp;
+        break;
+    case CC_MODE::TIMELY:
+        m_handleAck = &RdmaHw::HandleAckTimely;
+        break;
+    case CC_MODE::UFCC:
+        m_handleAck = &RdmaHw::HandleAckUfcc;
+        break;
+    case CC_MODE::UFCC_CWND:
+        m_handleAck = &RdmaHw::HandleAckUfcwndDctcp;
+        break;
+    case CC_MODE::DCTCP:
+        m_handleAck = &RdmaHw::HandleAckDctcp;
+        break;
+    case CC_MODE::HPCC_PINT:
+        m_handleAck = &RdmaHw::HandleAckHpPint;
+        break;
+    case CC_MODE::PATCHED_TIMELY:
+        m_handleAck = &RdmaHw::HandleAckPatchedTimely;
+        break;
+    case CC_MODE::SWIFT:
+        m_handleAck = &RdmaHw::HandleAckSwift;
+        break;
+    case CC_MODE::RTT_QCN:
+        m_handleAck = &RdmaHw::HandleAckRttQcn;
+        break;
+    case CC_MODE::POWERQCN:
+        m_handleAck = &RdmaHw::HandleAckPowerQcn;
+        break;
+    default:
+        NS_ABORT_MSG("Unknown CC mode");
+        break;
+    }
+}
+
+void
+RdmaHw::InitCc(Ptr<RdmaQueuePair> qp, DataRate rate)
+{
+    switch (m_cc_mode)
+    {
+    case CC_MODE::MLX_CNP:
+        qp->cc.emplace<RdmaQueuePair::MlxState>();
+        break;
+    case CC_MODE::HPCC:
+        if (PowerTCPEnabled)
+        {
+            qp->cc.emplace<RdmaQueuePair::PowerTcpState>();
+        }
+        else
+        {
+            qp->cc.emplace<RdmaQueuePair::HpState>();
+        }
+        break;
+    case CC_MODE::PATCHED_TIMELY:
+    case CC_MODE::TIMELY:
+        qp->cc.emplace<RdmaQueuePair::TimelyState>();
+        break;
+    case CC_MODE::DCTCP:
+        qp->cc.emplace<RdmaQueuePair::DctcpState>();
+        break;
+    case CC_MODE::HPCC_PINT:
+        qp->cc.emplace<RdmaQueuePair::HpccPintState>();
+        break;
+    case CC_MODE::SWIFT:
+        qp->cc.emplace<RdmaQueuePair::SwiftState>();
+        break;
+    case CC_MODE::UFCC:
+    case CC_MODE::UFCC_CWND: {
+        RdmaQueuePair::UfccState* ufcc;
+        if (m_cc_mode == CC_MODE::UFCC)
+        {
+            ufcc = &qp->cc.emplace<RdmaQueuePair::UfccState>();
+            ufcc->base_win = qp->m_win;
+        }
+        else
+        {
+            ufcc = &qp->cc.emplace<RdmaQueuePair::UfcwndState>();
+        }
+        ufcc->high_rate = rate;
+        ufcc->low_rate = m_minRate;
+        ufcc->max_times = 4000;
+        ufcc->state = qp->INIT;
+        break;
+    }
+    case CC_MODE::RTT_QCN:
+        qp->cc.emplace<RdmaQueuePair::RttQcnState>();
+        break;
+    case CC_MODE::POWERQCN:
+        qp->cc.emplace<RdmaQueuePair::PowerQcnState>();
+        break;
+    default:
+        NS_ABORT_MSG("Unknown CC mode");
+        break;
+    }
+    SetCcRate(qp, rate);
+}
+
+void
+RdmaHw::SetCcRate(Ptr<RdmaQueuePair> qp, DataRate rate)
+{
+    switch (m_cc_mode)
+    {
+    case CC_MODE::MLX_CNP:
+        qp->mlx().m_targetRate = rate;
+        break;
+    case CC_MODE::HPCC:
+        qp->hp().m_curRate = rate;
+        if (m_multipleRate)
+        {
+            for (uint32_t i = 0; i < IntHeader::maxHop; i++)
+            {
+                qp->hp().hopState[i].Rc = rate;
+            }
+        }
+        break;
+    case CC_MODE::PATCHED_TIMELY:
+    case CC_MODE::TIMELY:
+        qp->tmly().m_curRate = rate;
+        break;
+    case CC_MODE::HPCC_PINT:
+        qp->hpccPint().m_curRate = rate;
+        break;
+    case CC_MODE::SWIFT:
+        qp->swift().m_curRate = rate;
+        break;
+    }
 }
 
 uint32_t
@@ -422,61 +585,7 @@ RdmaHw::AddQueuePair(uint64_t size,
     }
     qp->m_rate = m_bps; // transmission starts at full rate
     qp->m_max_rate = m_bps;
-    switch (m_cc_mode)
-    {
-    case CC_MODE::MLX_CNP:
-        qp->mlx.m_targetRate = m_bps;
-        break;
-    case CC_MODE::HPCC:
-        qp->hp.m_curRate = m_bps;
-        if (m_multipleRate)
-        {
-            for (uint32_t i = 0; i < IntHeader::maxHop; i++)
-            {
-                qp->hp.hopState[i].Rc = m_bps;
-            }
-        }
-        break;
-    case CC_MODE::PATCHED_TIMELY:
-    case CC_MODE::TIMELY:
-        qp->tmly.m_curRate = m_bps;
-        break;
-    case CC_MODE::HPCC_PINT:
-        qp->hpccPint.m_curRate = m_bps;
-        break;
-    case CC_MODE::SWIFT:
-        qp->swift.m_curRate = m_bps;
-    case CC_MODE::UFCC:
-        qp->ufcc.high_rate = m_bps;
-        qp->ufcc.low_rate = m_minRate;
-        qp->ufcc.high = false;
-        qp->ufcc.low = false;
-        qp->ufcc.lastRtt = 0;
-        qp->ufcc.up = false;
-        qp->ufcc.cur_times = 0;
-        qp->ufcc.max_times = 4000;
-        qp->ufcc.m_lastUpdateSeq = 0;
-        qp->ufcc.de_tarRate = 0;
-        qp->ufcc.state = qp->INIT;
-        qp->ufcc.state_count = 0;
-        qp->ufcc.wait_count = 0;
-        qp->ufcc.base_win = qp->m_win;
-        
-    case CC_MODE::UFCC_CWND:
-        qp->ufcc.high_rate = m_bps;
-        qp->ufcc.low_rate = m_minRate;
-        qp->ufcc.high = false;
-        qp->ufcc.low = false;
-        qp->ufcc.lastRtt = 0;
-        qp->ufcc.up = false;
-        qp->ufcc.cur_times = 0;
-        qp->ufcc.max_times = 4000;
-        qp->ufcc.m_lastUpdateSeq = 0;
-        qp->ufcc.de_tarRate = 0;
-        qp->ufcc.state = qp->INIT;
-        qp->ufcc.state_count = 0;
-    }
-
+    InitCc(qp, m_bps);
 
     // Notify Nic
     m_nic[nic_idx].dev->NewQp(qp);
@@ -565,31 +674,7 @@ RdmaHw::ReceiveUdp(Ptr<Packet> p, CustomHeader& ch)
     int x = ReceiverCheckSeq(ch.udp.seq, rxQp, payload_size);
     if (x == 1 || x == 2)
     { // generate ACK or NACK
-        qbbHeader seqh;
-        seqh.SetSeq(rxQp->ReceiverNextExpectedSeq);
-        seqh.SetPG(ch.udp.pg);
-        seqh.SetSport(ch.udp.dport);
-        seqh.SetDport(ch.udp.sport);
-        seqh.SetIntHeader(ch.udp.ih); // ACK will preserve the INT header from the UDP
-        if (ecnbits)
-        {
-            seqh.SetCnp();
-        }
-
-        Ptr<Packet> newp =
-            Create<Packet>(std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0));
-        newp->AddHeader(seqh);
-
-        Ipv4Header head; // Prepare IPv4 header
-        head.SetDestination(Ipv4Address(ch.sip));
-        head.SetSource(Ipv4Address(ch.dip));
-        head.SetProtocol(x == 1 ? 0xFC : 0xFD); // ack=0xFC nack=0xFD
-        head.SetTtl(64);
-        head.SetPayloadSize(newp->GetSize());
-        head.SetIdentification(rxQp->m_ipid++);
-
-        newp->AddHeader(head);
-        AddHeader(newp, 0x800); // Attach PPP header
+        Ptr<Packet> newp = GetAckPacket(rxQp, ch, x == 2);
         // send
         uint32_t nic_idx = GetNicIdxOfRxQp(rxQp);
         m_nic[nic_idx].dev->RdmaEnqueueHighPrioQ(newp);
@@ -598,6 +683,37 @@ RdmaHw::ReceiveUdp(Ptr<Packet> p, CustomHeader& ch)
     return 0;
 }
 
+Ptr<Packet>
+RdmaHw::GetAckPacket(Ptr<RdmaRxQueuePair> rxQp, const CustomHeader& ch, bool nack)
+{
+    qbbHeader seqh;
+    seqh.SetSeq(rxQp->ReceiverNextExpectedSeq);
+    seqh.SetPG(ch.udp.pg);
+    seqh.SetSport(ch.udp.dport);
+    seqh.SetDport(ch.udp.sport);
+    seqh.SetIntHeader(ch.udp.ih); // ACK will preserve the INT header from the UDP
+    if (ch.GetIpv4EcnBits())
+    {
+        seqh.SetCnp();
+    }
+    if (nack && m_selectiveRepeat)
+    {
+        seqh.SetSack(ch.udp.seq);
+    }
+
+    uint32_t padding = std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0);
+    Ptr<Packet> newp = Create<Packet>(padding);
+    // PppHeader and Ipv4Header from the template of the rx qp, followed by seqh
+    if (!rxQp->m_ackHeader.IsInitialized())
+    {
+        rxQp->m_ackHeader.InitAck(Ipv4Address(rxQp->sip), Ipv4Address(rxQp->dip));
+    }
+    // ack=0xFC nack=0xFD
+    rxQp->m_ackHeader.SetAck(seqh, nack ? 0xFD : 0xFC, rxQp->m_ipid++, padding);
+    newp->AddHeader(rxQp->m_ackHeader);
+    return newp;
+}
+
 int
 RdmaHw::ReceiveCnp(Ptr<Packet> p, CustomHeader& ch)
 {
@@ -630,33 +746,8 @@ RdmaHw::ReceiveCnp(Ptr<Packet> p, CustomHeader& ch)
     if (qp->m_rate == 0) // lazy initialization
     {
         qp->m_rate = dev->GetDataRate();
-        if (m_cc_mode == CC_MODE::MLX_CNP)
-        {
-            qp->mlx.m_targetRate = dev->GetDataRate();
-        }
-        else if (m_cc_mode == CC_MODE::HPCC)
-        {
-            qp->hp.m_curRate = dev->GetDataRate();
-            if (m_multipleRate)
-            {
-                for (uint32_t i = 0; i < IntHeader::maxHop; i++)
-                {
-                    qp->hp.hopState[i].Rc = dev->GetDataRate();
-                }
-            }
-        }
-        else if (m_cc_mode == CC_MODE::TIMELY || m_cc_mode == CC_MODE::PATCHED_TIMELY)
-        {
-            qp->tmly.m_curRate = dev->GetDataRate();
-        }
-        else if (m_cc_mode == CC_MODE::HPCC_PINT)
-        {
-            qp->hpccPint.m_curRate = dev->GetDataRate();
-        }
-        else if (m_cc_mode == CC_MODE::SWIFT)
-        {
-            qp->swift.m_curRate = dev->GetDataRate();
-        }
+        SetCcRate(qp, dev->GetDataRate());
+        dev->GetRdmaQueue()->WakeQp(qp);
     }
     return 0;
 }
@@ -686,7 +777,7 @@ RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader& ch)
     }
     else
     {
-        if (!m_backto0)
+        if (!m_backto0 || m_selectiveRepeat)
         {
             qp->Acknowledge(seq);
         }
@@ -700,77 +791,45 @@ RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader& ch)
             QpComplete(qp);
         }
     }
-    if (ch.l3Prot == 0xFD)
+    if (m_selectiveRepeat)
+    {
+        if (!qp->IsFinished())
+        {
+            if (ch.l3Prot == 0xFD && ((ch.ack.flags >> qbbHeader::FLAG_SACK) & 1))
+            {
+                SelectiveRepeatNack(qp, ch.ack.sack);
+            }
+            RestartRto(qp);
+        }
+    }
+    else if (ch.l3Prot == 0xFD)
     { // NACK
         RecoverQueue(qp);
     }
 
     // handle cnp
-    if (cnp)
+    if (cnp && m_handleCnp)
     {
-        if (m_cc_mode == CC_MODE::MLX_CNP)
-        { // mlx version
-            cnp_received_mlx(qp);
-        }
+        (this->*m_handleCnp)(qp);
     }
 /*
     if (seq >= 400000 && qp->m_pg ==0)
     {
         qp->m_pg = 3;
-        qp->ufcc.low_rate = m_minRate;
-        qp->ufcc.state_count = 0;
-        qp->ufcc.state = qp->INIT;
-        qp->ufcc.wait_count = 5;
-        qp->ufcc.high_rate = qp->m_max_rate;
-        qp->m_rate = qp->ufcc.high_rate;
+        qp->ufcc().low_rate = m_minRate;
+        qp->ufcc().state_count = 0;
+        qp->ufcc().state = qp->INIT;
+        qp->ufcc().wait_count = 5;
+        qp->ufcc().high_rate = qp->m_max_rate;
+        qp->m_rate = qp->ufcc().high_rate;
     }
 */
-    switch (m_cc_mode)
+    if (m_handleAck)
     {
-    case CC_MODE::HPCC:
-        // Not only HPCC, but also PowerTCP!
-        HandleAckHp(qp, p, ch);
-        break;
-    case CC_MODE::TIMELY:
-        HandleAckTimely(qp, p, ch);
-        break;
-    case CC_MODE::UFCC:
-        if(true)
-        {
-            HandleAckUfcc(qp, p, ch);
-        }else {
-            HandleAckDctcp(qp, p, ch);
-        }
-        
-        break;
-    case CC_MODE::UFCC_CWND:
-        HandleAckUfcwnd(qp, p, ch);
-
-    case CC_MODE::DCTCP:
-        HandleAckDctcp(qp, p, ch);
-        break;
-    case CC_MODE::HPCC_PINT:
-        HandleAckHpPint(qp, p, ch);
-        break;
-    case CC_MODE::PATCHED_TIMELY:
-        HandleAckPatchedTimely(qp, p, ch);
-        break;
-    case CC_MODE::SWIFT:
-        HandleAckSwift(qp, p, ch);
-        break;
-    case CC_MODE::RTT_QCN:
-        HandleAckRttQcn(qp, p, ch);
-        break;
-    case CC_MODE::POWERQCN:
-        HandleAckPowerQcn(qp, p, ch);
-        break;
-    case CC_MODE::MLX_CNP:
-        break;
-    default:
-        NS_ABORT_MSG("Unknown CC mode");
-        break;
+        (this->*m_handleAck)(qp, p, ch);
     }
     // ACK may advance the on-the-fly window, allowing more packets to send
+    dev->GetRdmaQueue()->WakeQp(qp);
     dev->TriggerTransmit();
     return 0;
 }
@@ -808,6 +867,17 @@ RdmaHw::ReceiverCheckSeq(uint32_t seq, Ptr<RdmaRxQueuePair> q, uint32_t size) co
     if (seq == expected)
     {
         q->ReceiverNextExpectedSeq = expected + size;
+        if (!q->m_sackBitmap.empty())
+        {
+            // selective repeat: the hole is filled, take the packets held behind it
+            q->m_sackBitmap.pop_front();
+            while (!q->m_sackBitmap.empty() && q->m_sackBitmap.front())
+            {
+                q->m_sackBitmap.pop_front();
+                q->ReceiverNextExpectedSeq =
+                    std::min(q->ReceiverNextExpectedSeq + m_mtu, q->m_sackEnd);
+            }
+        }
         if (q->ReceiverNextExpectedSeq >= q->m_milestone_rx)
         {
             q->m_milestone_rx += m_ack_interval;
@@ -822,6 +892,18 @@ RdmaHw::ReceiverCheckSeq(uint32_t seq, Ptr<RdmaRxQueuePair> q, uint32_t size) co
             return 5;
         }
     }
+    else if (seq > expected && m_selectiveRepeat)
+    {
+        // Keep the packet and NACK it at once with a SACK, the sender only resends the holes
+        uint32_t slot = (seq - expected) / m_mtu;
+        if (q->m_sackBitmap.size() <= slot)
+        {
+            q->m_sackBitmap.resize(slot + 1, false);
+        }
+        q->m_sackBitmap[slot] = true;
+        q->m_sackEnd = std::max(q->m_sackEnd, seq + size);
+        return 2;
+    }
     else if (seq > expected)
     {
         // Generate NACK
@@ -840,6 +922,11 @@ RdmaHw::ReceiverCheckSeq(uint32_t seq, Ptr<RdmaRxQueuePair> q, uint32_t size) co
             return 4;
         }
     }
+    else if (m_selectiveRepeat)
+    {
+        // Duplicate, the ACK may have been lost
+        return 1;
+    }
     else
     {
         // Duplicate.
@@ -876,15 +963,55 @@ RdmaHw::RecoverQueue(Ptr<RdmaQueuePair> qp)
     qp->snd_nxt = qp->snd_una;
 }
 
+void
+RdmaHw::SelectiveRepeatNack(Ptr<RdmaQueuePair> qp, uint32_t sack)
+{
+    // Everything between the last reported hole and the SACK is lost; packets are MTU sized
+    // and MTU aligned up to the last one
+    qp->MarkSacked(sack);
+    for (uint64_t seq = std::max(qp->snd_una, qp->irn.highRetx); seq < sack; seq += m_mtu)
+    {
+        qp->MarkLost(seq, std::min<uint64_t>(m_mtu, qp->m_size - seq));
+    }
+    qp->irn.highRetx =
+        std::max<uint64_t>(qp->irn.highRetx, sack + std::min<uint64_t>(m_mtu, qp->m_size - sack));
+}
+
+void
+RdmaHw::RestartRto(Ptr<RdmaQueuePair> qp)
+{
+    Simulator::Cancel(qp->irn.rtoEvent);
+    if (qp->snd_nxt > qp->snd_una)
+    {
+        qp->irn.rtoEvent =
+            Simulator::Schedule(MicroSeconds(m_srRto), &RdmaHw::RtoTimeout, this, qp);
+    }
+}
+
+void
+RdmaHw::RtoTimeout(Ptr<RdmaQueuePair> qp)
+{
+    for (uint64_t seq = qp->snd_una; seq < qp->snd_nxt; seq += m_mtu)
+    {
+        qp->MarkLost(seq, std::min<uint64_t>(m_mtu, qp->m_size - seq));
+    }
+    qp->irn.highRetx = qp->snd_nxt;
+    RestartRto(qp);
+    uint32_t nic_idx = GetNicIdxOfQp(qp);
+    m_nic[nic_idx].dev->GetRdmaQueue()->WakeQp(qp);
+    m_nic[nic_idx].dev->TriggerTransmit();
+}
+
 void
 RdmaHw::QpComplete(Ptr<RdmaQueuePair> qp)
 {
     NS_ASSERT(!m_qpCompleteCallback.IsNull());
+    Simulator::Cancel(qp->irn.rtoEvent);
     if (m_cc_mode == CC_MODE::MLX_CNP)
     {
-        Simulator::Cancel(qp->mlx.m_eventUpdateAlpha);
-        Simulator::Cancel(qp->mlx.m_eventDecreaseRate);
-        Simulator::Cancel(qp->mlx.m_rpTimer);
+        CancelMlxTimer(qp, MLX_UPDATE_ALPHA);
+        CancelMlxTimer(qp, MLX_DECREASE_RATE);
+        CancelMlxTimer(qp, MLX_RATE_INC);
     }
 
     // This callback will log info
@@ -943,13 +1070,20 @@ RdmaHw::RedistributeQp()
 Ptr<Packet>
 RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp)
 {
-    uint32_t payload_size = qp->GetBytesLeft();
-    if (m_mtu < payload_size)
+    uint64_t seq = qp->snd_nxt;
+    uint32_t payload_size = std::min<uint64_t>(m_mtu, qp->m_size - qp->snd_nxt);
+    bool retx = !qp->irn.retx.empty();
+    if (retx)
     {
-        payload_size = m_mtu;
+        std::tie(seq, payload_size) = qp->PopRetx();
+    }
+    else if (m_selectiveRepeat && !qp->irn.rtoEvent.IsRunning())
+    {
+        qp->irn.rtoEvent =
+            Simulator::Schedule(MicroSeconds(m_srRto), &RdmaHw::RtoTimeout, this, qp);
     }
     Ptr<Packet> p = Create<Packet>(payload_size);
-    uint32_t sentBytes = qp->m_size - qp->GetBytesLeft();
+    uint32_t sentBytes = seq;
     uint32_t nic_idx = GetNicIdxOfQp(qp);
     DataRate m_bps = m_nic[nic_idx].dev->GetDataRate();
     double bdp = m_bps.GetBitRate() * 1 * qp->m_baseRtt * 1e-9 / 8;
@@ -963,33 +1097,19 @@ RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp)
         unschedtag.SetValue(0);
     }
     p->AddPacketTag(unschedtag);
-    // add SeqTsHeader
-    SeqTsHeader seqTs;
-    seqTs.SetSeq(qp->snd_nxt);
-    seqTs.SetPG(qp->m_pg);
-    p->AddHeader(seqTs);
-    // add udp header
-    UdpHeader udpHeader;
-    udpHeader.SetDestinationPort(qp->dport);
-    udpHeader.SetSourcePort(qp->sport);
-    p->AddHeader(udpHeader);
-    // add ipv4 header
-    Ipv4Header ipHeader;
-    ipHeader.SetSource(qp->sip);
-    ipHeader.SetDestination(qp->dip);
-    ipHeader.SetProtocol(0x11);
-    ipHeader.SetPayloadSize(p->GetSize());
-    ipHeader.SetTtl(64);
-    ipHeader.SetTos(0);
-    ipHeader.SetIdentification(qp->m_ipid);
-    p->AddHeader(ipHeader);
-    // add ppp header
-    PppHeader ppp;
-    ppp.SetProtocol(0x0021); // EtherToPpp(0x800), see point-to-point-net-device.cc
-    p->AddHeader(ppp);
+    // PppHeader, Ipv4Header, UdpHeader and SeqTsHeader from the template of the qp
+    if (!qp->m_dataHeader.IsInitialized())
+    {
+        qp->m_dataHeader.InitData(qp->sip, qp->dip, qp->sport, qp->dport, qp->m_pg);
+    }
+    qp->m_dataHeader.SetData(seq, qp->m_ipid, payload_size);
+    p->AddHeader(qp->m_dataHeader);
 
     // update state
-    qp->snd_nxt += payload_size;
+    if (!retx)
+    {
+        qp->snd_nxt += payload_size;
+    }
     qp->m_ipid++;
 
     // return
@@ -1004,7 +1124,10 @@ RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap) cons
     //	pkt->PeekHeader(seqTs);
     uint32_t seq = qp->snd_nxt;
 
-    qp->rates[qp->snd_nxt] = Simulator::Now().GetNanoSeconds();
+    if (RdmaQueuePair::PowerTcpState* power = std::get_if<RdmaQueuePair::PowerTcpState>(&qp->cc))
+    {
+        power->rates[qp->snd_nxt] = Simulator::Now().GetNanoSeconds();
+    }
     UpdateNextAvail(qp, interframeGap, pkt->GetSize());
 }
 
@@ -1036,6 +1159,14 @@ RdmaHw::ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate)
 #endif
     // change to new rate
     qp->m_rate = new_rate;
+    m_nic[nic_idx].dev->GetRdmaQueue()->WakeQp(qp);
+}
+
+void
+RdmaHw::WakeQp(Ptr<RdmaQueuePair> qp)
+{
+    uint32_t nic_idx = GetNicIdxOfQp(qp);
+    m_nic[nic_idx].dev->GetRdmaQueue()->WakeQp(qp);
 }
 
 #define PRINT_LOG 0
@@ -1047,52 +1178,49 @@ void
 RdmaHw::UpdateAlphaMlx(Ptr<RdmaQueuePair> q)
 {
 #if PRINT_LOG
-    // std::cout << Simulator::Now() << " alpha update:" << m_node->GetId() << ' ' << q->mlx.m_alpha
-    // << ' ' << (int)q->mlx.m_alpha_cnp_arrived << '\n'; printf("%lu alpha update: %08x %08x %u %u
+    // std::cout << Simulator::Now() << " alpha update:" << m_node->GetId() << ' ' << q->mlx().m_alpha
+    // << ' ' << (int)q->mlx().m_alpha_cnp_arrived << '\n'; printf("%lu alpha update: %08x %08x %u %u
     // %.6lf->", Simulator::Now().GetTimeStep(), q->sip.Get(), q->dip.Get(), q->sport, q->dport,
-    // q->mlx.m_alpha);
+    // q->mlx().m_alpha);
 #endif
-    if (q->mlx.m_alpha_cnp_arrived)
+    if (q->mlx().m_alpha_cnp_arrived)
     {
-        q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha + m_g; // binary feedback
+        q->mlx().m_alpha = (1 - m_g) * q->mlx().m_alpha + m_g; // binary feedback
     }
     else
     {
-        q->mlx.m_alpha = (1 - m_g) * q->mlx.m_alpha; // binary feedback
+        q->mlx().m_alpha = (1 - m_g) * q->mlx().m_alpha; // binary feedback
     }
 #if PRINT_LOG
-    // printf("%.6lf\n", q->mlx.m_alpha);
+    // printf("%.6lf\n", q->mlx().m_alpha);
 #endif
-    q->mlx.m_alpha_cnp_arrived = false; // clear the CNP_arrived bit
+    q->mlx().m_alpha_cnp_arrived = false; // clear the CNP_arrived bit
     ScheduleUpdateAlphaMlx(q);
 }
 
 void
 RdmaHw::ScheduleUpdateAlphaMlx(Ptr<RdmaQueuePair> q)
 {
-    q->mlx.m_eventUpdateAlpha = Simulator::Schedule(MicroSeconds(m_alpha_resume_interval),
-                                                    &RdmaHw::UpdateAlphaMlx,
-                                                    this,
-                                                    q);
+    ScheduleMlxTimer(q, MLX_UPDATE_ALPHA, MicroSeconds(m_alpha_resume_interval));
 }
 
 void
 RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q)
 {
-    q->mlx.m_alpha_cnp_arrived = true;    // set CNP_arrived bit for alpha update
-    q->mlx.m_decrease_cnp_arrived = true; // set CNP_arrived bit for rate decrease
-    if (q->mlx.m_first_cnp)
+    q->mlx().m_alpha_cnp_arrived = true;    // set CNP_arrived bit for alpha update
+    q->mlx().m_decrease_cnp_arrived = true; // set CNP_arrived bit for rate decrease
+    if (q->mlx().m_first_cnp)
     {
         // init alpha
-        q->mlx.m_alpha = 1;
-        q->mlx.m_alpha_cnp_arrived = false;
+        q->mlx().m_alpha = 1;
+        q->mlx().m_alpha_cnp_arrived = false;
         // schedule alpha update
         ScheduleUpdateAlphaMlx(q);
         // schedule rate decrease
         ScheduleDecreaseRateMlx(q, 1); // add 1 ns to make sure rate decrease is after alpha update
         // set rate on first CNP
-        q->mlx.m_targetRate = q->m_rate = m_rateOnFirstCNP * q->m_rate;
-        q->mlx.m_first_cnp = false;
+        q->mlx().m_targetRate = q->m_rate = m_rateOnFirstCNP * q->m_rate;
+        q->mlx().m_first_cnp = false;
     }
 }
 
@@ -1100,7 +1228,7 @@ void
 RdmaHw::CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q)
 {
     ScheduleDecreaseRateMlx(q, 0);
-    if (q->mlx.m_decrease_cnp_arrived)
+    if (q->mlx().m_decrease_cnp_arrived)
     {
 #if PRINT_LOG
         printf("%lu rate dec: %08x %08x %u %u (%0.3lf %.3lf)->",
@@ -1109,66 +1237,140 @@ RdmaHw::CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q)
                q->dip.Get(),
                q->sport,
                q->dport,
-               q->mlx.m_targetRate.GetBitRate() * 1e-9,
+               q->mlx().m_targetRate.GetBitRate() * 1e-9,
                q->m_rate.GetBitRate() * 1e-9);
 #endif
         bool clamp = true;
         if (!m_EcnClampTgtRate)
         {
-            if (q->mlx.m_rpTimeStage == 0)
+            if (q->mlx().m_rpTimeStage == 0)
             {
                 clamp = false;
             }
         }
         if (clamp)
         {
-            q->mlx.m_targetRate = q->m_rate;
+            q->mlx().m_targetRate = q->m_rate;
         }
-        q->m_rate = std::max(m_minRate, q->m_rate * (1 - q->mlx.m_alpha / 2));
+        q->m_rate = std::max(m_minRate, q->m_rate * (1 - q->mlx().m_alpha / 2));
         // reset rate increase related things
-        q->mlx.m_rpTimeStage = 0;
-        q->mlx.m_decrease_cnp_arrived = false;
-        Simulator::Cancel(q->mlx.m_rpTimer);
-        q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset),
-                                               &RdmaHw::RateIncEventTimerMlx,
-                                               this,
-                                               q);
+        q->mlx().m_rpTimeStage = 0;
+        q->mlx().m_decrease_cnp_arrived = false;
+        CancelMlxTimer(q, MLX_RATE_INC);
+        ScheduleMlxTimer(q, MLX_RATE_INC, MicroSeconds(m_rpgTimeReset));
 #if PRINT_LOG
         printf("(%.3lf %.3lf)\n",
-               q->mlx.m_targetRate.GetBitRate() * 1e-9,
+               q->mlx().m_targetRate.GetBitRate() * 1e-9,
                q->m_rate.GetBitRate() * 1e-9);
 #endif
+        WakeQp(q); // a smaller rate may shrink the window
     }
 }
 
 void
 RdmaHw::ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, uint32_t delta)
 {
-    q->mlx.m_eventDecreaseRate =
-        Simulator::Schedule(MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(delta),
-                            &RdmaHw::CheckRateDecreaseMlx,
-                            this,
-                            q);
+    ScheduleMlxTimer(q,
+                     MLX_DECREASE_RATE,
+                     MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(delta));
 }
 
 void
 RdmaHw::RateIncEventTimerMlx(Ptr<RdmaQueuePair> q)
 {
-    q->mlx.m_rpTimer =
-        Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
+    ScheduleMlxTimer(q, MLX_RATE_INC, MicroSeconds(m_rpgTimeReset));
     RateIncEventMlx(q);
-    q->mlx.m_rpTimeStage++;
+    q->mlx().m_rpTimeStage++;
+    WakeQp(q); // a larger rate may open the window
+}
+
+void
+RdmaHw::ScheduleMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind, Time delay)
+{
+    if (m_mlxTimerSlot <= 0)
+    {
+        q->mlx().m_timerEvent[kind] =
+            Simulator::Schedule(delay, &RdmaHw::FireMlxTimer, this, q, kind);
+        return;
+    }
+    // round up to the end of the slot, so that a timer never fires early
+    int64_t slot = std::max<int64_t>(1, MicroSeconds(m_mlxTimerSlot).GetTimeStep());
+    int64_t now = Simulator::Now().GetTimeStep();
+    int64_t ts = (now + delay.GetTimeStep() + slot - 1) / slot * slot;
+    m_mlxTimers.push({ts, m_mlxTimerSeq++, q->mlx().m_timerGen[kind], kind, q});
+    if (m_mlxTimersRunning)
+    {
+        return;
+    }
+    if (m_mlxTimerEvent.IsExpired() || ts < (int64_t)m_mlxTimerEvent.GetTs())
+    {
+        m_mlxTimerEvent.Cancel();
+        m_mlxTimerEvent = Simulator::Schedule(TimeStep(ts - now), &RdmaHw::RunMlxTimers, this);
+    }
+}
+
+void
+RdmaHw::CancelMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind)
+{
+    Simulator::Cancel(q->mlx().m_timerEvent[kind]);
+    q->mlx().m_timerGen[kind]++; // a wheel entry stays in m_mlxTimers and is dropped when due
+}
+
+void
+RdmaHw::FireMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind)
+{
+    switch (kind)
+    {
+    case MLX_UPDATE_ALPHA:
+        UpdateAlphaMlx(q);
+        break;
+    case MLX_DECREASE_RATE:
+        CheckRateDecreaseMlx(q);
+        break;
+    case MLX_RATE_INC:
+        RateIncEventTimerMlx(q);
+        break;
+    }
+}
+
+void
+RdmaHw::RunMlxTimers()
+{
+    m_mlxTimersRunning = true;
+    int64_t now = Simulator::Now().GetTimeStep();
+    while (!m_mlxTimers.empty() && m_mlxTimers.top().ts <= now)
+    {
+        MlxTimerEntry e = m_mlxTimers.top();
+        m_mlxTimers.pop();
+        if (e.gen == e.qp->mlx().m_timerGen[e.kind])
+        {
+            FireMlxTimer(e.qp, (MlxTimer)e.kind);
+        }
+    }
+    // do not wake up for cancelled timers
+    while (!m_mlxTimers.empty() &&
+           m_mlxTimers.top().gen != m_mlxTimers.top().qp->mlx().m_timerGen[m_mlxTimers.top().kind])
+    {
+        m_mlxTimers.pop();
+    }
+    m_mlxTimersRunning = false;
+    if (!m_mlxTimers.empty())
+    {
+        m_mlxTimerEvent = Simulator::Schedule(TimeStep(m_mlxTimers.top().ts - now),
+                                              &RdmaHw::RunMlxTimers,
+                                              this);
+    }
 }
 
 void
 RdmaHw::RateIncEventMlx(Ptr<RdmaQueuePair> q)
 {
     // check which increase phase: fast recovery, active increase, hyper increase
-    if (q->mlx.m_rpTimeStage < m_rpgThreshold)
+    if (q->mlx().m_rpTimeStage < m_rpgThreshold)
     { // fast recovery
         FastRecoveryMlx(q);
     }
-    else if (q->mlx.m_rpTimeStage == m_rpgThreshold)
+    else if (q->mlx().m_rpTimeStage == m_rpgThreshold)
     { // active increase
         ActiveIncreaseMlx(q);
     }
@@ -1188,13 +1390,13 @@ RdmaHw::FastRecoveryMlx(Ptr<RdmaQueuePair> q)
            q->dip.Get(),
            q->sport,
            q->dport,
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
-    q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+    q->m_rate = (q->m_rate / 2) + (q->mlx().m_targetRate / 2);
 #if PRINT_LOG
     printf("(%.3lf %.3lf)\n",
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
 }
@@ -1209,22 +1411,22 @@ RdmaHw::ActiveIncreaseMlx(Ptr<RdmaQueuePair> q)
            q->dip.Get(),
            q->sport,
            q->dport,
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
     // get NIC
     uint32_t nic_idx = GetNicIdxOfQp(q);
     Ptr<QbbNetDevice> dev = m_nic[nic_idx].dev;
     // increate rate
-    q->mlx.m_targetRate += m_rai;
-    if (q->mlx.m_targetRate > dev->GetDataRate())
+    q->mlx().m_targetRate += m_rai;
+    if (q->mlx().m_targetRate > dev->GetDataRate())
     {
-        q->mlx.m_targetRate = dev->GetDataRate();
+        q->mlx().m_targetRate = dev->GetDataRate();
     }
-    q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+    q->m_rate = (q->m_rate / 2) + (q->mlx().m_targetRate / 2);
 #if PRINT_LOG
     printf("(%.3lf %.3lf)\n",
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
 }
@@ -1239,22 +1441,22 @@ RdmaHw::HyperIncreaseMlx(Ptr<RdmaQueuePair> q)
            q->dip.Get(),
            q->sport,
            q->dport,
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
     // get NIC
     uint32_t nic_idx = GetNicIdxOfQp(q);
     Ptr<QbbNetDevice> dev = m_nic[nic_idx].dev;
     // increate rate
-    q->mlx.m_targetRate += m_rhai;
-    if (q->mlx.m_targetRate > dev->GetDataRate())
+    q->mlx().m_targetRate += m_rhai;
+    if (q->mlx().m_targetRate > dev->GetDataRate())
     {
-        q->mlx.m_targetRate = dev->GetDataRate();
+        q->mlx().m_targetRate = dev->GetDataRate();
     }
-    q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+    q->m_rate = (q->m_rate / 2) + (q->mlx().m_targetRate / 2);
 #if PRINT_LOG
     printf("(%.3lf %.3lf)\n",
-           q->mlx.m_targetRate.GetBitRate() * 1e-9,
+           q->mlx().m_targetRate.GetBitRate() * 1e-9,
            q->m_rate.GetBitRate() * 1e-9);
 #endif
 }
@@ -1267,27 +1469,13 @@ RdmaHw::HandleAckHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint32_t ack_seq = ch.ack.seq;
     // update rate
-    if (ack_seq > qp->hp.m_lastUpdateSeq)
+    if (ack_seq > qp->hp().m_lastUpdateSeq)
     { // if full RTT feedback is ready, do full update
-        if (PowerTCPEnabled)
-        {
-            UpdateRatePower(qp, p, ch, false);
-        }
-        else
-        {
-            UpdateRateHp(qp, p, ch, false);
-        }
+        UpdateRateHp(qp, p, ch, false);
     }
     else
     { // do fast react
-        if (PowerTCPEnabled)
-        {
-            FastReactPower(qp, p, ch);
-        }
-        else
-        {
-            FastReactHp(qp, p, ch);
-        }
+        FastReactHp(qp, p, ch);
     }
 }
 
@@ -1297,16 +1485,16 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
     uint32_t next_seq = qp->snd_nxt;
     bool print = true;
 
-    if (qp->hp.m_lastUpdateSeq == 0)
+    if (qp->hp().m_lastUpdateSeq == 0)
     { // first RTT
 
-        qp->hp.m_lastUpdateSeq = next_seq;
+        qp->hp().m_lastUpdateSeq = next_seq;
         // store INT
         IntHeader& ih = ch.ack.ih;
         NS_ASSERT(ih.nhop <= IntHeader::maxHop);
         for (uint32_t i = 0; i < ih.nhop; i++)
         {
-            qp->hp.hop[i] = ih.hop[i];
+            qp->hp().hop[i] = ih.hop[i];
         }
 #if PRINT_LOG
         if (print)
@@ -1318,7 +1506,7 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                    qp->dip.Get(),
                    qp->sport,
                    qp->dport,
-                   qp->hp.m_lastUpdateSeq,
+                   qp->hp().m_lastUpdateSeq,
                    ch.ack.seq,
                    next_seq);
             for (uint32_t i = 0; i < ih.nhop; i++)
@@ -1347,7 +1535,7 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                        qp->dip.Get(),
                        qp->sport,
                        qp->dport,
-                       qp->hp.m_lastUpdateSeq,
+                       qp->hp().m_lastUpdateSeq,
                        ch.ack.seq,
                        next_seq);
 #endif
@@ -1371,19 +1559,19 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                 if (print)
                     printf(" %u(%u) %lu(%lu) %lu(%lu)",
                            ih.hop[i].GetQlen(),
-                           qp->hp.hop[i].GetQlen(),
+                           qp->hp().hop[i].GetQlen(),
                            ih.hop[i].GetBytes(),
-                           qp->hp.hop[i].GetBytes(),
+                           qp->hp().hop[i].GetBytes(),
                            ih.hop[i].GetTime(),
-                           qp->hp.hop[i].GetTime());
+                           qp->hp().hop[i].GetTime());
 #endif
-                uint64_t tau = ih.hop[i].GetTimeDelta(qp->hp.hop[i]);
+                uint64_t tau = ih.hop[i].GetTimeDelta(qp->hp().hop[i]);
                 double duration = tau * 1e-9;
-                double txRate = (ih.hop[i].GetBytesDelta(qp->hp.hop[i])) * 8 / duration;
+                double txRate = (ih.hop[i].GetBytesDelta(qp->hp().hop[i])) * 8 / duration;
 
                 double u;
                 u = txRate / ih.hop[i].GetLineRate() +
-                    (double)std::min(ih.hop[i].GetQlen(), qp->hp.hop[i].GetQlen()) *
+                    (double)std::min(ih.hop[i].GetQlen(), qp->hp().hop[i].GetQlen()) *
                         qp->m_max_rate.GetBitRate() / ih.hop[i].GetLineRate() / qp->m_win;
 
 #if PRINT_LOG
@@ -1406,11 +1594,11 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                     {
                         tau = qp->m_baseRtt;
                     }
-                    qp->hp.hopState[i].u =
-                        (qp->hp.hopState[i].u * (qp->m_baseRtt - tau) + u * tau) /
+                    qp->hp().hopState[i].u =
+                        (qp->hp().hopState[i].u * (qp->m_baseRtt - tau) + u * tau) /
                         double(qp->m_baseRtt);
                 }
-                qp->hp.hop[i] = ih.hop[i];
+                qp->hp().hop[i] = ih.hop[i];
             }
 
             DataRate new_rate;
@@ -1427,18 +1615,18 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                         dt = 1.0 * qp->m_baseRtt;
                     }
 
-                    qp->hp.u = (qp->hp.u * (qp->m_baseRtt - dt) + U * dt) / double(qp->m_baseRtt);
-                    max_c = qp->hp.u / m_targetUtil;
+                    qp->hp().u = (qp->hp().u * (qp->m_baseRtt - dt) + U * dt) / double(qp->m_baseRtt);
+                    max_c = qp->hp().u / m_targetUtil;
 
-                    if (max_c >= 1 || qp->hp.m_incStage >= m_miThresh)
+                    if (max_c >= 1 || qp->hp().m_incStage >= m_miThresh)
                     {
-                        new_rate = qp->hp.m_curRate / max_c + m_rai;
+                        new_rate = qp->hp().m_curRate / max_c + m_rai;
                         new_incStage = 0;
                     }
                     else
                     {
-                        new_rate = qp->hp.m_curRate + m_rai;
-                        new_incStage = qp->hp.m_incStage + 1;
+                        new_rate = qp->hp().m_curRate + m_rai;
+                        new_incStage = qp->hp().m_incStage + 1;
                     }
 
                     if (new_rate < m_minRate)
@@ -1451,12 +1639,12 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                     }
 #if PRINT_LOG
                     if (print)
-                        printf(" u=%.6lf U=%.3lf dt=%u max_c=%.3lf", qp->hp.u, U, dt, max_c);
+                        printf(" u=%.6lf U=%.3lf dt=%u max_c=%.3lf", qp->hp().u, U, dt, max_c);
 #endif
 #if PRINT_LOG
                     if (print)
                         printf(" rate:%.3lf->%.3lf\n",
-                               qp->hp.m_curRate.GetBitRate() * 1e-9,
+                               qp->hp().m_curRate.GetBitRate() * 1e-9,
                                new_rate.GetBitRate() * 1e-9);
 #endif
                 }
@@ -1469,16 +1657,16 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                 {
                     if (updated[i])
                     {
-                        double c = qp->hp.hopState[i].u / m_targetUtil;
-                        if (c >= 1 || qp->hp.hopState[i].incStage >= m_miThresh)
+                        double c = qp->hp().hopState[i].u / m_targetUtil;
+                        if (c >= 1 || qp->hp().hopState[i].incStage >= m_miThresh)
                         {
-                            new_rate_per_hop[i] = qp->hp.hopState[i].Rc / c + m_rai;
+                            new_rate_per_hop[i] = qp->hp().hopState[i].Rc / c + m_rai;
                             new_incStage_per_hop[i] = 0;
                         }
                         else
                         {
-                            new_rate_per_hop[i] = qp->hp.hopState[i].Rc + m_rai;
-                            new_incStage_per_hop[i] = qp->hp.hopState[i].incStage + 1;
+                            new_rate_per_hop[i] = qp->hp().hopState[i].Rc + m_rai;
+                            new_incStage_per_hop[i] = qp->hp().hopState[i].incStage + 1;
                         }
                         // bound rate
                         if (new_rate_per_hop[i] < m_minRate)
@@ -1496,20 +1684,20 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                         }
 #if PRINT_LOG
                         if (print)
-                            printf(" [%u]u=%.6lf c=%.3lf", i, qp->hp.hopState[i].u, c);
+                            printf(" [%u]u=%.6lf c=%.3lf", i, qp->hp().hopState[i].u, c);
 #endif
 #if PRINT_LOG
                         if (print)
                             printf(" %.3lf->%.3lf",
-                                   qp->hp.hopState[i].Rc.GetBitRate() * 1e-9,
+                                   qp->hp().hopState[i].Rc.GetBitRate() * 1e-9,
                                    new_rate.GetBitRate() * 1e-9);
 #endif
                     }
                     else
                     {
-                        if (qp->hp.hopState[i].Rc < new_rate)
+                        if (qp->hp().hopState[i].Rc < new_rate)
                         {
-                            new_rate = qp->hp.hopState[i].Rc;
+                            new_rate = qp->hp().hopState[i].Rc;
                         }
                     }
                 }
@@ -1526,8 +1714,8 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
             {
                 if (updated_any)
                 {
-                    qp->hp.m_curRate = new_rate;
-                    qp->hp.m_incStage = new_incStage;
+                    qp->hp().m_curRate = new_rate;
+                    qp->hp().m_incStage = new_incStage;
                 }
                 if (m_multipleRate)
                 {
@@ -1536,8 +1724,8 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
                     {
                         if (updated[i])
                         {
-                            qp->hp.hopState[i].Rc = new_rate_per_hop[i];
-                            qp->hp.hopState[i].incStage = new_incStage_per_hop[i];
+                            qp->hp().hopState[i].Rc = new_rate_per_hop[i];
+                            qp->hp().hopState[i].incStage = new_incStage_per_hop[i];
                         }
                     }
                 }
@@ -1545,9 +1733,9 @@ RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, boo
         }
         if (!fast_react)
         {
-            if (next_seq > qp->hp.m_lastUpdateSeq)
+            if (next_seq > qp->hp().m_lastUpdateSeq)
             {
-                qp->hp.m_lastUpdateSeq = next_seq; //+ rand() % 2 * m_mtu;
+                qp->hp().m_lastUpdateSeq = next_seq; //+ rand() % 2 * m_mtu;
             }
         }
     }
@@ -1563,8 +1751,22 @@ RdmaHw::FastReactHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 }
 
 /**********************
- * PowerTCP (Int/Delay versions) called from HandleAckHp function at the moment
+ * PowerTCP (Int/Delay versions), on the HPCC state
  *********************/
+void
+RdmaHw::HandleAckPower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
+{
+    uint32_t ack_seq = ch.ack.seq;
+    // update rate
+    if (ack_seq > qp->hp().m_lastUpdateSeq)
+    { // if full RTT feedback is ready, do full update
+        UpdateRatePower(qp, p, ch, false);
+    }
+    else
+    { // do fast react
+        FastReactPower(qp, p, ch);
+    }
+}
 
 void
 RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool fast_react)
@@ -1573,32 +1775,34 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
     bool print = true;
     double prevRtt = qp->m_baseRtt;
     double prevCompletion = Simulator::Now().GetNanoSeconds();
-    std::map<uint32_t, double>::iterator it = qp->rates.find(ch.ack.seq);
+    RdmaQueuePair::PowerTcpState& powerState = qp->power();
+    std::map<uint32_t, double>::iterator it = powerState.rates.find(ch.ack.seq);
     DataRate old;
     double rtt;
 
-    if (it != qp->rates.end())
+    if (it != powerState.rates.end())
     {
-        qp->rates.erase(it);
-        prevRtt = Simulator::Now().GetNanoSeconds() - it->second;
+        double sent = it->second;
+        powerState.rates.erase(it);
+        prevRtt = Simulator::Now().GetNanoSeconds() - sent;
         if (PowerTCPdelay)
         {
             qp->m_baseRtt =
-                std::min(uint64_t(Simulator::Now().GetNanoSeconds() - it->second), qp->m_baseRtt);
+                std::min(uint64_t(Simulator::Now().GetNanoSeconds() - sent), qp->m_baseRtt);
         }
         prevCompletion = Simulator::Now().GetNanoSeconds();
     }
-    if (qp->hp.m_lastUpdateSeq == 0 && !PowerTCPdelay)
+    if (qp->hp().m_lastUpdateSeq == 0 && !PowerTCPdelay)
     {
-        qp->prevRtt = prevRtt;
-        qp->prevCompletion = Simulator::Now().GetNanoSeconds();
-        qp->hp.m_lastUpdateSeq = next_seq;
+        powerState.prevRtt = prevRtt;
+        powerState.prevCompletion = Simulator::Now().GetNanoSeconds();
+        qp->hp().m_lastUpdateSeq = next_seq;
         // store INT
         IntHeader& ih = ch.ack.ih;
         NS_ASSERT(ih.nhop <= IntHeader::maxHop);
         for (uint32_t i = 0; i < ih.nhop; i++)
         {
-            qp->hp.hop[i] = ih.hop[i];
+            qp->hp().hop[i] = ih.hop[i];
         }
     }
     else
@@ -1626,9 +1830,9 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                 }
                 updated[i] = updated_any = true;
 
-                uint64_t tau = ih.hop[i].GetTimeDelta(qp->hp.hop[i]);
+                uint64_t tau = ih.hop[i].GetTimeDelta(qp->hp().hop[i]);
                 double duration = tau * 1e-9;
-                double rxRate = (ih.hop[i].GetBytesDelta(qp->hp.hop[i])) * 8.0 / duration;
+                double rxRate = (ih.hop[i].GetBytesDelta(qp->hp().hop[i])) * 8.0 / duration;
 
                 double u;
 
@@ -1636,7 +1840,7 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                 {
                     double A = rxRate;
                     // double A = txRate + (double(ih.hop[i].GetQlen() * 8.0) -
-                    // double(qp->hp.hop[i].GetQlen() * 8.0)) / duration;
+                    // double(qp->hp().hop[i].GetQlen() * 8.0)) / duration;
                     double power = (A) * (double(ih.hop[i].GetQlen() * 8.0) +
                                           ih.hop[i].GetLineRate() * (qp->m_baseRtt * 1e-9));
                     double powerx = (power) / (ih.hop[i].GetLineRate() *
@@ -1646,8 +1850,9 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                 else
                 {
                     // delay approach
-                    double A =
-                        (double(prevRtt - qp->prevRtt) / (prevCompletion - qp->prevCompletion) + 1);
+                    double A = (double(prevRtt - powerState.prevRtt) /
+                                    (prevCompletion - powerState.prevCompletion) +
+                                1);
                     if (A < 0.5)
                     {
                         A = 0.5;
@@ -1661,14 +1866,14 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                     U = u;
                     if (PowerTCPdelay)
                     {
-                        dt = prevCompletion - qp->prevCompletion;
+                        dt = prevCompletion - powerState.prevCompletion;
                     }
                     else
                     {
                         dt = tau;
                     }
                 }
-                qp->hp.hop[i] = ih.hop[i];
+                qp->hp().hop[i] = ih.hop[i];
             }
 
             DataRate new_rate;
@@ -1685,21 +1890,21 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
 
                 if (U < 0)
                 {
-                    U = qp->hp.u;
+                    U = qp->hp().u;
                 }
-                qp->hp.u =
-                    (qp->hp.u * (1.0 * qp->m_baseRtt - dt) + U * dt) / double(1.0 * qp->m_baseRtt);
+                qp->hp().u =
+                    (qp->hp().u * (1.0 * qp->m_baseRtt - dt) + U * dt) / double(1.0 * qp->m_baseRtt);
                 if (!PowerTCPdelay)
                 {
-                    max_c = qp->hp.u / m_targetUtil;
-                    new_rate = (0.9 * (qp->hp.m_curRate / max_c + DataRate("150Mbps")) +
-                                0.1 * qp->hp.m_curRate); // gamma (EWMA param) = 0.9 for delay
+                    max_c = qp->hp().u / m_targetUtil;
+                    new_rate = (0.9 * (qp->hp().m_curRate / max_c + DataRate("150Mbps")) +
+                                0.1 * qp->hp().m_curRate); // gamma (EWMA param) = 0.9 for delay
                 }
                 else
                 {
-                    max_c = qp->hp.u;
-                    new_rate = (0.7 * (qp->hp.m_curRate / max_c + DataRate("150Mbps")) +
-                                0.3 * qp->hp.m_curRate); // gamma (EWMA param) = 0.7
+                    max_c = qp->hp().u;
+                    new_rate = (0.7 * (qp->hp().m_curRate / max_c + DataRate("150Mbps")) +
+                                0.3 * qp->hp().m_curRate); // gamma (EWMA param) = 0.7
                 }
                 if (new_rate < m_minRate)
                 {
@@ -1710,8 +1915,8 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                     new_rate = qp->m_max_rate;
                 }
             }
-            qp->prevRtt = prevRtt;
-            qp->prevCompletion = Simulator::Now().GetNanoSeconds();
+            powerState.prevRtt = prevRtt;
+            powerState.prevCompletion = Simulator::Now().GetNanoSeconds();
             if (updated_any)
             {
                 ChangeRate(qp, new_rate);
@@ -1720,16 +1925,16 @@ RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
             {
                 if (updated_any)
                 {
-                    qp->hp.m_curRate = new_rate;
-                    qp->hp.m_incStage = new_incStage;
+                    qp->hp().m_curRate = new_rate;
+                    qp->hp().m_incStage = new_incStage;
                 }
             }
         }
         if (!fast_react)
         {
-            if (next_seq > qp->hp.m_lastUpdateSeq)
+            if (next_seq > qp->hp().m_lastUpdateSeq)
             {
-                qp->hp.m_lastUpdateSeq = next_seq;
+                qp->hp().m_lastUpdateSeq = next_seq;
             }
         }
     }
@@ -1752,7 +1957,7 @@ RdmaHw::HandleAckTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint32_t ack_seq = ch.ack.seq;
     // update rate
-    if (ack_seq > qp->tmly.m_lastUpdateSeq)
+    if (ack_seq > qp->tmly().m_lastUpdateSeq)
     { // if full RTT feedback is ready, do full update
         UpdateRateTimely(qp, p, ch, false);
     }
@@ -1768,10 +1973,10 @@ RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
     uint32_t next_seq = qp->snd_nxt;
     uint64_t rtt = Simulator::Now().GetTimeStep() - ch.ack.ih.ts;
     bool print = !us;
-    if (qp->tmly.m_lastUpdateSeq != 0)
+    if (qp->tmly().m_lastUpdateSeq != 0)
     { // not first RTT
-        int64_t new_rtt_diff = (int64_t)rtt - (int64_t)qp->tmly.lastRtt;
-        double rtt_diff = (1 - m_tmly_alpha) * qp->tmly.rttDiff + m_tmly_alpha * new_rtt_diff;
+        int64_t new_rtt_diff = (int64_t)rtt - (int64_t)qp->tmly().lastRtt;
+        double rtt_diff = (1 - m_tmly_alpha) * qp->tmly().rttDiff + m_tmly_alpha * new_rtt_diff;
         double gradient = rtt_diff / m_tmly_minRtt;
         bool inc = false;
         double c = 0;
@@ -1783,7 +1988,7 @@ RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
                    rtt,
                    rtt_diff,
                    gradient,
-                   qp->tmly.m_curRate.GetBitRate() * 1e-9);
+                   qp->tmly().m_curRate.GetBitRate() * 1e-9);
 #endif
         if (rtt < m_tmly_TLow)
         {
@@ -1809,14 +2014,14 @@ RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
         }
         if (inc)
         {
-            if (qp->tmly.m_incStage < 5)
+            if (qp->tmly().m_incStage < 5)
             // WTF does this mean?
             {
-                qp->m_rate = qp->tmly.m_curRate + m_rai;
+                qp->m_rate = qp->tmly().m_curRate + m_rai;
             }
             else
             {
-                qp->m_rate = qp->tmly.m_curRate + m_rhai;
+                qp->m_rate = qp->tmly().m_curRate + m_rhai;
             }
             if (qp->m_rate > qp->m_max_rate)
             {
@@ -1824,19 +2029,19 @@ RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
             }
             if (!us)
             {
-                qp->tmly.m_curRate = qp->m_rate;
-                qp->tmly.m_incStage++;
-                qp->tmly.rttDiff = rtt_diff;
+                qp->tmly().m_curRate = qp->m_rate;
+                qp->tmly().m_incStage++;
+                qp->tmly().rttDiff = rtt_diff;
             }
         }
         else
         {
-            qp->m_rate = std::max(m_minRate, qp->tmly.m_curRate * c);
+            qp->m_rate = std::max(m_minRate, qp->tmly().m_curRate * c);
             if (!us)
             {
-                qp->tmly.m_curRate = qp->m_rate;
-                qp->tmly.m_incStage = 0;
-                qp->tmly.rttDiff = rtt_diff;
+                qp->tmly().m_curRate = qp->m_rate;
+                qp->tmly().m_incStage = 0;
+                qp->tmly().rttDiff = rtt_diff;
             }
         }
 #if PRINT_LOG
@@ -1846,11 +2051,11 @@ RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
         }
 #endif
     }
-    if (!us && next_seq > qp->tmly.m_lastUpdateSeq)
+    if (!us && next_seq > qp->tmly().m_lastUpdateSeq)
     {
-        qp->tmly.m_lastUpdateSeq = next_seq;
+        qp->tmly().m_lastUpdateSeq = next_seq;
         // update
-        qp->tmly.lastRtt = rtt;
+        qp->tmly().lastRtt = rtt;
     }
 }
 
@@ -1868,118 +2073,118 @@ RdmaHw::HandleAckUfcc(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint32_t ack_seq = ch.ack.seq;
     // update rate
-    //printf("%lu node:%u ack_num: %lu last_ack_num: %lu\n" ,Simulator::Now().GetTimeStep(),m_node->GetId(), ack_seq, qp->ufcc.m_lastUpdateSeq);
+    //printf("%lu node:%u ack_num: %lu last_ack_num: %lu\n" ,Simulator::Now().GetTimeStep(),m_node->GetId(), ack_seq, qp->ufcc().m_lastUpdateSeq);
     uint64_t rtt = Simulator::Now().GetTimeStep() - ch.ack.ih.ts;
 
     //qp->txBytes
-    if(qp->ufcc.lastRtt == 0)
+    if(qp->ufcc().lastRtt == 0)
     {
-        qp->ufcc.arvgRtt = rtt;
+        qp->ufcc().arvgRtt = rtt;
         uint64_t minRtt = qp->m_baseRtt +72;
-        qp->ufcc.minRtt = std::min(rtt , minRtt);
-        qp->ufcc.lastRtt = rtt;
-        qp->ufcc.m_lastUpdateSeq = qp->snd_nxt;
+        qp->ufcc().minRtt = std::min(rtt , minRtt);
+        qp->ufcc().lastRtt = rtt;
+        qp->ufcc().m_lastUpdateSeq = qp->snd_nxt;
         return;
     }
 
-    qp->ufcc.minRtt = std::min(rtt,qp->ufcc.minRtt);
+    qp->ufcc().minRtt = std::min(rtt,qp->ufcc().minRtt);
     
         
-    if(rtt>qp->ufcc.minRtt + burst_rtt)
+    if(rtt>qp->ufcc().minRtt + burst_rtt)
     {
-        qp->ufcc.state = qp->BURST;
+        qp->ufcc().state = qp->BURST;
 
     }
 
-    if (ack_seq > qp->ufcc.m_lastUpdateSeq )
+    if (ack_seq > qp->ufcc().m_lastUpdateSeq )
     { // if full RTT feedback is ready, do full update
 
         UpdateRateUfcc(qp, p, ch, false);
 
 
-    }else if(ack_seq <= qp->ufcc.m_lastUpdateSeq)
+    }else if(ack_seq <= qp->ufcc().m_lastUpdateSeq)
     {
          // do fast react
 
 
-        if(qp->ufcc.state == qp->INIT)
+        if(qp->ufcc().state == qp->INIT)
         {
    
-            if(rtt <= qp->ufcc.lastRtt)
+            if(rtt <= qp->ufcc().lastRtt)
             {
-                qp->ufcc.high = false;
+                qp->ufcc().high = false;
                 
-                qp->m_rate = std::min(qp->m_rate + qp->ufcc.up_rate,qp->ufcc.high_rate );
+                qp->m_rate = std::min(qp->m_rate + qp->ufcc().up_rate,qp->ufcc().high_rate );
 
-                    //printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                    //printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
                     
 
                     
             }else
             {
-                qp->ufcc.low = false;
-                qp->m_rate = std::max(qp->m_rate - qp->ufcc.down_rate ,qp->ufcc.low_rate);   
-                //printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().low = false;
+                qp->m_rate = std::max(qp->m_rate - qp->ufcc().down_rate ,qp->ufcc().low_rate);   
+                //printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
-                    //("ack:%u down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", ack_seq, qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                    //("ack:%u down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", ack_seq, qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
             }
 
             //printf("node:%u rtt_diff: %f\n", m_node->GetId(),rtt_diff-1);
-        }else if (qp->ufcc.state == qp->STEADY)
+        }else if (qp->ufcc().state == qp->STEADY)
         {
-            if(rtt <= qp->ufcc.arvgRtt)
+            if(rtt <= qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.high_rate;
+                qp->m_rate = qp->ufcc().high_rate;
                 //printf("node: %u low rate\n", m_node->GetId());
 
-            }else if(rtt > qp->ufcc.arvgRtt)
+            }else if(rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate;
+                qp->m_rate = qp->ufcc().low_rate;
               
             }
 
-            if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt && rtt > qp->ufcc.arvgRtt)
+            if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt && rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate*0.95;
+                qp->m_rate = qp->ufcc().low_rate*0.95;
 
             }
 
-            if (qp->ufcc.arvgRtt < qp->ufcc.minRtt + 0.7*(low_rtt + high_rtt))
+            if (qp->ufcc().arvgRtt < qp->ufcc().minRtt + 0.7*(low_rtt + high_rtt))
             {
-                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc.high_rate*1.05);
+                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc().high_rate*1.05);
 
             }
 
 
-            if( rtt < qp->ufcc.minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
+            if( rtt < qp->ufcc().minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
             {
-                qp->ufcc.state_count++;
+                qp->ufcc().state_count++;
             }else
             {
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state_count = 0;
             }
 
-            if(qp->ufcc.state_count >= 3)
+            if(qp->ufcc().state_count >= 3)
             {
-                qp->ufcc.high_rate = qp->m_max_rate;
+                qp->ufcc().high_rate = qp->m_max_rate;
 
-                qp->m_rate = qp->ufcc.high_rate;
-                qp->ufcc.up_rate = 0;
-                qp->ufcc.down_rate = 1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);   
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
+                qp->m_rate = qp->ufcc().high_rate;
+                qp->ufcc().up_rate = 0;
+                qp->ufcc().down_rate = 1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);   
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
                 
-                qp->ufcc.state = qp->INIT;
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state = qp->INIT;
+                qp->ufcc().state_count = 0;
             }
 
-        }else if (qp->ufcc.state == qp->BURST)
+        }else if (qp->ufcc().state == qp->BURST)
         {
-            qp->m_rate = std::max(0.5*qp->ufcc.low_rate , m_minRate);
-            if( rtt <= qp->ufcc.minRtt + burst_rtt)
+            qp->m_rate = std::max(0.5*qp->ufcc().low_rate , m_minRate);
+            if( rtt <= qp->ufcc().minRtt + burst_rtt)
             {
-                qp->m_rate = std::min((0.99*qp->ufcc.low_rate+ qp->ufcc.high_rate)/2, 2*0.99*qp->ufcc.low_rate);
+                qp->m_rate = std::min((0.99*qp->ufcc().low_rate+ qp->ufcc().high_rate)/2, 2*0.99*qp->ufcc().low_rate);
                
             }
 
@@ -2000,174 +2205,174 @@ RdmaHw::UpdateRateUfcc(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, b
 
 
 
-    if (qp->ufcc.lastRtt != 0)
+    if (qp->ufcc().lastRtt != 0)
     { // not first RTT
 
 
-        //printf("%lu node:%u rtt_diff:%f rate:%lu tar_rate:%lu Rtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(), rtt_diff , qp->m_rate.GetBitRate(),qp->ufcc.m_tarRate.GetBitRate(), rtt);
+        //printf("%lu node:%u rtt_diff:%f rate:%lu tar_rate:%lu Rtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(), rtt_diff , qp->m_rate.GetBitRate(),qp->ufcc().m_tarRate.GetBitRate(), rtt);
 
 
 
 
-        if(qp->ufcc.state == qp->INIT)
+        if(qp->ufcc().state == qp->INIT)
         {
-            if(rtt <= qp->ufcc.lastRtt)
+            if(rtt <= qp->ufcc().lastRtt)
             {
-                qp->ufcc.high = false;               
-                qp->m_rate = std::min(qp->m_rate + qp->ufcc.up_rate,qp->ufcc.high_rate );
-               // printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().high = false;               
+                qp->m_rate = std::min(qp->m_rate + qp->ufcc().up_rate,qp->ufcc().high_rate );
+               // printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
                 
             }else 
             {
-                qp->ufcc.low = false;
-                qp->m_rate = std::max(qp->m_rate - qp->ufcc.down_rate ,qp->ufcc.low_rate);   
-               // printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().low = false;
+                qp->m_rate = std::max(qp->m_rate - qp->ufcc().down_rate ,qp->ufcc().low_rate);   
+               // printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
             }
 
-            if(qp->ufcc.wait_count == 0)
+            if(qp->ufcc().wait_count == 0)
             {
-                if(qp->ufcc.low )
+                if(qp->ufcc().low )
                 {
-                    qp->ufcc.low_rate = qp->ufcc.last_rate;
+                    qp->ufcc().low_rate = qp->ufcc().last_rate;
                 }
             }else
             {
-                qp->ufcc.wait_count --;
+                qp->ufcc().wait_count --;
             }
 
 
-            if(qp->ufcc.high)
+            if(qp->ufcc().high)
             {
-                qp->ufcc.high_rate = qp->ufcc.last_rate;
+                qp->ufcc().high_rate = qp->ufcc().last_rate;
             }
 
-            qp->ufcc.low = true;
-            qp->ufcc.high = true;
+            qp->ufcc().low = true;
+            qp->ufcc().high = true;
 
-            if(qp->ufcc.low_rate  >= 0.95*qp->ufcc.high_rate)
+            if(qp->ufcc().low_rate  >= 0.95*qp->ufcc().high_rate)
             {
-                if(qp->ufcc.arvgRtt <= qp->ufcc.minRtt +  high_rtt)
+                if(qp->ufcc().arvgRtt <= qp->ufcc().minRtt +  high_rtt)
             {
-                qp->ufcc.state_count = 0;
-                qp->ufcc.state = qp->STEADY;
-                }else if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt)
+                qp->ufcc().state_count = 0;
+                qp->ufcc().state = qp->STEADY;
+                }else if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt)
                 {
 
-                    qp->ufcc.state_count = qp->ufcc.state_count+3;
+                    qp->ufcc().state_count = qp->ufcc().state_count+3;
                 }else
         {
-            qp->ufcc.state_count++;
+            qp->ufcc().state_count++;
                 }
-                if(qp->ufcc.state_count >= 5)
+                if(qp->ufcc().state_count >= 5)
             {
-                    qp->m_rate = std::max(qp->ufcc.low_rate - 0.1*m_minRate,m_minRate);
-                    qp->ufcc.low_rate = qp->m_rate;
-                qp->ufcc.state_count = 0;
+                    qp->m_rate = std::max(qp->ufcc().low_rate - 0.1*m_minRate,m_minRate);
+                    qp->ufcc().low_rate = qp->m_rate;
+                qp->ufcc().state_count = 0;
                 }
                 
             }
 
 
-            qp->m_rate = std::max(qp->ufcc.low_rate , qp->m_rate);
-            qp->m_rate = std::min(qp->ufcc.high_rate , qp->m_rate);
+            qp->m_rate = std::max(qp->ufcc().low_rate , qp->m_rate);
+            qp->m_rate = std::min(qp->ufcc().high_rate , qp->m_rate);
             
-            qp->ufcc.up_rate = 1000* std::min(0.5*(qp->ufcc.high_rate - qp->m_rate),qp->ufcc.high_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
-            qp->ufcc.down_rate =1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
+            qp->ufcc().up_rate = 1000* std::min(0.5*(qp->ufcc().high_rate - qp->m_rate),qp->ufcc().high_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
+            qp->ufcc().down_rate =1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
 
 
 
-        }else if (qp->ufcc.state == qp->STEADY)
+        }else if (qp->ufcc().state == qp->STEADY)
         {
-            if(rtt <= qp->ufcc.arvgRtt)
+            if(rtt <= qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.high_rate;
+                qp->m_rate = qp->ufcc().high_rate;
                 //printf("node: %u low rate\n", m_node->GetId());
 
-            }else if(rtt > qp->ufcc.arvgRtt)
+            }else if(rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate;
+                qp->m_rate = qp->ufcc().low_rate;
                 
 
             }
 
-            if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt  && rtt > qp->ufcc.arvgRtt)
+            if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt  && rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate*0.95;
+                qp->m_rate = qp->ufcc().low_rate*0.95;
 
             }
-            if (qp->ufcc.arvgRtt < qp->ufcc.minRtt + 0.7*(low_rtt + high_rtt))
+            if (qp->ufcc().arvgRtt < qp->ufcc().minRtt + 0.7*(low_rtt + high_rtt))
             {
-                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc.high_rate*1.05);
+                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc().high_rate*1.05);
 
             }
 
 
 
-            if( rtt < qp->ufcc.minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
+            if( rtt < qp->ufcc().minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
             {
-                qp->ufcc.state_count++;
+                qp->ufcc().state_count++;
             }else
             {
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state_count = 0;
             }
 
-            if(qp->ufcc.state_count >= 3)
+            if(qp->ufcc().state_count >= 3)
             {
-                qp->ufcc.high_rate = qp->m_max_rate;
+                qp->ufcc().high_rate = qp->m_max_rate;
 
-                qp->m_rate = qp->ufcc.high_rate;
-                qp->ufcc.up_rate = 0;
-                qp->ufcc.down_rate = 1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);   
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
-                qp->ufcc.state_count = 0;
-                qp->ufcc.state = qp->INIT;
+                qp->m_rate = qp->ufcc().high_rate;
+                qp->ufcc().up_rate = 0;
+                qp->ufcc().down_rate = 1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);   
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
+                qp->ufcc().state_count = 0;
+                qp->ufcc().state = qp->INIT;
             }
 
 
 
-        }else if (qp->ufcc.state == qp->RELEASE)
+        }else if (qp->ufcc().state == qp->RELEASE)
         {
             /* code */
-        }else if (qp->ufcc.state == qp->PREEMPT)
+        }else if (qp->ufcc().state == qp->PREEMPT)
         {
 
 
 
-        }else if (qp->ufcc.state == qp->BURST)
+        }else if (qp->ufcc().state == qp->BURST)
         {
-            if(rtt <=qp->ufcc.minRtt + burst_rtt)
+            if(rtt <=qp->ufcc().minRtt + burst_rtt)
             {
-                if(qp->ufcc.low_rate >= 0.8*qp->ufcc.high_rate)
+                if(qp->ufcc().low_rate >= 0.8*qp->ufcc().high_rate)
                 {
-                    qp->ufcc.high_rate =  (qp->m_max_rate+qp->ufcc.high_rate)/2;
+                    qp->ufcc().high_rate =  (qp->m_max_rate+qp->ufcc().high_rate)/2;
             }else
             {
-                    qp->ufcc.high_rate = (qp->ufcc.low_rate + qp->ufcc.high_rate)/2;
+                    qp->ufcc().high_rate = (qp->ufcc().low_rate + qp->ufcc().high_rate)/2;
             }
 
-                qp->ufcc.low_rate = std::max(0.99*qp->ufcc.low_rate, m_minRate);
+                qp->ufcc().low_rate = std::max(0.99*qp->ufcc().low_rate, m_minRate);
 
-                qp->m_rate = std::min((qp->ufcc.low_rate+ qp->ufcc.high_rate)/2, 2*qp->ufcc.low_rate);
-                qp->ufcc.down_rate =1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
+                qp->m_rate = std::min((qp->ufcc().low_rate+ qp->ufcc().high_rate)/2, 2*qp->ufcc().low_rate);
+                qp->ufcc().down_rate =1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
 
-                qp->ufcc.up_rate = 1000* std::min(0.5*(qp->ufcc.high_rate - qp->m_rate),qp->ufcc.high_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
-                qp->ufcc.down_rate = 0;
-                    qp->ufcc.state_count = 0;
-                    qp->ufcc.state = qp->INIT;
+                qp->ufcc().up_rate = 1000* std::min(0.5*(qp->ufcc().high_rate - qp->m_rate),qp->ufcc().high_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
+                qp->ufcc().down_rate = 0;
+                    qp->ufcc().state_count = 0;
+                    qp->ufcc().state = qp->INIT;
 
             }
         }
         
-         qp->ufcc.last_rate = qp->m_rate;  
-        qp->ufcc.arvgRtt = 0.3*qp->ufcc.arvgRtt + 0.7*rtt;
-        qp->ufcc.m_lastUpdateSeq = qp->snd_nxt;
-        qp->ufcc.lastRtt = rtt;
-        //qp->SetWin(qp->ufcc.base_win * rtt/qp->m_baseRtt);
-        //printf("%lu node:%u pg:%u aveRTT: %lu STATE:%u win:%u rate:%lu last_rtt: %lu rtt: %lu low_rate:%lu high_rate:%lu up_rate: %lu down_rate:%lu minRtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(),qp->m_pg,qp->ufcc.arvgRtt, qp->ufcc.state, qp->m_win  ,qp->m_rate.GetBitRate() , qp->ufcc.lastRtt, rtt,qp->ufcc.low_rate.GetBitRate(), qp->ufcc.high_rate.GetBitRate(),qp->ufcc.up_rate,qp->ufcc.down_rate,qp->ufcc.minRtt);
+         qp->ufcc().last_rate = qp->m_rate;  
+        qp->ufcc().arvgRtt = 0.3*qp->ufcc().arvgRtt + 0.7*rtt;
+        qp->ufcc().m_lastUpdateSeq = qp->snd_nxt;
+        qp->ufcc().lastRtt = rtt;
+        //qp->SetWin(qp->ufcc().base_win * rtt/qp->m_baseRtt);
+        //printf("%lu node:%u pg:%u aveRTT: %lu STATE:%u win:%u rate:%lu last_rtt: %lu rtt: %lu low_rate:%lu high_rate:%lu up_rate: %lu down_rate:%lu minRtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(),qp->m_pg,qp->ufcc().arvgRtt, qp->ufcc().state, qp->m_win  ,qp->m_rate.GetBitRate() , qp->ufcc().lastRtt, rtt,qp->ufcc().low_rate.GetBitRate(), qp->ufcc().high_rate.GetBitRate(),qp->ufcc().up_rate,qp->ufcc().down_rate,qp->ufcc().minRtt);
 
     }
 
@@ -2183,121 +2388,128 @@ RdmaHw::UpdateRateUfcc(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, b
 /**********************
  * UFCC CWND
  *********************/
+void
+RdmaHw::HandleAckUfcwndDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
+{
+    HandleAckUfcwnd(qp, p, ch);
+    HandleAckDctcp(qp, p, ch);
+}
+
 void
 RdmaHw::HandleAckUfcwnd(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint32_t ack_seq = ch.ack.seq;
     // update rate
-    //printf("%lu node:%u ack_num: %lu last_ack_num: %lu\n" ,Simulator::Now().GetTimeStep(),m_node->GetId(), ack_seq, qp->ufcc.m_lastUpdateSeq);
+    //printf("%lu node:%u ack_num: %lu last_ack_num: %lu\n" ,Simulator::Now().GetTimeStep(),m_node->GetId(), ack_seq, qp->ufcc().m_lastUpdateSeq);
     uint64_t rtt = Simulator::Now().GetTimeStep() - ch.ack.ih.ts;
     //qp->txBytes
-    if(qp->ufcc.lastRtt == 0)
+    if(qp->ufcc().lastRtt == 0)
     {
-        qp->ufcc.arvgRtt = rtt;
+        qp->ufcc().arvgRtt = rtt;
         uint64_t minRtt = m_tmly_minRtt;
-        qp->ufcc.minRtt = std::min(rtt , minRtt);
-        qp->ufcc.lastRtt = rtt;
-        qp->ufcc.m_lastUpdateSeq = qp->snd_nxt;
+        qp->ufcc().minRtt = std::min(rtt , minRtt);
+        qp->ufcc().lastRtt = rtt;
+        qp->ufcc().m_lastUpdateSeq = qp->snd_nxt;
         return;
     }
 
-    qp->ufcc.minRtt = std::min(rtt,qp->ufcc.minRtt);
+    qp->ufcc().minRtt = std::min(rtt,qp->ufcc().minRtt);
     
         
-    if(rtt>qp->ufcc.minRtt + burst_rtt)
+    if(rtt>qp->ufcc().minRtt + burst_rtt)
     {
-        qp->ufcc.state = qp->BURST;
+        qp->ufcc().state = qp->BURST;
     }
 
-    if (ack_seq > qp->ufcc.m_lastUpdateSeq )
+    if (ack_seq > qp->ufcc().m_lastUpdateSeq )
     { // if full RTT feedback is ready, do full update
 
         UpdateStateUfcwnd(qp, p, ch, false);
 
 
-    }else if(ack_seq <= qp->ufcc.m_lastUpdateSeq)
+    }else if(ack_seq <= qp->ufcc().m_lastUpdateSeq)
     {
          // do fast react
 
 
-        if(qp->ufcc.state == qp->INIT)
+        if(qp->ufcc().state == qp->INIT)
         {
    
-            if(rtt <= qp->ufcc.lastRtt)
+            if(rtt <= qp->ufcc().lastRtt)
             {
-                qp->ufcc.high = false;
+                qp->ufcc().high = false;
                 
-                qp->m_rate = std::min(qp->m_rate + qp->ufcc.up_rate,qp->ufcc.high_rate );
+                qp->m_rate = std::min(qp->m_rate + qp->ufcc().up_rate,qp->ufcc().high_rate );
 
-                    //printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                    //printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
                     
 
                     
             }else
             {
-                qp->ufcc.low = false;
-                qp->m_rate = std::max(qp->m_rate - qp->ufcc.down_rate ,qp->ufcc.low_rate);   
-                //printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().low = false;
+                qp->m_rate = std::max(qp->m_rate - qp->ufcc().down_rate ,qp->ufcc().low_rate);   
+                //printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
-                    //("ack:%u down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", ack_seq, qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                    //("ack:%u down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", ack_seq, qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
             }
 
             //printf("node:%u rtt_diff: %f\n", m_node->GetId(),rtt_diff-1);
-        }else if (qp->ufcc.state == qp->STEADY)
+        }else if (qp->ufcc().state == qp->STEADY)
         {
-            if(rtt <= qp->ufcc.arvgRtt)
+            if(rtt <= qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.high_rate;
+                qp->m_rate = qp->ufcc().high_rate;
                 //printf("node: %u low rate\n", m_node->GetId());
 
-            }else if(rtt > qp->ufcc.arvgRtt)
+            }else if(rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate;
+                qp->m_rate = qp->ufcc().low_rate;
               
             }
 
-            if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt && rtt > qp->ufcc.arvgRtt)
+            if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt && rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate*0.95;
+                qp->m_rate = qp->ufcc().low_rate*0.95;
 
             }
-            if (qp->ufcc.arvgRtt < qp->ufcc.minRtt + 0.7*(low_rtt + high_rtt))
+            if (qp->ufcc().arvgRtt < qp->ufcc().minRtt + 0.7*(low_rtt + high_rtt))
             {
-                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc.high_rate*1.05);
+                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc().high_rate*1.05);
 
             }
 
 
-            if( rtt < qp->ufcc.minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
+            if( rtt < qp->ufcc().minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
             {
-                qp->ufcc.state_count++;
+                qp->ufcc().state_count++;
             }else
             {
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state_count = 0;
             }
 
-            if(qp->ufcc.state_count >= 1)
+            if(qp->ufcc().state_count >= 1)
             {
-                qp->ufcc.high_rate = qp->m_max_rate;
+                qp->ufcc().high_rate = qp->m_max_rate;
 
-                qp->m_rate = qp->ufcc.high_rate;
-                qp->ufcc.up_rate = 0;
-                qp->ufcc.down_rate = 1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);   
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
+                qp->m_rate = qp->ufcc().high_rate;
+                qp->ufcc().up_rate = 0;
+                qp->ufcc().down_rate = 1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);   
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
                 
-                qp->ufcc.state = qp->INIT;
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state = qp->INIT;
+                qp->ufcc().state_count = 0;
             }
 
-        }else if (qp->ufcc.state == qp->BURST)
+        }else if (qp->ufcc().state == qp->BURST)
         {
-            qp->m_rate = std::max(0.1*qp->ufcc.low_rate , m_minRate);
+            qp->m_rate = std::max(0.1*qp->ufcc().low_rate , m_minRate);
    
-            if( rtt <= qp->ufcc.minRtt + burst_rtt)
+            if( rtt <= qp->ufcc().minRtt + burst_rtt)
             {
-                qp->m_rate = std::min((0.9*qp->ufcc.low_rate+ qp->ufcc.high_rate)/2, 2*0.9*qp->ufcc.low_rate);
+                qp->m_rate = std::min((0.9*qp->ufcc().low_rate+ qp->ufcc().high_rate)/2, 2*0.9*qp->ufcc().low_rate);
                
             }
 
@@ -2318,167 +2530,167 @@ RdmaHw::UpdateStateUfcwnd(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch
 
 
 
-    if (qp->ufcc.lastRtt != 0)
+    if (qp->ufcc().lastRtt != 0)
     { // not first RTT
 
 
-        //printf("%lu node:%u rtt_diff:%f rate:%lu tar_rate:%lu Rtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(), rtt_diff , qp->m_rate.GetBitRate(),qp->ufcc.m_tarRate.GetBitRate(), rtt);
+        //printf("%lu node:%u rtt_diff:%f rate:%lu tar_rate:%lu Rtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(), rtt_diff , qp->m_rate.GetBitRate(),qp->ufcc().m_tarRate.GetBitRate(), rtt);
 
 
 
 
-        if(qp->ufcc.state == qp->INIT)
+        if(qp->ufcc().state == qp->INIT)
         {
-            if(rtt <= qp->ufcc.lastRtt)
+            if(rtt <= qp->ufcc().lastRtt)
             {
-                qp->ufcc.high = false;               
-                qp->m_rate = std::min(qp->m_rate + qp->ufcc.up_rate,qp->ufcc.high_rate );
-               // printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().high = false;               
+                qp->m_rate = std::min(qp->m_rate + qp->ufcc().up_rate,qp->ufcc().high_rate );
+               // printf("node:%u rtt_diff: %f up rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
 
                 
             }else 
             {
-                qp->ufcc.low = false;
-                qp->m_rate = std::max(qp->m_rate - qp->ufcc.down_rate ,qp->ufcc.low_rate);   
-               // printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc.down_rate, qp->m_rate, rtt, qp->ufcc.lastRtt);
+                qp->ufcc().low = false;
+                qp->m_rate = std::max(qp->m_rate - qp->ufcc().down_rate ,qp->ufcc().low_rate);   
+               // printf("node:%u rtt_diff: %f down rate: %lu current rate: %lu rtt: %lu last rtt: %lu\n", m_node->GetId(), qp->ufcc().down_rate, qp->m_rate, rtt, qp->ufcc().lastRtt);
             }
 
-            if(qp->ufcc.low )
+            if(qp->ufcc().low )
             {
-                qp->ufcc.low_rate = qp->ufcc.last_rate;
+                qp->ufcc().low_rate = qp->ufcc().last_rate;
             }
-            if(qp->ufcc.high)
+            if(qp->ufcc().high)
             {
-                qp->ufcc.high_rate = qp->ufcc.last_rate;
+                qp->ufcc().high_rate = qp->ufcc().last_rate;
             }
 
-            qp->ufcc.low = true;
-            qp->ufcc.high = true;
+            qp->ufcc().low = true;
+            qp->ufcc().high = true;
 
-            if(qp->ufcc.low_rate  >= 0.95*qp->ufcc.high_rate)
+            if(qp->ufcc().low_rate  >= 0.95*qp->ufcc().high_rate)
             {
-                if(qp->ufcc.arvgRtt <= qp->ufcc.minRtt + 0.5*(low_rtt + high_rtt))
+                if(qp->ufcc().arvgRtt <= qp->ufcc().minRtt + 0.5*(low_rtt + high_rtt))
             {
-                qp->ufcc.state_count = 0;
-                qp->ufcc.state = qp->STEADY;
-                }else if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt)
+                qp->ufcc().state_count = 0;
+                qp->ufcc().state = qp->STEADY;
+                }else if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt)
                 {
 
-                    qp->ufcc.state_count = qp->ufcc.state_count+3;
+                    qp->ufcc().state_count = qp->ufcc().state_count+3;
                 }else
         {
-            qp->ufcc.state_count++;
+            qp->ufcc().state_count++;
                 }
-                if(qp->ufcc.state_count >= 5)
+                if(qp->ufcc().state_count >= 5)
             {
-                    qp->m_rate = std::max(qp->ufcc.low_rate - 0.1*m_minRate,m_minRate);
-                    qp->ufcc.low_rate = qp->m_rate;
-                qp->ufcc.state_count = 0;
+                    qp->m_rate = std::max(qp->ufcc().low_rate - 0.1*m_minRate,m_minRate);
+                    qp->ufcc().low_rate = qp->m_rate;
+                qp->ufcc().state_count = 0;
                 }
                 
             }
 
 
-            qp->m_rate = std::max(qp->ufcc.low_rate , qp->m_rate);
-            qp->m_rate = std::min(qp->ufcc.high_rate , qp->m_rate);
+            qp->m_rate = std::max(qp->ufcc().low_rate , qp->m_rate);
+            qp->m_rate = std::min(qp->ufcc().high_rate , qp->m_rate);
             
-            qp->ufcc.up_rate = 1000* std::min(0.5*(qp->ufcc.high_rate - qp->m_rate),qp->ufcc.high_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
-            qp->ufcc.down_rate =1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
+            qp->ufcc().up_rate = 1000* std::min(0.5*(qp->ufcc().high_rate - qp->m_rate),qp->ufcc().high_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
+            qp->ufcc().down_rate =1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
 
 
 
-        }else if (qp->ufcc.state == qp->STEADY)
+        }else if (qp->ufcc().state == qp->STEADY)
         {
-            if(rtt <= qp->ufcc.arvgRtt)
+            if(rtt <= qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.high_rate;
+                qp->m_rate = qp->ufcc().high_rate;
                 //printf("node: %u low rate\n", m_node->GetId());
 
-            }else if(rtt > qp->ufcc.arvgRtt)
+            }else if(rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate;
+                qp->m_rate = qp->ufcc().low_rate;
                 
 
             }
 
-            if(qp->ufcc.arvgRtt > qp->ufcc.minRtt + high_rtt  && rtt > qp->ufcc.arvgRtt)
+            if(qp->ufcc().arvgRtt > qp->ufcc().minRtt + high_rtt  && rtt > qp->ufcc().arvgRtt)
             {
-                qp->m_rate = qp->ufcc.low_rate*0.95;
+                qp->m_rate = qp->ufcc().low_rate*0.95;
 
             }
-            if (qp->ufcc.arvgRtt < qp->ufcc.minRtt + 0.7*(low_rtt + high_rtt))
+            if (qp->ufcc().arvgRtt < qp->ufcc().minRtt + 0.7*(low_rtt + high_rtt))
             {
-                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc.high_rate*1.05);
+                qp->m_rate = std::min(qp->m_max_rate,qp->ufcc().high_rate*1.05);
 
             }
 
 
 
-            if( rtt < qp->ufcc.minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
+            if( rtt < qp->ufcc().minRtt + 0.25*low_rtt && qp->m_rate != qp->m_max_rate)
             {
-                qp->ufcc.state_count++;
+                qp->ufcc().state_count++;
             }else
             {
-                qp->ufcc.state_count = 0;
+                qp->ufcc().state_count = 0;
             }
 
-            if(qp->ufcc.state_count >= 1)
+            if(qp->ufcc().state_count >= 1)
             {
-                qp->ufcc.high_rate = qp->m_max_rate;
+                qp->ufcc().high_rate = qp->m_max_rate;
 
-                qp->m_rate = qp->ufcc.high_rate;
-                qp->ufcc.up_rate = 0;
-                qp->ufcc.down_rate = 1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);   
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
-                qp->ufcc.state_count = 0;
-                qp->ufcc.state = qp->INIT;
+                qp->m_rate = qp->ufcc().high_rate;
+                qp->ufcc().up_rate = 0;
+                qp->ufcc().down_rate = 1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);   
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
+                qp->ufcc().state_count = 0;
+                qp->ufcc().state = qp->INIT;
             }
 
 
 
-        }else if (qp->ufcc.state == qp->RELEASE)
+        }else if (qp->ufcc().state == qp->RELEASE)
         {
             /* code */
-        }else if (qp->ufcc.state == qp->PREEMPT)
+        }else if (qp->ufcc().state == qp->PREEMPT)
         {
 
 
 
-        }else if (qp->ufcc.state == qp->BURST)
+        }else if (qp->ufcc().state == qp->BURST)
         {
-            if(rtt <=qp->ufcc.minRtt + burst_rtt)
+            if(rtt <=qp->ufcc().minRtt + burst_rtt)
             {
-                if(qp->ufcc.low_rate >= 0.8*qp->ufcc.high_rate)
+                if(qp->ufcc().low_rate >= 0.8*qp->ufcc().high_rate)
                 {
-                    qp->ufcc.high_rate =  (qp->m_max_rate+qp->ufcc.high_rate)/2;
+                    qp->ufcc().high_rate =  (qp->m_max_rate+qp->ufcc().high_rate)/2;
             }else
             {
-                    qp->ufcc.high_rate = (qp->ufcc.low_rate + qp->ufcc.high_rate)/2;
+                    qp->ufcc().high_rate = (qp->ufcc().low_rate + qp->ufcc().high_rate)/2;
             }
 
-                qp->ufcc.low_rate = std::max(0.9*qp->ufcc.low_rate, m_minRate);
+                qp->ufcc().low_rate = std::max(0.9*qp->ufcc().low_rate, m_minRate);
 
-                qp->m_rate = std::min((qp->ufcc.low_rate+ qp->ufcc.high_rate)/2, 2*qp->ufcc.low_rate);
-                qp->ufcc.down_rate =1000*0.5* (qp->m_rate - qp->ufcc.low_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
+                qp->m_rate = std::min((qp->ufcc().low_rate+ qp->ufcc().high_rate)/2, 2*qp->ufcc().low_rate);
+                qp->ufcc().down_rate =1000*0.5* (qp->m_rate - qp->ufcc().low_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
 
-                qp->ufcc.up_rate = 1000* std::min(0.5*(qp->ufcc.high_rate - qp->m_rate),qp->ufcc.high_rate)/(qp->snd_nxt - qp->ufcc.m_lastUpdateSeq);
-                qp->ufcc.low = false;
-                qp->ufcc.high = false;
-                qp->ufcc.down_rate = 0;
-                    qp->ufcc.state_count = 0;
-                    qp->ufcc.state = qp->INIT;
+                qp->ufcc().up_rate = 1000* std::min(0.5*(qp->ufcc().high_rate - qp->m_rate),qp->ufcc().high_rate)/(qp->snd_nxt - qp->ufcc().m_lastUpdateSeq);
+                qp->ufcc().low = false;
+                qp->ufcc().high = false;
+                qp->ufcc().down_rate = 0;
+                    qp->ufcc().state_count = 0;
+                    qp->ufcc().state = qp->INIT;
 
             }
         }
         
-         qp->ufcc.last_rate = qp->m_rate;  
-        //printf("%lu node:%u aveRTT: %lu STATE:%u rate:%lu rtt_diff:%f last_rtt: %lu rtt: %lu low_rate:%lu high_rate:%lu up_rate: %lu down_rate:%lu minRtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(),qp->ufcc.arvgRtt, qp->ufcc.state, qp->m_rate.GetBitRate(),  rtt_diff , qp->ufcc.lastRtt, rtt,qp->ufcc.low_rate.GetBitRate(), qp->ufcc.high_rate.GetBitRate(),qp->ufcc.up_rate,qp->ufcc.down_rate,qp->ufcc.minRtt);
-        qp->ufcc.arvgRtt = 0.3*qp->ufcc.arvgRtt + 0.7*rtt;
-        uint32_t new_win = qp->ufcc.base_win*rtt/qp->m_baseRtt;
+         qp->ufcc().last_rate = qp->m_rate;  
+        //printf("%lu node:%u aveRTT: %lu STATE:%u rate:%lu rtt_diff:%f last_rtt: %lu rtt: %lu low_rate:%lu high_rate:%lu up_rate: %lu down_rate:%lu minRtt:%lu\n",Simulator::Now().GetTimeStep(),m_node->GetId(),qp->ufcc().arvgRtt, qp->ufcc().state, qp->m_rate.GetBitRate(),  rtt_diff , qp->ufcc().lastRtt, rtt,qp->ufcc().low_rate.GetBitRate(), qp->ufcc().high_rate.GetBitRate(),qp->ufcc().up_rate,qp->ufcc().down_rate,qp->ufcc().minRtt);
+        qp->ufcc().arvgRtt = 0.3*qp->ufcc().arvgRtt + 0.7*rtt;
+        uint32_t new_win = qp->ufcc().base_win*rtt/qp->m_baseRtt;
         qp->SetWin(new_win);
-        qp->ufcc.m_lastUpdateSeq = qp->snd_nxt;
-        qp->ufcc.lastRtt = rtt;
+        qp->ufcc().m_lastUpdateSeq = qp->snd_nxt;
+        qp->ufcc().lastRtt = rtt;
     }
 
         
@@ -2500,7 +2712,7 @@ RdmaHw::HandleAckPatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeade
 {
     uint32_t ack_seq = ch.ack.seq;
     // update rate
-    if (ack_seq > qp->tmly.m_lastUpdateSeq)
+    if (ack_seq > qp->tmly().m_lastUpdateSeq)
     { // if full RTT feedback is ready, do full update
         UpdateRatePatchedTimely(qp, p, ch, false);
     }
@@ -2517,11 +2729,11 @@ RdmaHw::UpdateRatePatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHead
     uint64_t currTime = Simulator::Now().GetNanoSeconds();
     uint64_t rtt = currTime - ch.ack.ih.ts;
     bool print = !us;
-    if (qp->tmly.m_lastUpdateSeq != 0)
+    if (qp->tmly().m_lastUpdateSeq != 0)
     { // not first RTT
-        int64_t new_rtt_diff = (int64_t)rtt - (int64_t)qp->tmly.lastRtt;
-        qp->tmly.lastRtt = rtt;
-        double rtt_diff = (1 - m_tmly_alpha) * qp->tmly.rttDiff + m_tmly_alpha * new_rtt_diff;
+        int64_t new_rtt_diff = (int64_t)rtt - (int64_t)qp->tmly().lastRtt;
+        qp->tmly().lastRtt = rtt;
+        double rtt_diff = (1 - m_tmly_alpha) * qp->tmly().rttDiff + m_tmly_alpha * new_rtt_diff;
         double gradient = rtt_diff / m_tmly_minRtt;
         double weight;
         DataRate new_rate;
@@ -2534,17 +2746,17 @@ RdmaHw::UpdateRatePatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHead
                    rtt,
                    rtt_diff,
                    gradient,
-                   qp->tmly.m_curRate.GetBitRate() * 1e-9);
+                   qp->tmly().m_curRate.GetBitRate() * 1e-9);
 #endif
         if (rtt < m_tmly_TLow) // newRTT < Tlow
         {
             // rate = rate + rai
-            new_rate = qp->tmly.m_curRate + m_rai;
+            new_rate = qp->tmly().m_curRate + m_rai;
         }
         else if (rtt > m_tmly_THigh) // newRTT > Thigh
         {
             //  rate = rate * (1 - beta(1 - Thigh / new_rtt))
-            new_rate = qp->tmly.m_curRate * (1 - m_tmly_beta * (1 - (double)m_tmly_THigh / rtt));
+            new_rate = qp->tmly().m_curRate * (1 - m_tmly_beta * (1 - (double)m_tmly_THigh / rtt));
         }
         else
         {
@@ -2563,11 +2775,11 @@ RdmaHw::UpdateRatePatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHead
             }
             error = ((double)rtt - (double)m_ptmly_RttRef) / m_ptmly_RttRef;
             new_rate =
-                m_rai * (1 - weight) + qp->tmly.m_curRate * (1 - m_ptmly_beta * error * weight);
+                m_rai * (1 - weight) + qp->tmly().m_curRate * (1 - m_ptmly_beta * error * weight);
         }
-        qp->tmly.m_curRate = std::max(m_minRate, std::min(qp->m_max_rate, new_rate));
+        qp->tmly().m_curRate = std::max(m_minRate, std::min(qp->m_max_rate, new_rate));
         ChangeRate(qp, new_rate);
-        qp->tmly.rttDiff = rtt_diff;
+        qp->tmly().rttDiff = rtt_diff;
 #if PRINT_LOG
         if (print)
         {
@@ -2575,11 +2787,11 @@ RdmaHw::UpdateRatePatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHead
         }
 #endif
     }
-    if (!us && next_seq > qp->tmly.m_lastUpdateSeq)
+    if (!us && next_seq > qp->tmly().m_lastUpdateSeq)
     {
-        qp->tmly.m_lastUpdateSeq = next_seq;
+        qp->tmly().m_lastUpdateSeq = next_seq;
         // update
-        qp->tmly.lastRtt = rtt;
+        qp->tmly().lastRtt = rtt;
     }
     //std::cout << "[PTMLY] node:" << m_node->GetId() << " rate:" << qp->m_rate << " RTT:" << rtt
               //<< std::endl;
@@ -2594,15 +2806,15 @@ RdmaHw::FastReactPatchedTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeade
  * DCTCP
  *********************/
 void
-RdmaHw::HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const
+RdmaHw::HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint32_t ack_seq = ch.ack.seq;
     uint8_t cnp = (ch.ack.flags >> qbbHeader::FLAG_CNP) & 1;
     bool new_batch = false;
 
     // update alpha
-    qp->dctcp.m_ecnCnt += (cnp > 0);
-    if (ack_seq > qp->dctcp.m_lastUpdateSeq)
+    qp->dctcp().m_ecnCnt += (cnp > 0);
+    if (ack_seq > qp->dctcp().m_lastUpdateSeq)
     { // if full RTT feedback is ready, do alpha update
 #if PRINT_LOG
         printf("%lu %s %08x %08x %u %u [%u,%u,%u] %.3lf->",
@@ -2612,26 +2824,26 @@ RdmaHw::HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
                qp->dip.Get(),
                qp->sport,
                qp->dport,
-               qp->dctcp.m_lastUpdateSeq,
+               qp->dctcp().m_lastUpdateSeq,
                ch.ack.seq,
                qp->snd_nxt,
-               qp->dctcp.m_alpha);
+               qp->dctcp().m_alpha);
 #endif
         new_batch = true;
-        if (qp->dctcp.m_lastUpdateSeq == 0)
+        if (qp->dctcp().m_lastUpdateSeq == 0)
         { // first RTT
-            qp->dctcp.m_lastUpdateSeq = qp->snd_nxt;
-            qp->dctcp.m_batchSizeOfAlpha = qp->snd_nxt / m_mtu + 1;
+            qp->dctcp().m_lastUpdateSeq = qp->snd_nxt;
+            qp->dctcp().m_batchSizeOfAlpha = qp->snd_nxt / m_mtu + 1;
         }
         else
         {
-            double frac = std::min(1.0, double(qp->dctcp.m_ecnCnt) / qp->dctcp.m_batchSizeOfAlpha);
-            qp->dctcp.m_alpha = (1 - m_g) * qp->dctcp.m_alpha + m_g * frac;
-            qp->dctcp.m_lastUpdateSeq = qp->snd_nxt;
-            qp->dctcp.m_ecnCnt = 0;
-            qp->dctcp.m_batchSizeOfAlpha = (qp->snd_nxt - ack_seq) / m_mtu + 1;
+            double frac = std::min(1.0, double(qp->dctcp().m_ecnCnt) / qp->dctcp().m_batchSizeOfAlpha);
+            qp->dctcp().m_alpha = (1 - m_g) * qp->dctcp().m_alpha + m_g * frac;
+            qp->dctcp().m_lastUpdateSeq = qp->snd_nxt;
+            qp->dctcp().m_ecnCnt = 0;
+            qp->dctcp().m_batchSizeOfAlpha = (qp->snd_nxt - ack_seq) / m_mtu + 1;
 #if PRINT_LOG
-            printf("%.3lf F:%.3lf", qp->dctcp.m_alpha, frac);
+            printf("%.3lf F:%.3lf", qp->dctcp().m_alpha, frac);
 #endif
         }
 #if PRINT_LOG
@@ -2640,16 +2852,16 @@ RdmaHw::HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
     }
 
     // check cwr exit
-    if (qp->dctcp.m_caState == 1)
+    if (qp->dctcp().m_caState == 1)
     {
-        if (ack_seq > qp->dctcp.m_highSeq)
+        if (ack_seq > qp->dctcp().m_highSeq)
         {
-            qp->dctcp.m_caState = 0;
+            qp->dctcp().m_caState = 0;
         }
     }
 
     // check if need to reduce rate: ECN and not in CWR
-    if (cnp && qp->dctcp.m_caState == 0)
+    if (cnp && qp->dctcp().m_caState == 0)
     {
 #if PRINT_LOG
         printf("%lu %s %08x %08x %u %u %.3lf->",
@@ -2661,16 +2873,16 @@ RdmaHw::HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
                qp->dport,
                qp->m_rate.GetBitRate() * 1e-9);
 #endif
-        qp->m_rate = std::max(m_minRate, qp->m_rate * (1 - qp->dctcp.m_alpha / 2));
+        qp->m_rate = std::max(m_minRate, qp->m_rate * (1 - qp->dctcp().m_alpha / 2));
 #if PRINT_LOG
         printf("%.3lf\n", qp->m_rate.GetBitRate() * 1e-9);
 #endif
-        qp->dctcp.m_caState = 1;
-        qp->dctcp.m_highSeq = qp->snd_nxt;
+        qp->dctcp().m_caState = 1;
+        qp->dctcp().m_highSeq = qp->snd_nxt;
     }
 
     // additive inc
-    if (qp->dctcp.m_caState == 0 && new_batch)
+    if (qp->dctcp().m_caState == 0 && new_batch)
     {
         qp->m_rate = std::min(qp->m_max_rate, qp->m_rate + m_dctcp_rai);
     }
@@ -2695,7 +2907,7 @@ RdmaHw::HandleAckHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
         return;
     }
     // update rate
-    if (ack_seq > qp->hpccPint.m_lastUpdateSeq)
+    if (ack_seq > qp->hpccPint().m_lastUpdateSeq)
     { // if full RTT feedback is ready, do full update
         UpdateRateHpPint(qp, p, ch, false);
     }
@@ -2709,9 +2921,9 @@ void
 RdmaHw::UpdateRateHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool fast_react)
 {
     uint32_t next_seq = qp->snd_nxt;
-    if (qp->hpccPint.m_lastUpdateSeq == 0)
+    if (qp->hpccPint().m_lastUpdateSeq == 0)
     { // first RTT
-        qp->hpccPint.m_lastUpdateSeq = next_seq;
+        qp->hpccPint().m_lastUpdateSeq = next_seq;
     }
     else
     {
@@ -2723,15 +2935,15 @@ RdmaHw::UpdateRateHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
         int32_t new_incStage;
         double max_c = U / m_targetUtil;
 
-        if (max_c >= 1 || qp->hpccPint.m_incStage >= m_miThresh)
+        if (max_c >= 1 || qp->hpccPint().m_incStage >= m_miThresh)
         {
-            new_rate = qp->hpccPint.m_curRate / max_c + m_rai;
+            new_rate = qp->hpccPint().m_curRate / max_c + m_rai;
             new_incStage = 0;
         }
         else
         {
-            new_rate = qp->hpccPint.m_curRate + m_rai;
-            new_incStage = qp->hpccPint.m_incStage + 1;
+            new_rate = qp->hpccPint().m_curRate + m_rai;
+            new_incStage = qp->hpccPint().m_incStage + 1;
         }
         if (new_rate < m_minRate)
         {
@@ -2744,14 +2956,14 @@ RdmaHw::UpdateRateHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
         ChangeRate(qp, new_rate);
         if (!fast_react)
         {
-            qp->hpccPint.m_curRate = new_rate;
-            qp->hpccPint.m_incStage = new_incStage;
+            qp->hpccPint().m_curRate = new_rate;
+            qp->hpccPint().m_incStage = new_incStage;
         }
         if (!fast_react)
         {
-            if (next_seq > qp->hpccPint.m_lastUpdateSeq)
+            if (next_seq > qp->hpccPint().m_lastUpdateSeq)
             {
-                qp->hpccPint.m_lastUpdateSeq = next_seq; //+ rand() % 2 * m_mtu;
+                qp->hpccPint().m_lastUpdateSeq = next_seq; //+ rand() % 2 * m_mtu;
             }
         }
     }
@@ -2762,7 +2974,7 @@ RdmaHw::UpdateRateHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch,
  ********************/
 
 void
-RdmaHw::HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const
+RdmaHw::HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     auto ih = ch.ack.ih.swift;
     // std::cout << "[SWIFT] Hops: " << ih.nhop << ", Remote Delay: " << ih.remote_delay <<
@@ -2772,7 +2984,7 @@ RdmaHw::HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
     auto fabric_delay = rtt - ih.remote_delay;
 
     // on receiving ack
-    qp->swift.m_retransmit_cnt = 0;
+    qp->swift().m_retransmit_cnt = 0;
     auto target_fab_delay = TargetFabDelaySwift(qp, p, ch);
     auto fab_cwnd = GetCwndSwift(qp, p, ch, target_fab_delay, fabric_delay);
     auto endpoint_cwnd = GetCwndSwift(qp, p, ch, swift_target_endpoint_delay, ih.remote_delay);
@@ -2781,20 +2993,20 @@ RdmaHw::HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
         std::max(swift_min_cwnd, std::min(swift_max_cwnd, std::min(fab_cwnd, endpoint_cwnd)));
     if (cwnd < qp->m_win)
     {
-        qp->swift.m_t_last_decrease = Simulator::Now();
+        qp->swift().m_t_last_decrease = Simulator::Now();
     }
     if (cwnd < 1)
     {
-        qp->swift.m_pacing_delay = rtt * 1.0 / cwnd;
+        qp->swift().m_pacing_delay = rtt * 1.0 / cwnd;
         qp->SetWin(INT_MAX); // to make sure sending is only pacing-bound, but not window-bound
-        qp->swift.m_real_win = cwnd;
+        qp->swift().m_real_win = cwnd;
         qp->UpdatePacing();
     }
     else
     {
-        qp->swift.m_pacing_delay = 0;
+        qp->swift().m_pacing_delay = 0;
         qp->SetWin((uint32_t)cwnd);
-        qp->swift.m_real_win = cwnd;
+        qp->swift().m_real_win = cwnd;
     }
     //std::cout << "[SWIFT] node: " << m_node->GetId() << ", cwnd: " << cwnd
       //        << ", delay: " << fabric_delay << std::endl;
@@ -2804,7 +3016,7 @@ RdmaHw::HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) c
 uint64_t
 RdmaHw::TargetFabDelaySwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const
 {
-    double fcwnd = qp->swift.m_real_win;
+    double fcwnd = qp->swift().m_real_win;
     auto num_hops = ch.ack.ih.swift.nhop;
     auto alpha =
         swift_fs_range / (std::pow(swift_fs_min_cwnd, -0.5) - std::pow(swift_fs_max_cwnd, -0.5));
@@ -2822,8 +3034,8 @@ RdmaHw::GetCwndSwift(Ptr<RdmaQueuePair> qp,
                      uint64_t target_delay,
                      uint64_t curr_delay) const
 {
-    bool canDecrease = ch.ack.ih.swift.ts > qp->swift.m_t_last_decrease.GetNanoSeconds();
-    double cwnd = qp->swift.m_real_win;
+    bool canDecrease = ch.ack.ih.swift.ts > qp->swift().m_t_last_decrease.GetNanoSeconds();
+    double cwnd = qp->swift().m_real_win;
     if (curr_delay < target_delay)
     {
         if (cwnd >= 1)
@@ -2847,7 +3059,7 @@ RdmaHw::GetCwndSwift(Ptr<RdmaQueuePair> qp,
 }
 
 void
-RdmaHw::HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const
+RdmaHw::HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
 {
     uint64_t rtt = Simulator::Now().GetTimeStep() - ch.ack.ih.GetTs();
     std::random_device rd;
@@ -2870,7 +3082,7 @@ RdmaHw::HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
     }
 
     // window in mtu (1000), not in bytes / seq#
-    auto cwnd = qp->rttqcn.curr_win;
+    auto cwnd = qp->rttqcn().curr_win;
     if (cwnd < m_mtu)
     {
         if (ecn)
@@ -2894,9 +3106,9 @@ RdmaHw::HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch)
             cwnd += m_mtu * 10.0 / cwnd;
         }
     }
-    //std::cout << "[RTT-QCN] node: " << m_node->GetId() << ", cwnd: " << qp->rttqcn.curr_win << "->"
+    //std::cout << "[RTT-QCN] node: " << m_node->GetId() << ", cwnd: " << qp->rttqcn().curr_win << "->"
               //<< cwnd << ", RTT: " << rtt << ", ecn: " << ecn << std::endl;
-    qp->rttqcn.curr_win = cwnd;
+    qp->rttqcn().curr_win = cwnd;
     qp->m_win = (uint32_t)cwnd;
 }
 
@@ -2907,11 +3119,11 @@ RdmaHw::HandleAckPowerQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> distr(0, 1000);
-    uint64_t prev_rtt = qp->powerqcn.prev_rtt == 0 ? rtt : qp->powerqcn.prev_rtt;
-    if (qp->powerqcn.prev_rtt < ch.ack.ih.GetTs())
+    uint64_t prev_rtt = qp->powerqcn().prev_rtt == 0 ? rtt : qp->powerqcn().prev_rtt;
+    if (qp->powerqcn().prev_rtt < ch.ack.ih.GetTs())
     {
-        qp->powerqcn.prev_rtt = rtt;
-        qp->powerqcn.last_update = Simulator::Now().GetTimeStep();
+        qp->powerqcn().prev_rtt = rtt;
+        qp->powerqcn().last_update = Simulator::Now().GetTimeStep();
     }
     double rtt_gradient = (rtt - prev_rtt) / rtt_qcn_tmin;
 
@@ -2949,7 +3161,7 @@ RdmaHw::HandleAckPowerQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch
     }
 
     // window in mtu (1000), not in bytes / seq#
-    auto cwnd = qp->rttqcn.curr_win;
+    auto cwnd = qp->rttqcn().curr_win;
     if (cwnd < m_mtu)
     {
         if (rtt_ecn)
@@ -2988,9 +3200,9 @@ RdmaHw::HandleAckPowerQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch
             }
         }
     }
-   //std::cout << "[RTT-QCN] node: " << m_node->GetId() << ", cwnd: " << qp->rttqcn.curr_win << "->"
+   //std::cout << "[RTT-QCN] node: " << m_node->GetId() << ", cwnd: " << qp->rttqcn().curr_win << "->"
               //<< cwnd << ", RTT: " << rtt << ", ecn: " << rtt_ecn << gradient_ecn << std::endl;
-    qp->rttqcn.curr_win = cwnd;
+    qp->rttqcn().curr_win = cwnd;
     qp->m_win = (uint32_t)cwnd;
 }
 
@@ -9,7 +9,10 @@
 #include <ns3/rdma-queue-pair.h>
 
 #include <cstdint>
+#include <functional>
+#include <queue>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -45,6 +48,8 @@ class RdmaHw : public Object
     uint32_t m_chunk;
     uint32_t m_ack_interval;
     bool m_backto0;
+    bool m_selectiveRepeat; // IRN style selective repeat instead of go-back-N
+    double m_srRto;         // selective repeat retransmission timeout in microseconds
     bool m_var_win, m_fast_react;
     bool m_rateBound;
     std::vector<RdmaInterfaceMgr> m_nic; // list of running nic controlled by this RdmaHw
@@ -76,6 +81,18 @@ class RdmaHw : public Object
                       Time stopTime); // add a new qp (new send)
     void DeleteQueuePair(Ptr<RdmaQueuePair> qp);
 
+    // Congestion control entry points. All ACK handlers share one signature, and Setup picks the
+    // ones of m_cc_mode, so that the ACK path does not switch on the mode.
+    typedef void (RdmaHw::*AckHandler)(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
+    typedef void (RdmaHw::*CnpHandler)(Ptr<RdmaQueuePair> qp);
+    AckHandler m_handleAck; // null if the algorithm does not react to ACKs
+    CnpHandler m_handleCnp; // CNP flag of an ACK, null if ignored
+    void SetupCc();
+    // emplaces the state of m_cc_mode in qp->cc, starting at rate
+    void InitCc(Ptr<RdmaQueuePair> qp, DataRate rate);
+    // sets the current rate kept by the algorithm, if it keeps one
+    void SetCcRate(Ptr<RdmaQueuePair> qp, DataRate rate);
+
     Ptr<RdmaRxQueuePair> GetRxQp(uint32_t sip,
                                  uint32_t dip,
                                  uint16_t sport,
@@ -88,6 +105,8 @@ class RdmaHw : public Object
     int ReceiveUdp(Ptr<Packet> p, CustomHeader& ch);
     int ReceiveCnp(Ptr<Packet> p, CustomHeader& ch);
     int ReceiveAck(Ptr<Packet> p, CustomHeader& ch); // handle both ACK and NACK
+    // ACK, or NACK if nack, of the data packet ch for rxQp
+    Ptr<Packet> GetAckPacket(Ptr<RdmaRxQueuePair> rxQp, const CustomHeader& ch, bool nack);
     int Receive(Ptr<Packet> p,
                 CustomHeader&
                     ch); // callback function that the QbbNetDevice should use when receive packets.
@@ -99,6 +118,12 @@ class RdmaHw : public Object
     static uint16_t EtherToPpp(uint16_t protocol);
 
     void RecoverQueue(Ptr<RdmaQueuePair> qp);
+    // Selective repeat: queue the packets the receiver reported missing below a SACK
+    void SelectiveRepeatNack(Ptr<RdmaQueuePair> qp, uint32_t sack);
+    // Selective repeat: (re)start the RTO while packets are on the fly
+    void RestartRto(Ptr<RdmaQueuePair> qp);
+    // Selective repeat: RTO fired, retransmit everything not yet sacked
+    void RtoTimeout(Ptr<RdmaQueuePair> qp);
     void QpComplete(Ptr<RdmaQueuePair> qp);
     void SetLinkDown(Ptr<QbbNetDevice> dev);
 
@@ -111,6 +136,7 @@ class RdmaHw : public Object
     void PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap) const;
     void UpdateNextAvail(Ptr<RdmaQueuePair> qp, Time interframeGap, uint32_t pkt_size) const;
     void ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate);
+    void WakeQp(Ptr<RdmaQueuePair> qp); // tell the NIC scheduler that qp may send again
     /******************************
      * Mellanox's version of DCQCN
      *****************************/
@@ -145,6 +171,43 @@ class RdmaHw : public Object
     void ActiveIncreaseMlx(Ptr<RdmaQueuePair> q);
     void HyperIncreaseMlx(Ptr<RdmaQueuePair> q);
 
+    // The three Mellanox timers of a qp. With m_mlxTimerSlot > 0 the timers of all qps of this
+    // NIC go to a timing wheel: a timer is rounded up to the end of its slot, and the timers of a
+    // slot fire from one simulator event in the order they were set. With 0 every timer is its
+    // own simulator event, as in the original model.
+    enum MlxTimer
+    {
+        MLX_UPDATE_ALPHA = 0,
+        MLX_DECREASE_RATE = 1,
+        MLX_RATE_INC = 2,
+    };
+
+    struct MlxTimerEntry
+    {
+        int64_t ts;
+        uint64_t seq;
+        uint32_t gen; // cancelled if no longer q->mlx().m_timerGen[kind]
+        uint8_t kind;
+        Ptr<RdmaQueuePair> qp;
+
+        bool operator>(const MlxTimerEntry& o) const
+        {
+            return ts != o.ts ? ts > o.ts : seq > o.seq;
+        }
+    };
+
+    std::priority_queue<MlxTimerEntry, std::vector<MlxTimerEntry>, std::greater<MlxTimerEntry>>
+        m_mlxTimers;
+    uint64_t m_mlxTimerSeq;
+    EventId m_mlxTimerEvent;
+    bool m_mlxTimersRunning; // in RunMlxTimers, which sets m_mlxTimerEvent when done
+    double m_mlxTimerSlot;   // in microseconds
+
+    void ScheduleMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind, Time delay);
+    void CancelMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind);
+    void FireMlxTimer(Ptr<RdmaQueuePair> q, MlxTimer kind);
+    void RunMlxTimers();
+
     /***********************
      * High Precision CC
      ***********************/
@@ -163,6 +226,7 @@ class RdmaHw : public Object
      *********************/
     bool PowerTCPEnabled;
     bool PowerTCPdelay;
+    void HandleAckPower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
     void UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool fast_react);
     void FastReactPower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
 
@@ -181,6 +245,8 @@ class RdmaHw : public Object
 
     void HandleAckUfcc(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
     void HandleAckUfcwnd(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
+    // UFCC_CWND: HandleAckUfcwnd, then DCTCP's window on the same ACK
+    void HandleAckUfcwndDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
     void UpdateStateUfcwnd(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool us) const;
 
     void UpdateRateUfcc(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool us) const;
@@ -203,7 +269,7 @@ class RdmaHw : public Object
      * DCTCP
      *********************/
     DataRate m_dctcp_rai;
-    void HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const;
+    void HandleAckDctcp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
 
     /*********************
      * HPCC-PINT
@@ -228,7 +294,7 @@ class RdmaHw : public Object
     double swift_max_cwnd; // max cwnd Swift can exceed (not fs)
     double swift_target_endpoint_delay; // target endpoint delay
 
-    void HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const;
+    void HandleAckSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
     void UpdateRateSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch, bool fast_react);
     void FastReactSwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
     uint64_t TargetFabDelaySwift(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const;
@@ -247,7 +313,7 @@ class RdmaHw : public Object
         rtt_qcn_alpha; // additive increase when cwnd < 1; use original value, don't multiply by mtu
     double rtt_qcn_beta; // multiplicative decrease when cwnd > 1; use original value, don't
                          // multiply by mtu
-    void HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch) const;
+    void HandleAckRttQcn(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader& ch);
 
     /*********************
      * PowerQCN
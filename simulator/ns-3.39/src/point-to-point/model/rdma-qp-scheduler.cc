@@ -0,0 +1,381 @@
+#include "rdma-qp-scheduler.h"
+
+#include <ns3/assert.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+
+namespace ns3
+{
+
+RdmaQpScheduler::RdmaQpScheduler()
+    : m_tracked(0),
+      m_nextSeq(0),
+      m_dirty(false)
+{
+}
+
+void
+RdmaQpScheduler::AddQp(Ptr<RdmaQueuePairGroup> grp, Ptr<RdmaQueuePair> qp)
+{
+    if (m_grp != grp)
+    {
+        m_grp = grp;
+        m_dirty = true;
+    }
+    if (m_dirty)
+    {
+        return; // picked up by the next Rebuild
+    }
+    Track(qp);
+}
+
+void
+RdmaQpScheduler::WakeQp(Ptr<RdmaQueuePair> qp)
+{
+    if (m_dirty || qp->sched.state == NONE)
+    {
+        return;
+    }
+    CheckFinished(qp);
+    PushAvail(qp);
+    if (qp->sched.state != READY)
+    {
+        MakeReady(qp);
+    }
+}
+
+void
+RdmaQpScheduler::SetDirty()
+{
+    m_dirty = true;
+}
+
+void
+RdmaQpScheduler::Sync(Ptr<RdmaQueuePairGroup> grp)
+{
+    if (m_grp != grp || m_tracked != grp->GetN())
+    {
+        // somebody changed the group behind our back
+        m_grp = grp;
+        m_dirty = true;
+    }
+    if (m_dirty)
+    {
+        Rebuild();
+    }
+    if (m_lastServed)
+    {
+        PushAvail(m_lastServed);
+        m_lastServed = nullptr;
+    }
+}
+
+void
+RdmaQpScheduler::Rebuild()
+{
+    for (auto& qp : m_grp->m_qps)
+    {
+        qp->sched.state = NONE;
+    }
+    m_ready.clear();
+    m_timers = EntryHeap();
+    for (uint32_t i = 0; i < qCnt; i++)
+    {
+        m_parked[i].clear();
+    }
+    m_avail = EntryHeap();
+    m_finished.clear();
+    m_stops = EntryHeap();
+    m_expired.clear();
+    m_tracked = 0;
+    m_dirty = false;
+    for (auto& qp : m_grp->m_qps)
+    {
+        Track(qp);
+    }
+}
+
+void
+RdmaQpScheduler::Track(Ptr<RdmaQueuePair> qp)
+{
+    qp->sched.seq = m_nextSeq++;
+    qp->sched.finished = false;
+    m_tracked++;
+    MakeReady(qp);
+    PushAvail(qp);
+    CheckFinished(qp);
+    if (qp->stopTime < Simulator::GetMaximumSimulationTime())
+    {
+        m_stops.push({qp->stopTime.GetTimeStep(), qp->sched.seq, 0, qp});
+    }
+}
+
+void
+RdmaQpScheduler::Untrack(Ptr<RdmaQueuePair> qp)
+{
+    if (qp->sched.state == READY)
+    {
+        m_ready.erase(qp->sched.seq);
+    }
+    qp->sched.state = NONE;
+    qp->sched.gen++;
+    m_finished.erase(qp->sched.seq);
+    m_expired.erase(qp->sched.seq);
+    m_tracked--;
+}
+
+void
+RdmaQpScheduler::MakeReady(Ptr<RdmaQueuePair> qp)
+{
+    qp->sched.state = READY;
+    qp->sched.gen++;
+    m_ready[qp->sched.seq] = qp;
+}
+
+void
+RdmaQpScheduler::PushAvail(Ptr<RdmaQueuePair> qp)
+{
+    if (m_avail.size() > 2 * m_tracked + 64)
+    {
+        // too many stale entries, rebuild the heap from scratch
+        m_avail = EntryHeap();
+        for (auto& q : m_grp->m_qps)
+        {
+            if (q != qp && q->sched.state != NONE)
+            {
+                q->sched.availGen++;
+                m_avail.push({q->m_nextAvail.GetTimeStep(), q->sched.seq, q->sched.availGen, q});
+            }
+        }
+    }
+    qp->sched.availGen++;
+    m_avail.push({qp->m_nextAvail.GetTimeStep(), qp->sched.seq, qp->sched.availGen, qp});
+}
+
+void
+RdmaQpScheduler::CheckFinished(Ptr<RdmaQueuePair> qp)
+{
+    if (!qp->sched.finished && qp->snd_una >= qp->m_size)
+    {
+        qp->sched.finished = true;
+        m_finished.insert(qp->sched.seq);
+    }
+}
+
+// Smallest seq in [lo, hi) of a finished qp that the linear scan would flag for removal, i.e. a
+// finished qp that is not allowed to send.
+bool
+RdmaQpScheduler::FirstFinished(uint64_t lo, uint64_t hi, const bool paused[], uint64_t& seq) const
+{
+    bool any = false;
+    auto f = m_finished.lower_bound(lo);
+    if (f != m_finished.end() && *f < hi)
+    {
+        seq = *f;
+        any = true;
+    }
+    for (auto x = m_expired.lower_bound(lo); x != m_expired.end() && x->first < hi; x++)
+    {
+        if (any && x->first >= seq)
+        {
+            break;
+        }
+        Ptr<RdmaQueuePair> qp = x->second;
+        if (paused[qp->m_pg] || qp->GetBytesLeft() == 0 || qp->IsWinBound())
+        {
+            seq = x->first;
+            any = true;
+            break;
+        }
+    }
+    return any;
+}
+
+int
+RdmaQpScheduler::Position(uint64_t seq) const
+{
+    auto& qps = m_grp->m_qps;
+    auto it = std::lower_bound(qps.begin(),
+                               qps.end(),
+                               seq,
+                               [](const Ptr<RdmaQueuePair>& qp, uint64_t s) {
+                                   return qp->sched.seq < s;
+                               });
+    NS_ASSERT(it != qps.end() && (*it)->sched.seq == seq);
+    return it - qps.begin();
+}
+
+int
+RdmaQpScheduler::GetNextQindex(Ptr<RdmaQueuePairGroup> grp, uint32_t rrlast, const bool paused[])
+{
+    Sync(grp);
+    auto& qps = grp->m_qps;
+    uint32_t fcount = qps.size();
+    if (fcount == 0)
+    {
+        return NO_QP;
+    }
+    int64_t now = Simulator::Now().GetTimeStep();
+
+    // move qps whose pacing timer expired back to the ring
+    while (!m_timers.empty() && m_timers.top().ts <= now)
+    {
+        Entry e = m_timers.top();
+        m_timers.pop();
+        if (e.qp->sched.state == TIMER && e.qp->sched.gen == e.gen)
+        {
+            MakeReady(e.qp);
+        }
+    }
+    // move qps of resumed priorities back to the ring
+    for (uint32_t pg = 0; pg < qCnt; pg++)
+    {
+        if (paused[pg] || m_parked[pg].empty())
+        {
+            continue;
+        }
+        for (auto& e : m_parked[pg])
+        {
+            if (e.qp->sched.state == PARKED && e.qp->sched.gen == e.gen)
+            {
+                MakeReady(e.qp);
+            }
+        }
+        m_parked[pg].clear();
+    }
+    // qps past their stop time count as finished
+    while (!m_stops.empty() && m_stops.top().ts < now)
+    {
+        Entry e = m_stops.top();
+        m_stops.pop();
+        if (e.qp->sched.state != NONE)
+        {
+            m_expired[e.qp->sched.seq] = e.qp;
+        }
+    }
+
+    // walk the ring from where we left last time
+    uint64_t startSeq = qps[(1 + rrlast) % fcount]->sched.seq;
+    Ptr<RdmaQueuePair> found;
+    bool wrapped = false;
+    auto it = m_ready.lower_bound(startSeq);
+    while (true)
+    {
+        if (it == m_ready.end())
+        {
+            if (wrapped)
+            {
+                break;
+            }
+            wrapped = true;
+            it = m_ready.begin();
+            continue;
+        }
+        if (wrapped && it->first >= startSeq)
+        {
+            break;
+        }
+        Ptr<RdmaQueuePair> qp = it->second;
+        if (!paused[qp->m_pg] && qp->GetBytesLeft() > 0 && !qp->IsWinBound())
+        {
+            if (qp->m_nextAvail.GetTimeStep() <= now)
+            {
+                found = qp;
+                break;
+            }
+            // still sending or pacing
+            qp->sched.state = TIMER;
+            qp->sched.gen++;
+            m_timers.push({qp->m_nextAvail.GetTimeStep(), qp->sched.seq, qp->sched.gen, qp});
+        }
+        else if (paused[qp->m_pg])
+        {
+            qp->sched.state = PARKED;
+            qp->sched.gen++;
+            m_parked[qp->m_pg].push_back({0, qp->sched.seq, qp->sched.gen, qp});
+        }
+        else
+        {
+            qp->sched.state = BLOCKED;
+            qp->sched.gen++;
+        }
+        it = m_ready.erase(it);
+    }
+
+    // finished qps the linear scan would have passed over on its way to the selected one
+    uint64_t minFinished = 0;
+    bool clear;
+    if (!found)
+    {
+        clear = FirstFinished(0, UINT64_MAX, paused, minFinished);
+    }
+    else if (found->sched.seq >= startSeq)
+    {
+        clear = FirstFinished(startSeq, found->sched.seq, paused, minFinished);
+    }
+    else
+    {
+        clear = FirstFinished(0, found->sched.seq, paused, minFinished) ||
+                FirstFinished(startSeq, UINT64_MAX, paused, minFinished);
+    }
+
+    int res = NO_QP;
+    if (found)
+    {
+        res = Position(found->sched.seq);
+        found->UpdatePacing(); // add another pacing delay to nextAvail
+        m_lastServed = found;
+    }
+
+    // clear the finished qp, exactly like the linear scan
+    if (clear)
+    {
+        int nxt = Position(minFinished);
+        Untrack(qps[nxt]);
+        for (int i = nxt + 1; i < (int)fcount; i++)
+        {
+            if (!qps[i]->IsFinished())
+            {
+                if (i == res)
+                {
+                    res = nxt;
+                }
+                qps[nxt] = qps[i];
+                nxt++;
+            }
+            else
+            {
+                Untrack(qps[i]);
+            }
+        }
+        qps.resize(nxt);
+    }
+    return res;
+}
+
+Time
+RdmaQpScheduler::GetNextAvail(Ptr<RdmaQueuePairGroup> grp)
+{
+    Sync(grp);
+    while (!m_avail.empty())
+    {
+        Entry e = m_avail.top();
+        if (e.qp->sched.state == NONE || e.qp->sched.availGen != e.gen ||
+            e.qp->GetBytesLeft() == 0)
+        {
+            m_avail.pop();
+            continue;
+        }
+        if (e.ts != e.qp->m_nextAvail.GetTimeStep())
+        {
+            m_avail.pop();
+            PushAvail(e.qp);
+            continue;
+        }
+        return e.qp->m_nextAvail;
+    }
+    return Simulator::GetMaximumSimulationTime();
+}
+
+} // namespace ns3
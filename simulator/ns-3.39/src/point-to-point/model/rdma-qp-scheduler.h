@@ -0,0 +1,101 @@
+#ifndef RDMA_QP_SCHEDULER_H
+#define RDMA_QP_SCHEDULER_H
+
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/rdma-queue-pair.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+// Event-driven QP selection for RdmaEgressQueue::GetNextQindex.
+//
+// Instead of scanning every qp of the NIC on each dequeue, every qp lives in one of
+//  - the ready ring: qps that may be eligible, ordered by their position in the RdmaQueuePairGroup
+//  - the timer heap: qps that wait for m_nextAvail, keyed by m_nextAvail
+//  - the parked list of its priority: qps whose priority is paused by PFC
+//  - nowhere (blocked): qps with nothing to send or bound by the window. RdmaHw calls
+//    RdmaEgressQueue::WakeQp whenever an ACK/NACK or a rate change may unblock them.
+// The ready ring is walked from the same round-robin pointer as the linear scan, and finished qps
+// are removed from the group at the same moments as the linear scan does it, so the sequence of
+// returned indices is identical to the one of the linear scan.
+class RdmaQpScheduler
+{
+  public:
+    static const int NO_QP = -1024;
+    static const uint32_t qCnt = 8;
+
+    enum State
+    {
+        NONE = 0, // not (or no longer) in the qp group
+        READY = 1,
+        TIMER = 2,
+        PARKED = 3,
+        BLOCKED = 4,
+    };
+
+    RdmaQpScheduler();
+
+    // qp was just appended to grp
+    void AddQp(Ptr<RdmaQueuePairGroup> grp, Ptr<RdmaQueuePair> qp);
+    // state of qp changed (ACK, NACK, rate), it may have become eligible
+    void WakeQp(Ptr<RdmaQueuePair> qp);
+    // the qp group was rebuilt, resync before the next selection
+    void SetDirty();
+
+    // same contract as the linear scan: index into grp of the qp to send from, or NO_QP
+    int GetNextQindex(Ptr<RdmaQueuePairGroup> grp, uint32_t rrlast, const bool paused[]);
+    // earliest m_nextAvail among the qps that still have bytes to send
+    Time GetNextAvail(Ptr<RdmaQueuePairGroup> grp);
+
+  private:
+    struct Entry
+    {
+        int64_t ts;
+        uint64_t seq;
+        uint32_t gen;
+        Ptr<RdmaQueuePair> qp;
+
+        bool operator>(const Entry& o) const
+        {
+            return ts != o.ts ? ts > o.ts : seq > o.seq;
+        }
+    };
+
+    typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> EntryHeap;
+
+    void Sync(Ptr<RdmaQueuePairGroup> grp);
+    void Rebuild();
+    void Track(Ptr<RdmaQueuePair> qp);
+    void Untrack(Ptr<RdmaQueuePair> qp);
+    void MakeReady(Ptr<RdmaQueuePair> qp);
+    void PushAvail(Ptr<RdmaQueuePair> qp);
+    void CheckFinished(Ptr<RdmaQueuePair> qp);
+    bool FirstFinished(uint64_t lo, uint64_t hi, const bool paused[], uint64_t& seq) const;
+    int Position(uint64_t seq) const;
+
+    Ptr<RdmaQueuePairGroup> m_grp;
+    uint32_t m_tracked; // number of qps of m_grp known to the scheduler
+    uint64_t m_nextSeq;
+    bool m_dirty;
+    Ptr<RdmaQueuePair> m_lastServed; // its m_nextAvail is updated after selection
+
+    std::map<uint64_t, Ptr<RdmaQueuePair>> m_ready;    // the ready ring
+    EntryHeap m_timers;                                 // paced qps, keyed by m_nextAvail
+    std::vector<Entry> m_parked[qCnt];                  // qps of PFC-paused priorities
+    EntryHeap m_avail;                                  // all qps, keyed by m_nextAvail
+    std::set<uint64_t> m_finished;                      // qps with snd_una >= m_size
+    EntryHeap m_stops;                                  // qps with a stopTime, keyed by stopTime
+    std::map<uint64_t, Ptr<RdmaQueuePair>> m_expired;   // qps past their stopTime
+};
+
+} // namespace ns3
+
+#endif /* RDMA_QP_SCHEDULER_H */
@@ -45,52 +45,14 @@ RdmaQueuePair::RdmaQueuePair(uint16_t pg,
     m_var_win = false;
     m_rate = 0;
     m_nextAvail = Time(0);
-    mlx.m_alpha = 1;
-    mlx.m_alpha_cnp_arrived = false;
-    mlx.m_first_cnp = true;
-    mlx.m_decrease_cnp_arrived = false;
-    mlx.m_rpTimeStage = 0;
-    hp.m_lastUpdateSeq = 0;
-    for (uint32_t i = 0; i < sizeof(hp.keep) / sizeof(hp.keep[0]); i++)
-    {
-        hp.keep[i] = 0;
-    }
-    hp.m_incStage = 0;
-    hp.m_lastGap = 0;
-    hp.u = 1;
-    for (uint32_t i = 0; i < IntHeader::maxHop; i++)
-    {
-        hp.hopState[i].u = 1;
-        hp.hopState[i].incStage = 0;
-    }
-
-    tmly.m_lastUpdateSeq = 0;
-    tmly.m_incStage = 0;
-    tmly.lastRtt = 0;
-    tmly.rttDiff = 0;
-
-    dctcp.m_lastUpdateSeq = 0;
-    dctcp.m_caState = 0;
-    dctcp.m_highSeq = 0;
-    dctcp.m_alpha = 1;
-    dctcp.m_ecnCnt = 0;
-    dctcp.m_batchSizeOfAlpha = 0;
-
-    hpccPint.m_lastUpdateSeq = 0;
-    hpccPint.m_incStage = 0;
-
-    swift.m_lastUpdateSeq = 0;
-    swift.m_lastEndpointDelay = 0;
-    swift.m_t_last_decrease = Time(0);
-    swift.m_curRate = 0;
-    swift.m_retransmit_cnt = 0;
-    swift.m_pacing_delay = 0;
-    swift.m_real_win = 10000.0;
-
-    rttqcn.curr_win = 50000.0;
-
-    powerqcn.last_update = 0;
-    powerqcn.prev_rtt = 0;
+    sched.seq = 0;
+    sched.gen = 0;
+    sched.availGen = 0;
+    sched.state = 0;
+    sched.finished = false;
+
+    irn.retxBytes = 0;
+    irn.highRetx = 0;
 }
 
 void
@@ -126,7 +88,46 @@ RdmaQueuePair::SetAppNotifyCallback(Callback<void> notifyAppFinish)
 uint64_t
 RdmaQueuePair::GetBytesLeft() const
 {
-    return m_size >= snd_nxt ? m_size - snd_nxt : 0;
+    return (m_size >= snd_nxt ? m_size - snd_nxt : 0) + irn.retxBytes;
+}
+
+void
+RdmaQueuePair::MarkLost(uint64_t seq, uint32_t size)
+{
+    if (seq < snd_una || irn.sacked.count(seq))
+    {
+        return;
+    }
+    if (irn.retx.emplace(seq, size).second)
+    {
+        irn.retxBytes += size;
+    }
+}
+
+void
+RdmaQueuePair::MarkSacked(uint64_t seq)
+{
+    if (seq < snd_una)
+    {
+        return;
+    }
+    irn.sacked.insert(seq);
+    auto it = irn.retx.find(seq);
+    if (it != irn.retx.end())
+    {
+        irn.retxBytes -= it->second;
+        irn.retx.erase(it);
+    }
+}
+
+std::pair<uint64_t, uint32_t>
+RdmaQueuePair::PopRetx()
+{
+    auto it = irn.retx.begin();
+    std::pair<uint64_t, uint32_t> pkt = *it;
+    irn.retxBytes -= pkt.second;
+    irn.retx.erase(it);
+    return pkt;
 }
 
 uint32_t
@@ -155,6 +156,13 @@ RdmaQueuePair::Acknowledge(uint64_t ack)
     if (ack > snd_una)
     {
         snd_una = ack;
+        // selective repeat: forget what the cumulative ack covers
+        while (!irn.retx.empty() && irn.retx.begin()->first < snd_una)
+        {
+            irn.retxBytes -= irn.retx.begin()->second;
+            irn.retx.erase(irn.retx.begin());
+        }
+        irn.sacked.erase(irn.sacked.begin(), irn.sacked.lower_bound(snd_una));
     }
 }
 
@@ -167,6 +175,10 @@ RdmaQueuePair::GetOnTheFly() const
 bool
 RdmaQueuePair::IsWinBound() const
 {
+    if (!irn.retx.empty())
+    {
+        return false; // retransmissions do not add to the packets on the fly
+    }
     uint64_t w = GetWin();
     
     return w != 0 && GetOnTheFly() >= w;
@@ -179,7 +191,8 @@ RdmaQueuePair::UpdatePacing()
     // Minimum pacing delay is 1 RTT, and the sending process should be shorter?
     // For other CCs, pacing delay is always 0
     Time now = Simulator::Now();
-    auto pacing = Time(swift.m_pacing_delay);
+    const SwiftState* swift = std::get_if<SwiftState>(&cc);
+    auto pacing = Time(swift ? swift->m_pacing_delay : 0);
     this->m_nextAvail = std::max(this->m_nextAvail, now + pacing);
 }
 
@@ -232,7 +245,7 @@ RdmaQueuePair::HpGetCurWin() const
     uint64_t w;
     if (m_var_win)
     {
-        w = m_win * hp.m_curRate.GetBitRate() / m_max_rate.GetBitRate();
+        w = m_win * hp().m_curRate.GetBitRate() / m_max_rate.GetBitRate();
         if (w == 0)
         {
             w = 1; // must > 0
@@ -276,6 +289,7 @@ RdmaRxQueuePair::RdmaRxQueuePair()
     m_nackTimer = Time(0);
     m_milestone_rx = 0;
     m_lastNACK = 0;
+    m_sackEnd = 0;
 }
 
 uint32_t
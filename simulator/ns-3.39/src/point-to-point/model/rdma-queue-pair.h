@@ -8,8 +8,12 @@
 #include <ns3/ipv4-address.h>
 #include <ns3/object.h>
 #include <ns3/packet.h>
+#include <ns3/rdma-header-template.h>
 
 #include <cstdint>
+#include <deque>
+#include <set>
+#include <variant>
 #include <vector>
 // vamsi
 #include <map>
@@ -29,6 +33,7 @@ class RdmaQueuePair : public Object
     uint64_t snd_nxt, snd_una; // next seq to send, the highest unacked seq
     uint16_t m_pg;
     uint16_t m_ipid;
+    RdmaHeaderTemplate m_dataHeader; // headers of the data packets, built for the first one
     uint32_t m_win;      // bound of on-the-fly packets (bytes?)
     uint64_t m_baseRtt;  // base RTT of this qp
     DataRate m_max_rate; // max rate
@@ -39,9 +44,6 @@ class RdmaQueuePair : public Object
     Callback<void> m_notifyAppFinish;
 
     // vamsi
-    std::map<uint32_t, double> rates;
-    double prevRtt;
-    double prevCompletion;
     bool powerEnabled;
     Time stopTime;
 
@@ -59,104 +61,101 @@ class RdmaQueuePair : public Object
         BURST = 5,
     };
 
-    struct
+    /******************************
+     * congestion control states
+     *****************************/
+    // A qp only holds the state of the congestion control of its NIC: RdmaHw::AddQueuePair
+    // emplaces it in cc, and the accessors below fail on the state of another algorithm.
+
+    struct MlxState
     {
         DataRate m_targetRate; //< Target rate
-        EventId m_eventUpdateAlpha;
-        double m_alpha;
-        bool m_alpha_cnp_arrived; // indicate if CNP arrived in the last slot
-        bool m_first_cnp;         // indicate if the current CNP is the first CNP
-        EventId m_eventDecreaseRate;
-        bool m_decrease_cnp_arrived; // indicate if CNP arrived in the last slot
-        uint32_t m_rpTimeStage;
-        EventId m_rpTimer;
-    } mlx;
+        double m_alpha = 1;
+        bool m_alpha_cnp_arrived = false;    // indicate if CNP arrived in the last slot
+        bool m_first_cnp = true;             // indicate if the current CNP is the first CNP
+        bool m_decrease_cnp_arrived = false; // indicate if CNP arrived in the last slot
+        uint32_t m_rpTimeStage = 0;
+        EventId m_timerEvent[3]; // per RdmaHw::MlxTimer, without the timing wheel
+        uint32_t m_timerGen[3] = {0, 0, 0}; // per RdmaHw::MlxTimer, incremented to cancel a
+                                            // wheel entry
+    };
 
-    struct
+    // HPCC
+    struct HpState
     {
-        uint32_t m_lastUpdateSeq;
+        uint32_t m_lastUpdateSeq = 0;
         DataRate m_curRate;
         IntHop hop[IntHeader::maxHop];
-        uint32_t keep[IntHeader::maxHop];
-        uint32_t m_incStage;
-        double m_lastGap;
-        double u;
+        uint32_t keep[IntHeader::maxHop] = {};
+        uint32_t m_incStage = 0;
+        double m_lastGap = 0;
+        double u = 1;
 
         struct
         {
-            double u;
+            double u = 1;
             double qRate;
             DataRate Rc;
-            uint32_t incStage;
+            uint32_t incStage = 0;
         } hopState[IntHeader::maxHop];
-    } hp;
+    };
 
-    struct
+    // PowerTCP, which runs on top of the HPCC state
+    struct PowerTcpState : public HpState
     {
-        uint32_t m_lastUpdateSeq;
-        DataRate m_curRate;
-        IntHop hop[IntHeader::maxHop];
-        uint32_t keep[IntHeader::maxHop];
-        uint32_t m_incStage;
-        double m_lastGap;
-        double u;
-        bool useInt;
-
-        struct
-        {
-            double u;
-            DataRate Rc;
-            uint32_t incStage;
-        } hopState[IntHeader::maxHop];
-    } power;
+        std::map<uint32_t, double> rates; // vamsi: send time of the packets in flight by seq
+        double prevRtt;
+        double prevCompletion;
+    };
 
-    struct
+    // TIMELY and patched TIMELY
+    struct TimelyState
     {
-        uint32_t m_lastUpdateSeq;
+        uint32_t m_lastUpdateSeq = 0;
         DataRate m_curRate;
-        uint32_t m_incStage;
-        uint64_t lastRtt;
-        double rttDiff;
-    } tmly;
+        uint32_t m_incStage = 0;
+        uint64_t lastRtt = 0;
+        double rttDiff = 0;
+    };
 
-    struct
+    struct DctcpState
     {
-        uint32_t m_lastUpdateSeq;
-        uint32_t m_caState;
-        uint32_t m_highSeq; // when to exit cwr
-        double m_alpha;
-        uint32_t m_ecnCnt;
-        uint32_t m_batchSizeOfAlpha;
-    } dctcp;
+        uint32_t m_lastUpdateSeq = 0;
+        uint32_t m_caState = 0;
+        uint32_t m_highSeq = 0; // when to exit cwr
+        double m_alpha = 1;
+        uint32_t m_ecnCnt = 0;
+        uint32_t m_batchSizeOfAlpha = 0;
+    };
 
-    struct
+    struct HpccPintState
     {
-        uint32_t m_lastUpdateSeq;
+        uint32_t m_lastUpdateSeq = 0;
         DataRate m_curRate;
-        uint32_t m_incStage;
-    } hpccPint;
+        uint32_t m_incStage = 0;
+    };
 
-    struct
+    struct SwiftState
     {
         // seq num of packet which last triggered update
-        uint32_t m_lastUpdateSeq;
+        uint32_t m_lastUpdateSeq = 0;
         // last endpoint delay, stored for EWMA
-        uint32_t m_lastEndpointDelay;
+        uint32_t m_lastEndpointDelay = 0;
         // current rate
         DataRate m_curRate;
         // retransmit time count
-        uint16_t m_retransmit_cnt;
+        uint16_t m_retransmit_cnt = 0;
         // time (nanosecond) of last Multiple Decrease
         Time m_t_last_decrease;
         // pacing delay, i.e. sending interval
-        uint64_t m_pacing_delay;
+        uint64_t m_pacing_delay = 0;
         // real window size
         //
         // swift sets window size to INT_MAX to avoid packet capping during pacing (win<1)
-        double m_real_win;
-    } swift;
+        double m_real_win = 10000.0;
+    };
 
-    struct 
+    struct UfccState
     {
         uint32_t m_lastUpdateSeq;
         DataRate low_rate;
@@ -186,19 +185,121 @@ class RdmaQueuePair : public Object
         uint32_t low_win;
         uint32_t high_win;
         uint32_t cur_win;
-    } ufcc;
+    };
 
-    struct
+    // UFCC_CWND, which also runs DCTCP on every ACK
+    struct UfcwndState : public UfccState
+    {
+        DctcpState dctcp;
+    };
+
+    struct RttQcnState
     {
         // There's no packet pacing in rtt-qcn; however m_win is uint32_t, which makes additive increase really
         // slow. Using a double to store real window helps a lot.
-        double curr_win;
-    } rttqcn;
+        double curr_win = 50000.0;
+    };
+
+    // PowerQCN, which keeps its window in the RTT-QCN state
+    struct PowerQcnState : public RttQcnState
+    {
+        uint64_t prev_rtt = 0;    // previous RTT, used to calculate gradient
+        uint64_t last_update = 0; // last time we update prev_rtt
+    };
 
-    struct {
-        uint64_t prev_rtt;// previous RTT, used to calculate gradient
-        uint64_t last_update;// last time we update prev_rtt
-    } powerqcn;
+    std::variant<std::monostate,
+                 MlxState,
+                 HpState,
+                 PowerTcpState,
+                 TimelyState,
+                 DctcpState,
+                 HpccPintState,
+                 SwiftState,
+                 UfccState,
+                 UfcwndState,
+                 RttQcnState,
+                 PowerQcnState>
+        cc;
+
+    MlxState& mlx()
+    {
+        return std::get<MlxState>(cc);
+    }
+
+    HpState& hp()
+    {
+        HpState* s = std::get_if<HpState>(&cc);
+        return s ? *s : power();
+    }
+
+    const HpState& hp() const
+    {
+        const HpState* s = std::get_if<HpState>(&cc);
+        return s ? *s : std::get<PowerTcpState>(cc);
+    }
+
+    PowerTcpState& power()
+    {
+        return std::get<PowerTcpState>(cc);
+    }
+
+    TimelyState& tmly()
+    {
+        return std::get<TimelyState>(cc);
+    }
+
+    DctcpState& dctcp()
+    {
+        DctcpState* s = std::get_if<DctcpState>(&cc);
+        return s ? *s : std::get<UfcwndState>(cc).dctcp;
+    }
+
+    HpccPintState& hpccPint()
+    {
+        return std::get<HpccPintState>(cc);
+    }
+
+    SwiftState& swift()
+    {
+        return std::get<SwiftState>(cc);
+    }
+
+    UfccState& ufcc()
+    {
+        UfccState* s = std::get_if<UfccState>(&cc);
+        return s ? *s : std::get<UfcwndState>(cc);
+    }
+
+    RttQcnState& rttqcn()
+    {
+        RttQcnState* s = std::get_if<RttQcnState>(&cc);
+        return s ? *s : powerqcn();
+    }
+
+    PowerQcnState& powerqcn()
+    {
+        return std::get<PowerQcnState>(cc);
+    }
+
+    // bookkeeping of the NIC's RdmaQpScheduler
+    struct
+    {
+        uint64_t seq;      // key of this qp in the ready ring, increases with the position in the group
+        uint32_t gen;      // invalidates stale timer heap and parked entries
+        uint32_t availGen; // invalidates stale next-avail heap entries
+        uint8_t state;     // RdmaQpScheduler::State
+        bool finished;     // snd_una reached m_size
+    } sched;
+
+    // selective repeat loss recovery, see RdmaHw::m_selectiveRepeat
+    struct
+    {
+        std::map<uint64_t, uint32_t> retx; // seq -> size of the packets to retransmit
+        std::set<uint64_t> sacked;         // packets above snd_una the receiver already has
+        uint64_t retxBytes;                // bytes in retx
+        uint64_t highRetx;                 // losses below this seq have been queued in retx
+        EventId rtoEvent;
+    } irn;
 
     /***********
      * methods
@@ -227,8 +328,16 @@ class RdmaQueuePair : public Object
     void SetAppNotifyCallback(Callback<void> notifyAppFinish);
 
     // Returns the amount of data left to send, which can be used to determine if the transfer is
-    // complete.
+    // complete. Includes the bytes queued for selective repeat retransmission.
     uint64_t GetBytesLeft() const;
+    // Selective repeat: queue the packet at seq for retransmission, unless it is acked, sacked or
+    // already queued.
+    void MarkLost(uint64_t seq, uint32_t size);
+    // Selective repeat: the receiver holds the packet at seq, do not retransmit it.
+    void MarkSacked(uint64_t seq);
+    // Selective repeat: take the lowest packet queued for retransmission. Only call if
+    // irn.retx is not empty.
+    std::pair<uint64_t, uint32_t> PopRetx();
     // Generates a hash value based on the queue pair's source and destination IP addresses and
     // ports,
     // likely used for efficiently looking up queue pairs.
@@ -278,11 +387,16 @@ class RdmaRxQueuePair : public Object
     uint32_t sip, dip;
     uint16_t sport, dport;
     uint16_t m_ipid;
+    RdmaHeaderTemplate m_ackHeader; // headers of the ACKs and NACKs, built for the first one
     uint32_t ReceiverNextExpectedSeq;
     Time m_nackTimer;
     int32_t m_milestone_rx;
     uint32_t m_lastNACK;
     EventId QcnTimerEvent; // if destroy this rxQp, remember to cancel this timer
+    // selective repeat: packets received above ReceiverNextExpectedSeq, slot i is the packet at
+    // ReceiverNextExpectedSeq + i * mtu
+    std::deque<bool> m_sackBitmap;
+    uint32_t m_sackEnd; // end of the highest packet in m_sackBitmap
 
     static TypeId GetTypeId(void);
     RdmaRxQueuePair();
@@ -0,0 +1,150 @@
+#include "switch-load-balancer.h"
+
+#include <ns3/enum.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(SwitchLoadBalancer);
+
+TypeId
+SwitchLoadBalancer::GetTypeId(void)
+{
+    static TypeId tid =
+        TypeId("ns3::SwitchLoadBalancer")
+            .SetParent<Object>()
+            .AddConstructor<SwitchLoadBalancer>()
+            .AddAttribute("Mode",
+                          "How a switch picks among equal-cost next hops",
+                          EnumValue(ECMP),
+                          MakeEnumAccessor(&SwitchLoadBalancer::m_mode),
+                          MakeEnumChecker(FIRST,
+                                          "First",
+                                          ECMP,
+                                          "Ecmp",
+                                          FLOWLET,
+                                          "Flowlet",
+                                          SPRAY,
+                                          "Spray",
+                                          CONGESTION_AWARE,
+                                          "CongestionAware"))
+            .AddAttribute("FlowletGap",
+                          "Idle time after which the next packet of a flow starts a new flowlet",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&SwitchLoadBalancer::m_flowletGap),
+                          MakeTimeChecker())
+            .AddAttribute("FlowletTableSize",
+                          "Number of flowlet slots, flows are mapped to them by hash",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&SwitchLoadBalancer::m_flowletTableSize),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+SwitchLoadBalancer::SwitchLoadBalancer()
+{
+    m_rand = CreateObject<UniformRandomVariable>();
+}
+
+void
+SwitchLoadBalancer::SetQueueLengthCallback(Callback<uint32_t, uint32_t> cb)
+{
+    m_queueLength = cb;
+}
+
+int64_t
+SwitchLoadBalancer::AssignStreams(int64_t stream)
+{
+    m_rand->SetStream(stream);
+    return 1;
+}
+
+uint32_t
+SwitchLoadBalancer::Select(uint32_t hash, const std::vector<int>& nexthops)
+{
+    uint32_t n = nexthops.size();
+    if (n == 1)
+    {
+        return 0;
+    }
+    switch (m_mode)
+    {
+    case FIRST:
+        return 0;
+    case ECMP:
+        return hash % n;
+    case SPRAY:
+        return m_rand->GetInteger(0, n - 1);
+    case FLOWLET:
+    case CONGESTION_AWARE:
+        return SelectFlowlet(hash, nexthops);
+    }
+    return 0;
+}
+
+uint32_t
+SwitchLoadBalancer::SelectFlowlet(uint32_t hash, const std::vector<int>& nexthops)
+{
+    if (m_flowlets.empty())
+    {
+        m_flowlets.resize(m_flowletTableSize, {0, UINT32_MAX, 0});
+    }
+    int64_t now = Simulator::Now().GetTimeStep();
+    Flowlet& f = m_flowlets[hash % m_flowlets.size()];
+    if (f.hash == hash && now - f.lastSeen < m_flowletGap.GetTimeStep())
+    {
+        // same flowlet, stay on its path as long as it is still a next hop
+        for (uint32_t i = 0; i < nexthops.size(); i++)
+        {
+            if ((uint32_t)nexthops[i] == f.port)
+            {
+                f.lastSeen = now;
+                return i;
+            }
+        }
+    }
+
+    // new flowlet (or another flow took the slot)
+    uint32_t idx;
+    if (m_mode == FLOWLET)
+    {
+        idx = m_rand->GetInteger(0, nexthops.size() - 1);
+    }
+    else
+    {
+        idx = LeastLoaded(hash, nexthops);
+    }
+    f.hash = hash;
+    f.port = nexthops[idx];
+    f.lastSeen = now;
+    return idx;
+}
+
+uint32_t
+SwitchLoadBalancer::LeastLoaded(uint32_t hash, const std::vector<int>& nexthops)
+{
+    uint32_t n = nexthops.size();
+    if (m_queueLength.IsNull())
+    {
+        return hash % n;
+    }
+    // start at the hashed next hop so that ties do not all go to the first one
+    uint32_t first = hash % n;
+    uint32_t best = first;
+    uint32_t bestLen = m_queueLength(nexthops[best]);
+    for (uint32_t k = 1; k < n && bestLen > 0; k++)
+    {
+        uint32_t i = (first + k) % n;
+        uint32_t len = m_queueLength(nexthops[i]);
+        if (len < bestLen)
+        {
+            best = i;
+            bestLen = len;
+        }
+    }
+    return best;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,59 @@
+#ifndef SWITCH_LOAD_BALANCER_H
+#define SWITCH_LOAD_BALANCER_H
+
+#include <ns3/callback.h>
+#include <ns3/nstime.h>
+#include <ns3/object.h>
+#include <ns3/random-variable-stream.h>
+
+#include <vector>
+
+namespace ns3
+{
+
+// Picks one of the equal-cost next hops of a SwitchNode route entry.
+class SwitchLoadBalancer : public Object
+{
+  public:
+    enum Mode
+    {
+        FIRST = 0,            // always the first next hop
+        ECMP = 1,             // hash of the 5-tuple
+        FLOWLET = 2,          // LetFlow: random next hop for every new flowlet
+        SPRAY = 3,            // random next hop for every packet
+        CONGESTION_AWARE = 4, // CONGA-like: emptiest egress queue for every new flowlet
+    };
+
+    static TypeId GetTypeId(void);
+    SwitchLoadBalancer();
+
+    // returns the bytes queued at the egress port with the given ifIndex
+    void SetQueueLengthCallback(Callback<uint32_t, uint32_t> cb);
+
+    // index into nexthops of the next hop for a packet of the flow with the given hash
+    uint32_t Select(uint32_t hash, const std::vector<int>& nexthops);
+
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    struct Flowlet
+    {
+        uint32_t hash;    // flow owning the slot
+        uint32_t port;    // egress port of its current flowlet
+        int64_t lastSeen; // time step of its last packet
+    };
+
+    uint32_t SelectFlowlet(uint32_t hash, const std::vector<int>& nexthops);
+    uint32_t LeastLoaded(uint32_t hash, const std::vector<int>& nexthops);
+
+    Mode m_mode;
+    Time m_flowletGap;
+    uint32_t m_flowletTableSize;
+    std::vector<Flowlet> m_flowlets; // indexed by hash, allocated on first use
+    Callback<uint32_t, uint32_t> m_queueLength;
+    Ptr<UniformRandomVariable> m_rand;
+};
+
+} /* namespace ns3 */
+
+#endif /* SWITCH_LOAD_BALANCER_H */
@@ -21,7 +21,6 @@
 # define CS 103
 # define IB 104
 # define ABM 110
-# define REVERIE 111
 
 NS_LOG_COMPONENT_DEFINE("SwitchMmu");
 namespace ns3 {
@@ -59,7 +58,7 @@ SwitchMmu::SwitchMmu(void) {
 	// The buffer can be configured using Set functions through the simulation file later.
 
 	// Buffer model
-	bufferModel = "sonic"; // currently SONiC buffer (based on our understanding) and "reverie" buffer model are supported. The bufferModel can be set using SetBufferModel function externally.
+	bufferModel = SONIC; // currently SONiC buffer (based on our understanding) and "reverie" buffer model are supported. The bufferModel can be set using SetBufferModel function externally.
 
 	// Buffer pools
 	bufferPool = 24 * 1024 * 1024; // ASIC buffer size i.e, total shared buffer
@@ -88,62 +87,111 @@ SwitchMmu::SwitchMmu(void) {
 
 	Reveriegamma = 0.99;
 
-	for (uint32_t port = 0; port < pCnt; port++) {
-		for (uint32_t q = 0; q < qCnt; q++) {
-			// buffer configuration.
-			reserveIngress[port][q] = 0; // Per queue reserved buffer at ingress. IMPORTANT: reserve SHOULD BE SET EXPLICITLY in a simulation.
-			reserveEgress[port][q] = 0; // per queue reserved buffer at egress. Not used at the moment. TODO.
-			alphaEgress[port][q] = 1; // per queue alpha value used by Buffer Management/PFC Threshold at egress
-			alphaIngress[port][q] = 1; // per queue alpha value used by Buffer Management/PFC Threshold at ingress
-			xoff[port][q] = 0; // per queue headroom LIMIT at ingress. This can be changed using SetHeadroom. IMPORTANT: xoff SHOULD BE SET EXPLICITLY in a simulation.
-			xon[port][q] = 1248; // For pfc resume. Can be changed using SetXon
-			xon_offset[port][q] = 2496; // For pfc resume. Can be changed using SetXonOffset
-
-
-			// per queue run time
-			ingress_bytes[port][q] = 0; // total ingress bytes USED at each queue. This includes, bytes from reserved, ingress pool as well as any headroom.
-			// MMU maintains paused state for all Ingress queues to keep track if a queue is currently pausing the peer (an egress queue on the other end of the link)
-			// NOTE: QbbNetDevices (ports) maintain a separate paused state to keep track if an egress queue is paused or not. This can be found in qbb-net-device.cc
-			paused[port][q] = 0; // a state (see above).
-			egress_bytes[port][q] = 0; // Per queue egress bytes USED at each queue
-			xoffUsed[port][q] = 0; // The headroom buffer USED by each queue.
-			ingressLpf_bytes[port][q] = 0;
-			egressLpf_bytes[port][q] = 0;
-
-			// ABM related variables
-			congestedIngress[port][q] = 0; // This keeps track of the number of congested queues at the ingress
-			congestedEgress[port][q] = 0; // This keeps track of the number of congested queues at the egress
-			txBytesIngress[port][q] = 0; // used for calculating dequeue rates. counter for tx bytes of ingress queues
-			txBytesEgress[port][q] = 0; // used for calculating dequeue rates. counter for tx bytes of egress queues
-			dequeueRateIngress[port][q] = 1; // normalized dequeue rate of an ingress queue
-			dequeueRateEgress[port][q]  = 1; // normalized dequeue rate of an egress queue
-		}
-	}
+	// Per port state is sized to the ports the switch actually has, see AddPort. These are the values
+	// new queues start with. The "all ports" setters update them.
+	defaultConfig.reserveIngress = 0; // Per queue reserved buffer at ingress. IMPORTANT: reserve SHOULD BE SET EXPLICITLY in a simulation.
+	defaultConfig.alphaEgress = 1; // per queue alpha value used by Buffer Management/PFC Threshold at egress
+	defaultConfig.alphaIngress = 1; // per queue alpha value used by Buffer Management/PFC Threshold at ingress
+	defaultConfig.xoff = 0; // per queue headroom LIMIT at ingress. This can be changed using SetHeadroom. IMPORTANT: xoff SHOULD BE SET EXPLICITLY in a simulation.
+	defaultConfig.xon = 1248; // For pfc resume. Can be changed using SetXon
+	defaultConfig.xon_offset = 2496; // For pfc resume. Can be changed using SetXonOffset
+	nPorts = 0;
 
 	for (uint32_t qIndex = 0; qIndex < qCnt; qIndex++) {
 		NofPIngress[qIndex] = 0;
 		NofPEgress[qIndex] = 0;
 	}
-	for (uint32_t portId = 0; portId < pCnt; portId++) {
-		bandwidth[portId] = 25 * 1e9;
-	}
 	congestionIndicator = 20 * 1024;
 
 	ingressAlg[LOSSLESS] = DT;
 	ingressAlg[LOSSY] = DT;
 	egressAlg[LOSSLESS] = DT;
 	egressAlg[LOSSY] = DT;
-
-
-	memset(ingress_bytes, 0, sizeof(ingress_bytes));
-	memset(paused, 0, sizeof(paused));
-	memset(egress_bytes, 0, sizeof(egress_bytes));
+	SelectPolicies();
 
 	dequeueUpdatedOnce = 0; // For ABM, to trigger dequeue rate updates
+	lazyDequeueRates = false; // sweep all queues every updateIntervalNS. Can be changed using SetLazyDequeueRates
+	dequeueEpochStart = 0;
+	dequeueInterval = 1;
 	lpfUpdatedOnce = 0; // For Reverie, LPF updates
 	updateIntervalNS = 25 * 1000; // default 25us update interval for dequeue rates
 	alphaHigh = 1024; // default value to imitate a sky high threshold for all unscheduled packets
-	portCount = pCnt; // default value is 257. This should be set to the real port count using SetPortCount function externally based on the simulation setup
+	portCount = UINT32_MAX; // default is all ports. This can be limited using SetPortCount function externally based on the simulation setup
+}
+
+void
+SwitchMmu::AddPort(uint32_t port) {
+	if (port < nPorts)
+		return;
+	uint32_t n = port + 1;
+	auto fill = [](auto value) {
+		std::array<decltype(value), qCnt> a;
+		a.fill(value);
+		return a;
+	};
+	auto zero = fill(uint64_t(0));
+
+	// buffer configuration.
+	reserveIngress.resize(n, fill(defaultConfig.reserveIngress));
+	reserveEgress.resize(n, zero); // per queue reserved buffer at egress. Not used at the moment. TODO.
+	alphaEgress.resize(n, fill(defaultConfig.alphaEgress));
+	alphaIngress.resize(n, fill(defaultConfig.alphaIngress));
+	xoff.resize(n, fill(defaultConfig.xoff));
+	xon.resize(n, fill(defaultConfig.xon));
+	xon_offset.resize(n, fill(defaultConfig.xon_offset));
+	totalIngressReserved += (n - nPorts) * qCnt * defaultConfig.reserveIngress;
+	xoffTotal += (n - nPorts) * qCnt * defaultConfig.xoff;
+
+	// per queue run time
+	ingress_bytes.resize(n, zero); // total ingress bytes USED at each queue. This includes, bytes from reserved, ingress pool as well as any headroom.
+	// MMU maintains paused state for all Ingress queues to keep track if a queue is currently pausing the peer (an egress queue on the other end of the link)
+	// NOTE: QbbNetDevices (ports) maintain a separate paused state to keep track if an egress queue is paused or not. This can be found in qbb-net-device.cc
+	paused.resize(n, fill(uint32_t(0))); // a state (see above).
+	egress_bytes.resize(n, zero); // Per queue egress bytes USED at each queue
+	xoffUsed.resize(n, zero); // The headroom buffer USED by each queue.
+	ingressLpf_bytes.resize(n, zero);
+	egressLpf_bytes.resize(n, zero);
+
+	// ABM related variables
+	congestedIngress.resize(n, fill(0.0)); // This keeps track of the number of congested queues at the ingress
+	congestedEgress.resize(n, fill(0.0)); // This keeps track of the number of congested queues at the egress
+	txBytesIngress.resize(n, zero); // used for calculating dequeue rates. counter for tx bytes of ingress queues
+	txBytesEgress.resize(n, zero); // used for calculating dequeue rates. counter for tx bytes of egress queues
+	dequeueRateIngress.resize(n, fill(1.0)); // normalized dequeue rate of an ingress queue
+	dequeueRateEgress.resize(n, fill(1.0)); // normalized dequeue rate of an egress queue
+	dequeueEpochIngress.resize(n, fill(int64_t(-1))); // -1: not even the first sweep applied yet
+	dequeueEpochEgress.resize(n, fill(int64_t(-1)));
+	bandwidth.resize(n, 25 * 1e9);
+
+	// ECN
+	kmin.resize(n, 0);
+	kmax.resize(n, 0);
+	pmax.resize(n, 0);
+
+	nPorts = n;
+}
+
+uint32_t
+SwitchMmu::GetNPorts() const {
+	return nPorts;
+}
+
+uint64_t
+SwitchMmu::GetMemoryFootprint() const {
+	uint64_t perQueue = 0;
+	for (auto* v : {&reserveIngress, &reserveEgress, &xoff, &xon, &xon_offset, &ingress_bytes, &egress_bytes,
+	                &xoffUsed, &ingressLpf_bytes, &egressLpf_bytes, &txBytesIngress, &txBytesEgress}) {
+		perQueue += v->capacity() * sizeof(std::array<uint64_t, qCnt>);
+	}
+	for (auto* v : {&alphaEgress, &alphaIngress, &congestedIngress, &congestedEgress, &dequeueRateIngress,
+	                &dequeueRateEgress}) {
+		perQueue += v->capacity() * sizeof(std::array<double, qCnt>);
+	}
+	perQueue += paused.capacity() * sizeof(std::array<uint32_t, qCnt>);
+	perQueue += (dequeueEpochIngress.capacity() + dequeueEpochEgress.capacity()) * sizeof(std::array<int64_t, qCnt>);
+	uint64_t perPort = bandwidth.capacity() * sizeof(uint64_t) + (kmin.capacity() + kmax.capacity()) * sizeof(uint32_t) +
+	                   pmax.capacity() * sizeof(double);
+	return sizeof(*this) + perQueue + perPort;
 }
 
 void
@@ -178,6 +226,7 @@ SwitchMmu::SetEgressLosslessPool(uint64_t b) {
 
 void
 SwitchMmu::SetReserved(uint64_t b, uint32_t port, uint32_t q, std::string inout) {
+	AddPort(port);
 	if (inout == "ingress") {
 		if (totalIngressReserved >= reserveIngress[port][q])
 			totalIngressReserved -= reserveIngress[port][q];
@@ -196,7 +245,8 @@ SwitchMmu::SetReserved(uint64_t b, uint32_t port, uint32_t q, std::string inout)
 void
 SwitchMmu::SetReserved(uint64_t b, std::string inout) {
 	if (inout == "ingress") {
-		for (uint32_t port = 0; port < pCnt; port++) {
+		defaultConfig.reserveIngress = b;
+		for (uint32_t port = 0; port < nPorts; port++) {
 			for (uint32_t q = 0; q < qCnt ; q++) {
 				if (totalIngressReserved >= reserveIngress[port][q])
 					totalIngressReserved -= reserveIngress[port][q];
@@ -210,7 +260,7 @@ SwitchMmu::SetReserved(uint64_t b, std::string inout) {
 	else if (inout == "egress") {
 		std::cout << "setting reserved for egress is not supported. Exiting..!" << std::endl;
 		exit(1);
-		// for (uint32_t port = 0; port < pCnt; port++) {
+		// for (uint32_t port = 0; port < nPorts; port++) {
 		// 	for (uint32_t q = 0; q < qCnt; q++) {
 		// 		reserveEgress[port][q] = b;
 		// 	}
@@ -220,12 +270,14 @@ SwitchMmu::SetReserved(uint64_t b, std::string inout) {
 
 void
 SwitchMmu::SetAlphaIngress(double value, uint32_t port, uint32_t q) {
+	AddPort(port);
 	alphaIngress[port][q] = value;
 }
 
 void
 SwitchMmu::SetAlphaIngress(double value) {
-	for (uint32_t port = 0; port < pCnt; port++) {
+	defaultConfig.alphaIngress = value;
+	for (uint32_t port = 0; port < nPorts; port++) {
 		for (uint32_t q = 0; q < qCnt; q++) {
 			alphaIngress[port][q] = value;
 		}
@@ -234,12 +286,14 @@ SwitchMmu::SetAlphaIngress(double value) {
 
 void
 SwitchMmu::SetAlphaEgress(double value, uint32_t port, uint32_t q) {
+	AddPort(port);
 	alphaEgress[port][q] = value;
 }
 
 void
 SwitchMmu::SetAlphaEgress(double value) {
-	for (uint32_t port = 0; port < pCnt; port++) {
+	defaultConfig.alphaEgress = value;
+	for (uint32_t port = 0; port < nPorts; port++) {
 		for (uint32_t q = 0; q < qCnt; q++) {
 			alphaEgress[port][q] = value;
 		}
@@ -250,6 +304,7 @@ SwitchMmu::SetAlphaEgress(double value) {
 // This function allows for setting headroom per queue. When ever this is set, the xoffTotal (total headroom) is updated.
 void
 SwitchMmu::SetHeadroom(uint64_t b, uint32_t port, uint32_t q) {
+	AddPort(port);
 	xoffTotal -= xoff[port][q];
 	xoff[port][q] = b;
 	xoffTotal += xoff[port][q];
@@ -258,7 +313,8 @@ SwitchMmu::SetHeadroom(uint64_t b, uint32_t port, uint32_t q) {
 // This function allows for setting headroom for all queues in oneshot. When ever this is set, the xoffTotal (total headroom) is updated.
 void
 SwitchMmu::SetHeadroom(uint64_t b) {
-	for (uint32_t port = 0; port < pCnt; port++) {
+	defaultConfig.xoff = b;
+	for (uint32_t port = 0; port < nPorts; port++) {
 		for (uint32_t q = 0; q < qCnt; q++) {
 			xoffTotal -= xoff[port][q];
 			xoff[port][q] = b;
@@ -269,11 +325,13 @@ SwitchMmu::SetHeadroom(uint64_t b) {
 
 void
 SwitchMmu::SetXon(uint64_t b, uint32_t port, uint32_t q) {
+	AddPort(port);
 	xon[port][q] = b;
 }
 void
 SwitchMmu::SetXon(uint64_t b) {
-	for (uint32_t port = 0; port < pCnt; port++) {
+	defaultConfig.xon = b;
+	for (uint32_t port = 0; port < nPorts; port++) {
 		for (uint32_t q = 0; q < qCnt; q++) {
 			xon[port][q] = b;
 		}
@@ -282,11 +340,13 @@ SwitchMmu::SetXon(uint64_t b) {
 
 void
 SwitchMmu::SetXonOffset(uint64_t b, uint32_t port, uint32_t q) {
+	AddPort(port);
 	xon_offset[port][q] = b;
 }
 void
 SwitchMmu::SetXonOffset(uint64_t b) {
-	for (uint32_t port = 0; port < pCnt; port++) {
+	defaultConfig.xon_offset = b;
+	for (uint32_t port = 0; port < nPorts; port++) {
 		for (uint32_t q = 0; q < qCnt; q++) {
 			xon_offset[port][q] = b;
 		}
@@ -301,21 +361,25 @@ SwitchMmu::SetGamma(double value) {
 void
 SwitchMmu::SetIngressLossyAlg(uint32_t alg) {
 	ingressAlg[LOSSY] = alg;
+	SelectPolicies();
 }
 
 void
 SwitchMmu::SetIngressLosslessAlg(uint32_t alg) {
 	ingressAlg[LOSSLESS] = alg;
+	SelectPolicies();
 }
 
 void
 SwitchMmu::SetEgressLossyAlg(uint32_t alg) {
 	egressAlg[LOSSY] = alg;
+	SelectPolicies();
 }
 
 void
 SwitchMmu::SetEgressLosslessAlg(uint32_t alg) {
 	egressAlg[LOSSLESS] = alg;
+	SelectPolicies();
 }
 
 uint64_t SwitchMmu::GetIngressReservedUsed() {
@@ -335,11 +399,15 @@ uint64_t SwitchMmu::GetIngressSharedUsed() {
 	return (totalUsed - xoffTotalUsed - totalIngressReservedUsed);
 }
 
+// Buffer sharing algorithms. Each is specialized per direction at compile time, and SelectPolicies
+// puts the one configured for every (direction, type) in thresholdFn. Nothing here compares
+// strings or allocates.
+
 // DT's threshold = Alpha x remaining.
 // A sky high threshold for a queue can be emulated by setting the corresponding alpha to a large value. eg., UINT32_MAX
-uint64_t SwitchMmu::DynamicThreshold(uint32_t port, uint32_t qIndex, std::string inout, uint32_t type) {
-	if (inout == "ingress") {
-		double remaining = 0;
+template <SwitchMmu::Direction D>
+uint64_t SwitchMmu::DtThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched) {
+	if (D == INGRESS) {
 		uint64_t ingressPoolSharedUsed = GetIngressSharedUsed(); // Total bytes used from the ingress "shared" pool specifically.
 		uint64_t ingressSharedPool = ingressPool - totalIngressReserved;
 		if (ingressSharedPool > ingressPoolSharedUsed) {
@@ -352,8 +420,7 @@ uint64_t SwitchMmu::DynamicThreshold(uint32_t port, uint32_t qIndex, std::string
 			return 0;
 		}
 	}
-	else if (inout == "egress") {
-		double remaining = 0;
+	else {
 		if (egressPool[type] > egressPoolUsed[type]) {
 			uint64_t remaining = egressPool[type] - egressPoolUsed[type];
 			// UINT64_MAX - 1024*1024 is just a randomly chosen big value.
@@ -366,101 +433,111 @@ uint64_t SwitchMmu::DynamicThreshold(uint32_t port, uint32_t qIndex, std::string
 		}
 	}
 }
-void SwitchMmu::setCongested(uint32_t portId, uint32_t qIndex, std::string inout, double satLevel) {
-	if (inout == "ingress") {
-		// NofPIngress[qIndex] -= congestedIngress[portId][qIndex];
-		// if (ingressLpf_bytes[portId][qIndex] > congestionIndicator){
-		// 	NofPIngress[qIndex] += 1;
-		// 	congestedIngress[portId][qIndex] = 1;
-		// }
-		// else{
-		// 	congestedIngress[portId][qIndex] = 0;
-		// }
+
+uint64_t SwitchMmu::DynamicThreshold(uint32_t port, uint32_t qIndex, Direction inout, uint32_t type) {
+	if (inout == INGRESS)
+		return DtThreshold<INGRESS>(port, qIndex, type, 0);
+	else
+		return DtThreshold<EGRESS>(port, qIndex, type, 0);
+}
+
+void SwitchMmu::setCongested(uint32_t portId, uint32_t qIndex, Direction inout, double satLevel) {
+	if (inout == INGRESS) {
 		NofPIngress[qIndex] +=  satLevel - congestedIngress[portId][qIndex];
 		congestedIngress[portId][qIndex] = satLevel;
 	}
-	else if (inout == "egress") {
-		// NofPEgress[qIndex] -= congestedEgress[portId][qIndex];
-		// if (egressLpf_bytes[portId][qIndex] > congestionIndicator){
-		// 	NofPEgress[qIndex] += 1;
-		// 	congestedEgress[portId][qIndex] = 1;
-		// }
-		// else{
-		// 	congestedEgress[portId][qIndex] = 0;
-		// }
+	else {
 		NofPEgress[qIndex] += satLevel - congestedEgress[portId][qIndex];
 		congestedEgress[portId][qIndex] = satLevel;
 	}
 }
-double SwitchMmu::GetNofP(std::string inout, uint32_t qIndex) {
-	if (inout == "ingress") {
-		if (NofPIngress[qIndex] < 1)
-			return 1;
-		else
-			return NofPIngress[qIndex];
-	}
-	else if (inout == "egress") {
-		if (NofPEgress[qIndex] < 1)
-			return 1;
-		else
-			return NofPEgress[qIndex];
-	}
-	return 0;
+double SwitchMmu::GetNofP(Direction inout, uint32_t qIndex) {
+	double n = (inout == INGRESS) ? NofPIngress[qIndex] : NofPEgress[qIndex];
+	if (n < 1)
+		return 1;
+	else
+		return n;
 }
-double SwitchMmu::getDequeueRate(uint32_t port, uint32_t qIndex, std::string inout) {
-	if (inout == "ingress") {
+double SwitchMmu::getDequeueRate(uint32_t port, uint32_t qIndex, Direction inout) {
+	if (inout == INGRESS) {
 		return dequeueRateIngress[port][qIndex];
 	}
-	else if (inout == "egress") {
+	else {
 		return dequeueRateEgress[port][qIndex];
 	}
-	return 0;
 }
+double SwitchMmu::DequeueRate(uint32_t port, uint64_t txBytes, uint64_t queueBytes) {
+	double rate = (1e9 * txBytes * 8.0 / updateIntervalNS) / (bandwidth[port]);
+	if (queueBytes > congestionIndicator && txBytes > 2 * 1024)
+		return rate;
+	else
+		return 1;
+	// if (rate < 0.125) // min 1/8 considering 8 queues, with round-robin
+	// 	rate = 0.125;
+}
+
 void SwitchMmu::updateDequeueRates() {
-	for (uint32_t i = 0; i < portCount; i++) {
+	if (lazyDequeueRates) {
+		// No sweeps, just start counting them. See CatchUpDequeueRate.
+		dequeueEpochStart = Simulator::Now().GetTimeStep();
+		dequeueInterval = std::max<int64_t>(1, NanoSeconds(updateIntervalNS).GetTimeStep());
+		dequeueUpdatedOnce = 1;
+		return;
+	}
+	for (uint32_t i = 0; i < portCount && i < nPorts; i++) {
 		for (uint32_t j = 0; j < qCnt; j++) {
 			// update ingress queues dequeue rates
-			uint64_t temp = txBytesIngress[i][j];
+			dequeueRateIngress[i][j] = DequeueRate(i, txBytesIngress[i][j], ingress_bytes[i][j]);
 			txBytesIngress[i][j] = 0;
-			double temp1 = (1e9 * temp * 8.0 / updateIntervalNS) / (bandwidth[i]);
-			if (ingress_bytes[i][j] > congestionIndicator && temp > 2 * 1024)
-				dequeueRateIngress[i][j] = temp1;
-			else
-				dequeueRateIngress[i][j] = 1;
-			// if (dequeueRateIngress[i][j] < 0.125) // min 1/8 considering 8 queues, with round-robin
-			// 	dequeueRateIngress[i][j] = 0.125;
 
 			//update egress queues dequeue rates
-			temp = txBytesEgress[i][j];
+			dequeueRateEgress[i][j] = DequeueRate(i, txBytesEgress[i][j], egress_bytes[i][j]);
 			txBytesEgress[i][j] = 0;
-			temp1 = (1e9 * temp * 8.0 / updateIntervalNS) / (bandwidth[i]);
-			if (egress_bytes[i][j] > congestionIndicator && temp > 2 * 1024)
-				dequeueRateEgress[i][j] = temp1;
-			else
-				dequeueRateEgress[i][j] = 1;
 			// dequeueRateEgress[i][j] = 0.125 + (0.875)*(temp1*0.8 + dequeueRateEgress[i][j]*0.2);
-			// dequeueRateEgress[i][j] = (1e9 * temp * 8.0 / updateIntervalNS) / (bandwidth[i]);
-			// if (dequeueRateEgress[i][j] < 0.125) // min 1/8 considering 8 queues, with round-robin
-			// 	dequeueRateEgress[i][j] = 0.125;
 		}
 	}
 	dequeueUpdatedOnce = 1;
 	Simulator::Schedule(NanoSeconds(updateIntervalNS), &SwitchMmu::updateDequeueRates, this);
 }
 
-uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, std::string inout, uint32_t type, uint32_t unsched) {
+// The lazy counterpart of updateDequeueRates for one queue: apply the sweeps it missed since it was last touched.
+// Its tx bytes and queue length only change when it is touched, so the missed sweeps would have seen the values
+// it holds now. The result equals the sweep's, except for a packet at the very time step of a sweep, which the
+// sweep may count in either interval.
+template <SwitchMmu::Direction D>
+void SwitchMmu::CatchUpDequeueRate(uint32_t port, uint32_t qIndex) {
+	if (!dequeueUpdatedOnce || port >= portCount)
+		return;
+	int64_t epoch = (Simulator::Now().GetTimeStep() - dequeueEpochStart) / dequeueInterval;
+	int64_t& last = (D == INGRESS) ? dequeueEpochIngress[port][qIndex] : dequeueEpochEgress[port][qIndex];
+	if (epoch == last)
+		return;
+	uint64_t& txBytes = (D == INGRESS) ? txBytesIngress[port][qIndex] : txBytesEgress[port][qIndex];
+	double& rate = (D == INGRESS) ? dequeueRateIngress[port][qIndex] : dequeueRateEgress[port][qIndex];
+	if (epoch == last + 1)
+		rate = DequeueRate(port, txBytes, (D == INGRESS) ? ingress_bytes[port][qIndex] : egress_bytes[port][qIndex]);
+	else
+		rate = 1; // every sweep after the first missed one saw no tx bytes
+	txBytes = 0;
+	last = epoch;
+}
+
+template <SwitchMmu::Direction D>
+uint64_t SwitchMmu::AbmThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched) {
 	if (!dequeueUpdatedOnce) {
 		updateDequeueRates();
 	}
-	if (inout == "ingress") {
-		double remaining = 0;
+	if (lazyDequeueRates) {
+		CatchUpDequeueRate<D>(port, qIndex);
+	}
+	if (D == INGRESS) {
 		uint64_t ingressPoolSharedUsed = GetIngressSharedUsed(); // Total bytes used from the ingress "shared" pool specifically.
 		uint64_t ingressSharedPool = ingressPool - totalIngressReserved;
 		double satLevel = double(ingress_bytes[port][qIndex]) / congestionIndicator;
 		if (satLevel > 1) {
 			satLevel = 1;
 		}
-		setCongested(port, qIndex, inout, satLevel);
+		setCongested(port, qIndex, D, satLevel);
 		if (ingressSharedPool > ingressPoolSharedUsed) {
 			uint64_t remaining = ingressSharedPool - ingressPoolSharedUsed;
 			double alphaP = 1;
@@ -470,9 +547,7 @@ uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, std::
 			else {
 				alphaP = alphaIngress[port][qIndex];
 			}
-			uint64_t ABM_Threshold = alphaP * (remaining) * (1.0 / GetNofP(inout, qIndex)) * (getDequeueRate(port, qIndex, inout));
-			// if (type == LOSSLESS)
-			// 	std::cout << getDequeueRate(port, qIndex, inout) << " port " << port  << " qIndex " << qIndex << std::endl;
+			uint64_t ABM_Threshold = alphaP * (remaining) * (1.0 / GetNofP(D, qIndex)) * (getDequeueRate(port, qIndex, D));
 			return std::min(uint64_t(ABM_Threshold), UINT64_MAX - 1024 * 1024);
 		}
 		else {
@@ -481,13 +556,12 @@ uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, std::
 			return 0;
 		}
 	}
-	else if (inout == "egress") {
-		double remaining = 0;
+	else {
 		double satLevel = double(egress_bytes[port][qIndex]) / congestionIndicator;
 		if (satLevel > 1) {
 			satLevel = 1;
 		}
-		setCongested(port, qIndex, inout, satLevel);
+		setCongested(port, qIndex, D, satLevel);
 		if (egressPool[type] > egressPoolUsed[type]) {
 			uint64_t remaining = egressPool[type] - egressPoolUsed[type];
 			// UINT64_MAX - 1024*1024 is just a randomly chosen big value.
@@ -499,7 +573,7 @@ uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, std::
 			else {
 				alphaP = alphaEgress[port][qIndex];
 			}
-			uint64_t ABM_Threshold = alphaP * (remaining) * (1.0 / GetNofP(inout, qIndex)) * (getDequeueRate(port, qIndex, inout));
+			uint64_t ABM_Threshold = alphaP * (remaining) * (1.0 / GetNofP(D, qIndex)) * (getDequeueRate(port, qIndex, D));
 			return std::min(ABM_Threshold, UINT64_MAX - 1024 * 1024);
 		}
 		else {
@@ -508,247 +582,215 @@ uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, std::
 	}
 }
 
-uint64_t SwitchMmu::FlowAwareBuffer(uint32_t port, uint32_t qIndex, std::string inout, uint32_t type, uint32_t unsched) {
-	if (inout == "ingress") {
-		double remaining = 0;
+uint64_t SwitchMmu::ActiveBufferManagement(uint32_t port, uint32_t qIndex, Direction inout, uint32_t type, uint32_t unsched) {
+	if (inout == INGRESS)
+		return AbmThreshold<INGRESS>(port, qIndex, type, unsched);
+	else
+		return AbmThreshold<EGRESS>(port, qIndex, type, unsched);
+}
+
+template <SwitchMmu::Direction D>
+uint64_t SwitchMmu::FabThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched) {
+	uint64_t remaining = 0;
+	if (D == INGRESS) {
 		uint64_t ingressPoolSharedUsed = GetIngressSharedUsed(); // Total bytes used from the ingress "shared" pool specifically.
 		uint64_t ingressSharedPool = ingressPool - totalIngressReserved;
-		if (ingressSharedPool > ingressPoolSharedUsed) {
-			uint64_t remaining = ingressSharedPool - ingressPoolSharedUsed;
-			double alphaP = 1;
-			if (unsched) {
-				alphaP = alphaHigh;
-			}
-			else {
-				alphaP = alphaIngress[port][qIndex];
-			}
-			uint64_t FAB_Threshold = alphaP * (remaining);
-			return std::min(uint64_t(FAB_Threshold), UINT64_MAX - 1024 * 1024);
-		}
-		else {
+		if (ingressSharedPool <= ingressPoolSharedUsed) {
 			// ingressPoolShared is full. There is no `remaining` buffer in ingressPoolShared.
-			// DT's threshold returns zero in this case, but using if else just to avoid threshold computations even in the simple case.
 			return 0;
 		}
+		remaining = ingressSharedPool - ingressPoolSharedUsed;
 	}
-	else if (inout == "egress") {
-		double remaining = 0;
-		if (egressPool[type] > egressPoolUsed[type]) {
-			uint64_t remaining = egressPool[type] - egressPoolUsed[type];
-			// UINT64_MAX - 1024*1024 is just a randomly chosen big value.
-			// Just don't want to return UINT64_MAX value, sometimes causes overflow issues later.
-			double alphaP = 1;
-			if (unsched) {
-				alphaP = alphaHigh;
-			}
-			else {
-				alphaP = alphaEgress[port][qIndex];
-			}
-			uint64_t FAB_Threshold = alphaP * (remaining);
-			return std::min(FAB_Threshold, UINT64_MAX - 1024 * 1024);
-		}
-		else {
+	else {
+		if (egressPool[type] <= egressPoolUsed[type]) {
 			return 0;
 		}
+		remaining = egressPool[type] - egressPoolUsed[type];
+	}
+	double alphaP = 1;
+	if (unsched) {
+		alphaP = alphaHigh;
+	}
+	else {
+		alphaP = (D == INGRESS) ? alphaIngress[port][qIndex] : alphaEgress[port][qIndex];
 	}
+	// UINT64_MAX - 1024*1024 is just a randomly chosen big value.
+	// Just don't want to return UINT64_MAX value, sometimes causes overflow issues later.
+	uint64_t FAB_Threshold = alphaP * (remaining);
+	return std::min(FAB_Threshold, UINT64_MAX - 1024 * 1024);
 }
 
+uint64_t SwitchMmu::FlowAwareBuffer(uint32_t port, uint32_t qIndex, Direction inout, uint32_t type, uint32_t unsched) {
+	if (inout == INGRESS)
+		return FabThreshold<INGRESS>(port, qIndex, type, unsched);
+	else
+		return FabThreshold<EGRESS>(port, qIndex, type, unsched);
+}
 
-
-uint64_t SwitchMmu::ReverieThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched) {
-	if (type == LOSSLESS) {
-		// double remaining = 0;
-		double satLevel = double(ingressLpf_bytes[port][qIndex]) / congestionIndicator;
-		if (satLevel > 1) {
-			satLevel = 1;
-		}
-		setCongested(port, qIndex, "ingress", satLevel);
-		
-		// uint64_t ingressPoolSharedUsed = GetIngressSharedUsed(); // Total bytes used from the ingress "shared" pool specifically.
-		// uint64_t ingressSharedPool = ingressPool - totalIngressReserved;
-		// if (ingressSharedPool > ingressPoolSharedUsed) {
-		// 	uint64_t remaining = ingressSharedPool - ingressPoolSharedUsed;
-		// 	return std::min(uint64_t(alphaIngress[port][qIndex] * (remaining)), UINT64_MAX - 1024 * 1024);
-		// }
-		// else {
-		// 	// ingressPoolShared is full. There is no `remaining` buffer in ingressPoolShared.
-		// 	// DT's threshold returns zero in this case, but using if else just to avoid threshold computations even in the simple case.
-		// 	return 0;
-		// }
-		uint64_t sharedusedbuffer = sharedPoolUsed; //GetIngressSharedUsed();
-		uint64_t sharedbuffer = sharedPool; // ingressPool - totalIngressReserved;
-		if (sharedbuffer > sharedusedbuffer ) {
-			uint64_t remaining = sharedbuffer - sharedusedbuffer;
-			double alphaP = alphaIngress[port][qIndex];
-			uint64_t Reverie_Threshold = alphaP * (remaining) * (1.0 / GetNofP("ingress", qIndex)) ;//+ (ingress_bytes[port][qIndex] - ingressLpf_bytes[port][qIndex]);
-			return std::min(uint64_t(Reverie_Threshold), UINT64_MAX - 1024 * 1024);
-		}
-		else {
-			// SharedPool is full. There is no `remaining` buffer.
-			// The threshold returns zero in this case, but using if else just to avoid threshold computations even in the simple case.
-			return 0;
-		}
+// Reverie keeps a single shared pool. Lossless is admitted at the ingress, lossy at the egress.
+template <uint32_t Type>
+uint64_t SwitchMmu::ReverieThresholdT(uint32_t port, uint32_t qIndex, uint32_t unsched) {
+	const Direction D = (Type == LOSSLESS) ? INGRESS : EGRESS;
+	uint64_t lpf = (Type == LOSSLESS) ? ingressLpf_bytes[port][qIndex] : egressLpf_bytes[port][qIndex];
+	double satLevel = double(lpf) / congestionIndicator;
+	if (satLevel > 1) {
+		satLevel = 1;
 	}
-	else if (type == LOSSY) {
-		// double remaining = 0;
-		double satLevel = double(egressLpf_bytes[port][qIndex]) / congestionIndicator;
-		if (satLevel > 1) {
-			satLevel = 1;
-		}
-		setCongested(port, qIndex, "egress", satLevel);
-		if (sharedPool > sharedPoolUsed) {
-			uint64_t remaining = sharedPool - sharedPoolUsed;
-			double alphaP = 1;
-			if (unsched) {
-				alphaP = alphaHigh;
-			}
-			else {
-				alphaP = alphaEgress[port][qIndex];
-			}
-			uint64_t Reverie_Threshold = alphaP * (remaining) * (1.0 / GetNofP("egress", qIndex)); //* egress_bytes[port][qIndex]/egressLpf_bytes[port][qIndex];
-			return std::min(uint64_t(Reverie_Threshold), UINT64_MAX - 1024 * 1024);
+	setCongested(port, qIndex, D, satLevel);
+	if (sharedPool > sharedPoolUsed) {
+		uint64_t remaining = sharedPool - sharedPoolUsed;
+		double alphaP = 1;
+		if (Type == LOSSY && unsched) {
+			alphaP = alphaHigh;
 		}
 		else {
-			// SharedPool is full. There is no `remaining` buffer.
-			// The threshold returns zero in this case, but using if else just to avoid threshold computations even in the simple case.
-			return 0;
+			alphaP = (Type == LOSSLESS) ? alphaIngress[port][qIndex] : alphaEgress[port][qIndex];
 		}
+		uint64_t Reverie_Threshold = alphaP * (remaining) * (1.0 / GetNofP(D, qIndex));
+		return std::min(uint64_t(Reverie_Threshold), UINT64_MAX - 1024 * 1024);
+	}
+	else {
+		// SharedPool is full. There is no `remaining` buffer.
+		// The threshold returns zero in this case, but using if else just to avoid threshold computations even in the simple case.
+		return 0;
 	}
 }
 
-uint64_t SwitchMmu::Threshold(uint32_t port, uint32_t qIndex, std::string inout, uint32_t type, uint32_t unsched) {
-	uint64_t thresh = 0;
-	if (inout == "ingress") {
-		switch (ingressAlg[type]) {
-		case DT:
-			thresh = DynamicThreshold(port, qIndex, inout, type);
-			break;
-		case ABM:
-			thresh = ActiveBufferManagement(port, qIndex, inout, type, unsched);
-			break;
-		case FAB:
-			thresh = FlowAwareBuffer(port, qIndex, inout, type, unsched);
-			break;
-		default:
-			thresh = DynamicThreshold(port, qIndex, inout, type);
-			break;
-		}
+uint64_t SwitchMmu::ReverieThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched) {
+	if (type == LOSSLESS)
+		return ReverieThresholdT<LOSSLESS>(port, qIndex, unsched);
+	else
+		return ReverieThresholdT<LOSSY>(port, qIndex, unsched);
+}
+
+uint64_t SwitchMmu::Threshold(uint32_t port, uint32_t qIndex, Direction inout, uint32_t type, uint32_t unsched) {
+	return (this->*thresholdFn[inout][type])(port, qIndex, type, unsched);
+}
+
+template <SwitchMmu::Direction D>
+SwitchMmu::ThresholdFn SwitchMmu::SelectThreshold(uint32_t alg) {
+	switch (alg) {
+	case ABM:
+		return &SwitchMmu::AbmThreshold<D>;
+	case FAB:
+		return &SwitchMmu::FabThreshold<D>;
+	case DT:
+	default:
+		return &SwitchMmu::DtThreshold<D>;
 	}
-	else if (inout == "egress") {
-		switch (egressAlg[type]) {
-		case DT:
-			thresh = DynamicThreshold(port, qIndex, inout, type);
-			break;
-		case ABM:
-			thresh = ActiveBufferManagement(port, qIndex, inout, type, unsched);
-			break;
-		case FAB:
-			thresh = FlowAwareBuffer(port, qIndex, inout, type, unsched);
-			break;
-		default:
-			thresh = DynamicThreshold(port, qIndex, inout, type);
-			break;
-		}
+}
+
+// Called whenever the buffer model or an algorithm changes, so that the per packet path only
+// follows pointers.
+void SwitchMmu::SelectPolicies() {
+	for (uint32_t type = 0; type < 2; type++) {
+		thresholdFn[INGRESS][type] = SelectThreshold<INGRESS>(ingressAlg[type]);
+		thresholdFn[EGRESS][type] = SelectThreshold<EGRESS>(egressAlg[type]);
+	}
+	switch (bufferModel) {
+	case REVERIE:
+		checkIngressFn = &SwitchMmu::CheckIngressT<REVERIE>;
+		checkEgressFn = &SwitchMmu::CheckEgressT<REVERIE>;
+		updateIngressFn = &SwitchMmu::UpdateIngressT<REVERIE>;
+		shouldResumeFn = &SwitchMmu::CheckShouldResumeT<REVERIE>;
+		break;
+	case SONIC:
+	default:
+		checkIngressFn = &SwitchMmu::CheckIngressT<SONIC>;
+		checkEgressFn = &SwitchMmu::CheckEgressT<SONIC>;
+		updateIngressFn = &SwitchMmu::UpdateIngressT<SONIC>;
+		shouldResumeFn = &SwitchMmu::CheckShouldResumeT<SONIC>;
+		break;
+	}
+}
+
+void SwitchMmu::SetBufferModel(std::string model) {
+	if (model == "sonic") {
+		bufferModel = SONIC;
+	}
+	else if (model == "reverie") {
+		bufferModel = REVERIE;
+	}
+	else {
+		std::cout << "unknown bufferModel " << model << " passed to SetBufferModel! Abort!" << std::endl;
+		exit(1);
 	}
-	return thresh;
+	SelectPolicies();
 }
 
 bool SwitchMmu::CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
-	std::string model = bufferModel;
-	if (model == "reverie") {
-		// if (!lpfUpdatedOnce){
-		// 	UpdateLpfCounters();
-		// }
-		switch (type) {
-		case LOSSY:
+	return (this->*checkIngressFn)(port, qIndex, psize, type, unsched);
+}
+
+template <SwitchMmu::BufferModel M>
+bool SwitchMmu::CheckIngressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
+	switch (type) {
+	case LOSSY:
+		if (M == REVERIE) {
 			return true;
-			break;
-		case LOSSLESS:
-			// if reserved is used up
-			if ( ( (psize + ingress_bytes[port][qIndex] > reserveIngress[port][qIndex])
-			        // AND if per queue headroom is used up.
-			        && (psize + GetHdrmBytes(port, qIndex) > xoff[port][qIndex]) && GetHdrmBytes(port, qIndex) > 0 )
-			        // or if the headroom pool is full
-			        || (psize + xoffTotalUsed > xoffTotal && GetHdrmBytes(port, qIndex) > 0 )
-			        // if the ingresspool+headroom is full. With DT, this condition is redundant.
-			        // This is just to account for any badly configured buffer or buffer sharing if any.
-			        || (psize + totalUsed > ingressPool + xoffTotal)
-			        // if the switch buffer is full
-			        || (psize + totalUsed > bufferPool)  ) {
-
-				std::cout << "reverie: dropping lossless packet at ingress admission headroom " << GetHdrmBytes(port, qIndex) << " xoff " << xoff[port][qIndex] << " pktSize " << psize << " xoffTotalUsed " << xoffTotalUsed  << " totalUsed " <<  totalUsed << " ingresspool " << ingressPool << " threshold " << ReverieThreshold(port, qIndex, LOSSLESS, unsched) << " ingress_bytes " << ingressLpf_bytes[port][qIndex] << std::endl;
-				return false;
-			}
-			else {
-				return true;
-			}
-			break;
-		default:
-			std::cout << "unknown type came in to CheckIngressAdmission function! This is not expected. Abort!" << std::endl;
-			exit(1);
 		}
-	}
-	else if (model == "sonic") {
-		switch (type) {
-		case LOSSY:
-			// if ingress bytes is greater than the ingress threshold
-			if ( (psize + ingress_bytes[port][qIndex] > Threshold(port, qIndex, "ingress", type , unsched)
-			        // AND if the reserved is usedup
-			        && psize + ingress_bytes[port][qIndex] > reserveIngress[port][qIndex])
-			        // if the ingress pool is full. With DT, this condition is redundant.
-			        // This is just to account for any badly configured buffer or buffer sharing if any.
-			        || (psize + (totalUsed - xoffTotalUsed) > ingressPool)
-			        // or if the switch buffer is full
-			        || (psize + totalUsed > bufferPool) )
-			{
-				return false;
+		// if ingress bytes is greater than the ingress threshold
+		if ( (psize + ingress_bytes[port][qIndex] > (this->*thresholdFn[INGRESS][LOSSY])(port, qIndex, LOSSY, unsched)
+		        // AND if the reserved is usedup
+		        && psize + ingress_bytes[port][qIndex] > reserveIngress[port][qIndex])
+		        // if the ingress pool is full. With DT, this condition is redundant.
+		        // This is just to account for any badly configured buffer or buffer sharing if any.
+		        || (psize + (totalUsed - xoffTotalUsed) > ingressPool)
+		        // or if the switch buffer is full
+		        || (psize + totalUsed > bufferPool) )
+		{
+			return false;
+		}
+		else {
+			return true;
+		}
+		break;
+	case LOSSLESS:
+		// if reserved is used up
+		if ( ( (psize + ingress_bytes[port][qIndex] > reserveIngress[port][qIndex])
+		        // AND if per queue headroom is used up.
+		        && (psize + GetHdrmBytes(port, qIndex) > xoff[port][qIndex]) && GetHdrmBytes(port, qIndex) > 0 )
+		        // or if the headroom pool is full
+		        || (psize + xoffTotalUsed > xoffTotal && GetHdrmBytes(port, qIndex) > 0 )
+		        // if the ingresspool+headroom is full. With DT, this condition is redundant.
+		        // This is just to account for any badly configured buffer or buffer sharing if any.
+		        || (psize + totalUsed > ingressPool + xoffTotal)
+		        // if the switch buffer is full
+		        || (psize + totalUsed > bufferPool)  )
+		{
+			if (M == REVERIE) {
+				std::cout << "reverie: dropping lossless packet at ingress admission headroom " << GetHdrmBytes(port, qIndex) << " xoff " << xoff[port][qIndex] << " pktSize " << psize << " xoffTotalUsed " << xoffTotalUsed  << " totalUsed " <<  totalUsed << " ingresspool " << ingressPool << " threshold " << ReverieThresholdT<LOSSLESS>(port, qIndex, unsched) << " ingress_bytes " << ingressLpf_bytes[port][qIndex] << std::endl;
 			}
 			else {
-				return true;
-			}
-			break;
-		case LOSSLESS:
-			// if reserved is used up
-			if ( ( (psize + ingress_bytes[port][qIndex] > reserveIngress[port][qIndex])
-			        // AND if per queue headroom is used up.
-			        && (psize + GetHdrmBytes(port, qIndex) > xoff[port][qIndex]) && GetHdrmBytes(port, qIndex) > 0 )
-			        // or if the headroom pool is full
-			        || (psize + xoffTotalUsed > xoffTotal && GetHdrmBytes(port, qIndex) > 0 )
-			        // if the ingresspool+headroom is full. With DT, this condition is redundant.
-			        // This is just to account for any badly configured buffer or buffer sharing if any.
-			        || (psize + totalUsed > ingressPool + xoffTotal)
-			        // if the switch buffer is full
-			        || (psize + totalUsed > bufferPool)  )
-			{
 				std::cout << "dropping lossless packet at ingress admission headroom " << GetHdrmBytes(port, qIndex) << " xoff " << xoff[port][qIndex] << " pktSize " << psize << " xoffTotalUsed " << xoffTotalUsed << " totalUsed " <<  totalUsed << std::endl;
-				return false;
 			}
-			else {
-				return true;
-			}
-			break;
-		default:
-			std::cout << "unknown type came in to CheckIngressAdmission function! This is not expected. Abort!" << std::endl;
-			exit(1);
+			return false;
 		}
-	}
-	else {
-		std::cout << "unknown bufferModel encountered in CheckIngressAdmission function! This is not expected. Abort!" << std::endl;
+		else {
+			return true;
+		}
+		break;
+	default:
+		std::cout << "unknown type came in to CheckIngressAdmission function! This is not expected. Abort!" << std::endl;
 		exit(1);
 	}
 }
 
 
 bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
-	std::string model = bufferModel;
-	if (model == "reverie") {
+	return (this->*checkEgressFn)(port, qIndex, psize, type, unsched);
+}
+
+template <SwitchMmu::BufferModel M>
+bool SwitchMmu::CheckEgressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
+	if (M == REVERIE) {
 		switch (type) {
 		case LOSSLESS:
 			return true;
 			break;
 		case LOSSY:
 			// if the egress queue length is greater than the threshold
-			if ( (psize + egressLpf_bytes[port][qIndex] > ReverieThreshold(port, qIndex, LOSSY, unsched)
+			if ( (psize + egressLpf_bytes[port][qIndex] > ReverieThresholdT<LOSSY>(port, qIndex, unsched)
 			        // AND if the reserved is usedup. THiS IS NOT SUPPORTED AT THE MOMENT. NO reserved at the egress.
 			        // && psize + egress_bytes[port][qIndex] > reserveEgress[port][qIndex]
 			     )
@@ -769,11 +811,11 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
 			exit(1);
 		}
 	}
-	else if (model == "sonic") {
+	else {
 		switch (type) {
 		case LOSSY:
 			// if the egress queue length is greater than the threshold
-			if ( (psize + egress_bytes[port][qIndex] > Threshold(port, qIndex, "egress", type, unsched)
+			if ( (psize + egress_bytes[port][qIndex] > (this->*thresholdFn[EGRESS][LOSSY])(port, qIndex, LOSSY, unsched)
 			        // AND if the reserved is usedup. THiS IS NOT SUPPORTED AT THE MOMENT. NO reserved at the egress.
 			        // && psize + egress_bytes[port][qIndex] > reserveEgress[port][qIndex]
 			     )
@@ -790,7 +832,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
 			break;
 		case LOSSLESS:
 			// if threshold is exceeded
-			if ( ( (psize + egress_bytes[port][qIndex] > Threshold(port, qIndex, "egress", type, unsched))
+			if ( ( (psize + egress_bytes[port][qIndex] > (this->*thresholdFn[EGRESS][LOSSLESS])(port, qIndex, LOSSLESS, unsched))
 			        // AND reserved is used up. THiS IS NOT SUPPORTED AT THE MOMENT. NO reserved at the egress.
 			        // && (psize + egress_bytes[port][qIndex] > reserveEgress[port][qIndex])
 			     )
@@ -799,7 +841,7 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
 			        // or if the switch buffer is full
 			        || (psize + totalUsed > bufferPool) )
 			{
-				std::cout << "dropping lossless packet at egress admission port " << port << " qIndex " << qIndex << " egress_bytes " << egress_bytes[port][qIndex] << " threshold " << Threshold(port, qIndex, "egress", type, unsched)
+				std::cout << "dropping lossless packet at egress admission port " << port << " qIndex " << qIndex << " egress_bytes " << egress_bytes[port][qIndex] << " threshold " << (this->*thresholdFn[EGRESS][LOSSLESS])(port, qIndex, LOSSLESS, unsched)
 				          << std::endl;
 				return false;
 			}
@@ -812,20 +854,18 @@ bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t ps
 			exit(1);
 		}
 	}
-	else {
-		std::cout << "unknown bufferModel encountered in CheckIngressAdmission function! This is not expected. Abort!" << std::endl;
-		exit(1);
-	}
 	return true;
 }
 
 void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
+	if (lazyDequeueRates) {
+		CatchUpDequeueRate<INGRESS>(port, qIndex);
+	}
+	(this->*updateIngressFn)(port, qIndex, psize, type, unsched);
+}
 
-	std::string model = bufferModel;
-
-	// if (Threshold(port, qIndex, "ingress", LOSSLESS, unsched) != ReverieThreshold(port, qIndex, LOSSLESS, unsched)){
-	// 	std::cout << "FUCK" << std::endl;
-	// }
+template <SwitchMmu::BufferModel M>
+void SwitchMmu::UpdateIngressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched) {
 	// If else are simply unnecessary but its a safety check to avoid magic scenarios (if a packet vanishes in the buffer) where we
 	// might assign negative value to unsigned intergers.
 	if (totalIngressReservedUsed >= GetIngressReservedUsed(port, qIndex)) // removing the old reserved used (will be updated next)
@@ -843,19 +883,13 @@ void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t
 	// Update the total headroom used.
 	if (type == LOSSLESS) {
 		sharedPoolUsed += psize;
-		// uint64_t inst_ingress_shared_bytes = ingress_bytes[port][qIndex];//-xoffUsed[port][qIndex];
-		// ingressLpf_bytes[port][qIndex] = Reveriegamma * ingressLpf_bytes[port][qIndex] + (1.0 - Reveriegamma) * (inst_ingress_shared_bytes);
-		// if (ingress_bytes[port][qIndex] < ingressLpf_bytes[port][qIndex]) {
-		// // if (1){
-		// 	ingressLpf_bytes[port][qIndex] = ingress_bytes[port][qIndex];
-		// }
 		uint64_t threshold = 0;
 
-		if (model=="sonic"){
-			threshold = Threshold(port, qIndex, "ingress", LOSSLESS, unsched);
+		if (M == SONIC) {
+			threshold = (this->*thresholdFn[INGRESS][LOSSLESS])(port, qIndex, LOSSLESS, unsched);
 		}
-		else if (model == "reverie"){
-			threshold = ReverieThreshold(port, qIndex, LOSSLESS, unsched); // get the threshold
+		else {
+			threshold = ReverieThresholdT<LOSSLESS>(port, qIndex, unsched); // get the threshold
 		}
 		// First, remove the previously used headroom corresponding to queue: port, qIndex. This will be updated with current value next.
 		xoffTotalUsed -= xoffUsed[port][qIndex];
@@ -863,13 +897,7 @@ void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t
 		// if headroom is zero
 		if (xoffUsed[port][qIndex] == 0) {
 			// if ingress bytes of the queue exceeds threshold, start using headroom. pfc pause will be triggered by CheckShouldPause later.
-			uint64_t temp = 0;
-			if (model=="sonic"){
-				temp = ingress_bytes[port][qIndex];
-			}
-			else if (model=="reverie"){
-				temp = ingressLpf_bytes[port][qIndex];
-			}
+			uint64_t temp = (M == SONIC) ? ingress_bytes[port][qIndex] : ingressLpf_bytes[port][qIndex];
 			if (temp > threshold) {
 				// LOL: The commented part below was a HUGE mistake identified after debugging some of the lossless packets being dropped. It was a good lesson.
 				// xoffUsed[port][qIndex] += ingress_bytes[port][qIndex] - threshold;
@@ -884,12 +912,13 @@ void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t
 		}
 		// Finally, update the total headroom used by adding (since we removed before) the latest value of xoffUsed (headroom used) by the queue
 		xoffTotalUsed += xoffUsed[port][qIndex]; // add the current used headroom to total headroom
-		// uint64_t inst_ingress_shared_bytes = ingress_bytes[port][qIndex]-xoffUsed[port][qIndex];
-		// ingressLpf_bytes[port][qIndex] = Reveriegamma * ingressLpf_bytes [port][qIndex] + (1-Reveriegamma) * (inst_ingress_shared_bytes);
 	}
 }
 
 void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type) {
+	if (lazyDequeueRates) {
+		CatchUpDequeueRate<EGRESS>(port, qIndex);
+	}
 	egress_bytes[port][qIndex] += psize;
 	egressPoolUsed[type] += psize;
 	if (type == LOSSY) {
@@ -899,6 +928,9 @@ void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t p
 }
 
 void SwitchMmu::RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type) {
+	if (lazyDequeueRates) {
+		CatchUpDequeueRate<INGRESS>(port, qIndex);
+	}
 
 	txBytesIngress[port][qIndex] += psize; // We assume that the packet will not be dropped after this step for any other reason.
 
@@ -974,6 +1006,9 @@ void SwitchMmu::RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint3
 // }
 
 void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type) {
+	if (lazyDequeueRates) {
+		CatchUpDequeueRate<EGRESS>(port, qIndex);
+	}
 
 	txBytesEgress[port][qIndex] += psize; // We assume that the packet will not be dropped after this step for any other reason.
 
@@ -1012,16 +1047,20 @@ bool SwitchMmu::CheckShouldPause(uint32_t port, uint32_t qIndex) {
 }
 
 bool SwitchMmu::CheckShouldResume(uint32_t port, uint32_t qIndex) {
-	std::string model = bufferModel;
+	return (this->*shouldResumeFn)(port, qIndex);
+}
+
+template <SwitchMmu::BufferModel M>
+bool SwitchMmu::CheckShouldResumeT(uint32_t port, uint32_t qIndex) {
 	if (!paused[port][qIndex])
 		return false;
-	if (model == "sonic") {
-		return GetHdrmBytes(port, qIndex) == 0 && (ingress_bytes[port][qIndex] < xon[port][qIndex] || ingress_bytes[port][qIndex] + xon_offset[port][qIndex] <= Threshold(port, qIndex, "ingress", LOSSLESS, 0) );
+	if (M == SONIC) {
+		return GetHdrmBytes(port, qIndex) == 0 && (ingress_bytes[port][qIndex] < xon[port][qIndex] || ingress_bytes[port][qIndex] + xon_offset[port][qIndex] <= (this->*thresholdFn[INGRESS][LOSSLESS])(port, qIndex, LOSSLESS, 0) );
 	}
-	else if (model == "reverie") {
-		return GetHdrmBytes(port, qIndex) == 0 && (ingressLpf_bytes[port][qIndex] < xon[port][qIndex] || ingressLpf_bytes[port][qIndex] + xon_offset[port][qIndex] <= ReverieThreshold(port, qIndex, LOSSLESS, 0) );
+	else {
+		return GetHdrmBytes(port, qIndex) == 0 && (ingressLpf_bytes[port][qIndex] < xon[port][qIndex] || ingressLpf_bytes[port][qIndex] + xon_offset[port][qIndex] <= ReverieThresholdT<LOSSLESS>(port, qIndex, 0) );
 	}
-	// Minor detail: Threshold(port, qIndex, "ingress", LOSSLESS, 0) is used above where type=LOSSLESS and unsched=0; It is obvious that resume is triggered only for LOSSLESS queues.
+	// Minor detail: Threshold(port, qIndex, INGRESS, LOSSLESS, 0) is used above where type=LOSSLESS and unsched=0; It is obvious that resume is triggered only for LOSSLESS queues.
 	// Abound unsched=0: sending resume must be independent of arriving traffic and hence the threshold used is the default value and a prioritized value cannot be used here as is done for admission of priority packets in ABM.
 }
 
@@ -1045,6 +1084,7 @@ bool SwitchMmu::ShouldSendCN(uint32_t ifindex, uint32_t qIndex) {
 	return false;
 }
 void SwitchMmu::ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax) {
+	AddPort(port);
 	kmin[port] = _kmin * 1000;
 	kmax[port] = _kmax * 1000;
 	pmax[port] = _pmax;
@@ -3,7 +3,9 @@
 
 #include <ns3/node.h>
 
+#include <array>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -13,13 +15,36 @@ class Packet;
 class SwitchMmu : public Object
 {
   public:
-    static const uint32_t pCnt = 257; // Number of ports used
-    static const uint32_t qCnt = 8;   // Number of queues/priorities used
+    static const uint32_t qCnt = 8; // Number of queues/priorities used
+
+    enum Direction
+    {
+        INGRESS = 0,
+        EGRESS = 1,
+    };
+
+    enum BufferModel
+    {
+        SONIC = 0,   // separate ingress and egress pools, lossless admitted at the ingress
+        REVERIE = 1, // a single shared pool, admission on low pass filtered queue lengths
+    };
+
+    // per port, per queue state. Indexed as x[port][qIndex], grown by AddPort.
+    template <typename T>
+    using PortQueue = std::vector<std::array<T, qCnt>>;
 
     static TypeId GetTypeId(void);
 
     SwitchMmu(void);
 
+    // Make `port` a valid index of all per port state. New ports get the values last set by the
+    // "all ports" setters (SetAlphaIngress(value), SetHeadroom(b), ...).
+    void AddPort(uint32_t port);
+    uint32_t GetNPorts() const;
+
+    // bytes of heap and object memory held by the MMU
+    uint64_t GetMemoryFootprint() const;
+
     bool CheckIngressAdmission(uint32_t port,
                                uint32_t qIndex,
                                uint32_t psize,
@@ -48,10 +73,8 @@ class SwitchMmu : public Object
 
     void ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax);
 
-    void SetBufferModel(std::string model)
-    {
-        bufferModel = model;
-    }
+    // "sonic" or "reverie"
+    void SetBufferModel(std::string model);
 
     void SetBufferPool(uint64_t b);
 
@@ -95,11 +118,11 @@ class SwitchMmu : public Object
 
     uint64_t Threshold(uint32_t port,
                        uint32_t qIndex,
-                       std::string inout,
+                       Direction inout,
                        uint32_t type,
                        uint32_t alphaPrio);
 
-    uint64_t DynamicThreshold(uint32_t port, uint32_t qIndex, std::string inout, uint32_t type);
+    uint64_t DynamicThreshold(uint32_t port, uint32_t qIndex, Direction inout, uint32_t type);
 
     uint64_t GetHdrmBytes(uint32_t port, uint32_t qIndex);
 
@@ -109,23 +132,23 @@ class SwitchMmu : public Object
 
     uint64_t GetIngressSharedUsed();
 
-    void setCongested(uint32_t portId, uint32_t qIndex, std::string inout, double satLevel);
+    void setCongested(uint32_t portId, uint32_t qIndex, Direction inout, double satLevel);
 
-    double GetNofP(std::string inout, uint32_t qIndex);
+    double GetNofP(Direction inout, uint32_t qIndex);
 
-    double getDequeueRate(uint32_t port, uint32_t qIndex, std::string inout);
+    double getDequeueRate(uint32_t port, uint32_t qIndex, Direction inout);
 
     void updateDequeueRates();
 
     uint64_t ActiveBufferManagement(uint32_t port,
                                     uint32_t qIndex,
-                                    std::string inout,
+                                    Direction inout,
                                     uint32_t type,
                                     uint32_t unsched);
 
     uint64_t FlowAwareBuffer(uint32_t port,
                              uint32_t qIndex,
-                             std::string inout,
+                             Direction inout,
                              uint32_t type,
                              uint32_t unsched);
 
@@ -139,6 +162,13 @@ class SwitchMmu : public Object
         updateIntervalNS = time;
     }
 
+    // Instead of sweeping all queues every updateIntervalNS, update the dequeue rate of a queue
+    // when it is next touched. Must be set before the first packet, like SetABMdequeueUpdateNS.
+    void SetLazyDequeueRates(bool lazy)
+    {
+        lazyDequeueRates = lazy;
+    }
+
     void SetPortCount(uint32_t pc)
     {
         portCount = pc;
@@ -150,11 +180,11 @@ class SwitchMmu : public Object
 
     // config
     uint32_t node_id;
-    uint32_t kmin[pCnt], kmax[pCnt];
-    double pmax[pCnt];
+    std::vector<uint32_t> kmin, kmax;
+    std::vector<double> pmax;
 
     // Buffer model
-    std::string bufferModel;
+    BufferModel bufferModel;
 
     // Buffer pools
     uint64_t bufferPool;
@@ -173,22 +203,21 @@ class SwitchMmu : public Object
     uint64_t sharedPoolUsed;
 
     // buffer configuration.
-    uint64_t reserveIngress[pCnt][qCnt];
-    uint64_t reserveEgress[pCnt][qCnt];
-    double alphaEgress[pCnt][qCnt];
-    double alphaIngress[pCnt][qCnt];
-    uint64_t xoff[pCnt][qCnt];
-    uint64_t xon[pCnt][qCnt];
-    uint64_t xon_offset[pCnt][qCnt];
+    PortQueue<uint64_t> reserveIngress;
+    PortQueue<uint64_t> reserveEgress;
+    PortQueue<double> alphaEgress;
+    PortQueue<double> alphaIngress;
+    PortQueue<uint64_t> xoff;
+    PortQueue<uint64_t> xon;
+    PortQueue<uint64_t> xon_offset;
 
     // per queue run time
-    uint64_t ingress_bytes[pCnt][qCnt];
-    uint64_t hdrm_bytes[pCnt][qCnt];
-    uint32_t paused[pCnt][qCnt];
-    uint64_t egress_bytes[pCnt][qCnt];
-    uint64_t xoffUsed[pCnt][qCnt];
-    uint64_t ingressLpf_bytes[pCnt][qCnt];
-    uint64_t egressLpf_bytes[pCnt][qCnt];
+    PortQueue<uint64_t> ingress_bytes;
+    PortQueue<uint32_t> paused;
+    PortQueue<uint64_t> egress_bytes;
+    PortQueue<uint64_t> xoffUsed;
+    PortQueue<uint64_t> ingressLpf_bytes;
+    PortQueue<uint64_t> egressLpf_bytes;
 
     // Buffer Sharing algorithm
     uint32_t ingressAlg[2];
@@ -197,21 +226,82 @@ class SwitchMmu : public Object
     // ABM realted variables
     double NofPIngress[qCnt];
     double NofPEgress[qCnt];
-    double congestedIngress[pCnt][qCnt];
-    double congestedEgress[pCnt][qCnt];
-    double dequeueRateIngress[pCnt][qCnt];
-    double dequeueRateEgress[pCnt][qCnt];
-    uint64_t txBytesIngress[pCnt][qCnt];
-    uint64_t txBytesEgress[pCnt][qCnt];
-    uint64_t bandwidth[pCnt];
+    PortQueue<double> congestedIngress;
+    PortQueue<double> congestedEgress;
+    PortQueue<double> dequeueRateIngress;
+    PortQueue<double> dequeueRateEgress;
+    PortQueue<uint64_t> txBytesIngress;
+    PortQueue<uint64_t> txBytesEgress;
+    std::vector<uint64_t> bandwidth;
     uint32_t congestionIndicator;
     double alphaHigh;
     double updateIntervalNS;
     uint32_t dequeueUpdatedOnce;
     uint32_t portCount;
+    bool lazyDequeueRates;
+    int64_t dequeueEpochStart; // time step of the first sweep
+    int64_t dequeueInterval;   // updateIntervalNS in time steps
+    // with lazyDequeueRates, the last sweep (counted from dequeueEpochStart) applied to a queue
+    PortQueue<int64_t> dequeueEpochIngress;
+    PortQueue<int64_t> dequeueEpochEgress;
 
     double Reveriegamma;
     uint32_t lpfUpdatedOnce;
+
+  private:
+    typedef uint64_t (SwitchMmu::*ThresholdFn)(uint32_t port,
+                                               uint32_t qIndex,
+                                               uint32_t type,
+                                               uint32_t unsched);
+
+    // Resolve the buffer model and the algorithms into the function pointers below. Called by the
+    // constructor and the setters, so the per packet path never looks at strings or alg numbers.
+    void SelectPolicies();
+    template <Direction D>
+    static ThresholdFn SelectThreshold(uint32_t alg);
+
+    template <Direction D>
+    uint64_t DtThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched);
+    template <Direction D>
+    uint64_t AbmThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched);
+    template <Direction D>
+    uint64_t FabThreshold(uint32_t port, uint32_t qIndex, uint32_t type, uint32_t unsched);
+    template <uint32_t Type>
+    uint64_t ReverieThresholdT(uint32_t port, uint32_t qIndex, uint32_t unsched);
+
+    template <BufferModel M>
+    bool CheckIngressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched);
+    template <BufferModel M>
+    bool CheckEgressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched);
+    template <BufferModel M>
+    void UpdateIngressT(uint32_t port, uint32_t qIndex, uint32_t psize, uint32_t type, uint32_t unsched);
+    template <BufferModel M>
+    bool CheckShouldResumeT(uint32_t port, uint32_t qIndex);
+
+    // normalized dequeue rate of a queue that sent txBytes during the last interval
+    double DequeueRate(uint32_t port, uint64_t txBytes, uint64_t queueBytes);
+    template <Direction D>
+    void CatchUpDequeueRate(uint32_t port, uint32_t qIndex);
+
+    ThresholdFn thresholdFn[2][2]; // [Direction][type], per ingressAlg/egressAlg
+    bool (SwitchMmu::*checkIngressFn)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+    bool (SwitchMmu::*checkEgressFn)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+    void (SwitchMmu::*updateIngressFn)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+    bool (SwitchMmu::*shouldResumeFn)(uint32_t, uint32_t);
+
+    // values given to the queues of ports added after an "all ports" setter
+    struct QueueConfig
+    {
+        uint64_t reserveIngress;
+        double alphaEgress;
+        double alphaIngress;
+        uint64_t xoff;
+        uint64_t xon;
+        uint64_t xon_offset;
+    };
+
+    QueueConfig defaultConfig;
+    uint32_t nPorts;
 };
 
 } /* namespace ns3 */
@@ -15,7 +15,6 @@
 #include "ns3/packet.h"
 #include "ns3/pause-header.h"
 #include "ns3/simulator.h"
-#include "ns3/tcp-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/uinteger.h"
 #include "ns3/unsched-tag.h"
@@ -64,45 +63,53 @@ SwitchNode::GetTypeId(void)
 }
 
 SwitchNode::SwitchNode()
+{
+    Construct();
+}
+
+SwitchNode::SwitchNode(uint32_t systemId)
+    : Node(systemId)
+{
+    Construct();
+}
+
+void
+SwitchNode::Construct()
 {
     m_ecmpSeed = m_id;
     m_node_type = 1;
     m_mmu = CreateObject<SwitchMmu>();
-    for (uint32_t i = 0; i < pCnt; i++)
-    {
-        for (uint32_t j = 0; j < pCnt; j++)
-        {
-            for (uint32_t k = 0; k < qCnt; k++)
-            {
-                m_bytes[i][j][k] = 0;
-            }
-        }
-    }
-    for (uint32_t i = 0; i < pCnt; i++)
-    {
-        m_txBytes[i] = 0;
-    }
-    for (uint32_t i = 0; i < pCnt; i++)
-    {
-        m_lastPktSize[i] = m_lastPktTs[i] = 0;
-    }
-    for (uint32_t i = 0; i < pCnt; i++)
+    m_lb = CreateObject<SwitchLoadBalancer>();
+    m_lb->SetQueueLengthCallback(MakeCallback(&SwitchNode::GetEgressBytes, this));
+    // size the per port state to the devices we actually get
+    RegisterDeviceAdditionListener(MakeCallback(&SwitchNode::DeviceAdded, this));
+}
+
+void
+SwitchNode::DeviceAdded(Ptr<NetDevice> device)
+{
+    uint32_t n = device->GetIfIndex() + 1;
+    if (m_txBytes.size() < n)
     {
-        m_u[i] = 0;
+        m_txBytes.resize(n, 0);
+        m_lastPktSize.resize(n, 0);
+        m_lastPktTs.resize(n, 0);
+        m_u.resize(n, 0);
     }
+    m_mmu->AddPort(device->GetIfIndex());
 }
 
-int
-SwitchNode::GetOutDev(Ptr<const Packet> p, CustomHeader& ch)
+uint32_t
+SwitchNode::GetEgressBytes(uint32_t ifIndex)
 {
-    // look up entries
-    Ptr<Packet> cp = p->Copy();
+    return DynamicCast<QbbNetDevice>(m_devices[ifIndex])->GetQueue()->GetNBytesTotal();
+}
 
-    PppHeader ph;
-    cp->RemoveHeader(ph);
-    Ipv4Header ih;
-    cp->RemoveHeader(ih);
-    auto entry = m_rtTable.find(ih.GetDestination().Get());
+int
+SwitchNode::GetOutDev(const CustomHeader& ch)
+{
+    // look up entries, ch is already parsed by QbbNetDevice::Receive so the packet is not touched
+    auto entry = m_rtTable.find(ch.dip);
 
     // no matching entry
     if (entry == m_rtTable.end())
@@ -112,6 +119,10 @@ SwitchNode::GetOutDev(Ptr<const Packet> p, CustomHeader& ch)
 
     // entry found
     auto& nexthops = entry->second;
+    if (nexthops.size() == 1)
+    {
+        return nexthops[0];
+    }
 
     // pick one next hop based on hash
     union {
@@ -119,26 +130,11 @@ SwitchNode::GetOutDev(Ptr<const Packet> p, CustomHeader& ch)
         uint32_t u32[3];
     } buf;
 
-    buf.u32[0] = ih.GetSource().Get();
-    buf.u32[1] = ih.GetDestination().Get();
-    if (ih.GetProtocol() == 0x6)
-    {
-        TcpHeader th;
-        cp->PeekHeader(th);
-        buf.u32[2] = th.GetSourcePort() | ((uint32_t)th.GetDestinationPort() << 16);
-    }
-    else if (ch.l3Prot == 0x11)
-    {
-        buf.u32[2] = ch.udp.sport | ((uint32_t)ch.udp.dport << 16);
-    }
-    else if (ch.l3Prot == 0xFC || ch.l3Prot == 0xFD)
-    {
-        buf.u32[2] = ch.ack.sport | ((uint32_t)ch.ack.dport << 16);
-    }
+    buf.u32[0] = ch.sip;
+    buf.u32[1] = ch.dip;
+    buf.u32[2] = ch.GetL4Ports();
 
-    uint32_t idx = EcmpHash(buf.u8, 12, m_ecmpSeed) % nexthops.size();
-    // if (nexthops.size()>1){ std::cout << "selected " << idx << std::endl; }
-    idx = 0;
+    uint32_t idx = m_lb->Select(EcmpHash(buf.u8, 12, m_ecmpSeed), nexthops);
     return nexthops[idx];
 }
 
@@ -168,7 +164,7 @@ SwitchNode::CheckAndSendResume(uint32_t inDev, uint32_t qIndex)
 void
 SwitchNode::SendToDev(Ptr<Packet> p, CustomHeader& ch)
 {
-    int idx = GetOutDev(p, ch);
+    int idx = GetOutDev(ch);
     if (idx >= 0)
     {
         NS_ASSERT_MSG(m_devices[idx]->IsLinkUp(),
@@ -229,7 +225,7 @@ SwitchNode::SendToDev(Ptr<Packet> p, CustomHeader& ch)
             }
             CheckAndSendPfc(inDev, qIndex);
         }
-        m_bytes[inDev][idx][qIndex] += p->GetSize();
+        m_bytes[BytesKey(inDev, idx, qIndex)] += p->GetSize();
         m_devices[idx]->SwitchSend(qIndex, p, ch);
         DynamicCast<QbbNetDevice>(m_devices[idx])->totalBytesRcvd +=
             p->GetSize(); // Attention: this is the egress port's total received packets. Not the
@@ -328,7 +324,7 @@ SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p
         uint32_t inDev = t.GetPortId();
         m_mmu->RemoveFromIngressAdmission(inDev, qIndex, p->GetSize(), found);
         m_mmu->RemoveFromEgressAdmission(ifIndex, qIndex, p->GetSize(), found);
-        m_bytes[inDev][ifIndex][qIndex] -= p->GetSize();
+        m_bytes[BytesKey(inDev, ifIndex, qIndex)] -= p->GetSize();
         if (m_ecnEnabled)
         {
             bool egressCongested = m_mmu->ShouldSendCN(ifIndex, qIndex);
@@ -497,6 +493,42 @@ SwitchNode::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p
     m_lastPktTs[ifIndex] = Simulator::Now().GetTimeStep();
 }
 
+uint32_t
+SwitchNode::GetBytes(uint32_t inDev, uint32_t outDev, uint32_t qIndex) const
+{
+    auto it = m_bytes.find(BytesKey(inDev, outDev, qIndex));
+    return it == m_bytes.end() ? 0 : it->second;
+}
+
+uint64_t
+SwitchNode::GetMemoryFootprint() const
+{
+    return sizeof(*this) + m_devices.capacity() * sizeof(Ptr<NetDevice>) +
+           m_txBytes.capacity() * (sizeof(uint64_t) * 2 + sizeof(uint32_t) + sizeof(double)) +
+           UnorderedMapFootprint(m_bytes) + RouteTableFootprint() + m_mmu->GetMemoryFootprint();
+}
+
+void
+SwitchNode::PrintMemoryFootprint(std::ostream& os) const
+{
+    os << "switch " << GetId() << " ports " << m_txBytes.size() << " memory "
+       << GetMemoryFootprint() << " B (pfc monitor " << m_bytes.size() << " entries "
+       << UnorderedMapFootprint(m_bytes) << " B, routes " << m_rtTable.size() << " entries "
+       << RouteTableFootprint() << " B, mmu " << m_mmu->GetMemoryFootprint() << " B)"
+       << std::endl;
+}
+
+uint64_t
+SwitchNode::RouteTableFootprint() const
+{
+    uint64_t bytes = UnorderedMapFootprint(m_rtTable);
+    for (auto& entry : m_rtTable)
+    {
+        bytes += entry.second.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
 int
 SwitchNode::logres_shift(int b, int l)
 {
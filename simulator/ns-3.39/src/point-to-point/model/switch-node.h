@@ -3,11 +3,14 @@
 
 #include "pint.h"
 #include "qbb-net-device.h"
+#include "switch-load-balancer.h"
 #include "switch-mmu.h"
 
 #include <ns3/node.h>
 
+#include <ostream>
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -16,21 +19,21 @@ class Packet;
 
 class SwitchNode : public Node
 {
-    static const uint32_t pCnt = 257; // Number of ports used
-    static const uint32_t qCnt = 8;   // Number of queues/priorities used
     uint32_t m_ecmpSeed;
     std::unordered_map<uint32_t, std::vector<int>>
         m_rtTable; // map from ip address (u32) to possible ECMP port (index of dev)
 
     // monitor of PFC
-    uint32_t m_bytes[pCnt][pCnt][qCnt]; // m_bytes[inDev][outDev][qidx] is the bytes from inDev
-                                        // enqueued for outDev at qidx
+    std::unordered_map<uint64_t, uint32_t>
+        m_bytes; // m_bytes[BytesKey(inDev, outDev, qidx)] is the bytes from inDev enqueued for
+                 // outDev at qidx. Only (inDev, outDev, qidx) that ever carried traffic have an entry.
 
-    uint64_t m_txBytes[pCnt]; // counter of tx bytes
+    // per port state, indexed by ifIndex and sized to the devices of the node
+    std::vector<uint64_t> m_txBytes; // counter of tx bytes
 
-    uint32_t m_lastPktSize[pCnt];
-    uint64_t m_lastPktTs[pCnt]; // ns
-    double m_u[pCnt];
+    std::vector<uint32_t> m_lastPktSize;
+    std::vector<uint64_t> m_lastPktTs; // ns
+    std::vector<double> m_u;
 
   protected:
     bool m_ecnEnabled;
@@ -43,23 +46,51 @@ class SwitchNode : public Node
     bool PowerEnabled;
 
   private:
-    int GetOutDev(Ptr<const Packet>, CustomHeader& ch);
+    void Construct();
+    int GetOutDev(const CustomHeader& ch);
     void SendToDev(Ptr<Packet> p, CustomHeader& ch);
     static uint32_t EcmpHash(const uint8_t* key, size_t len, uint32_t seed);
     void CheckAndSendPfc(uint32_t inDev, uint32_t qIndex);
     void CheckAndSendResume(uint32_t inDev, uint32_t qIndex);
+    void DeviceAdded(Ptr<NetDevice> device);
+    uint32_t GetEgressBytes(uint32_t ifIndex);
+
+    static uint64_t BytesKey(uint32_t inDev, uint32_t outDev, uint32_t qIndex)
+    {
+        return ((uint64_t)inDev << 32) | ((uint64_t)outDev << 8) | qIndex;
+    }
+
+    // one node per element plus the bucket array
+    template <typename M>
+    static uint64_t UnorderedMapFootprint(const M& m)
+    {
+        return m.size() * (sizeof(typename M::value_type) + sizeof(void*)) +
+               m.bucket_count() * sizeof(void*);
+    }
+
+    uint64_t RouteTableFootprint() const;
 
   public:
     Ptr<SwitchMmu> m_mmu;
+    Ptr<SwitchLoadBalancer> m_lb;
 
     static TypeId GetTypeId(void);
     SwitchNode();
+    // a switch simulated by MPI rank systemId, see Node(uint32_t systemId)
+    SwitchNode(uint32_t systemId);
     void SetEcmpSeed(uint32_t seed);
     void AddTableEntry(Ipv4Address& dstAddr, uint32_t intf_idx);
     void ClearTable();
     bool SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> packet, CustomHeader& ch);
     void SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p);
 
+    // bytes from inDev currently queued for outDev at qIndex
+    uint32_t GetBytes(uint32_t inDev, uint32_t outDev, uint32_t qIndex) const;
+
+    // bytes of memory held by the node's forwarding state, counters and MMU
+    uint64_t GetMemoryFootprint() const;
+    void PrintMemoryFootprint(std::ostream& os) const;
+
     // for approximate calc in PINT
     int logres_shift(int b, int l);
     int log2apprx(int x, int b, int m, int l); // given x of at most b bits, use most significant m
@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/custom-header.h"
+#include "ns3/int-header.h"
+#include "ns3/packet.h"
+#include "ns3/qbb-header.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-header-template.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \brief The Swift timestamps the NIC writes in place are where CustomHeader reads them
+ */
+class QbbSwiftTimestampTest : public TestCase
+{
+  public:
+    QbbSwiftTimestampTest();
+    void DoRun() override;
+
+  private:
+    void Send();
+};
+
+QbbSwiftTimestampTest::QbbSwiftTimestampTest()
+    : TestCase("QbbNetDevice writes the Swift timestamps in place")
+{
+}
+
+void
+QbbSwiftTimestampTest::Send()
+{
+    // data packet: t_sent
+    RdmaHeaderTemplate data;
+    data.InitData(Ipv4Address("11.0.0.1"), Ipv4Address("11.0.1.1"), 10000, 100, 3);
+    data.SetData(5000, 7, 1000);
+    Ptr<Packet> p = Create<Packet>(1000);
+    p->AddHeader(data);
+    SwiftAttachTSent(p);
+    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    ch.getInt = 1;
+    p->PeekHeader(ch);
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.seq, 5000, "seq overwritten");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.ih.swift.ts, 3000, "t_sent");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.ih.swift.remote_delay, 0, "remote delay of a data packet");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.ih.swift.nhop, 0, "nhop of a data packet");
+
+    // ACK: the remote delay becomes t4 - t2
+    qbbHeader seqh;
+    seqh.SetSeq(6000);
+    IntHeader ih = ch.udp.ih;
+    ih.swift.remote_delay = 1000; // t2, set when the receiver got the data packet
+    seqh.SetIntHeader(ih);
+    RdmaHeaderTemplate ack;
+    ack.InitAck(Ipv4Address("11.0.1.1"), Ipv4Address("11.0.0.1"));
+    ack.SetAck(seqh, 0xFC, 1, 0);
+    p = Create<Packet>(0);
+    p->AddHeader(ack);
+    SwiftCalcEndpointDelay(p);
+    CustomHeader ah(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    ah.getInt = 1;
+    p->PeekHeader(ah);
+    NS_TEST_ASSERT_MSG_EQ(ah.ack.seq, 6000, "seq overwritten");
+    NS_TEST_ASSERT_MSG_EQ(ah.ack.ih.swift.remote_delay, 2000, "endpoint delay");
+    NS_TEST_ASSERT_MSG_EQ(ah.ack.ih.swift.ts, 3000, "t_sent not echoed");
+
+    // a NACK is left alone
+    ack.SetAck(seqh, 0xFD, 2, 0);
+    p = Create<Packet>(0);
+    p->AddHeader(ack);
+    SwiftCalcEndpointDelay(p);
+    p->PeekHeader(ah);
+    NS_TEST_ASSERT_MSG_EQ(ah.ack.ih.swift.remote_delay, 1000, "NACK changed");
+}
+
+void
+QbbSwiftTimestampTest::DoRun()
+{
+    IntHeader::Mode mode = IntHeader::mode;
+    IntHeader::mode = IntHeader::SWIFT;
+    Simulator::Schedule(MicroSeconds(3), &QbbSwiftTimestampTest::Send, this);
+    Simulator::Run();
+    Simulator::Destroy();
+    IntHeader::mode = mode;
+}
+
+/**
+ * \brief TestSuite for the Swift timestamps of QbbNetDevice
+ */
+class QbbSwiftTimestampTestSuite : public TestSuite
+{
+  public:
+    QbbSwiftTimestampTestSuite();
+};
+
+QbbSwiftTimestampTestSuite::QbbSwiftTimestampTestSuite()
+    : TestSuite("qbb-swift-timestamp", UNIT)
+{
+    AddTestCase(new QbbSwiftTimestampTest, TestCase::QUICK);
+}
+
+static QbbSwiftTimestampTestSuite g_qbbSwiftTimestampTestSuite; //!< The testsuite
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/int-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-header.h"
+#include "ns3/rdma-header-template.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief The header templates write the same bytes as the headers added one by one
+ */
+class RdmaHeaderTemplateTest : public TestCase
+{
+  public:
+    RdmaHeaderTemplateTest();
+    void DoRun() override;
+
+  private:
+    void CheckData(uint32_t seq, uint16_t ipid, uint32_t payloadSize);
+    void CheckAck(bool nack, bool sack, uint16_t ipid);
+    void CheckSame(Ptr<Packet> expected, Ptr<Packet> p, std::string what);
+
+    RdmaHeaderTemplate m_data;
+};
+
+RdmaHeaderTemplateTest::RdmaHeaderTemplateTest()
+    : TestCase("RdmaHeaderTemplate matches the separately added headers")
+{
+}
+
+void
+RdmaHeaderTemplateTest::CheckSame(Ptr<Packet> expected, Ptr<Packet> p, std::string what)
+{
+    NS_TEST_ASSERT_MSG_EQ(p->GetSize(), expected->GetSize(), what << " size");
+    std::vector<uint8_t> a(expected->GetSize());
+    std::vector<uint8_t> b(p->GetSize());
+    expected->CopyData(a.data(), a.size());
+    p->CopyData(b.data(), b.size());
+    // PppHeader leaves all but its first 2 bytes unwritten
+    for (uint32_t i = 0; i < a.size(); i++)
+    {
+        if (i >= 2 && i < 14)
+        {
+            continue;
+        }
+        NS_TEST_ASSERT_MSG_EQ((uint32_t)b[i], (uint32_t)a[i], what << " byte " << i);
+    }
+}
+
+void
+RdmaHeaderTemplateTest::CheckData(uint32_t seq, uint16_t ipid, uint32_t payloadSize)
+{
+    Ptr<Packet> expected = Create<Packet>(payloadSize);
+    SeqTsHeader seqTs;
+    seqTs.SetSeq(seq);
+    seqTs.SetPG(3);
+    expected->AddHeader(seqTs);
+    UdpHeader udpHeader;
+    udpHeader.SetDestinationPort(100);
+    udpHeader.SetSourcePort(10000);
+    expected->AddHeader(udpHeader);
+    Ipv4Header ipHeader;
+    ipHeader.SetSource(Ipv4Address("11.0.0.1"));
+    ipHeader.SetDestination(Ipv4Address("11.0.1.1"));
+    ipHeader.SetProtocol(0x11);
+    ipHeader.SetPayloadSize(expected->GetSize());
+    ipHeader.SetTtl(64);
+    ipHeader.SetTos(0);
+    ipHeader.SetIdentification(ipid);
+    expected->AddHeader(ipHeader);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    expected->AddHeader(ppp);
+
+    Ptr<Packet> p = Create<Packet>(payloadSize);
+    m_data.SetData(seq, ipid, payloadSize);
+    p->AddHeader(m_data);
+    CheckSame(expected, p, "data seq " + std::to_string(seq));
+}
+
+void
+RdmaHeaderTemplateTest::CheckAck(bool nack, bool sack, uint16_t ipid)
+{
+    qbbHeader seqh;
+    seqh.SetSeq(123456);
+    seqh.SetPG(3);
+    seqh.SetSport(100);
+    seqh.SetDport(10000);
+    seqh.SetCnp();
+    if (sack)
+    {
+        seqh.SetSack(200000);
+    }
+    uint32_t padding = std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0);
+
+    Ptr<Packet> expected = Create<Packet>(padding);
+    expected->AddHeader(seqh);
+    Ipv4Header head;
+    head.SetDestination(Ipv4Address("11.0.0.1"));
+    head.SetSource(Ipv4Address("11.0.1.1"));
+    head.SetProtocol(nack ? 0xFD : 0xFC);
+    head.SetTtl(64);
+    head.SetPayloadSize(expected->GetSize());
+    head.SetIdentification(ipid);
+    expected->AddHeader(head);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    expected->AddHeader(ppp);
+
+    RdmaHeaderTemplate ack;
+    ack.InitAck(Ipv4Address("11.0.1.1"), Ipv4Address("11.0.0.1"));
+    Ptr<Packet> p = Create<Packet>(padding);
+    ack.SetAck(seqh, nack ? 0xFD : 0xFC, ipid, padding);
+    p->AddHeader(ack);
+    CheckSame(expected, p, std::string(nack ? "nack" : "ack") + (sack ? " with sack" : ""));
+}
+
+void
+RdmaHeaderTemplateTest::DoRun()
+{
+    IntHeader::Mode mode = IntHeader::mode;
+    for (IntHeader::Mode m : {IntHeader::NORMAL, IntHeader::TS, IntHeader::PINT, IntHeader::NONE})
+    {
+        IntHeader::mode = m;
+        m_data = RdmaHeaderTemplate();
+        m_data.InitData(Ipv4Address("11.0.0.1"), Ipv4Address("11.0.1.1"), 10000, 100, 3);
+        CheckData(0, 0, 1000);
+        CheckData(1000, 1, 1000);
+        CheckData(0xfedcba98, 0xffff, 1);
+        // the timestamp of the TS IntHeader is the send time
+        Simulator::Schedule(MicroSeconds(7),
+                            &RdmaHeaderTemplateTest::CheckData,
+                            this,
+                            2000,
+                            2,
+                            9000);
+        Simulator::Run();
+        Simulator::Destroy();
+        CheckAck(false, false, 0);
+        CheckAck(true, false, 1);
+        CheckAck(true, true, 0x1234);
+    }
+    IntHeader::mode = mode;
+}
+
+/**
+ * \brief TestSuite for the RDMA header templates
+ */
+class RdmaHeaderTemplateTestSuite : public TestSuite
+{
+  public:
+    RdmaHeaderTemplateTestSuite();
+};
+
+RdmaHeaderTemplateTestSuite::RdmaHeaderTemplateTestSuite()
+    : TestSuite("rdma-header-template", UNIT)
+{
+    AddTestCase(new RdmaHeaderTemplateTest, TestCase::QUICK);
+}
+
+static RdmaHeaderTemplateTestSuite g_rdmaHeaderTemplateTestSuite; //!< The testsuite
@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/double.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \brief DCQCN timers on the per-NIC timing wheel
+ *
+ * Two alpha timers set in the same 2us slot fire together at its end, a cancelled one does not
+ * fire, and the rescheduled timers go to the next slot.
+ */
+class RdmaMlxTimerWheelTest : public TestCase
+{
+  public:
+    RdmaMlxTimerWheelTest();
+    void DoRun() override;
+
+  private:
+    void Check(double alpha0, double alpha1, double alpha2);
+
+    Ptr<RdmaQueuePair> m_qp[3];
+};
+
+RdmaMlxTimerWheelTest::RdmaMlxTimerWheelTest()
+    : TestCase("RdmaHw fires the DCQCN timers of a slot together")
+{
+}
+
+void
+RdmaMlxTimerWheelTest::Check(double alpha0, double alpha1, double alpha2)
+{
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_qp[0]->mlx().m_alpha, alpha0, 1e-9, "qp 0 at " << Simulator::Now());
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_qp[1]->mlx().m_alpha, alpha1, 1e-9, "qp 1 at " << Simulator::Now());
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_qp[2]->mlx().m_alpha, alpha2, 1e-9, "qp 2 at " << Simulator::Now());
+}
+
+void
+RdmaMlxTimerWheelTest::DoRun()
+{
+    Ptr<RdmaHw> hw = CreateObject<RdmaHw>();
+    hw->SetAttribute("EwmaGain", DoubleValue(0.5));
+    hw->SetAttribute("AlphaResumInterval", DoubleValue(1.0));
+    hw->SetAttribute("MlxTimerSlot", DoubleValue(2.0));
+    hw->SetAttribute("CcMode", UintegerValue(CC_MODE::MLX_CNP));
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        m_qp[i] = CreateObject<RdmaQueuePair>(3,
+                                              Ipv4Address("10.0.0.1"),
+                                              Ipv4Address("10.0.0.2"),
+                                              i,
+                                              100);
+        hw->InitCc(m_qp[i], DataRate("100Gb/s"));
+    }
+
+    hw->ScheduleMlxTimer(m_qp[0], RdmaHw::MLX_UPDATE_ALPHA, NanoSeconds(500));
+    hw->ScheduleMlxTimer(m_qp[1], RdmaHw::MLX_UPDATE_ALPHA, NanoSeconds(1500));
+    hw->ScheduleMlxTimer(m_qp[2], RdmaHw::MLX_UPDATE_ALPHA, NanoSeconds(1000));
+    hw->CancelMlxTimer(m_qp[2], RdmaHw::MLX_UPDATE_ALPHA);
+    Simulator::Schedule(NanoSeconds(1999), &RdmaMlxTimerWheelTest::Check, this, 1, 1, 1);
+    Simulator::Schedule(NanoSeconds(2001), &RdmaMlxTimerWheelTest::Check, this, 0.5, 0.5, 1);
+    // rescheduled at 2us + 1us, rounded up to 4us
+    Simulator::Schedule(NanoSeconds(3999), &RdmaMlxTimerWheelTest::Check, this, 0.5, 0.5, 1);
+    Simulator::Schedule(NanoSeconds(4001), &RdmaMlxTimerWheelTest::Check, this, 0.25, 0.25, 1);
+    Simulator::Stop(NanoSeconds(5000));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \brief TestSuite for the DCQCN timing wheel
+ */
+class RdmaMlxTimerTestSuite : public TestSuite
+{
+  public:
+    RdmaMlxTimerTestSuite();
+};
+
+RdmaMlxTimerTestSuite::RdmaMlxTimerTestSuite()
+    : TestSuite("rdma-mlx-timer", UNIT)
+{
+    AddTestCase(new RdmaMlxTimerWheelTest, TestCase::QUICK);
+}
+
+static RdmaMlxTimerTestSuite g_rdmaMlxTimerTestSuite; //!< The testsuite
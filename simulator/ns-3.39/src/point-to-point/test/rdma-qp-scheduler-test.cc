@@ -0,0 +1,236 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/enum.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <random>
+
+using namespace ns3;
+
+/**
+ * \brief Check that the ReadyRing NIC scheduler serves qps in the same order as the linear scan
+ *
+ * Two RdmaEgressQueues, one per scheduler, get identical qps and identical random ACKs, NACKs,
+ * window changes, pacing delays and PFC pauses. Every dequeue decision, the content of the qp
+ * group and the next-avail time must match.
+ */
+class RdmaQpSchedulerTest : public TestCase
+{
+  public:
+    RdmaQpSchedulerTest();
+    void DoRun() override;
+
+  private:
+    /// Add a qp with the same parameters to both queues
+    void AddQp();
+    /// Apply one random event, then dequeue from both queues and compare
+    void Step();
+    /**
+     * \brief RdmaHw::GetNxtPacket stand-in
+     * \param qp the qp to send from
+     * \return the packet
+     */
+    Ptr<Packet> GetNxtPkt(Ptr<RdmaQueuePair> qp);
+
+    static const uint32_t nSteps = 20000;
+
+    Ptr<RdmaEgressQueue> m_q[2];
+    std::vector<Ptr<RdmaQueuePair>> m_qps[2]; // all qps ever created, same index in both
+    bool m_paused[RdmaEgressQueue::qCnt];
+    std::mt19937 m_rng;
+    uint32_t m_step;
+    uint32_t m_sent;
+};
+
+RdmaQpSchedulerTest::RdmaQpSchedulerTest()
+    : TestCase("RdmaEgressQueue ReadyRing scheduler matches LinearScan"),
+      m_rng(42),
+      m_step(0),
+      m_sent(0)
+{
+}
+
+Ptr<Packet>
+RdmaQpSchedulerTest::GetNxtPkt(Ptr<RdmaQueuePair> qp)
+{
+    uint32_t size = std::min<uint64_t>(1000, qp->GetBytesLeft());
+    qp->snd_nxt += size;
+    return Create<Packet>(size);
+}
+
+void
+RdmaQpSchedulerTest::AddQp()
+{
+    uint16_t pg = m_rng() % 4;
+    uint16_t sport = m_qps[0].size();
+    uint64_t size = 1000 + m_rng() % 30000;
+    uint32_t win = 2000 + m_rng() % 8000;
+    bool stops = m_rng() % 8 == 0;
+    Time stop = Simulator::Now() + NanoSeconds(m_rng() % 200000);
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        Ptr<RdmaQueuePair> qp =
+            CreateObject<RdmaQueuePair>(pg, Ipv4Address("10.0.0.1"), Ipv4Address("10.0.0.2"), sport, 100);
+        qp->SetSize(size);
+        qp->SetWin(win);
+        qp->SetVarWin(false);
+        qp->powerEnabled = false;
+        if (stops)
+        {
+            qp->stopTime = stop;
+        }
+        qp->m_nextAvail = Simulator::Now();
+        m_qps[k].push_back(qp);
+        m_q[k]->m_qpGrp->AddQp(qp);
+        m_q[k]->AddQp(qp);
+    }
+}
+
+void
+RdmaQpSchedulerTest::Step()
+{
+    uint32_t n = m_qps[0].size();
+    uint32_t event = m_rng() % 100;
+    uint32_t i = m_rng() % n;
+    if (event < 3)
+    {
+        AddQp();
+    }
+    else if (event < 6)
+    {
+        uint32_t pg = m_rng() % 4;
+        m_paused[pg] = !m_paused[pg];
+    }
+    else if (event < 50)
+    { // ACK
+        uint64_t inflight = m_qps[0][i]->snd_nxt - m_qps[0][i]->snd_una;
+        if (inflight > 0)
+        {
+            uint64_t ack = m_qps[0][i]->snd_una + 1 + m_rng() % inflight;
+            for (uint32_t k = 0; k < 2; k++)
+            {
+                m_qps[k][i]->Acknowledge(ack);
+                m_q[k]->WakeQp(m_qps[k][i]);
+            }
+        }
+    }
+    else if (event < 53)
+    { // NACK
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            m_qps[k][i]->snd_nxt = m_qps[k][i]->snd_una;
+            m_q[k]->WakeQp(m_qps[k][i]);
+        }
+    }
+    else if (event < 58)
+    { // window change
+        uint32_t win = 1000 + m_rng() % 9000;
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            m_qps[k][i]->SetWin(win);
+            m_q[k]->WakeQp(m_qps[k][i]);
+        }
+    }
+
+    int res[2];
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        res[k] = m_q[k]->GetNextQindex(m_paused);
+    }
+    NS_TEST_ASSERT_MSG_EQ(res[0], res[1], "different qp selected at step " << m_step);
+    NS_TEST_ASSERT_MSG_EQ(m_q[0]->GetFlowCount(),
+                          m_q[1]->GetFlowCount(),
+                          "different qp group at step " << m_step);
+    for (uint32_t j = 0; j < m_q[0]->GetFlowCount(); j++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_q[0]->GetQp(j)->sport,
+                              m_q[1]->GetQp(j)->sport,
+                              "different qp group at step " << m_step);
+    }
+    if (res[0] >= 0)
+    {
+        Time gap = NanoSeconds(m_rng() % 400);
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            Ptr<RdmaQueuePair> qp = m_q[k]->GetQp(res[k]);
+            m_q[k]->DequeueQindex(res[k]);
+            qp->m_nextAvail = std::max(Simulator::Now() + gap, qp->m_nextAvail);
+        }
+        m_sent++;
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_q[0]->GetNextAvail(),
+                              m_q[1]->GetNextAvail(),
+                              "different next avail time at step " << m_step);
+    }
+
+    if (++m_step < nSteps)
+    {
+        Simulator::Schedule(NanoSeconds(m_rng() % 300), &RdmaQpSchedulerTest::Step, this);
+    }
+}
+
+void
+RdmaQpSchedulerTest::DoRun()
+{
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        Ptr<QbbNetDevice> dev = CreateObject<QbbNetDevice>();
+        dev->SetQueue(CreateObject<BEgressQueue>());
+        m_q[k] = dev->GetRdmaQueue();
+        m_q[k]->SetAttribute("QpScheduler",
+                             EnumValue(k == 0 ? RdmaEgressQueue::LINEAR_SCAN
+                                              : RdmaEgressQueue::READY_RING));
+        m_q[k]->m_qpGrp = CreateObject<RdmaQueuePairGroup>();
+        m_q[k]->m_rdmaGetNxtPkt = MakeCallback(&RdmaQpSchedulerTest::GetNxtPkt, this);
+    }
+    for (uint32_t pg = 0; pg < RdmaEgressQueue::qCnt; pg++)
+    {
+        m_paused[pg] = false;
+    }
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        AddQp();
+    }
+    Simulator::Schedule(NanoSeconds(1), &RdmaQpSchedulerTest::Step, this);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(m_step, nSteps, "test stopped early");
+    NS_TEST_ASSERT_MSG_GT(m_sent, nSteps / 10, "too few packets sent to be meaningful");
+}
+
+/**
+ * \brief TestSuite for the RDMA NIC qp scheduler
+ */
+class RdmaQpSchedulerTestSuite : public TestSuite
+{
+  public:
+    RdmaQpSchedulerTestSuite();
+};
+
+RdmaQpSchedulerTestSuite::RdmaQpSchedulerTestSuite()
+    : TestSuite("rdma-qp-scheduler", UNIT)
+{
+    AddTestCase(new RdmaQpSchedulerTest, TestCase::QUICK);
+}
+
+static RdmaQpSchedulerTestSuite g_rdmaQpSchedulerTestSuite; //!< The testsuite
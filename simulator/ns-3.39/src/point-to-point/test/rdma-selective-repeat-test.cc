@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/custom-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-header.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \brief Selective repeat: SACK on the wire, receiver bitmap and sender retransmission list
+ */
+class RdmaSelectiveRepeatTest : public TestCase
+{
+  public:
+    RdmaSelectiveRepeatTest();
+    void DoRun() override;
+};
+
+RdmaSelectiveRepeatTest::RdmaSelectiveRepeatTest()
+    : TestCase("RdmaHw selective repeat only resends the holes")
+{
+}
+
+void
+RdmaSelectiveRepeatTest::DoRun()
+{
+    // NACK with a SACK, parsed back by qbbHeader and by CustomHeader as the NIC does
+    qbbHeader nack;
+    nack.SetSeq(5000);
+    nack.SetSack(7000);
+    NS_TEST_ASSERT_MSG_EQ(nack.GetSerializedSize(),
+                          qbbHeader::GetBaseSize() + IntHeader::GetStaticSize() + 4,
+                          "SACK not counted");
+    Ptr<Packet> p = Create<Packet>(10);
+    p->AddHeader(nack);
+    qbbHeader copy;
+    p->PeekHeader(copy);
+    NS_TEST_ASSERT_MSG_EQ(copy.GetSack(), 7000, "qbbHeader lost the SACK");
+    Ipv4Header ip;
+    ip.SetProtocol(0xFD);
+    ip.SetPayloadSize(p->GetSize());
+    p->AddHeader(ip);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+    for (uint32_t getInt = 0; getInt < 2; getInt++)
+    {
+        CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header |
+                        CustomHeader::L4_Header);
+        ch.getInt = getInt;
+        uint32_t size = p->PeekHeader(ch);
+        NS_TEST_ASSERT_MSG_EQ(size, ppp.GetSerializedSize() + 20 + nack.GetSerializedSize(),
+                              "CustomHeader size");
+        NS_TEST_ASSERT_MSG_EQ(ch.ack.seq, 5000, "CustomHeader seq");
+        NS_TEST_ASSERT_MSG_EQ(((ch.ack.flags >> qbbHeader::FLAG_SACK) & 1), 1, "CustomHeader flag");
+        NS_TEST_ASSERT_MSG_EQ(ch.ack.sack, 7000, "CustomHeader lost the SACK");
+    }
+
+    Ptr<RdmaHw> hw = CreateObject<RdmaHw>();
+    hw->SetAttribute("Mtu", UintegerValue(1000));
+    hw->SetAttribute("L2ChunkSize", UintegerValue(4000));
+    hw->SetAttribute("L2AckInterval", UintegerValue(1));
+    hw->SetAttribute("SelectiveRepeat", BooleanValue(true));
+
+    // receiver: 1000 is lost, 2000, 3000 and the 500 byte tail wait in the bitmap
+    Ptr<RdmaRxQueuePair> rx = CreateObject<RdmaRxQueuePair>();
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(0, rx, 1000), 1, "in order packet not acked");
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(2000, rx, 1000), 2, "hole not nacked");
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(4000, rx, 500), 2, "hole not nacked");
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(3000, rx, 1000), 2, "NACK rate limited");
+    NS_TEST_ASSERT_MSG_EQ(rx->ReceiverNextExpectedSeq, 1000, "advanced past the hole");
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(1000, rx, 1000), 1, "filled hole not acked");
+    NS_TEST_ASSERT_MSG_EQ(rx->ReceiverNextExpectedSeq, 4500, "held packets not delivered");
+    NS_TEST_ASSERT_MSG_EQ(rx->m_sackBitmap.size(), 0, "bitmap not drained");
+    NS_TEST_ASSERT_MSG_EQ(hw->ReceiverCheckSeq(2000, rx, 1000), 1, "duplicate not acked");
+
+    // sender: everything sent, the NACKs for 2000 and 3000 arrive
+    Ptr<RdmaQueuePair> qp =
+        CreateObject<RdmaQueuePair>(3, Ipv4Address("10.0.0.1"), Ipv4Address("10.0.0.2"), 1, 2);
+    qp->SetSize(4500);
+    qp->snd_nxt = 4500;
+    qp->SetWin(1000);
+    qp->powerEnabled = false;
+    hw->SelectiveRepeatNack(qp, 2000);
+    hw->SelectiveRepeatNack(qp, 3000);
+    NS_TEST_ASSERT_MSG_EQ(qp->irn.retx.size(), 2, "holes below the SACK not queued");
+    NS_TEST_ASSERT_MSG_EQ(qp->GetBytesLeft(), 2000, "retransmissions not left to send");
+    NS_TEST_ASSERT_MSG_EQ(qp->IsWinBound(), false, "retransmission blocked by the window");
+    qp->Acknowledge(1000);
+    NS_TEST_ASSERT_MSG_EQ(qp->GetBytesLeft(), 1000, "acked packet still queued");
+    // what an RTO does: everything on the fly but the SACKed packets
+    for (uint64_t seq = qp->snd_una; seq < qp->snd_nxt; seq += 1000)
+    {
+        qp->MarkLost(seq, std::min<uint64_t>(1000, qp->m_size - seq));
+    }
+    NS_TEST_ASSERT_MSG_EQ(qp->GetBytesLeft(), 1500, "SACKed packets queued");
+    std::pair<uint64_t, uint32_t> pkt = qp->PopRetx();
+    NS_TEST_ASSERT_MSG_EQ(pkt.first, 1000, "lowest hole not first");
+    pkt = qp->PopRetx();
+    NS_TEST_ASSERT_MSG_EQ(pkt.first, 4000, "tail not queued");
+    NS_TEST_ASSERT_MSG_EQ(pkt.second, 500, "tail size");
+    NS_TEST_ASSERT_MSG_EQ(qp->GetBytesLeft(), 0, "bytes left after the retransmissions");
+    NS_TEST_ASSERT_MSG_EQ(qp->IsWinBound(), true, "window ignored");
+}
+
+/**
+ * \brief TestSuite for RDMA selective repeat
+ */
+class RdmaSelectiveRepeatTestSuite : public TestSuite
+{
+  public:
+    RdmaSelectiveRepeatTestSuite();
+};
+
+RdmaSelectiveRepeatTestSuite::RdmaSelectiveRepeatTestSuite()
+    : TestSuite("rdma-selective-repeat", UNIT)
+{
+    AddTestCase(new RdmaSelectiveRepeatTest, TestCase::QUICK);
+}
+
+static RdmaSelectiveRepeatTestSuite g_rdmaSelectiveRepeatTestSuite; //!< The testsuite
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/test.h"
+
+#include <deque>
+#include <random>
+
+using namespace ns3;
+
+/**
+ * \brief Check that lazy ABM dequeue rates match the periodic sweep
+ *
+ * Two ABM MMUs, one sweeping and one lazy, see the same random arrivals and departures, with
+ * bursts, idle gaps longer than several update intervals and queues left untouched for a while.
+ * Every admission decision and every threshold must match. No event falls on the time step of a
+ * sweep, where the sweep may count a packet in either interval.
+ */
+class SwitchMmuLazyDequeueRateTest : public TestCase
+{
+  public:
+    SwitchMmuLazyDequeueRateTest();
+    void DoRun() override;
+
+  private:
+    /// A packet held by both MMUs
+    struct Pkt
+    {
+        uint32_t inPort;
+        uint32_t outPort;
+        uint32_t qIndex;
+        uint32_t size;
+    };
+
+    /// Offer one packet and release some, then schedule the next step
+    void Step();
+
+    static const uint32_t nPorts = 4;
+    static const uint32_t nSteps = 40000;
+    static const uint32_t interval = 25000; // ns
+
+    Ptr<SwitchMmu> m_mmu[2];
+    std::deque<Pkt> m_buffer;
+    std::mt19937 m_rng;
+    int64_t m_start; // time step of the first packet, where the sweeps start
+    uint32_t m_step;
+    uint32_t m_measuredRates;
+};
+
+SwitchMmuLazyDequeueRateTest::SwitchMmuLazyDequeueRateTest()
+    : TestCase("SwitchMmu lazy dequeue rates match the periodic sweep"),
+      m_rng(7),
+      m_start(0),
+      m_step(0),
+      m_measuredRates(0)
+{
+}
+
+void
+SwitchMmuLazyDequeueRateTest::Step()
+{
+    if (m_step == 0)
+    {
+        m_start = Simulator::Now().GetTimeStep();
+    }
+
+    Pkt p;
+    p.inPort = m_rng() % nPorts;
+    p.outPort = m_rng() % nPorts;
+    p.qIndex = 4 + m_rng() % 2;
+    p.size = 500 + m_rng() % 1000;
+    uint64_t in[2];
+    uint64_t out[2];
+    bool ok[2];
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        in[k] = m_mmu[k]->Threshold(p.inPort, p.qIndex, SwitchMmu::INGRESS, 1, 0);
+        out[k] = m_mmu[k]->Threshold(p.outPort, p.qIndex, SwitchMmu::EGRESS, 1, 0);
+        ok[k] = m_mmu[k]->CheckIngressAdmission(p.inPort, p.qIndex, p.size, 1, 0) &&
+                m_mmu[k]->CheckEgressAdmission(p.outPort, p.qIndex, p.size, 1, 0);
+    }
+    NS_TEST_ASSERT_MSG_EQ(in[0], in[1], "different ingress threshold at step " << m_step);
+    NS_TEST_ASSERT_MSG_EQ(out[0], out[1], "different egress threshold at step " << m_step);
+    NS_TEST_ASSERT_MSG_EQ(ok[0], ok[1], "different admission at step " << m_step);
+    if (ok[0])
+    {
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            m_mmu[k]->UpdateIngressAdmission(p.inPort, p.qIndex, p.size, 1, 0);
+            m_mmu[k]->UpdateEgressAdmission(p.outPort, p.qIndex, p.size, 1);
+        }
+        m_buffer.push_back(p);
+    }
+    if (m_mmu[0]->getDequeueRate(p.outPort, p.qIndex, SwitchMmu::EGRESS) != 1)
+    {
+        m_measuredRates++;
+    }
+
+    // drain slower than the arrivals, so that queues build up past the congestion indicator
+    uint32_t departures = m_rng() % 3 == 0 ? 0 : 1;
+    for (uint32_t i = 0; i < departures && !m_buffer.empty(); i++)
+    {
+        Pkt& d = m_buffer.front();
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            m_mmu[k]->RemoveFromIngressAdmission(d.inPort, d.qIndex, d.size, 1);
+            m_mmu[k]->RemoveFromEgressAdmission(d.outPort, d.qIndex, d.size, 1);
+        }
+        m_buffer.pop_front();
+    }
+
+    if (++m_step == nSteps)
+    {
+        Simulator::Stop();
+        return;
+    }
+    uint64_t gap = m_rng() % 100 == 0 ? 50000 + m_rng() % 100000 : 1 + m_rng() % 120;
+    while ((Simulator::Now().GetTimeStep() + NanoSeconds(gap).GetTimeStep() - m_start) %
+               NanoSeconds(interval).GetTimeStep() ==
+           0)
+    {
+        gap++;
+    }
+    Simulator::Schedule(NanoSeconds(gap), &SwitchMmuLazyDequeueRateTest::Step, this);
+}
+
+void
+SwitchMmuLazyDequeueRateTest::DoRun()
+{
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        m_mmu[k] = CreateObject<SwitchMmu>();
+        for (uint32_t port = 0; port < nPorts; port++)
+        {
+            m_mmu[k]->AddPort(port);
+        }
+        m_mmu[k]->SetIngressLossyAlg(110);
+        m_mmu[k]->SetEgressLossyAlg(110);
+        m_mmu[k]->SetABMdequeueUpdateNS(interval);
+        m_mmu[k]->SetLazyDequeueRates(k == 1);
+        m_mmu[k]->SetBufferPool(2 * 1024 * 1024);
+        m_mmu[k]->SetIngressPool(2 * 1024 * 1024);
+        m_mmu[k]->SetEgressLossyPool(1024 * 1024);
+        m_mmu[k]->SetEgressLosslessPool(2 * 1024 * 1024);
+    }
+    Simulator::Schedule(NanoSeconds(3), &SwitchMmuLazyDequeueRateTest::Step, this);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(m_step, nSteps, "test stopped early");
+    NS_TEST_ASSERT_MSG_GT(m_measuredRates, nSteps / 10, "too few measured rates to be meaningful");
+}
+
+/**
+ * \brief TestSuite for the switch MMU
+ */
+class SwitchMmuTestSuite : public TestSuite
+{
+  public:
+    SwitchMmuTestSuite();
+};
+
+SwitchMmuTestSuite::SwitchMmuTestSuite()
+    : TestSuite("switch-mmu", UNIT)
+{
+    AddTestCase(new SwitchMmuLazyDequeueRateTest, TestCase::QUICK);
+}
+
+static SwitchMmuTestSuite g_switchMmuTestSuite; //!< The testsuite
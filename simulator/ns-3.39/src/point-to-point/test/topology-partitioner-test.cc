@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/topology-partitioner.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \brief Partition a leaf-spine and a k=4 fat-tree
+ *
+ * Hosts must stay with their ToR, the ranks must get the same number of hosts, and in the
+ * fat-tree a pod must not be split.
+ */
+class TopologyPartitionerTest : public TestCase
+{
+  public:
+    TopologyPartitionerTest();
+    void DoRun() override;
+};
+
+TopologyPartitionerTest::TopologyPartitionerTest()
+    : TestCase("TopologyPartitioner keeps hosts with their ToR and balances the ranks")
+{
+}
+
+void
+TopologyPartitionerTest::DoRun()
+{
+    // leaf-spine in the format of the examples: 16 hosts, 4 leaves (16-19), 2 spines (20-21)
+    std::stringstream ls;
+    ls << "22 6 4 24\n16 17 18 19 20 21\n";
+    for (uint32_t h = 0; h < 16; h++)
+    {
+        ls << h << " " << 16 + h / 4 << " 25000000000.0 1us 0\n";
+    }
+    for (uint32_t leaf = 16; leaf < 20; leaf++)
+    {
+        for (uint32_t spine = 20; spine < 22; spine++)
+        {
+            ls << leaf << " " << spine << " 100000000000.0 1us 0\n";
+        }
+    }
+    TopologyPartitioner leafSpine;
+    leafSpine.Read(ls);
+    std::vector<uint32_t> part = leafSpine.Partition(2);
+    uint32_t hosts[2] = {0, 0};
+    for (uint32_t h = 0; h < 16; h++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(part[h], part[16 + h / 4], "host " << h << " split from its ToR");
+        hosts[part[h]]++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(hosts[0], 8, "unbalanced hosts");
+    NS_TEST_ASSERT_MSG_NE(part[20], part[21], "spines not spread out");
+    NS_TEST_ASSERT_MSG_EQ(leafSpine.GetCutLinks(part), 4, "wrong cut");
+
+    // k=4 fat-tree: 16 hosts (0-15), 8 edges (16-23), 8 aggregations (24-31), 4 cores (32-35)
+    std::vector<uint32_t> switches;
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (uint32_t s = 16; s < 36; s++)
+    {
+        switches.push_back(s);
+    }
+    for (uint32_t h = 0; h < 16; h++)
+    {
+        links.emplace_back(h, 16 + h / 2);
+    }
+    for (uint32_t pod = 0; pod < 4; pod++)
+    {
+        for (uint32_t e = 0; e < 2; e++)
+        {
+            for (uint32_t a = 0; a < 2; a++)
+            {
+                links.emplace_back(16 + 2 * pod + e, 24 + 2 * pod + a);
+            }
+        }
+        for (uint32_t a = 0; a < 2; a++)
+        {
+            for (uint32_t c = 0; c < 2; c++)
+            {
+                links.emplace_back(24 + 2 * pod + a, 32 + 2 * a + c);
+            }
+        }
+    }
+    TopologyPartitioner fatTree;
+    fatTree.SetTopology(36, switches, links);
+    part = fatTree.Partition(4);
+    for (uint32_t pod = 0; pod < 4; pod++)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(part[4 * pod + i], pod, "pod " << pod << " split");
+        }
+        for (uint32_t s = 0; s < 2; s++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(part[16 + 2 * pod + s], pod, "edge of pod " << pod << " moved");
+            NS_TEST_ASSERT_MSG_EQ(part[24 + 2 * pod + s], pod, "aggregation of pod " << pod << " moved");
+        }
+    }
+    for (uint32_t c = 32; c < 36; c++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(part[c], c - 32, "cores not spread out");
+    }
+}
+
+/**
+ * \brief TestSuite for the MPI topology partitioner
+ */
+class TopologyPartitionerTestSuite : public TestSuite
+{
+  public:
+    TopologyPartitionerTestSuite();
+};
+
+TopologyPartitionerTestSuite::TopologyPartitionerTestSuite()
+    : TestSuite("topology-partitioner", UNIT)
+{
+    AddTestCase(new TopologyPartitionerTest, TestCase::QUICK);
+}
+
+static TopologyPartitionerTestSuite g_topologyPartitionerTestSuite; //!< The testsuite
@@ -0,0 +1,112 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-sketch.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+
+FlowSketch::FlowSketch()
+    : m_mask(0),
+      m_depth(0)
+{
+}
+
+void
+FlowSketch::Configure(uint32_t width, uint32_t depth)
+{
+    NS_ASSERT(width > 0 && depth > 0 && depth <= MAX_DEPTH);
+    uint32_t w = 1;
+    while (w < width)
+    {
+        w <<= 1;
+    }
+    m_mask = w - 1;
+    m_depth = depth;
+    m_cells.assign(uint64_t(w) * depth, Cell{std::numeric_limits<int64_t>::min() / 2, 0});
+}
+
+bool
+FlowSketch::IsConfigured() const
+{
+    return m_depth > 0;
+}
+
+uint32_t
+FlowSketch::Index(uint32_t row, uint32_t flowId) const
+{
+    // splitmix64 of the flow and the row, one independent hash per row
+    uint64_t x = (uint64_t(row) << 32 | flowId) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return row * (m_mask + 1) + (uint32_t(x) & m_mask);
+}
+
+uint32_t
+FlowSketch::Get(uint32_t flowId, Time now, Time window) const
+{
+    NS_ASSERT(IsConfigured());
+    int64_t t = now.GetTimeStep();
+    int64_t w = window.GetTimeStep();
+    uint32_t estimate = std::numeric_limits<uint32_t>::max();
+    for (uint32_t r = 0; r < m_depth; r++)
+    {
+        const Cell& c = m_cells[Index(r, flowId)];
+        estimate = std::min(estimate, t - c.lastSeen > w ? 0 : c.count);
+    }
+    return estimate;
+}
+
+uint32_t
+FlowSketch::Add(uint32_t flowId, uint32_t count, Time now, Time window)
+{
+    NS_ASSERT(IsConfigured());
+    int64_t t = now.GetTimeStep();
+    int64_t w = window.GetTimeStep();
+    uint32_t index[MAX_DEPTH];
+    uint32_t estimate = std::numeric_limits<uint32_t>::max();
+    for (uint32_t r = 0; r < m_depth; r++)
+    {
+        index[r] = Index(r, flowId);
+        Cell& c = m_cells[index[r]];
+        if (t - c.lastSeen > w)
+        {
+            c.count = 0;
+        }
+        estimate = std::min(estimate, c.count);
+    }
+    estimate += count;
+    for (uint32_t r = 0; r < m_depth; r++)
+    {
+        Cell& c = m_cells[index[r]];
+        c.count = std::max(c.count, estimate);
+        c.lastSeen = t;
+    }
+    return estimate;
+}
+
+uint64_t
+FlowSketch::GetMemory() const
+{
+    return m_cells.size() * sizeof(Cell);
+}
+
+} // namespace ns3
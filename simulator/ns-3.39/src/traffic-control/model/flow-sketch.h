@@ -0,0 +1,100 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_SKETCH_H
+#define FLOW_SKETCH_H
+
+#include "ns3/nstime.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Aging count-min sketch of per-flow counters, for the flow classification of
+ * GenQueueDisc (FAB, IB and AFD) in bounded memory
+ *
+ * Approximates the exact per-flow state of GenQueueDisc: a flow's counter restarts from 0 when
+ * the flow was idle for longer than a window, and otherwise grows by every packet. Each of the
+ * depth rows hashes the flow to one of width cells holding a counter and the time it was last
+ * updated; a cell idle for longer than the window reads as 0. The estimate is the minimum over
+ * the rows. Updates are conservative (a cell only grows up to the new estimate), so a flow is
+ * never underestimated and colliding flows inflate each other only as much as needed.
+ */
+class FlowSketch
+{
+  public:
+    static constexpr uint32_t MAX_DEPTH = 16; //!< most rows of a sketch
+
+    FlowSketch();
+
+    /**
+     * \brief Drop all state and use width cells in each of depth rows
+     * \param width cells per row, rounded up to a power of 2
+     * \param depth number of rows, at most MAX_DEPTH
+     */
+    void Configure(uint32_t width, uint32_t depth);
+
+    /// \return whether Configure was called
+    bool IsConfigured() const;
+
+    /**
+     * \brief Add count to a flow
+     * \param flowId the flow
+     * \param count what to add
+     * \param now the current time
+     * \param window a counter idle for longer than this restarts from 0
+     * \return the estimated counter of the flow, count included
+     */
+    uint32_t Add(uint32_t flowId, uint32_t count, Time now, Time window);
+
+    /**
+     * \param flowId the flow
+     * \param now the current time
+     * \param window a counter idle for longer than this reads as 0
+     * \return the estimated counter of the flow
+     */
+    uint32_t Get(uint32_t flowId, Time now, Time window) const;
+
+    /// \return the memory used by the cells, in bytes
+    uint64_t GetMemory() const;
+
+  private:
+    /// A counter and the time step of its last update
+    struct Cell
+    {
+        int64_t lastSeen;
+        uint32_t count;
+    };
+
+    /**
+     * \param row the row
+     * \param flowId the flow
+     * \return index of the cell of the flow in m_cells
+     */
+    uint32_t Index(uint32_t row, uint32_t flowId) const;
+
+    uint32_t m_mask;  //!< width - 1
+    uint32_t m_depth; //!< number of rows
+    std::vector<Cell> m_cells;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_SKETCH_H */
@@ -104,10 +104,26 @@ TypeId GenQueueDisc::GetTypeId (void)
                                      UintegerValue (0),
                                      MakeUintegerAccessor (&GenQueueDisc::strict_priority),
                                      MakeUintegerChecker<uint32_t> ())
+                      .AddAttribute ("FlowSketch", "track the flows of FAB and IB with an aging count-min sketch of bounded memory instead of exact per-flow counters",
+                                     BooleanValue (false),
+                                     MakeBooleanAccessor (&GenQueueDisc::enableFlowSketch),
+                                     MakeBooleanChecker())
+                      .AddAttribute ("FlowSketchWidth", "counters per row of the flow sketch",
+                                     UintegerValue (4096),
+                                     MakeUintegerAccessor (&GenQueueDisc::flowSketchWidth),
+                                     MakeUintegerChecker<uint32_t> (1))
+                      .AddAttribute ("FlowSketchDepth", "rows of the flow sketch",
+                                     UintegerValue (4),
+                                     MakeUintegerAccessor (&GenQueueDisc::flowSketchDepth),
+                                     MakeUintegerChecker<uint32_t> (1, FlowSketch::MAX_DEPTH))
                       .AddAttribute ("predict", "whether to use predictions or not in Credence buffer sharing",
                                      BooleanValue (false),
                                      MakeBooleanAccessor (&GenQueueDisc::enablePredictions),
                                      MakeBooleanChecker())
+                      .AddAttribute ("Predictor", "random forest for Credence predictions. Without it, predictions come from the getPrediction trace",
+                                     PointerValue (),
+                                     MakePointerAccessor (&GenQueueDisc::predictor),
+                                     MakePointerChecker<TreeEnsemble> ())
                       .AddTraceSource ("genEnqueue", "trace enqueue events",
                                        MakeTraceSourceAccessor (&GenQueueDisc::m_rxTrace),
                                        "ns3::Packet::TracedCallback")
@@ -297,6 +313,35 @@ bool GenQueueDisc::ActiveBufferManagement(uint32_t priority, Ptr<Packet> packet)
 }
 
 
+uint32_t
+GenQueueDisc::CountFlow(uint32_t flowId, uint32_t count, Time window) {
+  Time now = Simulator::Now();
+  if (enableFlowSketch) {
+    if (!flowSketch.IsConfigured())
+      flowSketch.Configure(flowSketchWidth, flowSketchDepth);
+    return flowSketch.Add(flowId, count, now, window);
+  }
+
+  auto &entry = FlowCount.try_emplace(flowId, 0, now).first->second;
+  if (now - entry.second > window)
+    entry.first = 0;
+  entry.first += count;
+  entry.second = now;
+  uint32_t counter = entry.first;
+
+  /* A flow idle for longer than the window starts over from zero anyway, so forgetting it changes nothing. */
+  if (FlowCount.size() >= flowPurgeSize) {
+    for (auto it = FlowCount.begin(); it != FlowCount.end();) {
+      if (now - it->second.second > window)
+        it = FlowCount.erase(it);
+      else
+        ++it;
+    }
+    flowPurgeSize = std::max<size_t>(4096, 2 * FlowCount.size());
+  }
+  return counter;
+}
+
 bool GenQueueDisc::FlowAwareBuffer(uint32_t priority, Ptr<Packet> packet) {
 
   double alpha;
@@ -310,23 +355,11 @@ bool GenQueueDisc::FlowAwareBuffer(uint32_t priority, Ptr<Packet> packet) {
     flowId = tag.GetFlowId();
   }
 
-  /* Find the flow entry */
-  if (FlowCount.find(flowId) == FlowCount.end()) {
-    FlowCount[flowId].first = 0;
-    FlowCount[flowId].second = Simulator::Now();
-  }
-
-  /* If the flow did not appear in the last FabWindow duration, reset its bytes counter to zero. */
-  if (Simulator::Now() - FlowCount[flowId].second > FabWindow) {
-    FlowCount[flowId].first = 0;
-  }
-
-  /* Per-flow counters - increment bytes count and last updated time. */
-  FlowCount[flowId].first += packet->GetSize();
-  FlowCount[flowId].second = Simulator::Now();
+  /* Per-flow counters - increment bytes count, reset to zero if the flow did not appear in the last FabWindow duration. */
+  uint32_t flowBytes = CountFlow(flowId, packet->GetSize(), FabWindow);
 
   /* If the flow sent less than FabThreshold no.of bytes in the last FabWindow, then prioritize these packets */
-  if (FlowCount[flowId].first < FabThreshold) {
+  if (flowBytes < FabThreshold) {
     alpha = alphaUnsched; // alphaUnsched is usually set to a high value i.e., these packets are prioritized.
   }
   else {
@@ -413,7 +446,12 @@ bool GenQueueDisc::Credence(uint32_t priority, Ptr<Packet> packet, Ptr<QueueDisc
   int drop = 0;
   if (longestQueueLength > bufferSize/numPorts &&  priority==1){
       if (qlen + packet->GetSize() <= sharedMemory->GetThreshold(portId, priority)){
-        if (enablePredictions){
+        if (enablePredictions && predictor){
+          NS_ASSERT_MSG (predictor->GetNFeatures () == 4, "Credence predictor must take 4 features");
+          float features[4] = {float(qlen), float(avgqlen), float(sharedOccupancy), float(avgsharedoccupancy)};
+          drop = (predictor->Predict(features) == 1);
+        }
+        else if (enablePredictions){
           m_getPrediction(qlen, avgqlen, sharedOccupancy, avgsharedoccupancy,drop);
         }
 
@@ -489,19 +527,10 @@ bool GenQueueDisc::IntelligentBuffer(uint32_t priority, Ptr<Packet> packet) {
   found = packet->PeekPacketTag (tag);
   if (found) {flowId = tag.GetFlowId();}
 
-  if (FlowCount.find(flowId) == FlowCount.end()) {
-    FlowCount[flowId].first = 0;
-    FlowCount[flowId].second = Simulator::Now();
-  }
-
   //DPP
-  if (Simulator::Now() - FlowCount[flowId].second > DppWindow)
-    FlowCount[flowId].first = 0;
-
-  FlowCount[flowId].first += 1;
-  FlowCount[flowId].second = Simulator::Now();
+  uint32_t flowPackets = CountFlow(flowId, 1, DppWindow);
 
-  if (FlowCount[flowId].first < DppThreshold && enableDPPQueue) { // Short flows are sent to queue-0 which is a priority queue.
+  if (flowPackets < DppThreshold && enableDPPQueue) { // Short flows are sent to queue-0 which is a priority queue.
     DPPQueue = 0;
     accept = DynamicThresholds(DPPQueue, packet);
   }
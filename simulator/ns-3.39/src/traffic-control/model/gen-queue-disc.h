@@ -27,6 +27,8 @@
 #include "unordered_map"
 #include "ns3/simulator.h"
 #include "shared-memory.h"
+#include "tree-ensemble.h"
+#include "flow-sketch.h"
 #include "ns3/random-variable-stream.h"
 
 namespace ns3 {
@@ -115,6 +117,15 @@ public:
   void SetDppThreshold(uint32_t n) {DppThreshold = n;}
   bool IntelligentBuffer(uint32_t priority, Ptr<Packet> packet);
 
+  /**
+   * \brief Per-flow counter of FAB and IB: adds count to the flow, restarting from 0 if the flow
+   * was idle for longer than window, in FlowCount or in the sketch
+   * \return the counter of the flow, count included
+   */
+  uint32_t CountFlow(uint32_t flowId, uint32_t count, Time window);
+  /// \return the number of flows with exact state, 0 with the sketch
+  uint32_t GetNFlows() {return FlowCount.size();}
+
   bool AcceptPacket(uint32_t priority, Ptr<Packet> packet, Ptr<QueueDiscItem> item);
 
   void TrimPacket(Ptr<Packet> packetCopy);
@@ -168,6 +179,11 @@ private:
   std::string switchname; //optional
 
   std::unordered_map<uint32_t, std::pair<uint32_t, Time>> FlowCount; // FlowId --> <packetcounter, LastSeen>
+  size_t flowPurgeSize = 4096; // drop the idle flows of FlowCount once it has this many
+  bool enableFlowSketch;
+  uint32_t flowSketchWidth;
+  uint32_t flowSketchDepth;
+  FlowSketch flowSketch; // instead of FlowCount if enableFlowSketch
 
   uint64_t bufferMax[11] = {0};
 
@@ -215,6 +231,7 @@ private:
   Ptr<UniformRandomVariable> urv;
   double addErr;
   bool enablePredictions;
+  Ptr<TreeEnsemble> predictor; // if set, Credence predicts with it instead of the getPrediction trace
   uint32_t numPackets_big;
   uint32_t numPackets_small;
 };
@@ -25,20 +25,75 @@ TypeId SharedMemoryBuffer::GetTypeId (void)
   return tid;
 }
 
+LongestQueueTree::LongestQueueTree()
+	: m_size(0),
+	  m_leaves(1)
+{
+}
+
+void LongestQueueTree::Reset(uint32_t n){
+	m_size = n;
+	m_leaves = 1;
+	while (m_leaves < n){
+		m_leaves <<= 1;
+	}
+	m_value.assign(m_leaves, 0);
+	// all values are 0, so the leftmost leaf of each subtree wins
+	m_winner.assign(m_leaves, 0);
+	for (uint32_t node = m_leaves - 1; node >= 1; node--){
+		m_winner[node] = Winner(2*node);
+	}
+}
+
+uint32_t LongestQueueTree::Winner(uint32_t node) const{
+	return node >= m_leaves ? node - m_leaves : m_winner[node];
+}
+
+void LongestQueueTree::Update(uint32_t i, uint32_t value){
+	NS_ASSERT(i < m_size);
+	if (m_value[i] == value){
+		return;
+	}
+	m_value[i] = value;
+	for (uint32_t node = (i + m_leaves) / 2; node >= 1; node /= 2){
+		uint32_t left = Winner(2*node);
+		uint32_t right = Winner(2*node+1);
+		m_winner[node] = m_value[right] > m_value[left] ? right : left;
+	}
+}
+
+uint32_t LongestQueueTree::Top() const{
+	if (m_size <= 1){
+		return 0;
+	}
+	return m_winner[1];
+}
+
+void DeqWindow::Push(uint32_t bytes, Time t){
+	if (m_samples.size() < CAPACITY){
+		if (m_samples.empty()){
+			m_samples.reserve(CAPACITY);
+		}
+		m_samples.emplace_back(bytes, t);
+		return;
+	}
+	m_samples[m_head] = std::make_pair(bytes, t);
+	m_head = (m_head + 1) % CAPACITY;
+}
+
+const std::pair<uint32_t,Time>& DeqWindow::Front() const{
+	return m_samples[m_head];
+}
+
+const std::pair<uint32_t,Time>& DeqWindow::Back() const{
+	return m_samples[(m_head + m_samples.size() - 1) % m_samples.size()];
+}
+
 SharedMemoryBuffer::SharedMemoryBuffer(){
 	for (int i=0;i<8;i++){
 		N[i]=0;
 	}
-	for (int i=0;i<99;i++){
-		for (int j=0;j<8;j++){
-			saturated[i][j]=0;
-			sumBytes[i][j]=1500;
-			tDiff[i][j]=Seconds(0);
-			queueLength[i][j]=0;
-			averageQueueLength[i][j]=0;
-			threshold[i][j]=0;
-		}
-	}
+	Resize(100); // ports before setPorts, as many as the former fixed arrays had
 
 	OccupiedBuffer=0;
 	numPorts = 0;
@@ -46,6 +101,8 @@ SharedMemoryBuffer::SharedMemoryBuffer(){
 	averageSharedOccupancy=0;
 	thresholdBusy=false;
 	totalThreshold=0;
+	trackLongestQueue=false;
+	trackLongestThreshold=false;
 }
 
 SharedMemoryBuffer::~SharedMemoryBuffer ()
@@ -61,15 +118,11 @@ SharedMemoryBuffer::DoDispose (void)
   for (int i=0;i<8;i++){
   		N[i]=0;
   	}
-  	for (int i=0;i<99;i++){
-  		for (int j=0;j<8;j++){
-  			saturated[i][j]=0;
-  			timestamp[i][j]=Seconds(0);
-			queueLength[i][j]=0;
-			averageQueueLength[i][j]=0;
-			threshold[i][j]=0;
-  		}
+  	ResetQueues();
+  	for (auto &t : timestamp){
+  		t.fill(Seconds(0));
   	}
+  	QueuePtr.clear();
   	TotalBuffer=0;
   	OccupiedBuffer=0;
   	RemainingBuffer=0;
@@ -87,14 +140,7 @@ SharedMemoryBuffer::DoInitialize (void)
   for (int i=0;i<8;i++){
   		N[i]=1;
   	}
-  	for (int i=0;i<99;i++){
-  		for (int j=0;j<8;j++){
-  			saturated[i][j]=0;
-			queueLength[i][j]=0;
-			averageQueueLength[i][j]=0;
-			threshold[i][j]=0;
-		}
-  	}
+  	ResetQueues();
 
   	OccupiedBuffer=0;
 	averageSharedOccupancy=0;
@@ -103,6 +149,52 @@ SharedMemoryBuffer::DoInitialize (void)
   Object::DoInitialize ();
 }
 
+void SharedMemoryBuffer::Resize(uint32_t ports){
+	if (ports <= queueLength.size()){
+		return;
+	}
+	std::array<double,8> bytes;
+	bytes.fill(1500);
+	saturated.resize(ports, std::array<double,8>{});
+	Deq.resize(ports);
+	sumBytes.resize(ports, bytes);
+	tDiff.resize(ports);
+	timestamp.resize(ports);
+	queueLength.resize(ports, std::array<uint32_t,8>{});
+	averageQueueLength.resize(ports, std::array<uint32_t,8>{});
+	threshold.resize(ports, std::array<uint32_t,8>{});
+	QueuePtr.resize(ports);
+	LastUpdatedAverage.resize(ports);
+}
+
+void SharedMemoryBuffer::ResetQueues(void){
+	for (uint32_t i=0;i<queueLength.size();i++){
+		saturated[i].fill(0);
+		queueLength[i].fill(0);
+		averageQueueLength[i].fill(0);
+		threshold[i].fill(0);
+	}
+	trackLongestQueue=false;
+	trackLongestThreshold=false;
+}
+
+void SharedMemoryBuffer::setPorts(uint32_t ports){
+	Resize(ports);
+	numPorts = ports;
+}
+
+void SharedMemoryBuffer::UpdateLongest(uint32_t port, uint32_t queue){
+	if (queue != 1){
+		return;
+	}
+	if (trackLongestQueue && port < longestQueue.GetSize()){
+		longestQueue.Update(port, queueLength[port][1]);
+	}
+	if (trackLongestThreshold && port < longestThreshold.GetSize()){
+		longestThreshold.Update(port, threshold[port][1]);
+	}
+}
+
 
 void SharedMemoryBuffer::SetSharedBufferSize(uint32_t size){
 	TotalBuffer = size;
@@ -126,15 +218,15 @@ uint32_t SharedMemoryBuffer::GetQueueSize(uint32_t port, uint32_t queue){
 
 
 uint32_t SharedMemoryBuffer::findLongestThreshold(){
-	uint32_t longestQueueLength = 0;
-	uint32_t longestQueue = 0;
-	for (uint32_t i = 0; i < numPorts; i++){
-		if (threshold[i][1] > longestQueueLength ){ // For now, this is a single queue case. We assume only queue id 1 at each port receives data packets.
-			longestQueueLength = threshold[i][1];
-			longestQueue = i;
+	// For now, this is a single queue case. We assume only queue id 1 at each port receives data packets.
+	if (!trackLongestThreshold || longestThreshold.GetSize() != numPorts){
+		longestThreshold.Reset(numPorts);
+		for (uint32_t i = 0; i < numPorts; i++){
+			longestThreshold.Update(i, threshold[i][1]);
 		}
+		trackLongestThreshold = true;
 	}
-	return longestQueue;
+	return longestThreshold.Top();
 }
 
 void SharedMemoryBuffer::UpdateThreshold(uint32_t size, uint32_t port, uint32_t queue){
@@ -158,9 +250,11 @@ void SharedMemoryBuffer::UpdateThreshold(uint32_t size, uint32_t port, uint32_t
 			}
 			threshold[lq][1] = 0;
 		}
+		UpdateLongest(lq, 1);
 	}
 	threshold[port][queue] = std::min(threshold[port][queue]+size, TotalBuffer);
 	totalThreshold = std::min(totalThreshold+size, TotalBuffer);
+	UpdateLongest(port, queue);
 	// if (switchId==0 && port==17 && queue==1){
 	// 	std::cout << "UpdateThreshold: " << "queuelength " << queueLength[port][queue] << " threshold " << threshold[port][queue] << " totalThreshold " << totalThreshold << " size " << size  << std::endl;
 	// }
@@ -172,6 +266,7 @@ bool SharedMemoryBuffer::EnqueueBuffer(uint32_t size, uint32_t port, uint32_t qu
 		RemainingBuffer-=size;
 		OccupiedBuffer= std::min(OccupiedBuffer+size, TotalBuffer);
 		queueLength[port][queue]+=size;
+		UpdateLongest(port, queue);
 		// if (switchId==0 && port==17 && queue==1){
 		// 	std::cout << "Enqueue: " << "queuelength " << queueLength[port][queue] << " threshold " << threshold[port][queue] << " totalThreshold " << totalThreshold << " size " << size  << std::endl;
 		// }
@@ -240,6 +335,7 @@ void SharedMemoryBuffer::DequeueBuffer(uint32_t size, uint32_t port, uint32_t qu
 			}	
 		}
 	}
+	UpdateLongest(port, queue);
 	// if (switchId==0 && port==17 && queue==1){
 	// 	std::cout << "Dequeue: " <<  "queuelength " << queueLength[port][queue] << " threshold " << threshold[port][queue] << " totalThreshold " << totalThreshold << " size " << size << std::endl;
 	// }
@@ -253,19 +349,20 @@ double SharedMemoryBuffer::GetNofP(uint32_t priority){
 }
 
 void SharedMemoryBuffer::addQueuePtr(Ptr<QueueDisc> queuePtr, uint32_t port){
+	Resize(port+1);
 	QueuePtr[port]=queuePtr;
 }
 
 uint32_t SharedMemoryBuffer::findLongestQueue(){
-	uint32_t longestQueueLength = 0;
-	uint32_t longestQueue = 0;
-	for (uint32_t i = 0; i < numPorts; i++){
-		if (queueLength[i][1] > longestQueueLength ){ // For now, this is a single queue case. We assume only queue id 1 at each port receives data packets.
-			longestQueueLength = queueLength[i][1];
-			longestQueue = i;
+	// For now, this is a single queue case. We assume only queue id 1 at each port receives data packets.
+	if (!trackLongestQueue || longestQueue.GetSize() != numPorts){
+		longestQueue.Reset(numPorts);
+		for (uint32_t i = 0; i < numPorts; i++){
+			longestQueue.Update(i, queueLength[i][1]);
 		}
+		trackLongestQueue = true;
 	}
-	return longestQueue;
+	return longestQueue.Top();
 }
 
 uint32_t*
@@ -325,15 +422,10 @@ void SharedMemoryBuffer::setSaturated(uint32_t port,uint32_t priority, double sa
 }
 
 void SharedMemoryBuffer::addDeq(uint32_t bytes,uint32_t prio, uint32_t port){
-	if(Deq[port][prio].size() > 100){
-		sumBytes[port][prio]-= Deq[port][prio][0].first;
-		Deq[port][prio].erase(Deq[port][prio].begin());
+	if(Deq[port][prio].size() == DeqWindow::CAPACITY){
+		sumBytes[port][prio]-= Deq[port][prio].Front().first;
 	}
-
-	std::pair<uint32_t,Time> temp;
-	temp.first=bytes;
-	temp.second=Simulator::Now();
-	Deq[port][prio].push_back(temp);
+	Deq[port][prio].Push(bytes, Simulator::Now());
 	sumBytes[port][prio]+=bytes;
 }
 
@@ -342,7 +434,7 @@ double SharedMemoryBuffer::getDeq(uint32_t prio,uint32_t port){
 //	std::cout << "Size " << Deq[port][prio].size() << " SumBytes " << sumBytes[port][prio] << std::endl;
 	if(Deq[port][prio].size()>1){
 //		std::cout << "tEnd " << (Deq[port][prio].end()-1)->second.GetSeconds() << " tBegin " << Deq[port][prio].begin()->second.GetSeconds() << std::endl;
-		t = (Deq[port][prio].end()-1)->second - Deq[port][prio].begin()->second;
+		t = Deq[port][prio].Back().second - Deq[port][prio].Front().second;
 	}
 	else
 		return 1;
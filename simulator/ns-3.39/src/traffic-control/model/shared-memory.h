@@ -23,8 +23,56 @@
 #include "ns3/socket.h"
 #include "ns3/unused.h"
 
+#include <array>
+#include <vector>
+
 namespace ns3 {
 
+/*
+ * Index of the largest of n values, in O(log n) per update. A tournament (winner) tree: each
+ * internal node holds the index of the larger value of its two subtrees, the lower index on ties,
+ * so Top() is the same port a linear scan with ">" picks.
+ */
+class LongestQueueTree {
+public:
+	LongestQueueTree();
+
+	/* n values, all 0 */
+	void Reset(uint32_t n);
+	void Update(uint32_t i, uint32_t value);
+	/* Index of the largest value, 0 if there are none */
+	uint32_t Top() const;
+	uint32_t GetSize() const {return m_size;}
+
+private:
+	uint32_t Winner(uint32_t node) const;
+
+	uint32_t m_size;
+	uint32_t m_leaves; // power of 2, at least m_size
+	std::vector<uint32_t> m_value; // per leaf
+	std::vector<uint32_t> m_winner; // per internal node, 1 is the root
+};
+
+/*
+ * The last (bytes, time) dequeue samples of a queue in a fixed-capacity ring.
+ */
+class DeqWindow {
+public:
+	static const uint32_t CAPACITY = 101;
+
+	DeqWindow() : m_head(0) {}
+
+	uint32_t size() const {return m_samples.size();}
+	/* Append a sample, dropping the oldest one if the window is full */
+	void Push(uint32_t bytes, Time t);
+	const std::pair<uint32_t,Time>& Front() const;
+	const std::pair<uint32_t,Time>& Back() const;
+
+private:
+	std::vector<std::pair<uint32_t,Time>> m_samples; // allocated on the first sample
+	uint32_t m_head; // oldest sample once full
+};
+
 class SharedMemoryBuffer : public Object{
 public:
 	static TypeId GetTypeId (void);
@@ -60,9 +108,7 @@ public:
 
 	void addQueuePtr(Ptr<QueueDisc> queue, uint32_t port);
 
-	void setPorts(uint32_t ports){
-		numPorts = ports;
-	}
+	void setPorts(uint32_t ports);
 	uint32_t getPorts(){
 		return numPorts;
 	}
@@ -105,6 +151,12 @@ protected:
 
 	virtual void DoDispose (void);
 
+	/* Grow the per-port state to at least ports ports */
+	void Resize(uint32_t ports);
+	void ResetQueues(void);
+	/* Let the longest queue and threshold trees know queue id 1 of a port changed */
+	void UpdateLongest(uint32_t port, uint32_t queue);
+
 
 private:
 	uint32_t TotalBuffer;
@@ -112,27 +164,33 @@ private:
 	uint32_t OccupiedBufferPriority[8]={0,0,0,0,0,0,0,0};
 	uint32_t RemainingBuffer;
 	double N[8]; // N corresponds to each queue (one-one mapping with priority) at each port. 8 queues exist at each port.
-	double saturated[100][8]; // 100 ports and 8 queues per node which share the buffer, are supported for now.
+	// Per port state, 8 queues per port share the buffer. Sized by setPorts and addQueuePtr.
+	std::vector<std::array<double,8>> saturated;
 
 	std::unordered_map<uint32_t,uint32_t> PriorityToGroupMap;
 
-	std::vector<std::pair<uint32_t,Time>> Deq[100][8];
-	double sumBytes[100][8];
-	Time tDiff[100][8];
+	std::vector<std::array<DeqWindow,8>> Deq;
+	std::vector<std::array<double,8>> sumBytes;
+	std::vector<std::array<Time,8>> tDiff;
 	uint64_t MaxRate;
-	Time timestamp[100][8];
+	std::vector<std::array<Time,8>> timestamp;
 
 	///////////////
-	uint32_t queueLength[100][8];
-	uint32_t averageQueueLength[100][8];
-	uint32_t threshold[100][8];
+	std::vector<std::array<uint32_t,8>> queueLength;
+	std::vector<std::array<uint32_t,8>> averageQueueLength;
+	std::vector<std::array<uint32_t,8>> threshold;
 	uint32_t totalThreshold;
 	uint32_t averageSharedOccupancy;
-	Ptr<QueueDisc> QueuePtr[100];
+	std::vector<Ptr<QueueDisc>> QueuePtr;
+	// Queue id 1 of the first numPorts ports, built on the first findLongestQueue/findLongestThreshold
+	LongestQueueTree longestQueue;
+	LongestQueueTree longestThreshold;
+	bool trackLongestQueue;
+	bool trackLongestThreshold;
 	uint32_t numPorts;
 	uint32_t numQueues;
 	uint32_t switchId;
-	Time LastUpdatedAverage[100][8];
+	std::vector<std::array<Time,8>> LastUpdatedAverage;
 	Time LastUpdatedAverageTotal;
 	Time AverageInterval;
 
@@ -0,0 +1,416 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tree-ensemble.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TreeEnsemble");
+
+NS_OBJECT_ENSURE_REGISTERED(TreeEnsemble);
+
+namespace
+{
+
+/// Just enough JSON for the exported models: objects, arrays, numbers and strings
+struct JsonValue
+{
+    enum Type
+    {
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT,
+        LITERAL, // true, false, null
+    };
+
+    Type type = LITERAL;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> items;                            // ARRAY
+    std::vector<std::pair<std::string, JsonValue>> members; // OBJECT
+
+    /**
+     * \param key member name
+     * \return the member, aborts if there is none
+     */
+    const JsonValue& Get(const std::string& key) const
+    {
+        for (const auto& m : members)
+        {
+            if (m.first == key)
+            {
+                return m.second;
+            }
+        }
+        NS_FATAL_ERROR("TreeEnsemble: missing \"" << key << "\" in model");
+    }
+
+    /**
+     * \brief Append all numbers of a (nested) array
+     * \param out the numbers
+     */
+    void Flatten(std::vector<double>& out) const
+    {
+        if (type == NUMBER)
+        {
+            out.push_back(number);
+            return;
+        }
+        NS_ABORT_MSG_IF(type != ARRAY, "TreeEnsemble: expected a number array");
+        for (const auto& i : items)
+        {
+            i.Flatten(out);
+        }
+    }
+};
+
+/// Recursive descent parser for JsonValue
+class JsonParser
+{
+  public:
+    JsonParser(const std::string& s)
+        : m_s(s),
+          m_pos(0)
+    {
+    }
+
+    JsonValue Parse()
+    {
+        JsonValue v = ParseValue();
+        SkipSpace();
+        NS_ABORT_MSG_IF(m_pos != m_s.size(), "TreeEnsemble: trailing data at " << m_pos);
+        return v;
+    }
+
+  private:
+    void SkipSpace()
+    {
+        while (m_pos < m_s.size() && isspace(static_cast<unsigned char>(m_s[m_pos])))
+        {
+            m_pos++;
+        }
+    }
+
+    void Expect(char c)
+    {
+        SkipSpace();
+        NS_ABORT_MSG_IF(m_pos >= m_s.size() || m_s[m_pos] != c,
+                        "TreeEnsemble: expected '" << c << "' at " << m_pos);
+        m_pos++;
+    }
+
+    bool Accept(char c)
+    {
+        SkipSpace();
+        if (m_pos < m_s.size() && m_s[m_pos] == c)
+        {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    std::string ParseString()
+    {
+        Expect('"');
+        std::string out;
+        while (m_pos < m_s.size() && m_s[m_pos] != '"')
+        {
+            if (m_s[m_pos] == '\\')
+            {
+                m_pos++; // keys and labels are plain ASCII, keep the escaped character as is
+            }
+            if (m_pos < m_s.size())
+            {
+                out += m_s[m_pos++];
+            }
+        }
+        Expect('"');
+        return out;
+    }
+
+    JsonValue ParseValue()
+    {
+        JsonValue v;
+        SkipSpace();
+        NS_ABORT_MSG_IF(m_pos >= m_s.size(), "TreeEnsemble: unexpected end of model");
+        char c = m_s[m_pos];
+        if (c == '{')
+        {
+            v.type = JsonValue::OBJECT;
+            m_pos++;
+            if (!Accept('}'))
+            {
+                do
+                {
+                    std::string key = ParseString();
+                    Expect(':');
+                    v.members.emplace_back(key, ParseValue());
+                } while (Accept(','));
+                Expect('}');
+            }
+        }
+        else if (c == '[')
+        {
+            v.type = JsonValue::ARRAY;
+            m_pos++;
+            if (!Accept(']'))
+            {
+                do
+                {
+                    v.items.push_back(ParseValue());
+                } while (Accept(','));
+                Expect(']');
+            }
+        }
+        else if (c == '"')
+        {
+            v.type = JsonValue::STRING;
+            v.string = ParseString();
+        }
+        else if (isalpha(static_cast<unsigned char>(c)))
+        {
+            while (m_pos < m_s.size() && isalpha(static_cast<unsigned char>(m_s[m_pos])))
+            {
+                m_pos++;
+            }
+        }
+        else
+        {
+            v.type = JsonValue::NUMBER;
+            const char* begin = m_s.c_str() + m_pos;
+            char* end;
+            v.number = strtod(begin, &end);
+            NS_ABORT_MSG_IF(end == begin, "TreeEnsemble: bad number at " << m_pos);
+            m_pos += end - begin;
+        }
+        return v;
+    }
+
+    const std::string& m_s;
+    size_t m_pos;
+};
+
+} // namespace
+
+TypeId
+TreeEnsemble::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TreeEnsemble")
+                            .SetParent<Object>()
+                            .SetGroupName("TrafficControl")
+                            .AddConstructor<TreeEnsemble>();
+    return tid;
+}
+
+TreeEnsemble::TreeEnsemble()
+    : m_nFeatures(0)
+{
+}
+
+void
+TreeEnsemble::Load(std::string filename)
+{
+    std::ifstream in(filename);
+    NS_ABORT_MSG_IF(!in.good(), "TreeEnsemble: cannot open " << filename);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    LoadFromString(ss.str());
+    NS_LOG_INFO("loaded " << GetNTrees() << " trees, " << m_nodes.size() << " nodes from "
+                          << filename);
+}
+
+void
+TreeEnsemble::LoadFromString(const std::string& json)
+{
+    JsonValue model = JsonParser(json).Parse();
+    m_nFeatures = model.Get("n_features").number;
+    std::vector<double> classes;
+    model.Get("classes").Flatten(classes);
+    m_classes.assign(classes.begin(), classes.end());
+    uint32_t nClasses = m_classes.size();
+    NS_ABORT_MSG_IF(nClasses == 0 || nClasses > MAX_CLASSES,
+                    "TreeEnsemble: need 1 to " << MAX_CLASSES << " classes");
+
+    m_roots.clear();
+    m_nodes.clear();
+    m_leafProb.clear();
+    for (const auto& tree : model.Get("trees").items)
+    {
+        std::vector<double> left;
+        std::vector<double> right;
+        std::vector<double> feature;
+        std::vector<double> threshold;
+        std::vector<double> value;
+        tree.Get("children_left").Flatten(left);
+        tree.Get("children_right").Flatten(right);
+        tree.Get("feature").Flatten(feature);
+        tree.Get("threshold").Flatten(threshold);
+        tree.Get("value").Flatten(value);
+        uint32_t n = left.size();
+        NS_ABORT_MSG_IF(n == 0 || right.size() != n || feature.size() != n ||
+                            threshold.size() != n || value.size() != n * nClasses,
+                        "TreeEnsemble: inconsistent tree arrays");
+
+        // Lay the tree out depth first from its root, whatever order it was exported in.
+        // Right children are patched once their subtree starts.
+        m_roots.push_back(m_nodes.size());
+        std::vector<std::pair<uint32_t, uint32_t>> stack; // <exported node, parent to patch>
+        stack.emplace_back(0, UINT32_MAX);
+        while (!stack.empty())
+        {
+            uint32_t i = stack.back().first;
+            uint32_t parent = stack.back().second;
+            stack.pop_back();
+            NS_ABORT_MSG_IF(i >= n, "TreeEnsemble: child index out of range");
+            if (parent != UINT32_MAX)
+            {
+                m_nodes[parent].right = m_nodes.size();
+            }
+            Node node;
+            if (left[i] < 0)
+            {
+                // sklearn keeps weighted counts (or fractions) per leaf; predict_proba normalizes
+                double sum = 0;
+                for (uint32_t c = 0; c < nClasses; c++)
+                {
+                    sum += value[i * nClasses + c];
+                }
+                if (sum == 0)
+                {
+                    sum = 1;
+                }
+                node.threshold = 0;
+                node.feature = -1;
+                node.right = m_leafProb.size();
+                for (uint32_t c = 0; c < nClasses; c++)
+                {
+                    m_leafProb.push_back(value[i * nClasses + c] / sum);
+                }
+                m_nodes.push_back(node);
+            }
+            else
+            {
+                NS_ABORT_MSG_IF(feature[i] < 0 || feature[i] >= m_nFeatures,
+                                "TreeEnsemble: bad feature index " << feature[i]);
+                node.threshold = threshold[i];
+                node.feature = feature[i];
+                node.right = 0;
+                uint32_t self = m_nodes.size();
+                m_nodes.push_back(node);
+                stack.emplace_back(right[i], self);
+                stack.emplace_back(left[i], UINT32_MAX); // next node, popped first
+            }
+        }
+    }
+}
+
+uint32_t
+TreeEnsemble::GetNFeatures() const
+{
+    return m_nFeatures;
+}
+
+uint32_t
+TreeEnsemble::GetNTrees() const
+{
+    return m_roots.size();
+}
+
+uint32_t
+TreeEnsemble::FindLeaf(uint32_t tree, const float* x) const
+{
+    const Node* node = &m_nodes[m_roots[tree]];
+    while (node->feature >= 0)
+    {
+        if (x[node->feature] <= node->threshold)
+        {
+            node++;
+        }
+        else
+        {
+            node = &m_nodes[node->right];
+        }
+    }
+    return node->right;
+}
+
+int
+TreeEnsemble::ArgMax(const double* sum) const
+{
+    uint32_t best = 0;
+    for (uint32_t c = 1; c < m_classes.size(); c++)
+    {
+        if (sum[c] > sum[best])
+        {
+            best = c;
+        }
+    }
+    return m_classes[best];
+}
+
+int
+TreeEnsemble::Predict(const float* x) const
+{
+    uint32_t nClasses = m_classes.size();
+    double sum[MAX_CLASSES];
+    for (uint32_t c = 0; c < nClasses; c++)
+    {
+        sum[c] = 0;
+    }
+    for (uint32_t t = 0; t < m_roots.size(); t++)
+    {
+        const double* prob = &m_leafProb[FindLeaf(t, x)];
+        for (uint32_t c = 0; c < nClasses; c++)
+        {
+            sum[c] += prob[c];
+        }
+    }
+    return ArgMax(sum);
+}
+
+void
+TreeEnsemble::PredictBatch(const float* x, uint32_t n, int* labels) const
+{
+    uint32_t nClasses = m_classes.size();
+    std::vector<double> sum(n * nClasses, 0);
+    for (uint32_t t = 0; t < m_roots.size(); t++)
+    {
+        for (uint32_t s = 0; s < n; s++)
+        {
+            const double* prob = &m_leafProb[FindLeaf(t, x + s * m_nFeatures)];
+            for (uint32_t c = 0; c < nClasses; c++)
+            {
+                sum[s * nClasses + c] += prob[c];
+            }
+        }
+    }
+    for (uint32_t s = 0; s < n; s++)
+    {
+        labels[s] = ArgMax(&sum[s * nClasses]);
+    }
+}
+
+} // namespace ns3
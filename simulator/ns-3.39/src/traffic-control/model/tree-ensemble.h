@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TREE_ENSEMBLE_H
+#define TREE_ENSEMBLE_H
+
+#include "ns3/object.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Random forest classifier, for the predictions of Credence (GenQueueDisc)
+ *
+ * Loads a scikit-learn RandomForestClassifier exported to JSON by
+ * examples/Credence/trainLqd.py:
+ *
+ * \code
+ * {"n_features": 4, "classes": [0, 1],
+ *  "trees": [{"children_left": [...], "children_right": [...], "feature": [...],
+ *             "threshold": [...], "value": [...]}, ...]}
+ * \endcode
+ *
+ * with the arrays of each tree's tree_ attribute. Predictions are those of
+ * RandomForestClassifier::predict: features are rounded to float, a sample goes left when
+ * feature <= threshold, and the class with the largest sum of leaf probabilities wins.
+ *
+ * All trees live in one array of 16 byte nodes in depth first order, so a left child is the
+ * next node and only the right child is stored.
+ */
+class TreeEnsemble : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TreeEnsemble();
+
+    /**
+     * \brief Replace the model with the one in a JSON file. Aborts if the file is malformed.
+     * \param filename the exported model
+     */
+    void Load(std::string filename);
+
+    /**
+     * \brief Replace the model with a JSON document
+     * \param json the exported model
+     */
+    void LoadFromString(const std::string& json);
+
+    /// \return the number of features of a sample
+    uint32_t GetNFeatures() const;
+    /// \return the number of trees
+    uint32_t GetNTrees() const;
+
+    /**
+     * \param x GetNFeatures() features
+     * \return the predicted class label
+     */
+    int Predict(const float* x) const;
+
+    /**
+     * \brief Predict n samples at once. Walks one tree for all samples before the next, which
+     * keeps the tree in cache when many predictions are due at the same time.
+     * \param x n samples of GetNFeatures() features each, one after the other
+     * \param n the number of samples
+     * \param labels receives the n predicted class labels
+     */
+    void PredictBatch(const float* x, uint32_t n, int* labels) const;
+
+  private:
+    static const uint32_t MAX_CLASSES = 16;
+
+    /// A split, or a leaf if feature < 0
+    struct Node
+    {
+        double threshold; //!< go left if x[feature] <= threshold
+        int32_t feature;  //!< feature to compare, -1 for a leaf
+        uint32_t right;   //!< index of the right child, or offset of the leaf's probabilities
+    };
+
+    /**
+     * \param tree the tree index
+     * \param x the sample
+     * \return offset of the class probabilities of the leaf x ends up in
+     */
+    uint32_t FindLeaf(uint32_t tree, const float* x) const;
+
+    /**
+     * \param sum summed class probabilities
+     * \return the label of the largest, the first one on ties
+     */
+    int ArgMax(const double* sum) const;
+
+    uint32_t m_nFeatures;
+    std::vector<int> m_classes;     //!< class labels
+    std::vector<uint32_t> m_roots;  //!< root node of each tree
+    std::vector<Node> m_nodes;      //!< all trees
+    std::vector<double> m_leafProb; //!< class probabilities, m_classes.size() per leaf
+};
+
+} // namespace ns3
+
+#endif /* TREE_ENSEMBLE_H */
@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/flow-sketch.h"
+#include "ns3/gen-queue-disc.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <random>
+#include <unordered_map>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief FlowSketch against exact per-flow counters
+ */
+class FlowSketchTestCase : public TestCase
+{
+  public:
+    FlowSketchTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+FlowSketchTestCase::FlowSketchTestCase()
+    : TestCase("FlowSketch ages counters and never underestimates")
+{
+}
+
+void
+FlowSketchTestCase::DoRun()
+{
+    const Time window = MicroSeconds(10);
+    FlowSketch sketch;
+    sketch.Configure(1000, 4);
+    NS_TEST_ASSERT_MSG_EQ(sketch.GetMemory(), 1024 * 4 * 16, "width not rounded up");
+
+    // one flow: counts up, restarts after an idle window, not after an idle window exactly
+    NS_TEST_ASSERT_MSG_EQ(sketch.Add(7, 1000, MicroSeconds(1), window), 1000, "first packet");
+    NS_TEST_ASSERT_MSG_EQ(sketch.Add(7, 500, MicroSeconds(11), window), 1500, "within window");
+    NS_TEST_ASSERT_MSG_EQ(sketch.Get(7, MicroSeconds(21), window), 1500, "window is inclusive");
+    NS_TEST_ASSERT_MSG_EQ(sketch.Get(7, MicroSeconds(22), window), 0, "not aged");
+    NS_TEST_ASSERT_MSG_EQ(sketch.Add(7, 300, MicroSeconds(22), window), 300, "not restarted");
+    NS_TEST_ASSERT_MSG_EQ(sketch.Get(8, MicroSeconds(22), window), 0, "other flow counted");
+
+    // ~1000 flows active per window: the sketch is an upper bound of the exact counters, and
+    // tight for most packets with the default size
+    sketch.Configure(4096, 4);
+    std::unordered_map<uint32_t, std::pair<uint32_t, Time>> exact;
+    std::mt19937 rng(1);
+    uint32_t packets = 200000;
+    uint32_t exactPackets = 0;
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        Time now = NanoSeconds(i * 10);
+        uint32_t flow = rng() % 20000;
+        auto& e = exact.try_emplace(flow, 0, now).first->second;
+        if (now - e.second > window)
+        {
+            e.first = 0;
+        }
+        e.first += 1000;
+        e.second = now;
+        uint32_t estimate = sketch.Add(flow, 1000, now, window);
+        NS_TEST_ASSERT_MSG_GT_OR_EQ(estimate, e.first, "underestimated flow " << flow);
+        exactPackets += (estimate == e.first);
+    }
+    NS_TEST_ASSERT_MSG_GT(exactPackets, packets * 0.99, "sketch too far off");
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief The exact flow counters of GenQueueDisc forget idle flows without changing counts
+ */
+class GenQueueDiscFlowCountTestCase : public TestCase
+{
+  public:
+    GenQueueDiscFlowCountTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * \brief Count one packet of each of n flows, starting from flow first
+     * \param q the queue disc
+     * \param first the first flow
+     * \param n number of flows
+     * \param expected expected counter of each flow, a lower bound with the sketch
+     */
+    void Count(Ptr<GenQueueDisc> q, uint32_t first, uint32_t n, uint32_t expected);
+};
+
+GenQueueDiscFlowCountTestCase::GenQueueDiscFlowCountTestCase()
+    : TestCase("GenQueueDisc bounds its exact flow table")
+{
+}
+
+void
+GenQueueDiscFlowCountTestCase::Count(Ptr<GenQueueDisc> q,
+                                     uint32_t first,
+                                     uint32_t n,
+                                     uint32_t expected)
+{
+    BooleanValue sketch;
+    q->GetAttribute("FlowSketch", sketch);
+    for (uint32_t f = first; f < first + n; f++)
+    {
+        uint32_t counter = q->CountFlow(f, 1, MicroSeconds(10));
+        if (sketch.Get())
+        {
+            NS_TEST_ASSERT_MSG_GT_OR_EQ(counter, expected, "flow " << f);
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_EQ(counter, expected, "flow " << f);
+        }
+    }
+}
+
+void
+GenQueueDiscFlowCountTestCase::DoRun()
+{
+    Ptr<GenQueueDisc> exact = CreateObject<GenQueueDisc>();
+    Ptr<GenQueueDisc> sketch = CreateObject<GenQueueDisc>();
+    sketch->SetAttribute("FlowSketch", BooleanValue(true));
+    for (uint32_t t = 0; t < 10; t++)
+    {
+        // 1000 new flows every 20us, and flows 0..99 all the time
+        Simulator::Schedule(MicroSeconds(20 * t),
+                            &GenQueueDiscFlowCountTestCase::Count,
+                            this,
+                            exact,
+                            1000 * (t + 1),
+                            1000,
+                            1);
+        Simulator::Schedule(MicroSeconds(20 * t),
+                            &GenQueueDiscFlowCountTestCase::Count,
+                            this,
+                            exact,
+                            0,
+                            100,
+                            1);
+        Simulator::Schedule(MicroSeconds(20 * t + 5),
+                            &GenQueueDiscFlowCountTestCase::Count,
+                            this,
+                            exact,
+                            0,
+                            100,
+                            2);
+        Simulator::Schedule(MicroSeconds(20 * t),
+                            &GenQueueDiscFlowCountTestCase::Count,
+                            this,
+                            sketch,
+                            1000 * (t + 1),
+                            1000,
+                            1);
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+    NS_TEST_ASSERT_MSG_LT(exact->GetNFlows(), 4096 + 1100, "idle flows kept");
+    NS_TEST_ASSERT_MSG_EQ(sketch->GetNFlows(), 0, "sketch mode keeps exact state");
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief FlowSketch TestSuite
+ */
+static class FlowSketchTestSuite : public TestSuite
+{
+  public:
+    FlowSketchTestSuite()
+        : TestSuite("flow-sketch", UNIT)
+    {
+        AddTestCase(new FlowSketchTestCase(), TestCase::QUICK);
+        AddTestCase(new GenQueueDiscFlowCountTestCase(), TestCase::QUICK);
+    }
+} g_flowSketchTestSuite; ///< the test suite
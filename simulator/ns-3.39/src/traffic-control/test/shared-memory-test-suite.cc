@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/shared-memory.h"
+#include "ns3/test.h"
+
+#include <random>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief The longest queue and threshold of a high-radix SharedMemoryBuffer against a scan
+ */
+class SharedMemoryLongestQueueTestCase : public TestCase
+{
+  public:
+    SharedMemoryLongestQueueTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SharedMemoryLongestQueueTestCase::SharedMemoryLongestQueueTestCase()
+    : TestCase("SharedMemoryBuffer finds the longest queue and threshold of 160 ports")
+{
+}
+
+void
+SharedMemoryLongestQueueTestCase::DoRun()
+{
+    const uint32_t ports = 160;
+    Ptr<SharedMemoryBuffer> sm = CreateObject<SharedMemoryBuffer>();
+    sm->SetSharedBufferSize(2000000);
+    sm->setPorts(ports);
+    sm->setAverageInteral(MicroSeconds(10));
+    NS_TEST_ASSERT_MSG_EQ(sm->findLongestQueue(), 0, "empty buffer");
+
+    std::mt19937 rng(1);
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        uint32_t port = rng() % ports;
+        uint32_t queue = rng() % 4 == 0 ? 0 : 1;
+        uint32_t size = 64 + rng() % 1437;
+        if (rng() % 2)
+        {
+            sm->UpdateThreshold(size, port, queue);
+            sm->EnqueueBuffer(size, port, queue);
+        }
+        else if (sm->GetQueueSize(port, queue) > 0)
+        {
+            sm->DequeueBuffer(size, port, queue);
+        }
+
+        uint32_t longestQueue = 0;
+        uint32_t longestThreshold = 0;
+        for (uint32_t p = 0; p < ports; p++)
+        {
+            if (sm->GetQueueSize(p, 1) > sm->GetQueueSize(longestQueue, 1))
+            {
+                longestQueue = p;
+            }
+            if (sm->GetThreshold(p, 1) > sm->GetThreshold(longestThreshold, 1))
+            {
+                longestThreshold = p;
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(sm->findLongestQueue(), longestQueue, "longest queue, step " << i);
+        NS_TEST_ASSERT_MSG_EQ(sm->findLongestThreshold(),
+                              longestThreshold,
+                              "longest threshold, step " << i);
+    }
+
+    // fewer ports: the queues past the last port do not count
+    sm->setPorts(3);
+    NS_TEST_ASSERT_MSG_LT(sm->findLongestQueue(), 3, "port out of range");
+    sm->Dispose();
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief The dequeue window keeps the last samples
+ */
+class DeqWindowTestCase : public TestCase
+{
+  public:
+    DeqWindowTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DeqWindowTestCase::DeqWindowTestCase()
+    : TestCase("DeqWindow keeps the last 101 dequeues")
+{
+}
+
+void
+DeqWindowTestCase::DoRun()
+{
+    DeqWindow w;
+    w.Push(1, NanoSeconds(1));
+    NS_TEST_ASSERT_MSG_EQ(w.size(), 1, "one sample");
+    NS_TEST_ASSERT_MSG_EQ(w.Front().first, 1, "oldest sample");
+    NS_TEST_ASSERT_MSG_EQ(w.Back().first, 1, "newest sample");
+    for (uint32_t i = 2; i <= 150; i++)
+    {
+        w.Push(i, NanoSeconds(i));
+        uint32_t oldest = i > DeqWindow::CAPACITY ? i - DeqWindow::CAPACITY + 1 : 1;
+        NS_TEST_ASSERT_MSG_EQ(w.size(), i - oldest + 1, "window size");
+        NS_TEST_ASSERT_MSG_EQ(w.Front().first, oldest, "oldest sample");
+        NS_TEST_ASSERT_MSG_EQ(w.Back().second, NanoSeconds(i), "newest sample");
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief SharedMemoryBuffer TestSuite
+ */
+static class SharedMemoryTestSuite : public TestSuite
+{
+  public:
+    SharedMemoryTestSuite()
+        : TestSuite("shared-memory", UNIT)
+    {
+        AddTestCase(new SharedMemoryLongestQueueTestCase(), TestCase::QUICK);
+        AddTestCase(new DeqWindowTestCase(), TestCase::QUICK);
+    }
+} g_sharedMemoryTestSuite; ///< the test suite
@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/tree-ensemble.h"
+
+#include <random>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Check TreeEnsemble predictions on a small hand made forest
+ *
+ * The first tree is exported breadth first and holds raw class counts, the second one holds
+ * counts of a single class, as older scikit-learn versions export them.
+ */
+class TreeEnsembleTestCase : public TestCase
+{
+  public:
+    TreeEnsembleTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TreeEnsembleTestCase::TreeEnsembleTestCase()
+    : TestCase("Random forest predictions and batch predictions")
+{
+}
+
+void
+TreeEnsembleTestCase::DoRun()
+{
+    // tree 0: x0 <= 10 ? P(1)=0.25 : (x2 <= 5.5 ? P(1)=1 : P(1)=0.5)
+    // tree 1: x1 <= 100 ? P(1)=0 : P(1)=1
+    std::string json = R"({
+      "n_features": 4,
+      "classes": [0, 1],
+      "trees": [
+        {"children_left": [1, -1, 3, -1, -1],
+         "children_right": [2, -1, 4, -1, -1],
+         "feature": [0, -2, 2, -2, -2],
+         "threshold": [10.0, -2.0, 5.5, -2.0, -2.0],
+         "value": [[[4, 4]], [[3, 1]], [[1, 3]], [[0, 2]], [[1, 1]]]},
+        {"children_left": [1, -1, -1],
+         "children_right": [2, -1, -1],
+         "feature": [1, -2, -2],
+         "threshold": [100.0, -2.0, -2.0],
+         "value": [[1, 4], [1, 0], [0, 4]]}
+      ]
+    })";
+    Ptr<TreeEnsemble> rf = CreateObject<TreeEnsemble>();
+    rf->LoadFromString(json);
+    NS_TEST_ASSERT_MSG_EQ(rf->GetNTrees(), 2, "wrong number of trees");
+    NS_TEST_ASSERT_MSG_EQ(rf->GetNFeatures(), 4, "wrong number of features");
+
+    struct
+    {
+        float x[4];
+        int label;
+    } cases[] = {
+        {{5, 0, 0, 0}, 0},    // 0.25 + 0
+        {{20, 200, 3, 0}, 1}, // 1 + 1
+        {{20, 50, 9, 0}, 0},  // 0.5 + 0
+        {{20, 200, 9, 0}, 1}, // 0.5 + 1
+        {{10, 200, 9, 0}, 1}, // threshold itself goes left: 0.25 + 1
+    };
+    for (const auto& c : cases)
+    {
+        NS_TEST_ASSERT_MSG_EQ(rf->Predict(c.x),
+                              c.label,
+                              "wrong prediction for " << c.x[0] << " " << c.x[1] << " " << c.x[2]);
+    }
+
+    // a tie goes to the first class, as numpy's argmax
+    float tie[4] = {20, 100, 3, 0}; // 1 + 0 for class 1, 0 + 1 for class 0
+    NS_TEST_ASSERT_MSG_EQ(rf->Predict(tie), 0, "tie not resolved to the first class");
+
+    std::mt19937 rng(1);
+    const uint32_t n = 1000;
+    std::vector<float> x(n * 4);
+    for (auto& f : x)
+    {
+        f = rng() % 300;
+    }
+    std::vector<int> labels(n);
+    rf->PredictBatch(x.data(), n, labels.data());
+    for (uint32_t s = 0; s < n; s++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(labels[s], rf->Predict(&x[s * 4]), "batch differs at sample " << s);
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief TreeEnsemble TestSuite
+ */
+static class TreeEnsembleTestSuite : public TestSuite
+{
+  public:
+    TreeEnsembleTestSuite()
+        : TestSuite("tree-ensemble", UNIT)
+    {
+        AddTestCase(new TreeEnsembleTestCase(), TestCase::QUICK);
+    }
+} g_treeEnsembleTestSuite; ///< the test suite
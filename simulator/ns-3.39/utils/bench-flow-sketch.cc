@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures how well FlowSketch classifies flows compared to the exact per-flow
+// counters of GenQueueDisc. 'active' flows with heavy-tailed sizes share a link, a new flow
+// replaces each finished one, and every packet is classified as short (counter below the
+// threshold, as FlowAwareBuffer does) by the exact counters and by sketches of several widths.
+// Sample usage:  ./ns3 run 'bench-flow-sketch --n=2000000 --active=2000 --threshold=20000'
+
+#include "ns3/command-line.h"
+#include "ns3/flow-sketch.h"
+#include "ns3/nstime.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+/// A flow on the link
+struct BenchFlow
+{
+    uint32_t id;
+    uint64_t left;
+};
+
+/// One packet of the workload
+struct BenchPacket
+{
+    uint32_t flowId;
+    Time now;
+};
+
+/**
+ * \brief Classify every packet with the exact counters of GenQueueDisc
+ * \param packets the packets
+ * \param size packet size
+ * \param window FAB window
+ * \param threshold FAB threshold
+ * \param isShort set per packet
+ */
+static void
+Exact(const std::vector<BenchPacket>& packets,
+      uint32_t size,
+      Time window,
+      uint32_t threshold,
+      std::vector<bool>& isShort)
+{
+    std::unordered_map<uint32_t, std::pair<uint32_t, Time>> counts;
+    SystemWallClockMs clock;
+    clock.Start();
+    for (uint64_t i = 0; i < packets.size(); i++)
+    {
+        const BenchPacket& p = packets[i];
+        auto& e = counts.try_emplace(p.flowId, 0, p.now).first->second;
+        if (p.now - e.second > window)
+        {
+            e.first = 0;
+        }
+        e.first += size;
+        e.second = p.now;
+        isShort[i] = e.first < threshold;
+    }
+    int64_t ms = clock.End();
+    std::cout << "exact: " << counts.size() << " flows kept without purging, "
+              << counts.size() * (sizeof(*counts.begin()) + 2 * sizeof(void*)) / 1024
+              << " KiB, " << ms << " ms" << std::endl;
+}
+
+/**
+ * \brief Classify every packet with a sketch and compare with the exact counters
+ * \param packets the packets
+ * \param size packet size
+ * \param window FAB window
+ * \param threshold FAB threshold
+ * \param isShort the exact classification
+ * \param width cells per row
+ * \param depth rows
+ */
+static void
+Sketch(const std::vector<BenchPacket>& packets,
+       uint32_t size,
+       Time window,
+       uint32_t threshold,
+       const std::vector<bool>& isShort,
+       uint32_t width,
+       uint32_t depth)
+{
+    FlowSketch sketch;
+    sketch.Configure(width, depth);
+    uint64_t wrong = 0;
+    SystemWallClockMs clock;
+    clock.Start();
+    for (uint64_t i = 0; i < packets.size(); i++)
+    {
+        const BenchPacket& p = packets[i];
+        // the sketch never underestimates, so it can only take short packets for long ones
+        wrong += (sketch.Add(p.flowId, size, p.now, window) < threshold) != isShort[i];
+    }
+    int64_t ms = clock.End();
+    std::cout << "sketch " << width << "x" << depth << ": " << sketch.GetMemory() / 1024
+              << " KiB, " << wrong << " packets misclassified ("
+              << 100.0 * wrong / packets.size() << "%), " << ms << " ms" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t n = 2000000;
+    uint32_t active = 2000;
+    uint32_t size = 1000;
+    double meanFlow = 100000;
+    uint32_t threshold = 20000;
+    Time window = MicroSeconds(100);
+    Time gap = NanoSeconds(80);
+    uint32_t depth = 4;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "number of packets", n);
+    cmd.AddValue("active", "number of flows sharing the link", active);
+    cmd.AddValue("size", "packet size", size);
+    cmd.AddValue("meanFlow", "mean flow size in bytes, Pareto with shape 1.2", meanFlow);
+    cmd.AddValue("threshold", "FAB threshold in bytes", threshold);
+    cmd.AddValue("window", "FAB window", window);
+    cmd.AddValue("gap", "time between packets", gap);
+    cmd.AddValue("depth", "rows of the sketches", depth);
+    cmd.Parse(argc, argv);
+
+    if (active < 1 || size < 1)
+    {
+        std::cerr << "need at least 1 flow and 1 byte per packet" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running bench-flow-sketch with n=" << n << " active=" << active
+              << " size=" << size << " meanFlow=" << meanFlow << " threshold=" << threshold
+              << " window=" << window.As(Time::US) << " gap=" << gap.As(Time::NS) << std::endl;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    const double shape = 1.2;
+    const double scale = meanFlow * (shape - 1) / shape;
+    auto flowSize = [&]() { return uint64_t(scale / std::pow(1 - uniform(rng), 1 / shape)) + 1; };
+    std::vector<BenchFlow> flows(active);
+    uint32_t nextId = 0;
+    for (auto& f : flows)
+    {
+        f = {nextId++, flowSize()};
+    }
+    std::vector<BenchPacket> packets(n);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        BenchFlow& f = flows[rng() % active];
+        packets[i] = {f.id, gap * int64_t(i)};
+        if (f.left <= size)
+        {
+            f = {nextId++, flowSize()};
+        }
+        else
+        {
+            f.left -= size;
+        }
+    }
+
+    std::vector<bool> isShort(n);
+    Exact(packets, size, window, threshold, isShort);
+    for (uint32_t width : {256, 1024, 4096, 16384})
+    {
+        Sketch(packets, size, window, threshold, isShort, width, depth);
+    }
+    return 0;
+}
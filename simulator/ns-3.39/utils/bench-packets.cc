@@ -18,23 +18,67 @@
  */
 
 // This program can be used to benchmark packet serialization/deserialization
-// operations using Headers and Tags, for various numbers of packets 'n'
+// operations using Headers and Tags, for various numbers of packets 'n'.
+// It also reports the heap allocations per packet, to compare builds
+// with and without the slab allocator (--enable-slab-allocator).
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
 
 #include "ns3/command-line.h"
 #include "ns3/packet-metadata.h"
 #include "ns3/packet.h"
+#include "ns3/slab-allocator.h"
 #include "ns3/system-wall-clock-ms.h"
 
 #include <algorithm>
+#include <cstdlib> // for exit (), malloc ()
 #include <iostream>
 #include <limits>
+#include <new>
 #include <sstream>
-#include <stdlib.h> // for exit ()
 #include <string>
 
 using namespace ns3;
 
+/// Number of heap allocations, counted by the global operator new below
+static uint64_t g_allocations = 0;
+
+/**
+ * Count the heap allocations
+ * \param size the size of the allocation
+ * \return the memory
+ */
+void*
+operator new(std::size_t size)
+{
+    ++g_allocations;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Release memory from the operator new above
+ * \param p the memory
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Release memory from the operator new above
+ * \param p the memory
+ */
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 /// BenchHeader class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchHeader : public Header
@@ -364,6 +408,7 @@ static void
 runBench(void (*bench)(uint32_t), uint32_t n, uint32_t minIterations, const char* name)
 {
     uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+    uint64_t allocations = g_allocations;
     for (uint32_t i = 0; i < minIterations; i++)
     {
         uint64_t delay = runBenchOneIteration(bench, n);
@@ -372,8 +417,11 @@ runBench(void (*bench)(uint32_t), uint32_t n, uint32_t minIterations, const char
     double ps = n;
     ps *= 1000;
     ps /= minDelay;
+    double allocs = g_allocations - allocations;
+    allocs /= static_cast<double>(n) * minIterations;
     std::cout << ps << " packets/s"
-              << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+              << " (" << minDelay << " ms elapsed, " << allocs << " allocs/packet)\t" << name
+              << std::endl;
 }
 
 int
@@ -400,6 +448,7 @@ main(int argc, char* argv[])
     }
     std::cout << "Running bench-packets with n=" << n << std::endl;
     std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
+    std::cout << "Slab allocator: " << (SlabAllocator::IsEnabled() ? "on" : "off") << std::endl;
 
     runBench(&benchA, n, minIterations, "Copy packet, remove headers");
     runBench(&benchB, n, minIterations, "Just add headers");
@@ -0,0 +1,223 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures how fast the RDMA NIC builds its data packets and ACKs.
+// Each packet is built once with the headers added one by one, as RdmaHw used to, and once with
+// the RdmaHeaderTemplate of its qp. 'qps' qps take turns so the templates are not all in cache.
+// Sample usage:  ./ns3 run 'bench-rdma-headers --n=1000000 --qps=1024 --int=0'
+
+#include "ns3/command-line.h"
+#include "ns3/int-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-header.h"
+#include "ns3/rdma-header-template.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/udp-header.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/// The per-qp state the packets are built from
+struct BenchQp
+{
+    Ipv4Address sip;
+    Ipv4Address dip;
+    uint16_t sport;
+    uint16_t dport;
+    uint16_t ipid;
+    uint32_t seq;
+    RdmaHeaderTemplate data;
+    RdmaHeaderTemplate ack;
+};
+
+/**
+ * \brief Build a data packet with the headers added one by one
+ * \param qp the qp
+ * \param size payload size
+ * \return the packet
+ */
+static Ptr<Packet>
+DataPerHeader(BenchQp& qp, uint32_t size)
+{
+    Ptr<Packet> p = Create<Packet>(size);
+    SeqTsHeader seqTs;
+    seqTs.SetSeq(qp.seq);
+    seqTs.SetPG(3);
+    p->AddHeader(seqTs);
+    UdpHeader udpHeader;
+    udpHeader.SetDestinationPort(qp.dport);
+    udpHeader.SetSourcePort(qp.sport);
+    p->AddHeader(udpHeader);
+    Ipv4Header ipHeader;
+    ipHeader.SetSource(qp.sip);
+    ipHeader.SetDestination(qp.dip);
+    ipHeader.SetProtocol(0x11);
+    ipHeader.SetPayloadSize(p->GetSize());
+    ipHeader.SetTtl(64);
+    ipHeader.SetTos(0);
+    ipHeader.SetIdentification(qp.ipid);
+    p->AddHeader(ipHeader);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+    return p;
+}
+
+/**
+ * \brief Build a data packet with the template of the qp
+ * \param qp the qp
+ * \param size payload size
+ * \return the packet
+ */
+static Ptr<Packet>
+DataTemplate(BenchQp& qp, uint32_t size)
+{
+    Ptr<Packet> p = Create<Packet>(size);
+    qp.data.SetData(qp.seq, qp.ipid, size);
+    p->AddHeader(qp.data);
+    return p;
+}
+
+/**
+ * \brief The qbbHeader of an ACK of qp
+ * \param qp the qp
+ * \return the header
+ */
+static qbbHeader
+AckOf(const BenchQp& qp)
+{
+    qbbHeader seqh;
+    seqh.SetSeq(qp.seq);
+    seqh.SetPG(3);
+    seqh.SetSport(qp.dport);
+    seqh.SetDport(qp.sport);
+    return seqh;
+}
+
+/**
+ * \brief Build an ACK with the headers added one by one
+ * \param qp the qp
+ * \return the packet
+ */
+static Ptr<Packet>
+AckPerHeader(BenchQp& qp)
+{
+    qbbHeader seqh = AckOf(qp);
+    Ptr<Packet> p = Create<Packet>(std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0));
+    p->AddHeader(seqh);
+    Ipv4Header head;
+    head.SetDestination(qp.sip);
+    head.SetSource(qp.dip);
+    head.SetProtocol(0xFC);
+    head.SetTtl(64);
+    head.SetPayloadSize(p->GetSize());
+    head.SetIdentification(qp.ipid);
+    p->AddHeader(head);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+    return p;
+}
+
+/**
+ * \brief Build an ACK with the template of the qp
+ * \param qp the qp
+ * \return the packet
+ */
+static Ptr<Packet>
+AckTemplate(BenchQp& qp)
+{
+    qbbHeader seqh = AckOf(qp);
+    uint32_t padding = std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0);
+    Ptr<Packet> p = Create<Packet>(padding);
+    qp.ack.SetAck(seqh, 0xFC, qp.ipid, padding);
+    p->AddHeader(qp.ack);
+    return p;
+}
+
+/**
+ * \brief Build n packets round robin over the qps and print the rate
+ * \param name what is built
+ * \param qps the qps
+ * \param n number of packets
+ * \param build builds one packet of a qp
+ */
+template <typename F>
+static void
+Bench(const char* name, std::vector<BenchQp>& qps, uint64_t n, F build)
+{
+    uint64_t bytes = 0;
+    SystemWallClockMs clock;
+    clock.Start();
+    for (uint64_t i = 0; i < n; i++)
+    {
+        BenchQp& qp = qps[i % qps.size()];
+        bytes += build(qp)->GetSize();
+        qp.seq += 1000;
+        qp.ipid++;
+    }
+    int64_t ms = clock.End();
+    std::cout << name << ": " << n << " packets (" << bytes << " bytes) in " << ms << " ms, "
+              << (ms > 0 ? n * 1000.0 / ms : 0) << " packets/s" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t n = 1000000;
+    uint32_t qps = 1024;
+    uint32_t size = 1000;
+    uint32_t intMode = IntHeader::NORMAL;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "number of packets of each kind", n);
+    cmd.AddValue("qps", "number of qps", qps);
+    cmd.AddValue("size", "payload size of the data packets", size);
+    cmd.AddValue("int", "IntHeader mode (0 NORMAL, 1 TS, 2 PINT, 4 NONE)", intMode);
+    cmd.Parse(argc, argv);
+    IntHeader::mode = (IntHeader::Mode)intMode;
+
+    if (qps < 1)
+    {
+        std::cerr << "need at least 1 qp" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running bench-rdma-headers with n=" << n << " qps=" << qps << " size=" << size
+              << " int=" << intMode << std::endl;
+    std::vector<BenchQp> q(qps);
+    for (uint32_t i = 0; i < qps; i++)
+    {
+        q[i].sip = Ipv4Address(0x0b000001 + ((i % 256) << 8));
+        q[i].dip = Ipv4Address(0x0b000001 + (((i + 1) % 256) << 8));
+        q[i].sport = 10000 + i;
+        q[i].dport = 100;
+        q[i].ipid = 0;
+        q[i].seq = 0;
+        q[i].data.InitData(q[i].sip, q[i].dip, q[i].sport, q[i].dport, 3);
+        q[i].ack.InitAck(q[i].dip, q[i].sip);
+    }
+
+    Bench("data, per header", q, n, [size](BenchQp& qp) { return DataPerHeader(qp, size); });
+    Bench("data, template", q, n, [size](BenchQp& qp) { return DataTemplate(qp, size); });
+    Bench("ack, per header", q, n, AckPerHeader);
+    Bench("ack, template", q, n, AckTemplate);
+    return 0;
+}
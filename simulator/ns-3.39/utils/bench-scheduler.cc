@@ -19,10 +19,12 @@
 
 #include "ns3/core-module.h"
 
-#include <cmath> // sqrt
+#include <cmath> // ceil, sqrt
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <new>
 #include <string.h>
 #include <vector>
 
@@ -47,6 +49,54 @@ std::string g_me;
 /** Output field width for numeric data. */
 int g_fwidth = 6;
 
+/** Flag to drive the schedulers directly, without the simulator. */
+bool g_direct = false;
+
+/** Number of heap allocations, counted by the global operator new below. */
+uint64_t g_allocations = 0;
+
+/**
+ * Count the heap allocations, from the events and the schedulers,
+ * so that runs with and without the slab allocator can be compared.
+ *
+ * \param [in] size The size of the allocation.
+ * 
+eturns The memory.
+ */
+void*
+operator new(std::size_t size)
+{
+    ++g_allocations;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Release memory from the operator new above.
+ *
+ * \param [in] p The memory.
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Release memory from the operator new above.
+ *
+ * \param [in] p The memory.
+ */
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 /**
  *  Benchmark instance which can do a single run.
  *
@@ -100,13 +150,25 @@ class Bench
         m_total = total;
     }
 
+    /**
+     * Drive a scheduler directly, without the simulator.
+     * \param [in] factory Factory pre-configured to create the desired Scheduler.
+     */
+    void SetDirect(const ObjectFactory& factory)
+    {
+        m_direct = true;
+        m_factory = factory;
+    }
+
     /** The output. */
     struct Result
     {
-        double init;     /**< Time (s) for initialization. */
-        double simu;     /**< Time (s) for simulation. */
-        uint64_t pop;    /**< Event population. */
-        uint64_t events; /**< Number of events executed. */
+        double init;          /**< Time (s) for initialization. */
+        double simu;          /**< Time (s) for simulation. */
+        uint64_t pop;         /**< Event population. */
+        uint64_t events;      /**< Number of events executed. */
+        uint64_t initAllocs;  /**< Heap allocations during initialization. */
+        uint64_t simuAllocs;  /**< Heap allocations during simulation. */
     };
 
     /**
@@ -123,16 +185,30 @@ class Bench
      */
     void Cb();
 
+    /**
+     *  Run the benchmark on the scheduler alone: each event removed
+     *  is replaced by a new one, as Cb() does through the simulator.
+     *
+     * \returns The Result.
+     */
+    Result RunDirect();
+
     Ptr<RandomVariableStream> m_rand; /**< Stream for event delays. */
     uint64_t m_population;            /**< Event population size. */
     uint64_t m_total;                 /**< Total number of events to execute. */
     uint64_t m_count;                 /**< Count of events executed so far. */
+    bool m_direct{false};             /**< Drive the scheduler directly. */
+    ObjectFactory m_factory;          /**< Factory for the scheduler driven directly. */
 
 }; // class Bench
 
 Bench::Result
 Bench::Run()
 {
+    if (m_direct)
+    {
+        return RunDirect();
+    }
     SystemWallClockMs timer;
     double init;
     double simu;
@@ -140,6 +216,7 @@ Bench::Run()
     DEB("initializing");
     m_count = 0;
 
+    uint64_t allocs = g_allocations;
     timer.Start();
     for (uint64_t i = 0; i < m_population; ++i)
     {
@@ -147,17 +224,57 @@ Bench::Run()
         Simulator::Schedule(at, &Bench::Cb, this);
     }
     init = timer.End() / 1000.0;
+    uint64_t initAllocs = g_allocations - allocs;
     DEB("initialization took " << init << "s");
 
     DEB("running");
+    allocs = g_allocations;
     timer.Start();
     Simulator::Run();
     simu = timer.End() / 1000.0;
+    uint64_t simuAllocs = g_allocations - allocs;
     DEB("run took " << simu << "s");
 
     Simulator::Destroy();
 
-    return Result{init, simu, m_population, m_count};
+    return Result{init, simu, m_population, m_count, initAllocs, simuAllocs};
+}
+
+Bench::Result
+Bench::RunDirect()
+{
+    SystemWallClockMs timer;
+    double init;
+    double simu;
+
+    Ptr<Scheduler> scheduler = m_factory.Create<Scheduler>();
+    Scheduler::Event ev{nullptr, {0, 0, 0}};
+    m_count = 0;
+
+    uint64_t allocs = g_allocations;
+    timer.Start();
+    for (uint64_t i = 0; i < m_population; ++i)
+    {
+        ev.key.m_ts = NanoSeconds(m_rand->GetValue()).GetTimeStep();
+        scheduler->Insert(ev);
+        ++ev.key.m_uid;
+    }
+    init = timer.End() / 1000.0;
+    uint64_t initAllocs = g_allocations - allocs;
+
+    allocs = g_allocations;
+    timer.Start();
+    for (; m_count < m_total; ++m_count)
+    {
+        Scheduler::Event next = scheduler->RemoveNext();
+        ev.key.m_ts = next.key.m_ts + NanoSeconds(m_rand->GetValue()).GetTimeStep();
+        scheduler->Insert(ev);
+        ++ev.key.m_uid;
+    }
+    simu = timer.End() / 1000.0;
+    uint64_t simuAllocs = g_allocations - allocs;
+
+    return Result{init, simu, m_population, m_count, initAllocs, simuAllocs};
 }
 
 void
@@ -214,6 +331,7 @@ class BenchSuite
         double time;   /**< Phase run time time (s). */
         double rate;   /**< Phase event rate (events/s). */
         double period; /**< Phase period (s/event). */
+        double allocs; /**< Phase heap allocations per event. */
     };
 
     /** Results from initialization and execution of a single run. */
@@ -248,8 +366,8 @@ class BenchSuite
 BenchSuite::Result
 BenchSuite::Result::Bench(Bench::Result r)
 {
-    return Result{{r.init, r.pop / r.init, r.init / r.pop},
-                  {r.simu, r.events / r.simu, r.simu / r.events}};
+    return Result{{r.init, r.pop / r.init, r.init / r.pop, double(r.initAllocs) / r.pop},
+                  {r.simu, r.events / r.simu, r.simu / r.events, double(r.simuAllocs) / r.events}};
 }
 
 template <typename T>
@@ -260,8 +378,9 @@ BenchSuite::Result::Log(T label) const
 
     LOG(std::left << std::setw(g_fwidth) << label << std::setw(g_fwidth) << init.time
                   << std::setw(g_fwidth) << init.rate << std::setw(g_fwidth) << init.period
-                  << std::setw(g_fwidth) << run.time << std::setw(g_fwidth) << run.rate
-                  << std::setw(g_fwidth) << run.period);
+                  << std::setw(g_fwidth) << init.allocs << std::setw(g_fwidth) << run.time
+                  << std::setw(g_fwidth) << run.rate << std::setw(g_fwidth) << run.period
+                  << std::setw(g_fwidth) << run.allocs);
 }
 
 BenchSuite::BenchSuite(ObjectFactory& factory,
@@ -284,6 +403,10 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     }
 
     Bench bench(pop, total);
+    if (g_direct)
+    {
+        bench.SetDirect(factory);
+    }
     bench.SetRandomStream(eventStream);
     bench.SetPopulation(pop);
     bench.SetTotal(total);
@@ -314,18 +437,21 @@ BenchSuite::Header() const
     // table header
     LOG("");
     LOG(m_scheduler);
-    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(3 * g_fwidth)
+    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(4 * g_fwidth)
                   << "Initialization:" << std::left << "Simulation:");
     LOG(std::left << std::setw(g_fwidth) << "" << std::left << std::setw(g_fwidth) << "Time (s)"
                   << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
                   << std::setw(g_fwidth) << "Per (s/ev)" << std::left << std::setw(g_fwidth)
-                  << "Time (s)" << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
-                  << "Per (s/ev)");
+                  << "Allocs/ev" << std::left << std::setw(g_fwidth) << "Time (s)" << std::left
+                  << std::setw(g_fwidth) << "Rate (ev/s)" << std::left << std::setw(g_fwidth)
+                  << "Per (s/ev)" << std::left << "Allocs/ev");
     LOG(std::setfill('-') << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
                           << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
-                          << std::right << std::setw(g_fwidth) << " " << std::setfill(' '));
+                          << std::right << std::setw(g_fwidth) << " " << std::right
+                          << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
+                          << std::setfill(' '));
 }
 
 void
@@ -345,8 +471,8 @@ BenchSuite::Log() const
 
     uint64_t n{0};                // number of samples
     Result average{m_results[0]}; // average
-    Result moment2{{0, 0, 0},     // 2nd moment, to calculate stdev
-                   {0, 0, 0}};
+    Result moment2{{0, 0, 0, 0},  // 2nd moment, to calculate stdev
+                   {0, 0, 0, 0}};
 
     for (; n < m_results.size(); ++n)
     {
@@ -364,9 +490,11 @@ BenchSuite::Log() const
         ACCUMULATE(init, time);
         ACCUMULATE(init, rate);
         ACCUMULATE(init, period);
+        ACCUMULATE(init, allocs);
         ACCUMULATE(run, time);
         ACCUMULATE(run, rate);
         ACCUMULATE(run, period);
+        ACCUMULATE(run, allocs);
 
 #undef ACCUMULATE
     }
@@ -374,10 +502,12 @@ BenchSuite::Log() const
     auto stdev = Result{
         {std::sqrt(moment2.init.time / n),
          std::sqrt(moment2.init.rate / n),
-         std::sqrt(moment2.init.period / n)},
+         std::sqrt(moment2.init.period / n),
+         std::sqrt(moment2.init.allocs / n)},
         {std::sqrt(moment2.run.time / n),
          std::sqrt(moment2.run.rate / n),
-         std::sqrt(moment2.run.period / n)},
+         std::sqrt(moment2.run.period / n),
+         std::sqrt(moment2.run.allocs / n)},
     };
 
     average.Log("average");
@@ -451,12 +581,63 @@ GetRandomStream(std::string filename)
     return stream;
 }
 
+/**
+ *  Create a RandomVariableStream of datacenter-like next event delays.
+ *
+ *  The delays mimic the events of an RDMA fabric simulation, almost all
+ *  of which are due within a few microseconds:
+ *  - 50% transmit completions, the serialization of a 1 KB packet
+ *    at 400, 100 or 25 Gbps: 21, 84 or 336 ns;
+ *  - 30% channel deliveries, a link delay of 1 us;
+ *  - 15% pacing wakeups, uniform in [10, 2000] ns;
+ *  - 5% timers, exponential with mean 100 us.
+ *
+ *  A table of delays is drawn once and then replayed.
+ *
+ *  \returns The RandomVariableStream.
+ */
+Ptr<RandomVariableStream>
+GetDatacenterStream()
+{
+    LOG("  Event time distribution:      datacenter");
+    auto uniform = CreateObject<UniformRandomVariable>();
+    auto timer = CreateObject<ExponentialRandomVariable>();
+    timer->SetAttribute("Mean", DoubleValue(100000));
+    const double serialization[] = {21, 84, 336};
+
+    std::vector<double> nsValues(1 << 20);
+    for (auto& value : nsValues)
+    {
+        double kind = uniform->GetValue();
+        if (kind < 0.5)
+        {
+            value = serialization[uniform->GetInteger(0, 2)];
+        }
+        else if (kind < 0.8)
+        {
+            value = 1000;
+        }
+        else if (kind < 0.95)
+        {
+            value = uniform->GetInteger(10, 2000);
+        }
+        else
+        {
+            value = std::ceil(timer->GetValue());
+        }
+    }
+    auto drv = CreateObject<DeterministicRandomVariable>();
+    drv->SetValueArray(nsValues);
+    return drv;
+}
+
 int
 main(int argc, char* argv[])
 {
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -466,12 +647,14 @@ main(int argc, char* argv[])
     uint64_t runs = 1;
     std::string filename = "";
     bool calRev = false;
+    bool datacenter = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
               "\n"
               "Event intervals are taken from one of:\n"
               "  an exponential distribution, with mean 100 ns,\n"
+              "  a datacenter-like distribution, given by the --dc argument,\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
@@ -482,6 +665,7 @@ main(int argc, char* argv[])
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -490,6 +674,8 @@ main(int argc, char* argv[])
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
+    cmd.AddValue("dc", "use datacenter-like event times", datacenter);
+    cmd.AddValue("direct", "drive the schedulers directly, without the simulator", g_direct);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
 
@@ -501,19 +687,24 @@ main(int argc, char* argv[])
     LOG("  Event population size:        " << pop);
     LOG("  Total events per run:         " << total);
     LOG("  Number of runs per scheduler: " << runs);
+    LOG("  Slab allocator:               " << (SlabAllocator::IsEnabled() ? "on" : "off"));
+    if (g_direct)
+    {
+        LOG("  Schedulers driven directly, without the simulator");
+    }
     DEB("debugging is ON");
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = datacenter ? GetDatacenterStream() : GetRandomStream(filename);
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
@@ -532,6 +723,11 @@ main(int argc, char* argv[])
         factory.SetTypeId("ns3::HeapScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
     if (schedList)
     {
         factory.SetTypeId("ns3::ListScheduler");
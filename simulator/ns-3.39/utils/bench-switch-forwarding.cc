@@ -0,0 +1,214 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the forwarding rate of a single SwitchNode.
+// 'ports' hosts hang off one switch. Host i sends to host (i + 1) % ports at line rate, so every
+// egress port is busy but no queue builds up. Packets enter the switch the same way
+// QbbNetDevice::Receive hands them over, leave it through the egress queues and are counted by
+// the receiving NIC.
+// Sample usage:  ./ns3 run 'bench-switch-forwarding --n=1000000 --ports=32'
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/custom-header.h"
+#include "ns3/interface-tag.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-helper.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/switch-node.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/tcp-header.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// Drives packets through one switch and counts them on the other side
+class SwitchForwardingBench
+{
+  public:
+    /**
+     * \param ports number of hosts (and switch ports)
+     * \param nexthops number of ECMP next hops in each route entry
+     * \param size packet size in bytes, including headers
+     * \param n total number of packets to forward
+     */
+    SwitchForwardingBench(uint32_t ports, uint32_t nexthops, uint32_t size, uint64_t n);
+
+    /// Run the simulation and print the forwarding rate
+    void Run();
+
+  private:
+    /**
+     * \brief Hand the next packet of host i to the switch
+     * \param i the host index
+     */
+    void Inject(uint32_t i);
+
+    /**
+     * \brief Receive callback of the hosts
+     * \return true
+     */
+    bool Receive(Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address&);
+
+    Ptr<SwitchNode> m_switch;
+    std::vector<Ptr<QbbNetDevice>> m_ports; // switch side
+    std::vector<Ptr<Packet>> m_templates;   // one packet per sending host
+    Time m_interval;                        // serialization time of one packet
+    uint64_t m_n;
+    uint64_t m_injected;
+    uint64_t m_received;
+    std::chrono::steady_clock::duration m_ingress; // time spent in SwitchReceiveFromDevice
+};
+
+SwitchForwardingBench::SwitchForwardingBench(uint32_t ports,
+                                             uint32_t nexthops,
+                                             uint32_t size,
+                                             uint64_t n)
+    : m_n(n),
+      m_injected(0),
+      m_received(0),
+      m_ingress(0)
+{
+    const DataRate rate("100Gbps");
+    m_interval = rate.CalculateBytesTxTime(size);
+
+    m_switch = CreateObject<SwitchNode>();
+    QbbHelper qbb;
+    qbb.SetDeviceAttribute("DataRate", DataRateValue(rate));
+    qbb.SetChannelAttribute("Delay", StringValue("1us"));
+    for (uint32_t i = 0; i < ports; i++)
+    {
+        Ptr<Node> host = CreateObject<Node>();
+        NetDeviceContainer d = qbb.Install(m_switch, host);
+        m_ports.push_back(DynamicCast<QbbNetDevice>(d.Get(0)));
+        d.Get(1)->SetReceiveCallback(MakeCallback(&SwitchForwardingBench::Receive, this));
+
+        Ipv4Address addr(0x0b000001 + (i << 8));
+        for (uint32_t k = 0; k < nexthops; k++)
+        {
+            m_switch->AddTableEntry(addr, d.Get(0)->GetIfIndex());
+        }
+    }
+
+    for (uint32_t i = 0; i < ports; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(size - 2 - 20 - 20);
+        TcpHeader th;
+        th.SetSourcePort(10000 + i);
+        th.SetDestinationPort(100);
+        p->AddHeader(th);
+        Ipv4Header ih;
+        ih.SetSource(Ipv4Address(0x0b000001 + (i << 8)));
+        ih.SetDestination(Ipv4Address(0x0b000001 + (((i + 1) % ports) << 8)));
+        ih.SetProtocol(0x6);
+        ih.SetPayloadSize(p->GetSize());
+        ih.SetTtl(64);
+        p->AddHeader(ih);
+        PppHeader ppp;
+        ppp.SetProtocol(0x0021);
+        p->AddHeader(ppp);
+        m_templates.push_back(p);
+    }
+}
+
+void
+SwitchForwardingBench::Inject(uint32_t i)
+{
+    if (m_injected >= m_n)
+    {
+        return;
+    }
+    m_injected++;
+
+    // what QbbNetDevice::Receive does for a switch
+    Ptr<Packet> p = m_templates[i]->Copy();
+    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    ch.getInt = 1;
+    p->PeekHeader(ch);
+    p->AddPacketTag(InterfaceTag(m_ports[i]->GetIfIndex()));
+
+    auto start = std::chrono::steady_clock::now();
+    m_switch->SwitchReceiveFromDevice(m_ports[i], p, ch);
+    m_ingress += std::chrono::steady_clock::now() - start;
+
+    Simulator::Schedule(m_interval, &SwitchForwardingBench::Inject, this, i);
+}
+
+bool
+SwitchForwardingBench::Receive(Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address&)
+{
+    m_received++;
+    return true;
+}
+
+void
+SwitchForwardingBench::Run()
+{
+    for (uint32_t i = 0; i < m_ports.size(); i++)
+    {
+        Simulator::Schedule(NanoSeconds(i), &SwitchForwardingBench::Inject, this, i);
+    }
+    SystemWallClockMs clock;
+    clock.Start();
+    Simulator::Run();
+    int64_t ms = clock.End();
+    Simulator::Destroy();
+
+    double ingressMs = std::chrono::duration<double, std::milli>(m_ingress).count();
+    std::cout << "forwarded " << m_received << " of " << m_injected << " packets in " << ms
+              << " ms, " << (ms > 0 ? m_received * 1000.0 / ms : 0) << " packets/s" << std::endl;
+    std::cout << "switch ingress (lookup, admission, enqueue) " << ingressMs << " ms, "
+              << (ingressMs > 0 ? m_injected * 1000.0 / ingressMs : 0) << " packets/s"
+              << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t n = 1000000;
+    uint32_t ports = 32;
+    uint32_t nexthops = 1;
+    uint32_t size = 1000;
+    std::string lb = "Ecmp";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "number of packets to forward", n);
+    cmd.AddValue("ports", "number of switch ports", ports);
+    cmd.AddValue("nexthops", "number of ECMP next hops per route", nexthops);
+    cmd.AddValue("size", "packet size in bytes", size);
+    cmd.AddValue("lb", "SwitchLoadBalancer mode", lb);
+    cmd.Parse(argc, argv);
+    Config::SetDefault("ns3::SwitchLoadBalancer::Mode", StringValue(lb));
+
+    if (ports < 2 || nexthops < 1 || size < 64)
+    {
+        std::cerr << "need at least 2 ports, 1 next hop and 64 byte packets" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running bench-switch-forwarding with n=" << n << " ports=" << ports
+              << " nexthops=" << nexthops << " size=" << size << " lb=" << lb << std::endl;
+    SwitchForwardingBench bench(ports, nexthops, size, n);
+    bench.Run();
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the admission rate of SwitchMmu for every buffer model and buffer sharing
+// algorithm. Each packet goes through the same calls SwitchNode makes: ingress and egress
+// admission checks, the updates, PFC pause/resume checks and, once the buffer holds 'inflight'
+// packets, the removal of the oldest one.
+// Sample usage:  ./ns3 run 'bench-switch-mmu --n=2000000'
+
+#include "ns3/command-line.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace ns3;
+
+/// A packet held by the benchmark's switch buffer
+struct BenchPacket
+{
+    uint32_t inPort;  //!< ingress port
+    uint32_t outPort; //!< egress port
+    uint32_t qIndex;  //!< queue
+    uint32_t size;    //!< bytes
+    uint32_t type;    //!< 0 lossless, 1 lossy
+};
+
+/**
+ * \brief Run n packets through one MMU configuration
+ * \param model buffer model
+ * \param alg buffer sharing algorithm, see switch-mmu.cc
+ * \param algName name of alg to print
+ * \param n number of packets
+ * \param ports number of ports
+ * \param inflight packets held in the buffer
+ */
+static void
+RunBench(std::string model,
+         uint32_t alg,
+         std::string algName,
+         uint64_t n,
+         uint32_t ports,
+         uint32_t inflight)
+{
+    Ptr<SwitchMmu> mmu = CreateObject<SwitchMmu>();
+    for (uint32_t p = 0; p < ports; p++)
+    {
+        mmu->AddPort(p);
+    }
+    mmu->SetBufferModel(model);
+    mmu->SetIngressLossyAlg(alg);
+    mmu->SetIngressLosslessAlg(alg);
+    mmu->SetEgressLossyAlg(alg);
+    mmu->SetEgressLosslessAlg(alg);
+    mmu->SetPortCount(ports);
+    mmu->SetHeadroom(100 * 1000);
+    mmu->SetAlphaIngress(1);
+    mmu->SetAlphaEgress(1);
+    mmu->SetBufferPool(32 * 1024 * 1024);
+    mmu->SetIngressPool(32 * 1024 * 1024 - ports * 8 * 100 * 1000);
+    mmu->SetSharedPool(32 * 1024 * 1024 - ports * 8 * 100 * 1000);
+    mmu->SetEgressLosslessPool(32 * 1024 * 1024);
+    mmu->SetEgressLossyPool(16 * 1024 * 1024);
+
+    std::mt19937 rng(1);
+    std::deque<BenchPacket> buffer;
+    uint64_t admitted = 0;
+    SystemWallClockMs clock;
+    clock.Start();
+    for (uint64_t i = 0; i < n; i++)
+    {
+        BenchPacket p;
+        p.inPort = rng() % ports;
+        p.outPort = rng() % ports;
+        p.qIndex = 1 + rng() % 7;
+        p.size = 64 + rng() % 1437;
+        p.type = p.qIndex < 4 ? 0 : 1;
+        if (mmu->CheckIngressAdmission(p.inPort, p.qIndex, p.size, p.type, 0) &&
+            mmu->CheckEgressAdmission(p.outPort, p.qIndex, p.size, p.type, 0))
+        {
+            mmu->UpdateIngressAdmission(p.inPort, p.qIndex, p.size, p.type, 0);
+            mmu->UpdateEgressAdmission(p.outPort, p.qIndex, p.size, p.type);
+            if (mmu->CheckShouldPause(p.inPort, p.qIndex))
+            {
+                mmu->SetPause(p.inPort, p.qIndex);
+            }
+            buffer.push_back(p);
+            admitted++;
+        }
+        if (buffer.size() > inflight)
+        {
+            BenchPacket& d = buffer.front();
+            mmu->RemoveFromIngressAdmission(d.inPort, d.qIndex, d.size, d.type);
+            mmu->RemoveFromEgressAdmission(d.outPort, d.qIndex, d.size, d.type);
+            mmu->ShouldSendCN(d.outPort, d.qIndex);
+            if (mmu->CheckShouldResume(d.inPort, d.qIndex))
+            {
+                mmu->SetResume(d.inPort, d.qIndex);
+            }
+            buffer.pop_front();
+        }
+    }
+    int64_t ms = clock.End();
+    Simulator::Destroy();
+
+    std::cout << model << "\t" << algName << "\t" << ms << " ms\t"
+              << (ms > 0 ? n * 1000.0 / ms : 0) << " packets/s\t" << admitted << " admitted"
+              << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t n = 2000000;
+    uint32_t ports = 64;
+    uint32_t inflight = 2000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "number of packets per configuration", n);
+    cmd.AddValue("ports", "number of switch ports", ports);
+    cmd.AddValue("inflight", "number of packets held in the buffer", inflight);
+    cmd.Parse(argc, argv);
+
+    std::cout << "Running bench-switch-mmu with n=" << n << " ports=" << ports
+              << " inflight=" << inflight << std::endl;
+    RunBench("sonic", 101, "DT", n, ports, inflight);
+    RunBench("sonic", 110, "ABM", n, ports, inflight);
+    RunBench("sonic", 102, "FAB", n, ports, inflight);
+    RunBench("reverie", 101, "Reverie", n, ports, inflight);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Converts the flow.txt and topology.txt of the datacenter examples to the binary formats of
+// FlowTraceFile and TopologyFile, which the examples read in place of the text files.
+// With --compare, also times a full read of the flow trace in both formats.
+// Sample usage:
+//   ./ns3 run 'convert-trace --flowIn=flow.txt --flowOut=flow.bin --compare'
+//   ./ns3 run 'convert-trace --topologyIn=topology.txt --topologyOut=topology.bin'
+
+#include "ns3/command-line.h"
+#include "ns3/flow-trace-file.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/topology-file.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \brief Read a flow trace to the end
+ * \param fileName the trace
+ * \return the sum of the flow sizes, so that the reads are not optimized away
+ */
+static uint64_t
+ReadAll(const std::string& fileName)
+{
+    FlowTraceFile trace;
+    if (!trace.Open(fileName))
+    {
+        std::cerr << "Can't read " << fileName << std::endl;
+        exit(1);
+    }
+    FlowTraceRecord record;
+    uint64_t bytes = 0;
+    while (trace.Read(record))
+    {
+        bytes += record.size;
+    }
+    return bytes;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string flowIn;
+    std::string flowOut;
+    std::string topologyIn;
+    std::string topologyOut;
+    bool compare = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("flowIn", "text flow trace to convert", flowIn);
+    cmd.AddValue("flowOut", "binary flow trace to write", flowOut);
+    cmd.AddValue("topologyIn", "text topology to convert", topologyIn);
+    cmd.AddValue("topologyOut", "binary topology to write", topologyOut);
+    cmd.AddValue("compare", "time a full read of the text and binary flow traces", compare);
+    cmd.Parse(argc, argv);
+
+    if (!flowIn.empty() && !flowOut.empty())
+    {
+        SystemWallClockMs clock;
+        clock.Start();
+        if (!FlowTraceFile::Convert(flowIn, flowOut))
+        {
+            std::cerr << "Can't convert " << flowIn << " to " << flowOut << std::endl;
+            return 1;
+        }
+        std::cout << "flows: " << flowIn << " -> " << flowOut << " in " << clock.End() << " ms"
+                  << std::endl;
+        if (compare)
+        {
+            clock.Start();
+            uint64_t textBytes = ReadAll(flowIn);
+            int64_t text = clock.End();
+            clock.Start();
+            uint64_t binaryBytes = ReadAll(flowOut);
+            int64_t binary = clock.End();
+            std::cout << "read text " << text << " ms, binary " << binary << " ms"
+                      << (textBytes == binaryBytes ? "" : " (different flows!)") << std::endl;
+        }
+    }
+    if (!topologyIn.empty() && !topologyOut.empty())
+    {
+        if (!TopologyFile::Convert(topologyIn, topologyOut))
+        {
+            std::cerr << "Can't convert " << topologyIn << " to " << topologyOut << std::endl;
+            return 1;
+        }
+        std::cout << "topology: " << topologyIn << " -> " << topologyOut << std::endl;
+    }
+    return 0;
+}